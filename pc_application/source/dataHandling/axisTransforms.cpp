@@ -0,0 +1,157 @@
+#include "axisTransforms.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// First axis of each group, in the order of ControllerNumberValues
+static constexpr uint8_t groupFirstAxis[NUM_OF_AXIS_GROUPS] = { ControllerNumberValues::LEFT_X, ControllerNumberValues::RIGHT_X, ControllerNumberValues::ACCEL_X, ControllerNumberValues::GYRO_1 };
+static constexpr uint8_t groupNumOfAxes[NUM_OF_AXIS_GROUPS] = { 2, 2, 3, 3 };
+
+static constexpr float axisLimit        = 32767.0f;
+static constexpr float degreesToRadians = 3.14159265358979f / 180.0f;
+
+// Rounds and clamps the values back into the column
+static void storeColumn(int16_t* column, const float* values, uint32_t count) {
+	for(uint32_t i = 0; i < count; i++) {
+		float value = std::min(std::max(values[i], -axisLimit), axisLimit);
+		column[i]   = (int16_t)(value < 0.0f ? value - 0.5f : value + 0.5f);
+	}
+}
+
+static void transformRun(FrameChunk& chunk, uint32_t index, uint32_t count, const AxisTransform& transform) {
+	uint8_t firstAxis = groupFirstAxis[transform.group];
+	uint8_t numOfAxes = groupNumOfAxes[transform.group];
+	float amount      = transform.amount;
+
+	float values[3][FRAME_CHUNK_SIZE];
+	float lengths[FRAME_CHUNK_SIZE];
+	for(uint8_t axis = 0; axis < numOfAxes; axis++) {
+		const int16_t* column = &chunk.axes[firstAxis + axis][index];
+		for(uint32_t i = 0; i < count; i++) {
+			values[axis][i] = column[i];
+		}
+	}
+
+	float* x = values[0];
+	float* y = values[1];
+
+	switch(transform.type) {
+	case AXIS_TRANSFORM_SCALE:
+		for(uint8_t axis = 0; axis < numOfAxes; axis++) {
+			for(uint32_t i = 0; i < count; i++) {
+				values[axis][i] *= amount;
+			}
+		}
+		break;
+	case AXIS_TRANSFORM_CLAMP:
+	case AXIS_TRANSFORM_SET_MAGNITUDE:
+		for(uint32_t i = 0; i < count; i++) {
+			lengths[i] = 0.0f;
+		}
+		for(uint8_t axis = 0; axis < numOfAxes; axis++) {
+			for(uint32_t i = 0; i < count; i++) {
+				lengths[i] += values[axis][i] * values[axis][i];
+			}
+		}
+		// Lengths become how much to scale by, anything under 1 is the center
+		if(transform.type == AXIS_TRANSFORM_CLAMP) {
+			for(uint32_t i = 0; i < count; i++) {
+				lengths[i] = std::min(1.0f, std::fabs(amount) / std::max(std::sqrt(lengths[i]), 1.0f));
+			}
+		} else {
+			for(uint32_t i = 0; i < count; i++) {
+				lengths[i] = amount / std::max(std::sqrt(lengths[i]), 1.0f);
+			}
+		}
+		for(uint8_t axis = 0; axis < numOfAxes; axis++) {
+			for(uint32_t i = 0; i < count; i++) {
+				values[axis][i] *= lengths[i];
+			}
+		}
+		break;
+	case AXIS_TRANSFORM_ROTATE: {
+		float c = std::cos(amount * degreesToRadians);
+		float s = std::sin(amount * degreesToRadians);
+		for(uint32_t i = 0; i < count; i++) {
+			float rotatedX = x[i] * c - y[i] * s;
+			y[i]           = x[i] * s + y[i] * c;
+			x[i]           = rotatedX;
+		}
+	} break;
+	case AXIS_TRANSFORM_SET_ANGLE: {
+		float c = std::cos(amount * degreesToRadians);
+		float s = std::sin(amount * degreesToRadians);
+		for(uint32_t i = 0; i < count; i++) {
+			float length = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+			x[i]         = length * c;
+			y[i]         = length * s;
+		}
+	} break;
+	default:
+		return;
+	}
+
+	for(uint8_t axis = 0; axis < numOfAxes; axis++) {
+		storeColumn(&chunk.axes[firstAxis + axis][index], values[axis], count);
+	}
+}
+
+static void smoothAxes(FrameStore& frames, FrameNum first, FrameNum last, const AxisTransform& transform) {
+	uint8_t firstAxis = groupFirstAxis[transform.group];
+	uint8_t numOfAxes = groupNumOfAxes[transform.group];
+	uint32_t count    = last - first + 1;
+	// Frames on each side of the one being averaged
+	uint32_t radius = (uint32_t)std::max(transform.amount, 1.0f) / 2;
+	if(radius == 0) {
+		return;
+	}
+
+	// Sums of every frame before, so any window is one subtraction
+	std::vector<int64_t> sums[3];
+	for(uint8_t axis = 0; axis < numOfAxes; axis++) {
+		sums[axis].resize(count + 1);
+	}
+
+	frames.forEachRun(first, last, [&](uint32_t frame, const FrameChunk& chunk, uint32_t index, uint32_t runCount) {
+		for(uint8_t axis = 0; axis < numOfAxes; axis++) {
+			int64_t* sum          = &sums[axis][frame - first];
+			const int16_t* column = &chunk.axes[firstAxis + axis][index];
+			for(uint32_t i = 0; i < runCount; i++) {
+				sum[i + 1] = sum[i] + column[i];
+			}
+		}
+	});
+
+	frames.forEachWritableRun(first, last, [&](uint32_t frame, FrameChunk& chunk, uint32_t index, uint32_t runCount) {
+		float values[FRAME_CHUNK_SIZE];
+		for(uint8_t axis = 0; axis < numOfAxes; axis++) {
+			const int64_t* sum = sums[axis].data();
+			for(uint32_t i = 0; i < runCount; i++) {
+				uint32_t at   = frame - first + i;
+				uint32_t low  = at > radius ? at - radius : 0;
+				uint32_t high = std::min(at + radius, count - 1);
+				values[i]     = (float)(sum[high + 1] - sum[low]) / (high - low + 1);
+			}
+			storeColumn(&chunk.axes[firstAxis + axis][index], values, runCount);
+		}
+	});
+}
+
+void transformAxes(FrameStore& frames, FrameNum first, FrameNum last, const AxisTransform& transform) {
+	if(frames.size() == 0 || first >= frames.size() || transform.group >= NUM_OF_AXIS_GROUPS) {
+		return;
+	}
+	last = std::min(last, frames.size() - 1);
+	if(first > last) {
+		return;
+	}
+
+	if(transform.type == AXIS_TRANSFORM_SMOOTH) {
+		smoothAxes(frames, first, last, transform);
+	} else {
+		frames.forEachWritableRun(first, last, [&](uint32_t frame, FrameChunk& chunk, uint32_t index, uint32_t count) {
+			transformRun(chunk, index, count, transform);
+		});
+	}
+}
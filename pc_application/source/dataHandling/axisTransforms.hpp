@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "buttonConstants.hpp"
+#include "frameStore.hpp"
+
+enum AxisGroup : uint8_t {
+	AXIS_GROUP_LEFT_STICK,
+	AXIS_GROUP_RIGHT_STICK,
+	AXIS_GROUP_ACCEL,
+	AXIS_GROUP_GYRO,
+	NUM_OF_AXIS_GROUPS,
+};
+
+// Rotating and angles use the first two axes of the group, the rest use all of them
+enum AxisTransformType : uint8_t {
+	// Multiplies by amount
+	AXIS_TRANSFORM_SCALE,
+	// Keeps the length within amount, sticks stay round
+	AXIS_TRANSFORM_CLAMP,
+	// Counterclockwise by amount degrees
+	AXIS_TRANSFORM_ROTATE,
+	// Points at amount degrees, keeping the length
+	AXIS_TRANSFORM_SET_ANGLE,
+	// Makes the length amount, keeping the angle
+	AXIS_TRANSFORM_SET_MAGNITUDE,
+	// Averages amount frames around each frame
+	AXIS_TRANSFORM_SMOOTH,
+	NUM_OF_AXIS_TRANSFORMS,
+};
+
+struct AxisTransform {
+	AxisTransformType type = AXIS_TRANSFORM_SCALE;
+	AxisGroup group        = AXIS_GROUP_LEFT_STICK;
+	float amount           = 1.0f;
+};
+
+// Changes the axes of first to last a whole column of a chunk at a time
+// The loops are plain float math over arrays, so the compiler can vectorize them
+void transformAxes(FrameStore& frames, FrameNum first, FrameNum last, const AxisTransform& transform);
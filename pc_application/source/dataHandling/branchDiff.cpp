@@ -0,0 +1,174 @@
+#include "branchDiff.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// Adds the frames to the end of ranges, joining them onto the last range when they touch
+static void addRange(std::vector<FrameRange>& ranges, FrameNum first, FrameNum last) {
+	if(!ranges.empty() && ranges.back().last + 1 == first) {
+		ranges.back().last = last;
+	} else {
+		ranges.push_back({ first, last });
+	}
+}
+
+static bool sameInputs(const FrameChunk& a, uint32_t indexA, const FrameChunk& b, uint32_t indexB, uint32_t count) {
+	if(memcmp(&a.buttons[indexA], &b.buttons[indexB], count * sizeof(uint32_t)) != 0) {
+		return false;
+	}
+	for(uint8_t axis = 0; axis < NUM_OF_FRAME_AXES; axis++) {
+		if(memcmp(&a.axes[axis][indexA], &b.axes[axis][indexB], count * sizeof(int16_t)) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void diffSegment(std::vector<FrameRange>& ranges, FrameNum frame, const FrameChunk& a, uint32_t indexA, const FrameChunk& b, uint32_t indexB, uint32_t count) {
+	if(sameInputs(a, indexA, b, indexB, count)) {
+		return;
+	}
+	for(uint32_t i = 0; i < count; i++) {
+		if(!sameInputs(a, indexA + i, b, indexB + i, 1)) {
+			addRange(ranges, frame + i, frame + i);
+		}
+	}
+}
+
+std::vector<FrameRange> diffFrames(const FrameStore& a, const FrameStore& b, FrameNum first, FrameNum last) {
+	std::vector<FrameRange> ranges;
+	FrameNum shared = std::min(a.size(), b.size());
+	FrameNum longer = std::max(a.size(), b.size());
+	if(longer == 0 || first > last || first >= longer) {
+		return ranges;
+	}
+	last = std::min(last, longer - 1);
+
+	if(first < shared) {
+		std::vector<ChunkRef> runsA = a.getRuns(first, std::min(last, shared - 1));
+		std::vector<ChunkRef> runsB = b.getRuns(first, std::min(last, shared - 1));
+
+		// Both lists cover the same frames, so walk them together cutting at every edge of either
+		FrameNum frame   = first;
+		std::size_t runA = 0;
+		std::size_t runB = 0;
+		uint32_t offsetA = 0;
+		uint32_t offsetB = 0;
+		while(runA < runsA.size() && runB < runsB.size()) {
+			const ChunkRef& refA = runsA[runA];
+			const ChunkRef& refB = runsB[runB];
+			uint32_t count       = std::min(refA.size - offsetA, refB.size - offsetB);
+			uint32_t indexA      = refA.first + offsetA;
+			uint32_t indexB      = refB.first + offsetB;
+
+			// The same frames of the same chunk, nothing to read
+			if(refA.data != refB.data || indexA != indexB) {
+				diffSegment(ranges, frame, *refA.data, indexA, *refB.data, indexB, count);
+			}
+
+			frame += count;
+			offsetA += count;
+			offsetB += count;
+			if(offsetA == refA.size) {
+				runA++;
+				offsetA = 0;
+			}
+			if(offsetB == refB.size) {
+				runB++;
+				offsetB = 0;
+			}
+		}
+	}
+
+	if(last >= shared) {
+		addRange(ranges, std::max(first, shared), last);
+	}
+
+	return ranges;
+}
+
+// Inputs of first to last copied out column by column, frames past the end of the store stay empty
+struct InputColumns {
+	std::vector<uint32_t> buttons;
+	std::vector<int16_t> axes[NUM_OF_FRAME_AXES];
+
+	void read(const FrameStore& frames, FrameNum first, FrameNum last) {
+		uint32_t count = last - first + 1;
+		buttons.assign(count, 0);
+		for(uint8_t axis = 0; axis < NUM_OF_FRAME_AXES; axis++) {
+			axes[axis].assign(count, 0);
+		}
+		if(first >= frames.size()) {
+			return;
+		}
+
+		frames.forEachRun(first, std::min(last, frames.size() - 1), [&](uint32_t frame, const FrameChunk& chunk, uint32_t index, uint32_t runCount) {
+			std::copy_n(&chunk.buttons[index], runCount, &buttons[frame - first]);
+			for(uint8_t axis = 0; axis < NUM_OF_FRAME_AXES; axis++) {
+				std::copy_n(&chunk.axes[axis][index], runCount, &axes[axis][frame - first]);
+			}
+		});
+	}
+};
+
+MergeResult mergeFrames(FrameStore& target, const FrameStore& source, const FrameStore& base, FrameNum first, FrameNum last, bool preferSource) {
+	MergeResult result;
+	FrameNum shared = std::min(source.size(), target.size());
+	if(first > last || first >= shared) {
+		return result;
+	}
+
+	// Only frames source changed can change target
+	std::vector<FrameRange> changed = diffFrames(source, base, first, std::min(last, shared - 1));
+	if(changed.empty()) {
+		return result;
+	}
+
+	InputColumns ours;
+	InputColumns theirs;
+	InputColumns original;
+	for(FrameRange range : changed) {
+		ours.read(target, range.first, range.last);
+		theirs.read(source, range.first, range.last);
+		original.read(base, range.first, range.last);
+
+		for(uint32_t i = 0; i <= range.last - range.first; i++) {
+			FrameNum frame = range.first + i;
+			// Buttons source pressed or released since the base
+			uint32_t mask    = theirs.buttons[i] ^ original.buttons[i];
+			uint32_t buttons = (theirs.buttons[i] & mask) | (ours.buttons[i] & ~mask);
+			bool different   = buttons != ours.buttons[i];
+			bool conflict    = false;
+
+			int16_t axes[NUM_OF_FRAME_AXES];
+			for(uint8_t axis = 0; axis < NUM_OF_FRAME_AXES; axis++) {
+				int16_t mine  = ours.axes[axis][i];
+				int16_t other = theirs.axes[axis][i];
+				int16_t old   = original.axes[axis][i];
+				axes[axis]    = mine;
+				if(other == old || other == mine) {
+					continue;
+				}
+				if(mine != old) {
+					conflict = true;
+					if(!preferSource) {
+						continue;
+					}
+				}
+				axes[axis] = other;
+				different  = true;
+			}
+
+			if(conflict) {
+				addRange(result.conflicts, frame, frame);
+			}
+			if(different) {
+				target.setInputs(frame, buttons, axes, NUM_OF_FRAME_AXES);
+				result.changedFrames++;
+				result.firstChangedFrame = std::min(result.firstChangedFrame, frame);
+			}
+		}
+	}
+
+	return result;
+}
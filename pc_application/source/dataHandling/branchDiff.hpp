@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buttonConstants.hpp"
+#include "frameStore.hpp"
+
+// Last is included, like a selection in the editor
+struct FrameRange {
+	FrameNum first;
+	FrameNum last;
+};
+
+struct MergeResult {
+	FrameNum changedFrames     = 0;
+	FrameNum firstChangedFrame = UINT32_MAX;
+	// Frames where both branches changed the same axis differently from the base
+	std::vector<FrameRange> conflicts;
+};
+
+// Frames first to last where the inputs of the two stores differ, frame states aren't compared
+// Chunks both stores still share are skipped without reading them, only the ones copied on write are compared
+// A frame only one of the stores has counts as different
+std::vector<FrameRange> diffFrames(const FrameStore& a, const FrameStore& b, FrameNum first, FrameNum last);
+
+// Brings what source changed since base into target, for first to last
+// Buttons merge one button at a time, axes one axis at a time, anything only target changed is kept
+// When both changed an axis differently preferSource picks which one wins, the frame is reported as a conflict either way
+// Frames past the end of target are left alone, grow it first to merge them, frames past the end of base count as empty
+MergeResult mergeFrames(FrameStore& target, const FrameStore& source, const FrameStore& base, FrameNum first, FrameNum last, bool preferSource);
@@ -13,6 +13,7 @@
 #include <wx/wx.h>
 
 #include "../sharedNetworkCode/buttonData.hpp"
+#include "frameStore.hpp"
 
 // So that types are somewhat unified
 typedef uint32_t FrameNum;
@@ -45,11 +46,16 @@ struct Savestate {
 	uint32_t frame;
 };
 
-typedef std::vector<std::shared_ptr<std::vector<std::shared_ptr<ControllerData>>>> SavestateHookBlock;
+typedef std::vector<std::shared_ptr<FrameStore>> SavestateHookBlock;
 struct SavestateHook {
 	std::string dHash;
 	wxBitmap* screenshot;
 	SavestateHookBlock inputs;
+	// RAM hash after each frame ran, the index is the branch and then the frame
+	// Only the first player's hooks keep them, 0 means the frame wasn't hashed
+	std::vector<std::vector<uint64_t>> ramHashes;
+	// Hashes from the last final TAS that started at this hook, the next run is compared to them
+	std::vector<uint64_t> finalTasRamHashes;
 };
 
 enum ControllerNumberValues : uint8_t {
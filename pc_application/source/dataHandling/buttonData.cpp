@@ -31,6 +31,7 @@ void ButtonData::setupButtonMapping(rapidjson::Document* mainSettings) {
 
 		// For later
 		scriptNameToButton[scriptName] = chosenButton;
+		scriptConverter.setButtonName(chosenButton, scriptName);
 
 		thisButtonInfo->onIcon = new wxImage();
 		thisButtonInfo->onIcon->LoadFile(onIconImage, wxBITMAP_TYPE_PNG);
@@ -73,36 +74,20 @@ void ButtonData::setupButtonMapping(rapidjson::Document* mainSettings) {
 }
 
 FrameNum ButtonData::textToFrames(DataProcessing* dataProcessing, std::string text, FrameNum startLoc, bool insertPaste, bool placePaste) {
-	std::vector<std::string> frameParts = HELPERS::splitString(text, '\n');
-	bool haveSetFirstFrame              = false;
+	const char* cursor     = text.data();
+	const char* end        = text.data() + text.size();
+	bool haveSetFirstFrame = false;
 	FrameNum firstFrame;
 	FrameNum lastReadFrame;
-	for(std::string frame : frameParts) {
-		// Split on whitespace
-		std::vector<std::string> parts = HELPERS::splitString(frame, ' ');
-		// This is to allow a variable number of parts
-		uint8_t currentIndexInParts = 0;
-
-		// This is repeated to break function when it runs out of parts, allows variable
-		// Amounts of data per line
-		if(parts.size() == currentIndexInParts)
-			continue;
-
-		// Has to be decimal number
-		FrameNum frameNum = strtol(parts[currentIndexInParts].c_str(), nullptr, 10);
-
+	ScriptLine line;
+	while(scriptConverter.readLine(cursor, end, line)) {
 		if(!haveSetFirstFrame) {
 			// This is the first script frame, it will be put at the startLoc
-			firstFrame = frameNum;
+			firstFrame = line.frame;
 		}
 
 		// The actual index
-		FrameNum actualIndex = startLoc + (frameNum - firstFrame);
-
-		// Just to keep the app running
-		if(actualIndex % 50 == 0) {
-			wxTheApp->Yield();
-		}
+		FrameNum actualIndex = startLoc + (line.frame - firstFrame);
 
 		FrameNum thisDataIndex;
 
@@ -134,8 +119,8 @@ FrameNum ButtonData::textToFrames(DataProcessing* dataProcessing, std::string te
 		// Have reference, so we can now do this
 		lastReadFrame = actualIndex;
 
-		currentIndexInParts++;
-		if(parts.size() == currentIndexInParts)
+		// Allows variable amounts of data per line
+		if(line.numOfParts < SCRIPT_PART_BUTTONS)
 			continue;
 
 		if(!placePaste) {
@@ -143,67 +128,16 @@ FrameNum ButtonData::textToFrames(DataProcessing* dataProcessing, std::string te
 			dataProcessing->clearAllButtons(thisDataIndex);
 		}
 
-		// Deal with buttons
-		// Can be no buttons at all
-		if(parts[currentIndexInParts] != "NONE") {
-			for(std::string buttonName : HELPERS::splitString(parts[currentIndexInParts], ';')) {
-				if(scriptNameToButton.count(buttonName)) {
-					dataProcessing->modifyButton(thisDataIndex, scriptNameToButton[buttonName], true);
-				}
+		for(uint8_t btn = 0; btn < Btn::BUTTONS_SIZE; btn++) {
+			if(GET_BIT(line.buttons, btn)) {
+				dataProcessing->modifyButton(thisDataIndex, (Btn)btn, true);
 			}
 		}
 
-		currentIndexInParts++;
-		if(parts.size() == currentIndexInParts)
-			continue;
-
-		// Joysticks
-		std::vector<std::string> joystickPartsLeft = HELPERS::splitString(parts[currentIndexInParts], ';');
-		if(joystickPartsLeft.size() == 2) {
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::LEFT_X, strtol(joystickPartsLeft[0].c_str(), nullptr, 10));
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::LEFT_Y, strtol(joystickPartsLeft[1].c_str(), nullptr, 10));
-		} else {
-			continue;
-		}
-
-		currentIndexInParts++;
-		if(parts.size() == currentIndexInParts)
-			continue;
-
-		std::vector<std::string> joystickPartsRight = HELPERS::splitString(parts[currentIndexInParts], ';');
-		if(joystickPartsRight.size() == 2) {
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::RIGHT_X, strtol(joystickPartsRight[0].c_str(), nullptr, 10));
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::RIGHT_Y, strtol(joystickPartsRight[1].c_str(), nullptr, 10));
-		} else {
-			continue;
-		}
-
-		currentIndexInParts++;
-		if(parts.size() == currentIndexInParts)
-			continue;
-
-		// Accelerometer and gyro data
-
-		std::vector<std::string> accelParts = HELPERS::splitString(parts[currentIndexInParts], ';');
-		if(accelParts.size() == 3) {
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::ACCEL_X, strtol(accelParts[0].c_str(), nullptr, 10));
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::ACCEL_Y, strtol(accelParts[1].c_str(), nullptr, 10));
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::ACCEL_Z, strtol(accelParts[2].c_str(), nullptr, 10));
-		} else {
-			continue;
-		}
-
-		currentIndexInParts++;
-		if(parts.size() == currentIndexInParts)
-			continue;
-
-		std::vector<std::string> gyroParts = HELPERS::splitString(parts[currentIndexInParts], ';');
-		if(gyroParts.size() == 3) {
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::GYRO_1, strtol(gyroParts[0].c_str(), nullptr, 10));
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::GYRO_2, strtol(gyroParts[1].c_str(), nullptr, 10));
-			dataProcessing->setNumberValues(thisDataIndex, ControllerNumberValues::GYRO_3, strtol(gyroParts[2].c_str(), nullptr, 10));
-		} else {
-			continue;
+		// Joysticks, accelerometer and gyro data, in the same order as the line
+		uint8_t numOfAxes = ScriptConverter::numOfAxes(line.numOfParts);
+		for(uint8_t axis = 0; axis < numOfAxes; axis++) {
+			dataProcessing->setNumberValues(thisDataIndex, (ControllerNumberValues)axis, line.axes[axis]);
 		}
 	}
 
@@ -212,136 +146,48 @@ FrameNum ButtonData::textToFrames(DataProcessing* dataProcessing, std::string te
 
 std::string ButtonData::framesToText(DataProcessing* dataProcessing, FrameNum startLoc, FrameNum endLoc, int playerIndex, BranchNum branch) {
 	// If the player index is provided, get every savestate hook in that player
-	std::vector<std::string> textVector;
-	// Loop through each frame and convert it
-	SavestateBlockNum start;
-	SavestateBlockNum end;
+	std::string text;
 	if(playerIndex == -1) {
-		start = dataProcessing->getCurrentSavestateHook();
-		end   = dataProcessing->getCurrentSavestateHook() + 1;
+		auto& savestateHook = dataProcessing->getAllPlayers()[dataProcessing->getCurrentPlayer()]->at(dataProcessing->getCurrentSavestateHook());
+		scriptConverter.writeFrames(*savestateHook->inputs[branch], startLoc, endLoc, startLoc, text, nullptr);
 	} else {
-		start = 0;
-		end   = dataProcessing->getNumOfSavestateHooks(playerIndex);
-	}
-
-	FrameNum indexForAllSavestateHooks = 0;
-	for(SavestateBlockNum j = start; j < end; j++) {
-		if(playerIndex != -1) {
-			startLoc = 0;
-			endLoc   = dataProcessing->getNumOfFramesInSavestateHook(j, playerIndex) - 1;
-		}
-
-		for(FrameNum i = startLoc; i <= endLoc; i++) {
-			// Just to keep the app running
-			if(i % 50 == 0) {
-				wxTheApp->Yield();
-			}
-
-			// Keeping empty ones there clutters things
-			if(!isEmptyControllerData(dataProcessing->getFrame(i))) {
-				std::vector<std::string> parts;
-
-				if(playerIndex == -1) {
-					parts.push_back(std::to_string(i));
-				} else {
-					parts.push_back(std::to_string(indexForAllSavestateHooks));
-				}
-
-				std::vector<std::string> buttonParts;
-				for(uint8_t btn = 0; btn < Btn::BUTTONS_SIZE; btn++) {
-					Btn button = (Btn)btn;
-					uint8_t isSelected;
-					if(playerIndex == -1) {
-						isSelected = dataProcessing->getButton(i, button);
-					} else {
-						isSelected = dataProcessing->getButtonSpecific(i, button, j, branch, playerIndex);
-					}
-					if(isSelected) {
-						// Add to the string
-						buttonParts.push_back(buttonMapping[button]->scriptName);
-					}
-				}
-
-				if(buttonParts.size() == 0) {
-					// Sometimes, it's nothing, so push a constant
-					parts.push_back("NONE");
-				} else {
-					parts.push_back(HELPERS::joinString(buttonParts, ";"));
-				}
-
-				typedef ControllerNumberValues CNV;
-
-				uint8_t realPlayer;
-				if(playerIndex == -1) {
-					realPlayer = dataProcessing->getCurrentPlayer();
-				} else {
-					realPlayer = playerIndex;
-				}
-
-				// clang-format off
-				parts.push_back(std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::LEFT_X, j, branch, realPlayer)) + \
-					";" + std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::LEFT_Y, j, branch, realPlayer)));
-
-				parts.push_back(std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::RIGHT_X, j, branch, realPlayer)) + \
-					";" + std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::RIGHT_Y, j,branch, realPlayer)));
-
-				parts.push_back(std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::ACCEL_X, j, branch, realPlayer)) + \
-					";" + std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::ACCEL_Y, j, branch, realPlayer)) + \
-					";" + std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::ACCEL_Z, j, branch, realPlayer)));
-
-				parts.push_back(std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::GYRO_1, j,branch, realPlayer)) + \
-					";" + std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::GYRO_2, j, branch, realPlayer)) + \
-					";" + std::to_string(dataProcessing->getNumberValuesSpecific(i, CNV::GYRO_3, j, branch, realPlayer)));
-				// clang-format on
-
-				textVector.push_back(HELPERS::joinString(parts, " "));
-			}
-
-			indexForAllSavestateHooks++;
+		// Frames are numbered across every savestate hook
+		FrameNum indexForAllSavestateHooks = 0;
+		for(auto& savestateHook : *dataProcessing->getAllPlayers()[playerIndex]) {
+			FrameStore& frames = *savestateHook->inputs[branch];
+			scriptConverter.writeFrames(frames, 0, frames.size() - 1, indexForAllSavestateHooks, text, nullptr);
+			indexForAllSavestateHooks += frames.size();
 		}
 	}
-	// Return with newlines
-	return HELPERS::joinString(textVector, "\n");
+	return text;
 }
 
-void ButtonData::transferControllerData(ControllerData src, std::shared_ptr<ControllerData> dest, bool placePaste) {
+void ButtonData::transferControllerData(ControllerData src, FrameView dest, bool placePaste) {
 	// Transfer all over
 
 	if(placePaste) {
 		// Add them together, not replace (bitwise or)
-		dest->buttons |= src.buttons;
-	} else {
-		// Just replace
-		dest->buttons = src.buttons;
+		src.buttons |= dest.buttons();
 	}
-	dest->LS_X       = src.LS_X;
-	dest->LS_Y       = src.LS_Y;
-	dest->RS_X       = src.RS_X;
-	dest->RS_Y       = src.RS_Y;
-	dest->ACCEL_X    = src.ACCEL_X;
-	dest->ACCEL_Y    = src.ACCEL_Y;
-	dest->ACCEL_Z    = src.ACCEL_Z;
-	dest->GYRO_1     = src.GYRO_1;
-	dest->GYRO_2     = src.GYRO_2;
-	dest->GYRO_3     = src.GYRO_3;
-	dest->frameState = src.frameState;
+	dest.setInputs(src);
+	dest.setFrameState(src.frameState);
 }
 
-bool ButtonData::isEmptyControllerData(std::shared_ptr<ControllerData> data) {
+bool ButtonData::isEmptyControllerData(FrameView data) {
 	ControllerData emptyData;
 	// clang-format off
 	return
-		(data->buttons    == emptyData.buttons)   &&
-		(data->LS_X       == emptyData.LS_X)      &&
-		(data->LS_Y       == emptyData.LS_Y)      &&
-		(data->RS_X       == emptyData.RS_X)      &&
-		(data->RS_Y       == emptyData.RS_Y)      &&
-		(data->ACCEL_X    == emptyData.ACCEL_X)   &&
-		(data->ACCEL_Y    == emptyData.ACCEL_Y)   &&
-		(data->ACCEL_Z    == emptyData.ACCEL_Z)   &&
-		(data->GYRO_1     == emptyData.GYRO_1)    &&
-		(data->GYRO_2     == emptyData.GYRO_2)    &&
-		(data->GYRO_3     == emptyData.GYRO_3)    &&
-		(data->frameState == emptyData.frameState);
+		(data.buttons()                             == emptyData.buttons)    &&
+		(data.axis(ControllerNumberValues::LEFT_X)  == emptyData.LS_X)       &&
+		(data.axis(ControllerNumberValues::LEFT_Y)  == emptyData.LS_Y)       &&
+		(data.axis(ControllerNumberValues::RIGHT_X) == emptyData.RS_X)       &&
+		(data.axis(ControllerNumberValues::RIGHT_Y) == emptyData.RS_Y)       &&
+		(data.axis(ControllerNumberValues::ACCEL_X) == emptyData.ACCEL_X)    &&
+		(data.axis(ControllerNumberValues::ACCEL_Y) == emptyData.ACCEL_Y)    &&
+		(data.axis(ControllerNumberValues::ACCEL_Z) == emptyData.ACCEL_Z)    &&
+		(data.axis(ControllerNumberValues::GYRO_1)  == emptyData.GYRO_1)     &&
+		(data.axis(ControllerNumberValues::GYRO_2)  == emptyData.GYRO_2)     &&
+		(data.axis(ControllerNumberValues::GYRO_3)  == emptyData.GYRO_3)     &&
+		(data.frameState()                          == emptyData.frameState);
 	// clang-format on
 }
\ No newline at end of file
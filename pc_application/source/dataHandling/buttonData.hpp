@@ -19,6 +19,7 @@
 #include "../sharedNetworkCode/buttonData.hpp"
 #include "buttonConstants.hpp"
 #include "dataProcessing.hpp"
+#include "scriptConverter.hpp"
 
 // Forward declare to allow headers to include each other
 class DataProcessing;
@@ -57,6 +58,8 @@ public:
 
 	// To convert to Btn
 	std::unordered_map<std::string, Btn> scriptNameToButton;
+	// Reads and writes scripts with the script names, safe to use from other threads
+	ScriptConverter scriptConverter;
 
 	static constexpr int16_t axisMin = -32767;
 	static constexpr int16_t axisMax = 32767;
@@ -71,7 +74,7 @@ public:
 	FrameNum textToFrames(DataProcessing* dataProcessing, std::string text, FrameNum startLoc, bool insertPaste, bool placePaste);
 	std::string framesToText(DataProcessing* dataProcessing, FrameNum startLoc, FrameNum endLoc, int playerIndex, BranchNum branch);
 
-	void transferControllerData(ControllerData src, std::shared_ptr<ControllerData> dest, bool placePaste);
+	void transferControllerData(ControllerData src, FrameView dest, bool placePaste);
 
-	bool isEmptyControllerData(std::shared_ptr<ControllerData> data);
+	bool isEmptyControllerData(FrameView data);
 };
\ No newline at end of file
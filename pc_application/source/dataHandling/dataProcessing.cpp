@@ -1,5 +1,8 @@
 #include "dataProcessing.hpp"
 #include "buttonData.hpp"
+#include "../ui/axisTransformer.hpp"
+#include "../ui/branchDiffViewer.hpp"
+#include "../ui/inputStatistics.hpp"
 
 DataProcessing::DataProcessing(rapidjson::Document* settings, std::shared_ptr<ButtonData> buttons, std::shared_ptr<CommunicateWithNetwork> communicateWithNetwork, wxWindow* parent)
 	: wxListCtrl(parent, DataProcessing::LIST_CTRL_ID, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_VIRTUAL | wxLC_HRULES) {
@@ -50,7 +53,7 @@ DataProcessing::DataProcessing(rapidjson::Document* settings, std::shared_ptr<Bu
 
 	// Create keyboard handlers
 	// Each menu item is added here
-	wxAcceleratorEntry entries[11];
+	wxAcceleratorEntry entries[20];
 
 	pasteInsertID         = wxNewId();
 	pastePlaceID          = wxNewId();
@@ -60,6 +63,13 @@ DataProcessing::DataProcessing(rapidjson::Document* settings, std::shared_ptr<Bu
 	frameAdvanceID        = wxNewId();
 	savestateID           = wxNewId();
 	mergeIntoMainBranchID = wxNewId();
+	jumpToFrameID         = wxNewId();
+	findButtonsID         = wxNewId();
+	findNextID            = wxNewId();
+	findPreviousID        = wxNewId();
+	inputStatisticsID     = wxNewId();
+	transformAxesID       = wxNewId();
+	compareBranchesID     = wxNewId();
 
 	insertPaste = false;
 	placePaste  = false;
@@ -77,7 +87,20 @@ DataProcessing::DataProcessing(rapidjson::Document* settings, std::shared_ptr<Bu
 	entries[9].Set(wxACCEL_CTRL, (int)'H', savestateID, editMenu.Append(savestateID, wxT("Add Savestate\tCtrl+H")));
 	entries[10].Set(wxACCEL_CTRL, (int)'M', mergeIntoMainBranchID, editMenu.Append(mergeIntoMainBranchID, wxT("Merge Frames into Main Branch\tCtrl+M")));
 
-	wxAcceleratorTable accel(11, entries);
+	entries[11].Set(wxACCEL_CTRL, (int)'J', jumpToFrameID, editMenu.Append(jumpToFrameID, wxT("Jump to Frame\tCtrl+J")));
+
+	entries[12].Set(wxACCEL_CTRL, (int)'Z', wxID_UNDO, editMenu.Append(wxID_UNDO, wxT("Undo\tCtrl+Z")));
+	entries[13].Set(wxACCEL_CTRL, (int)'Y', wxID_REDO, editMenu.Append(wxID_REDO, wxT("Redo\tCtrl+Y")));
+
+	entries[14].Set(wxACCEL_CTRL, (int)'F', findButtonsID, editMenu.Append(findButtonsID, wxT("Find Buttons\tCtrl+F")));
+	entries[15].Set(wxACCEL_NORMAL, WXK_F3, findNextID, editMenu.Append(findNextID, wxT("Find Next Press\tF3")));
+	entries[16].Set(wxACCEL_SHIFT, WXK_F3, findPreviousID, editMenu.Append(findPreviousID, wxT("Find Previous Press\tShift+F3")));
+	entries[17].Set(wxACCEL_CTRL | wxACCEL_SHIFT, (int)'I', inputStatisticsID, editMenu.Append(inputStatisticsID, wxT("Input Statistics\tCtrl+Shift+I")));
+
+	entries[18].Set(wxACCEL_CTRL, (int)'T', transformAxesID, editMenu.Append(transformAxesID, wxT("Transform Sticks And Motion\tCtrl+T")));
+	entries[19].Set(wxACCEL_CTRL | wxACCEL_SHIFT, (int)'B', compareBranchesID, editMenu.Append(compareBranchesID, wxT("Compare Branches\tCtrl+Shift+B")));
+
+	wxAcceleratorTable accel(20, entries);
 	SetAcceleratorTable(accel);
 
 	// Bind each to a handler, both menu and button events
@@ -92,6 +115,15 @@ DataProcessing::DataProcessing(rapidjson::Document* settings, std::shared_ptr<Bu
 	Bind(wxEVT_MENU, &DataProcessing::onFrameAdvance, this, frameAdvanceID);
 	Bind(wxEVT_MENU, &DataProcessing::onAddSavestate, this, savestateID);
 	Bind(wxEVT_MENU, &DataProcessing::onMergeIntoMainBranch, this, mergeIntoMainBranchID);
+	Bind(wxEVT_MENU, &DataProcessing::onJumpToFrame, this, jumpToFrameID);
+	Bind(wxEVT_MENU, &DataProcessing::onUndo, this, wxID_UNDO);
+	Bind(wxEVT_MENU, &DataProcessing::onRedo, this, wxID_REDO);
+	Bind(wxEVT_MENU, &DataProcessing::onFindButtons, this, findButtonsID);
+	Bind(wxEVT_MENU, &DataProcessing::onFindNext, this, findNextID);
+	Bind(wxEVT_MENU, &DataProcessing::onFindPrevious, this, findPreviousID);
+	Bind(wxEVT_MENU, &DataProcessing::onInputStatistics, this, inputStatisticsID);
+	Bind(wxEVT_MENU, &DataProcessing::onTransformAxes, this, transformAxesID);
+	Bind(wxEVT_MENU, &DataProcessing::onCompareBranches, this, compareBranchesID);
 }
 
 // clang-format off
@@ -130,6 +162,10 @@ void DataProcessing::setBranchInfoCallback(std::function<void(uint16_t, uint16_t
 	branchInfoCallback = callback;
 }
 
+void DataProcessing::setEditCallback(std::function<void(SavestateBlockNum, FrameNum)> callback) {
+	editCallback = callback;
+}
+
 void DataProcessing::triggerCurrentFrameChanges() {
 	if(changingSelectedFrameCallback) {
 		changingSelectedFrameCallback(currentFrame, currentRunFrame, currentImageFrame);
@@ -140,10 +176,10 @@ void DataProcessing::sendAutoAdvance(uint8_t includeFramebuffer) {
 	for(uint8_t playerIndex = 0; playerIndex < allPlayers.size(); playerIndex++) {
 		// Set inputs of all other players correctly but not the current one
 		if(playerIndex != viewingPlayerIndex) {
-			std::shared_ptr<ControllerData> controllerDatas = getControllerData(playerIndex, currentSavestateHook, viewingBranchIndex, currentRunFrame);
+			ControllerData controllerDatas = getControllerData(playerIndex, currentSavestateHook, viewingBranchIndex, currentRunFrame).get();
 
 			ADD_TO_QUEUE(SendFrameData, networkInstance, {
-				data.controllerData     = *controllerDatas;
+				data.controllerData     = controllerDatas;
 				data.frame              = currentRunFrame;
 				data.savestateHookNum   = currentSavestateHook;
 				data.branchIndex        = viewingBranchIndex;
@@ -166,35 +202,59 @@ void DataProcessing::sendAutoAdvance(uint8_t includeFramebuffer) {
 	})
 }
 
-std::string DataProcessing::getExportedCurrentPlayer() {
-	/*
-	wxFile file(exportTarget.GetFullPath(), wxFile::write);
-
-	if(file.IsOpened()) {
-		std::string exported = buttonData->framesToText(this, 0, 0, viewingPlayerIndex);
-		file.Write(wxString::FromUTF8(exported));
-		file.Close();
+bool DataProcessing::getExportedCurrentPlayer(std::string& exported) {
+	// Always export the main branch, MAY CHANGE
+	// Forks, so the thread doesn't see anything edited in the meantime
+	std::vector<BranchData> savestateHooks;
+	ScriptProgress progress;
+	for(auto& savestateHook : *allPlayers[viewingPlayerIndex]) {
+		savestateHooks.push_back(savestateHook->inputs[0]->fork());
+		progress.total += savestateHooks.back()->size();
 	}
-	*/
 
-	// This blocks for a long time
-	// Always export the main branch, MAY CHANGE
-	return buttonData->framesToText(this, 0, 0, viewingPlayerIndex, 0);
+	return runInBackground("Exporting script", progress, [&] {
+		// Frames are numbered across every savestate hook
+		FrameNum indexForAllSavestateHooks = 0;
+		for(auto& frames : savestateHooks) {
+			if(!buttonData->scriptConverter.writeFrames(*frames, 0, frames->size() - 1, indexForAllSavestateHooks, exported, &progress)) {
+				return;
+			}
+			indexForAllSavestateHooks += frames->size();
+		}
+	});
 }
 
 void DataProcessing::importFromFile(wxFileName importTarget) {
 	wxFile file(importTarget.GetFullPath(), wxFile::read);
 
 	if(file.IsOpened()) {
-		wxString fileContents;
-		bool successful = file.ReadAll(&fileContents);
+		// Parsed into a fork on another thread, then swapped in all at once
+		BranchData imported = getInputsList()->fork();
+		ScriptProgress progress;
+		bool haveFrames = false;
+
+		bool finished = runInBackground("Importing script", progress, [&] {
+			std::string fileContents(file.Length(), '\0');
+			if(file.Read(&fileContents[0], fileContents.size()) == (ssize_t)fileContents.size()) {
+				haveFrames = buttonData->scriptConverter.readScript(fileContents, *imported, &progress);
+			}
+		});
 		file.Close();
 
-		if(successful) {
+		if(finished && haveFrames) {
 			Freeze();
-			FrameNum lastFrame = buttonData->textToFrames(this, fileContents.ToStdString(), 0, false, false);
-			// Remove all frames after the data
-			removeFrames(lastFrame + 1, allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->size() - 1);
+			beginEdit();
+			FrameNum numOfFrames = imported->size();
+			bool resized         = numOfFrames != getFramesSize();
+			getInputsList()->swap(*imported);
+			// Every other player and branch keeps its inputs, just with the same number of frames
+			for(auto& player : allPlayers) {
+				for(auto& branch : player->at(currentSavestateHook)->inputs) {
+					branch->resize(numOfFrames);
+				}
+			}
+			deferEdit(0, resized);
+			commitEdit();
 			Thaw();
 			setCurrentFrame(0);
 			Refresh();
@@ -202,6 +262,36 @@ void DataProcessing::importFromFile(wxFileName importTarget) {
 	}
 }
 
+bool DataProcessing::runInBackground(wxString message, ScriptProgress& progress, std::function<void()> task) {
+	std::atomic_bool done { false };
+	std::thread worker([&] {
+		task();
+		done = true;
+	});
+
+	// Quick tasks are done before a dialog would even show up
+	auto start = std::chrono::steady_clock::now();
+	std::unique_ptr<wxProgressDialog> dialog;
+	while(!done) {
+		if(!dialog && std::chrono::steady_clock::now() - start > std::chrono::milliseconds(200)) {
+			dialog = std::make_unique<wxProgressDialog>("Please wait", message, 1000, this, wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME);
+		}
+
+		if(dialog) {
+			uint64_t total = progress.total;
+			int value      = total == 0 ? 0 : std::min<uint64_t>(progress.done * 1000 / total, 999);
+			if(!dialog->Update(value)) {
+				progress.cancelled = true;
+			}
+		}
+
+		wxMilliSleep(15);
+	}
+
+	worker.join();
+	return !progress.cancelled;
+}
+
 void DataProcessing::onDropFiles(wxDropFilesEvent& event) {
 	if(event.GetNumberOfFiles() == 1) {
 		wxString dropped = event.GetFiles()[0];
@@ -280,6 +370,18 @@ void DataProcessing::setItemAttributes() {
 	// SavestateHook takes precedence in the case where both are present
 	SET_BIT(state, true, FrameState::RAN);
 	itemAttributes[state] = itemAttribute;
+	// And over lag too
+	SET_BIT(state, true, FrameState::LAG);
+	itemAttributes[state] = itemAttribute;
+	SET_BIT(state, false, FrameState::RAN);
+	itemAttributes[state] = itemAttribute;
+	SET_BIT(state, false, FrameState::SAVESTATE);
+
+	itemAttribute = new wxItemAttr();
+	itemAttribute->SetBackgroundColour(wxColor((*mainSettings)["ui"]["frameViewerColors"]["lag"].GetString()));
+	itemAttributes[state] = itemAttribute;
+	SET_BIT(state, true, FrameState::RAN);
+	itemAttributes[state] = itemAttribute;
 }
 
 void DataProcessing::OnEraseBackground(wxEraseEvent& event) {
@@ -411,6 +513,7 @@ void DataProcessing::onPaste(wxCommandEvent& event) {
 				std::string clipboardText = data.GetText().ToStdString();
 
 				Freeze();
+				beginEdit();
 				FrameNum lastItem    = buttonData->textToFrames(this, clipboardText, firstSelectedItem, insertPaste, placePaste);
 				FrameNum sizeOfPaste = lastItem - firstSelectedItem + 1;
 				if(!insertPaste) {
@@ -418,6 +521,7 @@ void DataProcessing::onPaste(wxCommandEvent& event) {
 						buttonData->textToFrames(this, clipboardText, i, insertPaste, placePaste);
 					}
 				}
+				commitEdit();
 				setCurrentFrame(firstSelectedItem + sizeOfPaste - 1);
 				Thaw();
 				Refresh();
@@ -462,6 +566,121 @@ void DataProcessing::onFrameAdvance(wxCommandEvent& event) {
 	}
 }
 
+void DataProcessing::onJumpToFrame(wxCommandEvent& event) {
+	if(tethered) {
+		sendJumpToFrame(currentFrame);
+	}
+}
+
+void DataProcessing::onUndo(wxCommandEvent& event) {
+	undo();
+}
+
+void DataProcessing::onRedo(wxCommandEvent& event) {
+	redo();
+}
+
+void DataProcessing::onFindButtons(wxCommandEvent& event) {
+	wxString text = wxGetTextFromUser("Script names of the buttons, separated by ;\nStart with = to only find frames with exactly these buttons", "Find buttons", findText);
+	if(text.empty()) {
+		return;
+	}
+
+	ButtonQuery query;
+	query.starts = true;
+
+	std::string names = text.ToStdString();
+	bool exactly      = names[0] == '=';
+	if(exactly) {
+		names.erase(0, 1);
+	}
+
+	for(std::string name : HELPERS::splitString(names, ';')) {
+		if(name.empty()) {
+			continue;
+		}
+		if(!buttonData->scriptNameToButton.count(name)) {
+			wxMessageDialog errorDialog(this, wxString::Format("%s isn't the script name of a button", wxString::FromUTF8(name)), "Find buttons", wxOK | wxICON_ERROR);
+			errorDialog.ShowModal();
+			return;
+		}
+		query.required |= 1UL << buttonData->scriptNameToButton[name];
+	}
+
+	if(exactly) {
+		query.forbidden = ~query.required;
+	}
+
+	findQuery     = query;
+	haveFindQuery = true;
+	findText      = text;
+	findButtons(true);
+}
+
+void DataProcessing::onFindNext(wxCommandEvent& event) {
+	if(haveFindQuery) {
+		findButtons(true);
+	} else {
+		onFindButtons(event);
+	}
+}
+
+void DataProcessing::onFindPrevious(wxCommandEvent& event) {
+	if(haveFindQuery) {
+		findButtons(false);
+	} else {
+		onFindButtons(event);
+	}
+}
+
+void DataProcessing::onInputStatistics(wxCommandEvent& event) {
+	long firstSelectedItem = GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
+	long lastSelectedItem  = firstSelectedItem == wxNOT_FOUND ? -1 : firstSelectedItem + GetSelectedItemCount() - 1;
+
+	InputStatistics inputStatistics(this, buttonData, getInputsList(), firstSelectedItem, lastSelectedItem);
+	inputStatistics.ShowModal();
+}
+
+void DataProcessing::onTransformAxes(wxCommandEvent& event) {
+	// The selection, or every frame if nothing is selected
+	long firstSelectedItem = GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
+	FrameNum firstFrame    = 0;
+	FrameNum lastFrame     = getFramesSize() - 1;
+	if(firstSelectedItem != wxNOT_FOUND) {
+		firstFrame = firstSelectedItem;
+		lastFrame  = firstSelectedItem + GetSelectedItemCount() - 1;
+	}
+
+	AxisTransformer axisTransformer(this, this, firstFrame, lastFrame);
+	if(axisTransformer.ShowModal() == wxID_OK) {
+		applyAxisTransform(firstFrame, lastFrame, axisTransformer.getTransform());
+	} else {
+		endAxisTransformPreview();
+	}
+}
+
+void DataProcessing::onCompareBranches(wxCommandEvent& event) {
+	if(getNumBranches() < 2) {
+		wxMessageDialog errorDialog(this, "This savestate hook has no other branches to compare with", "No Branches", wxOK | wxICON_ERROR);
+		errorDialog.ShowModal();
+		return;
+	}
+
+	BranchDiffViewer branchDiffViewer(this, this);
+	branchDiffViewer.ShowModal();
+}
+
+void DataProcessing::findButtons(bool forward) {
+	BranchData frames = getInputsList();
+	FrameNum frame    = forward ? frames->findNextMatch(currentFrame, findQuery) : frames->findPreviousMatch(currentFrame, findQuery);
+
+	if(frame == UINT32_MAX) {
+		wxBell();
+	} else {
+		setCurrentFrame(frame);
+	}
+}
+
 void DataProcessing::onAddSavestate(wxCommandEvent& event) {
 	// NEEDS WORK
 	createSavestateHere();
@@ -472,10 +691,16 @@ void DataProcessing::onMergeIntoMainBranch(wxCommandEvent& event) {
 	long firstSelectedItem = GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
 	if(firstSelectedItem != wxNOT_FOUND) {
 		long lastSelectedItem = firstSelectedItem + GetSelectedItemCount() - 1;
+		journal.beginGroup();
 		for(FrameNum i = firstSelectedItem; i <= lastSelectedItem; i++) {
 			// Transfer directly
-			buttonData->transferControllerData(*(allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->at(i)), allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[0]->at(i), false);
+			transferControllerDataJournaled(allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->get(i), viewingPlayerIndex, currentSavestateHook, 0, i);
 		}
+		journal.endGroup();
+
+		// The main branch ran with the old inputs
+		invalidateRunSpecific(firstSelectedItem, currentSavestateHook, 0, viewingPlayerIndex);
+		editMade(currentSavestateHook, firstSelectedItem);
 	}
 	// It's up to the user to remove the frames in the other branch if they want
 }
@@ -483,9 +708,6 @@ void DataProcessing::onMergeIntoMainBranch(wxCommandEvent& event) {
 void DataProcessing::setCurrentFrame(FrameNum frameNum) {
 	// Must be a frame that has already been written, else, raise error
 	if(frameNum < getFramesSize()) {
-		// Set the current frame to this frame
-		// Shared pointer so this can be done
-		currentData = allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->at(frameNum);
 		// Set the current frame to this number
 		// Focus to this specific row now
 		// This essentially scrolls to it
@@ -517,7 +739,7 @@ void DataProcessing::createSavestateHere() {
 	// Add one savestate hook at this frame
 	savestates[currentFrame] = std::make_shared<Savestate>();
 	// Set the style of this frame
-	SET_BIT(currentData->frameState, true, FrameState::SAVESTATE);
+	getInputsList()->setFrameState(currentFrame, FrameState::SAVESTATE, true);
 	// Refresh the item for it to take effect
 	RefreshItem(currentFrame);
 }
@@ -525,8 +747,6 @@ void DataProcessing::createSavestateHere() {
 void DataProcessing::runFrame(uint8_t forAutoFrame, uint8_t updateFramebuffer, uint8_t includeFramebuffer) {
 	if(currentRunFrame < allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->size() - 1) {
 		// Technically, should handle for entering next savetstate hook block, but TODO
-		std::shared_ptr<ControllerData> controllerData = allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->at(currentRunFrame);
-
 		setFramestateInfo(currentRunFrame, FrameState::RAN, true);
 
 		uint8_t withinFrames = currentRunFrame < allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->size();
@@ -560,9 +780,9 @@ void DataProcessing::runFrame(uint8_t forAutoFrame, uint8_t updateFramebuffer, u
 			if(!forAutoFrame) {
 				// Send to switch to run for each player
 				for(uint8_t playerIndex = 0; playerIndex < allPlayers.size(); playerIndex++) {
-					std::shared_ptr<ControllerData> controllerDatas = getControllerData(playerIndex, currentSavestateHook, viewingBranchIndex, currentRunFrame);
+					ControllerData controllerDatas = getControllerData(playerIndex, currentSavestateHook, viewingBranchIndex, currentRunFrame).get();
 					ADD_TO_QUEUE(SendFrameData, networkInstance, {
-						data.controllerData     = *controllerDatas;
+						data.controllerData     = controllerDatas;
 						data.frame              = currentRunFrame;
 						data.savestateHookNum   = currentSavestateHook;
 						data.branchIndex        = viewingBranchIndex;
@@ -586,6 +806,82 @@ void DataProcessing::runFrame(uint8_t forAutoFrame, uint8_t updateFramebuffer, u
 	}
 }
 
+void DataProcessing::sendJumpToFrame(FrameNum frame) {
+	// Every player needs inputs up to the frame
+	for(uint8_t playerIndex = 0; playerIndex < allPlayers.size(); playerIndex++) {
+		FrameNum numOfFrames = allPlayers[playerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->size();
+		if(frame >= numOfFrames) {
+			wxLogMessage("Can't jump to frame %u, player %u only has %u frames", frame, playerIndex + 1, numOfFrames);
+			return;
+		}
+	}
+
+	// Removing or undoing branches and hooks renumbers them, so the branches themselves are compared
+	bool sameBranches = jumpInputsHook == currentSavestateHook && jumpInputsBranch == viewingBranchIndex && jumpInputsBranches.size() == allPlayers.size();
+	for(uint8_t playerIndex = 0; sameBranches && playerIndex < allPlayers.size(); playerIndex++) {
+		sameBranches = jumpInputsBranches[playerIndex].lock() == allPlayers[playerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex];
+	}
+	if(!sameBranches) {
+		jumpInputsBranches.clear();
+		for(uint8_t playerIndex = 0; playerIndex < allPlayers.size(); playerIndex++) {
+			jumpInputsBranches.push_back(allPlayers[playerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]);
+		}
+		jumpInputsHook   = currentSavestateHook;
+		jumpInputsBranch = viewingBranchIndex;
+		jumpInputsEnd    = 1;
+	}
+
+	// Frame 0 is the savestate hook itself, the switch only replays what it doesn't have a state for
+	// The target frame is always sent so the switch can check it
+	FrameNum firstFrame = std::max<FrameNum>(std::min(jumpInputsEnd, frame), 1);
+	std::vector<ControllerData> inputs;
+	inputs.reserve((frame + 1 - firstFrame) * allPlayers.size());
+	for(FrameNum i = firstFrame; i <= frame; i++) {
+		for(uint8_t playerIndex = 0; playerIndex < allPlayers.size(); playerIndex++) {
+			inputs.push_back(getControllerData(playerIndex, currentSavestateHook, viewingBranchIndex, i).get());
+		}
+	}
+	jumpInputsEnd = std::max(jumpInputsEnd, frame + 1);
+
+	ADD_TO_QUEUE(SendJumpToFrame, networkInstance, {
+		data.frame              = frame;
+		data.savestateHookNum   = currentSavestateHook;
+		data.branchIndex        = viewingBranchIndex;
+		data.playerIndex        = viewingPlayerIndex;
+		data.includeFramebuffer = true;
+		data.firstFrame         = firstFrame;
+		data.numOfPlayers       = allPlayers.size();
+		data.inputs             = inputs;
+	})
+}
+
+void DataProcessing::jumpToFrameFailed(FrameNum frame, SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t inputsMissing) {
+	// The switch only records inputs of frames it replays, the ones sent this time might not be there
+	jumpInputsBranches.clear();
+	jumpInputsEnd = 1;
+
+	// Still wanted, every frame goes this time so it can't be missing inputs again
+	if(inputsMissing && savestateHookNum == currentSavestateHook && branch == viewingBranchIndex && frame == currentFrame) {
+		sendJumpToFrame(frame);
+	} else {
+		wxLogMessage("No savestate to jump to frame %u from, the frames have to be run normally", frame);
+	}
+}
+
+void DataProcessing::jumpedToFrame(FrameNum frame) {
+	currentRunFrame   = frame;
+	currentImageFrame = frame;
+	setCurrentFrame(frame);
+
+	modifyCurrentFrameViews(currentFrame);
+
+	if(changingSelectedFrameCallback) {
+		changingSelectedFrameCallback(currentFrame, currentRunFrame, currentImageFrame);
+	}
+
+	Refresh();
+}
+
 bool DataProcessing::handleKeyboardInput(wxChar key) {
 	if(charToButton.count(key)) {
 		triggerButton(charToButton[key]);
@@ -594,7 +890,7 @@ bool DataProcessing::handleKeyboardInput(wxChar key) {
 	return false;
 }
 
-std::shared_ptr<std::vector<std::shared_ptr<ControllerData>>> DataProcessing::getInputsList() const {
+BranchData DataProcessing::getInputsList() const {
 	return currentBranchData;
 }
 
@@ -627,9 +923,9 @@ void DataProcessing::addNewSavestateHook(std::string dHash, wxBitmap* screenshot
 		savestateHook->dHash                         = dHash;
 		savestateHook->screenshot                    = screenshot;
 		// Add a single branch for default
-		savestateHook->inputs.push_back(std::make_shared<std::vector<FrameData>>());
+		savestateHook->inputs.push_back(std::make_shared<FrameStore>());
 		allPlayers[i]->push_back(savestateHook);
-		allPlayers[i]->at(0)->inputs[0]->push_back(std::make_shared<ControllerData>());
+		allPlayers[i]->at(0)->inputs[0]->resize(1);
 		viewingBranchIndex = 0;
 		// NOTE: There must be at least one block with one input when this is loaded
 		// Automatically, the first block is always at index 0
@@ -640,6 +936,7 @@ void DataProcessing::addNewSavestateHook(std::string dHash, wxBitmap* screenshot
 
 void DataProcessing::setSavestateHook(SavestateBlockNum index) {
 	currentSavestateHook = index;
+	ramDesyncReported    = false;
 
 	// Just in case, refresh branch here
 	setBranch(viewingBranchIndex);
@@ -659,39 +956,46 @@ void DataProcessing::setSavestateHook(SavestateBlockNum index) {
 
 void DataProcessing::removeSavestateHook(SavestateBlockNum index) {
 	if(allPlayers[viewingPlayerIndex]->size() > 1) {
+		journal.recordRemoveSavestateHook(viewingPlayerIndex, index, allPlayers[viewingPlayerIndex]->at(index));
+
 		allPlayers[viewingPlayerIndex]->erase(allPlayers[viewingPlayerIndex]->begin() + index);
 		setSavestateHook(0);
 
-		// Move over all the framebuffer names
+		// Move over all the framebuffer names, folders go through the collector so anything queued in them follows
 		wxRemoveFile(getFramebufferPathForSavestateHook(index).GetFullPath());
-		HELPERS::popOffDirs(getFramebufferPath(0, index, 0, 0), 1).Rmdir(wxPATH_RMDIR_RECURSIVE);
+		framebufferCollector.remove(getFramebufferDirForSavestateHook(index).GetPath(), getRemovedFramebuffersDir());
 
-		// Rename all images following this hook
-		SavestateBlockNum temp1 = index;
-		while(true) {
-			temp1++;
-			wxFileName savestateHookFile = getFramebufferPathForSavestateHook(temp1);
-			if(savestateHookFile.FileExists()) {
-				wxRenameFile(savestateHookFile.GetPath(), getFramebufferPathForSavestateHook(temp1).GetPath());
-			} else {
-				// Have encountered last savestate hook, break loop
-				break;
-			}
+		// Rename all images and folders following this hook
+		SavestateBlockNum temp = index + 1;
+		while(savestateHookFramebuffersExist(temp)) {
+			moveSavestateHookFramebuffers(temp, temp - 1);
+			temp++;
 		}
+	}
+}
 
-		// Rename all folders following this hook
-		SavestateBlockNum temp2 = index;
-		while(true) {
-			temp2++;
-			wxFileName savestateHookDir = HELPERS::popOffDirs(getFramebufferPath(0, temp2, 0, 0), 1);
-			if(savestateHookDir.DirExists()) {
-				wxRenameFile(savestateHookDir.GetPath(), HELPERS::popOffDirs(getFramebufferPath(0, temp2 - 1, 0, 0), 1).GetPath());
-			} else {
-				// Have encountered last savestate hook, break loop
-				break;
-			}
-		}
+bool DataProcessing::savestateHookFramebuffersExist(SavestateBlockNum index) {
+	return wxFileExists(getFramebufferPathForSavestateHook(index).GetFullPath()) || getFramebufferDirForSavestateHook(index).DirExists();
+}
+
+void DataProcessing::moveSavestateHookFramebuffers(SavestateBlockNum from, SavestateBlockNum to) {
+	wxFileName savestateHookFile = getFramebufferPathForSavestateHook(from);
+	if(savestateHookFile.FileExists()) {
+		wxRenameFile(savestateHookFile.GetFullPath(), getFramebufferPathForSavestateHook(to).GetFullPath());
 	}
+
+	framebufferCollector.move(getFramebufferDirForSavestateHook(from).GetPath(), getFramebufferDirForSavestateHook(to).GetPath());
+}
+
+void DataProcessing::saveFramebuffer(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame, std::vector<uint8_t>& buf) {
+	wxFileName framebufferFileName = getFramebufferPath(player, savestateHookNum, branch, frame);
+	framebufferFileName.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+	// The frame might have been invalidated before it ran again, the old screenshot can still be queued for deletion
+	framebufferCollector.keep(framebufferFileName.GetPath(), frame);
+
+	wxFile file(framebufferFileName.GetFullPath(), wxFile::write);
+	file.Write(buf.data(), buf.size());
+	file.Close();
 }
 
 void DataProcessing::addNewPlayer() {
@@ -705,12 +1009,9 @@ void DataProcessing::addNewPlayer() {
 
 			// Has the same number of branches
 			for(FrameNum i = 0; i < hook->inputs.size(); i++) {
-				newSavestateHook->inputs.push_back(std::make_shared<std::vector<std::shared_ptr<ControllerData>>>());
-				// Each of those branches have the same number of inputs
-				for(FrameNum j = 0; j < hook->inputs[i]->size(); j++) {
-					// Create empty frames to add
-					newSavestateHook->inputs[i]->push_back(std::make_shared<ControllerData>());
-				}
+				newSavestateHook->inputs.push_back(std::make_shared<FrameStore>());
+				// Each of those branches have the same number of inputs, all empty
+				newSavestateHook->inputs[i]->resize(hook->inputs[i]->size());
 			}
 
 			newSavestateHook->dHash      = "";
@@ -720,6 +1021,10 @@ void DataProcessing::addNewPlayer() {
 	}
 
 	allPlayers.push_back(player);
+	// The first one is part of the project, not an edit
+	if(allPlayers.size() > 1) {
+		journal.recordAddPlayer(allPlayers.size() - 1, player);
+	}
 
 	setPlayer(allPlayers.size() - 1);
 }
@@ -742,6 +1047,7 @@ void DataProcessing::setPlayer(uint8_t playerIndex) {
 
 void DataProcessing::removePlayer(uint8_t playerIndex) {
 	if(allPlayers.size() > 1) {
+		journal.recordRemovePlayer(playerIndex, allPlayers[playerIndex]);
 		allPlayers.erase(allPlayers.begin() + playerIndex);
 		setPlayer(allPlayers.size() - 1);
 	}
@@ -762,26 +1068,26 @@ void DataProcessing::sendPlayerNum() {
 	}
 }
 
-std::shared_ptr<ControllerData> DataProcessing::getFrame(FrameNum frame) const {
+FrameView DataProcessing::getFrame(FrameNum frame) const {
 	return allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->at(frame);
 }
 
 void DataProcessing::addNewBranch() {
+	std::vector<BranchData> branches;
 	// Only add to this player
 	for(auto& player : allPlayers) {
 		auto& list = player->at(currentSavestateHook)->inputs;
-		list.push_back(std::make_shared<std::vector<std::shared_ptr<ControllerData>>>());
-		uint16_t lastElement = list.size() - 1;
-		// Add number of frames as the first branch has
-		for(FrameNum j = 0; j < list[0]->size(); j++) {
-			list[lastElement]->push_back(std::make_shared<ControllerData>());
-		}
+		// Starts out as the branch being viewed, frames are only copied once either of them is edited
+		list.push_back(list[viewingBranchIndex]->fork());
+		branches.push_back(list.back());
 	}
+	journal.recordAddBranch(currentSavestateHook, allPlayers[0]->at(currentSavestateHook)->inputs.size() - 1, branches);
 	setBranch(allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs.size() - 1);
 }
 
 void DataProcessing::setBranch(uint16_t branchIndex) {
 	viewingBranchIndex = branchIndex;
+	ramDesyncReported  = false;
 	currentBranchData  = allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex];
 	if(branchInfoCallback) {
 		branchInfoCallback(getNumBranches(), branchIndex, true);
@@ -792,17 +1098,23 @@ void DataProcessing::setBranch(uint16_t branchIndex) {
 
 void DataProcessing::removeBranch(uint8_t branchIndex) {
 	if(allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs.size() > 1) {
+		journal.recordRemoveBranch(viewingPlayerIndex, currentSavestateHook, branchIndex, allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[branchIndex]);
 		allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs.erase(allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs.begin() + branchIndex);
+
+		auto& ramHashes = allPlayers[0]->at(currentSavestateHook)->ramHashes;
+		if(branchIndex < ramHashes.size()) {
+			ramHashes.erase(ramHashes.begin() + branchIndex);
+		}
 		setBranch(allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs.size() - 1);
 
-		getFramebufferPath(0, currentSavestateHook, branchIndex, 0).Rmdir(wxPATH_RMDIR_RECURSIVE);
+		framebufferCollector.remove(getFramebufferDir(currentSavestateHook, branchIndex).GetPath(), getRemovedFramebuffersDir());
 
 		// Rename all images in this branch
 		while(true) {
 			branchIndex++;
-			wxFileName branchFolder = getFramebufferPath(0, currentSavestateHook, branchIndex, 0);
+			wxFileName branchFolder = getFramebufferDir(currentSavestateHook, branchIndex);
 			if(branchFolder.DirExists()) {
-				wxRenameFile(branchFolder.GetPath(), getFramebufferPath(0, currentSavestateHook, branchIndex - 1, 0).GetPath());
+				framebufferCollector.move(branchFolder.GetPath(), getFramebufferDir(currentSavestateHook, branchIndex - 1).GetPath());
 			} else {
 				// Have encountered last savestate hook, break loop
 				break;
@@ -830,9 +1142,16 @@ void DataProcessing::triggerButton(Btn button) {
 		// Now, apply the button
 		// Usually, just set to the opposite of the currently selected element
 		uint8_t state = !getButton(currentFrame, button);
+		if(firstSelectedItem == lastSelectedItem) {
+			modifyButton(firstSelectedItem, button, state);
+			return;
+		}
+
+		beginEdit(false);
 		for(FrameNum i = firstSelectedItem; i <= lastSelectedItem; i++) {
 			modifyButton(i, button, state);
 		}
+		commitEdit();
 	}
 }
 
@@ -842,18 +1161,32 @@ void DataProcessing::triggerNumberValues(ControllerNumberValues joystickId, int1
 	long firstSelectedItem = GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
 	if(firstSelectedItem != wxNOT_FOUND) {
 		long lastSelectedItem = firstSelectedItem + GetSelectedItemCount() - 1;
+		if(firstSelectedItem == lastSelectedItem) {
+			setNumberValues(firstSelectedItem, joystickId, value);
+			return;
+		}
+
+		beginEdit(false);
 		for(FrameNum i = firstSelectedItem; i <= lastSelectedItem; i++) {
 			setNumberValues(i, joystickId, value);
 			// No refresh for now, as the joystick is not visible in the allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs
 		}
+		commitEdit();
 	}
 }
 
 // New FANCY methods
 void DataProcessing::modifyButton(FrameNum frame, Btn button, uint8_t isPressed) {
-	SET_BIT(allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[viewingBranchIndex]->at(frame)->buttons, isPressed, button);
+	uint32_t before = getInputsList()->buttons(frame);
+	getInputsList()->setButton(frame, button, isPressed);
+	journal.recordButtons(viewingPlayerIndex, currentSavestateHook, viewingBranchIndex, frame, before ^ getInputsList()->buttons(frame));
+
+	if(deferEdit(frame, false)) {
+		return;
+	}
 
 	invalidateRun(frame);
+	editMade(currentSavestateHook, frame);
 
 	RefreshItem(frame);
 	modifyCurrentFrameViews(frame);
@@ -865,127 +1198,46 @@ void DataProcessing::toggleButton(FrameNum frame, Btn button) {
 
 void DataProcessing::clearAllButtons(FrameNum frame) {
 	// I think this works
-	getInputsList()->at(frame)->buttons = 0;
+	journal.recordButtons(viewingPlayerIndex, currentSavestateHook, viewingBranchIndex, frame, getInputsList()->buttons(frame));
+	getInputsList()->setButtons(frame, 0);
+
+	if(deferEdit(frame, false)) {
+		return;
+	}
 
 	invalidateRun(frame);
+	editMade(currentSavestateHook, frame);
 	modifyCurrentFrameViews(frame);
 	RefreshItem(frame);
 }
 
 void DataProcessing::setNumberValues(FrameNum frame, ControllerNumberValues joystickId, int16_t value) {
-	switch(joystickId) {
-	case ControllerNumberValues::LEFT_X:
-		getInputsList()->at(frame)->LS_X = value;
-		break;
-	case ControllerNumberValues::LEFT_Y:
-		getInputsList()->at(frame)->LS_Y = value;
-		break;
-	case ControllerNumberValues::RIGHT_X:
-		getInputsList()->at(frame)->RS_X = value;
-		break;
-	case ControllerNumberValues::RIGHT_Y:
-		getInputsList()->at(frame)->RS_Y = value;
-		break;
-	case ControllerNumberValues::ACCEL_X:
-		getInputsList()->at(frame)->ACCEL_X = value;
-		break;
-	case ControllerNumberValues::ACCEL_Y:
-		getInputsList()->at(frame)->ACCEL_Y = value;
-		break;
-	case ControllerNumberValues::ACCEL_Z:
-		getInputsList()->at(frame)->ACCEL_Z = value;
-		break;
-	case ControllerNumberValues::GYRO_1:
-		getInputsList()->at(frame)->GYRO_1 = value;
-		break;
-	case ControllerNumberValues::GYRO_2:
-		getInputsList()->at(frame)->GYRO_2 = value;
-		break;
-	case ControllerNumberValues::GYRO_3:
-		getInputsList()->at(frame)->GYRO_3 = value;
-		break;
+	journal.recordNumberValue(viewingPlayerIndex, currentSavestateHook, viewingBranchIndex, frame, joystickId, getInputsList()->axis(frame, joystickId), value);
+	getInputsList()->setAxis(frame, joystickId, value);
+
+	if(deferEdit(frame, false)) {
+		return;
 	}
 
 	modifyCurrentFrameViews(frame);
 	invalidateRun(frame);
+	editMade(currentSavestateHook, frame);
 }
 
 int16_t DataProcessing::getNumberValues(FrameNum frame, ControllerNumberValues joystickId) const {
-	switch(joystickId) {
-	case ControllerNumberValues::LEFT_X:
-		return getInputsList()->at(frame)->LS_X;
-		break;
-	case ControllerNumberValues::LEFT_Y:
-		return getInputsList()->at(frame)->LS_Y;
-		break;
-	case ControllerNumberValues::RIGHT_X:
-		return getInputsList()->at(frame)->RS_X;
-		break;
-	case ControllerNumberValues::RIGHT_Y:
-		return getInputsList()->at(frame)->RS_Y;
-		break;
-	case ControllerNumberValues::ACCEL_X:
-		return getInputsList()->at(frame)->ACCEL_X;
-		break;
-	case ControllerNumberValues::ACCEL_Y:
-		return getInputsList()->at(frame)->ACCEL_Y;
-		break;
-	case ControllerNumberValues::ACCEL_Z:
-		return getInputsList()->at(frame)->ACCEL_Z;
-		break;
-	case ControllerNumberValues::GYRO_1:
-		return getInputsList()->at(frame)->GYRO_1;
-		break;
-	case ControllerNumberValues::GYRO_2:
-		return getInputsList()->at(frame)->GYRO_2;
-		break;
-	case ControllerNumberValues::GYRO_3:
-		return getInputsList()->at(frame)->GYRO_3;
-		break;
-	}
+	return getInputsList()->axis(frame, joystickId);
 }
 
 int16_t DataProcessing::getNumberValuesSpecific(FrameNum frame, ControllerNumberValues joystickId, SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t player) const {
-	switch(joystickId) {
-	case ControllerNumberValues::LEFT_X:
-		return getControllerData(player, savestateHookNum, branch, frame)->LS_X;
-		break;
-	case ControllerNumberValues::LEFT_Y:
-		return getControllerData(player, savestateHookNum, branch, frame)->LS_Y;
-		break;
-	case ControllerNumberValues::RIGHT_X:
-		return getControllerData(player, savestateHookNum, branch, frame)->RS_X;
-		break;
-	case ControllerNumberValues::RIGHT_Y:
-		return getControllerData(player, savestateHookNum, branch, frame)->RS_Y;
-		break;
-	case ControllerNumberValues::ACCEL_X:
-		return getControllerData(player, savestateHookNum, branch, frame)->ACCEL_X;
-		break;
-	case ControllerNumberValues::ACCEL_Y:
-		return getControllerData(player, savestateHookNum, branch, frame)->ACCEL_Y;
-		break;
-	case ControllerNumberValues::ACCEL_Z:
-		return getControllerData(player, savestateHookNum, branch, frame)->ACCEL_Z;
-		break;
-	case ControllerNumberValues::GYRO_1:
-		return getControllerData(player, savestateHookNum, branch, frame)->GYRO_1;
-		break;
-	case ControllerNumberValues::GYRO_2:
-		return getControllerData(player, savestateHookNum, branch, frame)->GYRO_2;
-		break;
-	case ControllerNumberValues::GYRO_3:
-		return getControllerData(player, savestateHookNum, branch, frame)->GYRO_3;
-		break;
-	}
+	return getControllerData(player, savestateHookNum, branch, frame).axis(joystickId);
 }
 
 uint8_t DataProcessing::getButton(FrameNum frame, Btn button) const {
-	return GET_BIT(getInputsList()->at(frame)->buttons, button);
+	return GET_BIT(getInputsList()->buttons(frame), button);
 }
 
 uint8_t DataProcessing::getButtonSpecific(FrameNum frame, Btn button, SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t player) const {
-	return GET_BIT(getControllerData(player, savestateHookNum, branch, frame)->buttons, button);
+	return GET_BIT(getControllerData(player, savestateHookNum, branch, frame).buttons(), button);
 }
 
 uint8_t DataProcessing::getButtonCurrent(Btn button) const {
@@ -993,13 +1245,45 @@ uint8_t DataProcessing::getButtonCurrent(Btn button) const {
 }
 
 void DataProcessing::setControllerDataForAutoRun(ControllerData controllerData) {
-	// Set controller data manually
-	std::shared_ptr<ControllerData> newData = std::make_shared<ControllerData>();
-	buttonData->transferControllerData(controllerData, newData, false);
-	getInputsList()->at(currentFrame) = newData;
+	// Set controller data manually, recorded like an edit so undoing gives back the inputs from before the run
+	transferControllerDataJournaled(controllerData, viewingPlayerIndex, currentSavestateHook, viewingBranchIndex, currentFrame);
 	modifyCurrentFrameViews(currentFrame);
 }
 
+void DataProcessing::beginAutoRun() {
+	if(!autoRunJournalGroup) {
+		autoRunJournalGroup = true;
+		journal.beginGroup();
+	}
+}
+
+void DataProcessing::endAutoRun() {
+	// A frame still on its way ends up in its own undo step
+	if(autoRunJournalGroup) {
+		autoRunJournalGroup = false;
+		journal.endGroup();
+	}
+}
+
+void DataProcessing::transferControllerDataJournaled(ControllerData controllerData, uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame) {
+	FrameView view         = allPlayers[player]->at(savestateHookNum)->inputs[branch]->at(frame);
+	uint32_t buttonsBefore = view.buttons();
+	int16_t axesBefore[NUM_OF_FRAME_AXES];
+	for(uint8_t axis = 0; axis < NUM_OF_FRAME_AXES; axis++) {
+		axesBefore[axis] = view.axis(axis);
+	}
+
+	buttonData->transferControllerData(controllerData, view, false);
+
+	// One undo step for the whole frame
+	journal.beginGroup();
+	journal.recordButtons(player, savestateHookNum, branch, frame, buttonsBefore ^ view.buttons());
+	for(uint8_t axis = 0; axis < NUM_OF_FRAME_AXES; axis++) {
+		journal.recordNumberValue(player, savestateHookNum, branch, frame, (ControllerNumberValues)axis, axesBefore[axis], view.axis(axis));
+	}
+	journal.endGroup();
+}
+
 int16_t DataProcessing::getNumberValueCurrent(ControllerNumberValues joystickId) const {
 	return getNumberValues(currentFrame, joystickId);
 }
@@ -1022,7 +1306,7 @@ void DataProcessing::modifyCurrentFrameViews(FrameNum frame) {
 }
 
 void DataProcessing::setFramestateInfo(FrameNum frame, FrameState id, uint8_t state) {
-	SET_BIT(getInputsList()->at(frame)->frameState, state, id);
+	getInputsList()->setFrameState(frame, id, state);
 
 	if(IsVisible(frame)) {
 		RefreshItem(frame);
@@ -1032,96 +1316,272 @@ void DataProcessing::setFramestateInfo(FrameNum frame, FrameState id, uint8_t st
 }
 
 void DataProcessing::setFramestateInfoSpecific(FrameNum frame, FrameState id, uint8_t state, SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t player) {
-	if(savestateHookNum == currentSavestateHook && player == viewingPlayerIndex) {
+	if(savestateHookNum == currentSavestateHook && branch == viewingBranchIndex && player == viewingPlayerIndex) {
 		setFramestateInfo(frame, id, state);
 	} else {
-		SET_BIT(getControllerData(player, savestateHookNum, branch, frame)->frameState, state, id);
+		allPlayers[player]->at(savestateHookNum)->inputs[branch]->setFrameState(frame, id, state);
 	}
 }
 
 uint8_t DataProcessing::getFramestateInfo(FrameNum frame, FrameState id) const {
-	return GET_BIT(getInputsList()->at(frame)->frameState, id);
+	return GET_BIT(getInputsList()->frameState(frame), id);
 }
 
 uint8_t DataProcessing::getFramestateInfoSpecific(FrameNum frame, FrameState id, SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t player) const {
-	return GET_BIT(getControllerData(player, savestateHookNum, branch, frame)->frameState, id);
+	return GET_BIT(getControllerData(player, savestateHookNum, branch, frame).frameState(), id);
 }
 
 // Without the id, just return the whole hog
 uint8_t DataProcessing::getFramestateInfo(FrameNum frame) const {
-	return getInputsList()->at(frame)->frameState;
+	return getInputsList()->frameState(frame);
 }
 
 void DataProcessing::invalidateRun(FrameNum frame) {
-	while(true) {
-		if(frame == getInputsList()->size() || !getFramestateInfo(frame, FrameState::RAN)) {
-			// Refresh all these items
-			// I don't care if it's way off the page, I think wxWidgets handles for this
-			Refresh();
-			break;
-		}
-		// Set bit
-		setFramestateInfo(frame, FrameState::RAN, false);
-		// Also delete framebuffer from filesystem if neccessary
-		wxFileName framebufferFileName = getFramebufferPath(viewingPlayerIndex, currentSavestateHook, viewingBranchIndex, frame);
-		if(framebufferFileName.FileExists()) {
-			// Delete file from filesystem
-			wxRemoveFile(framebufferFileName.GetFullPath());
+	invalidateRunSpecific(frame, currentSavestateHook, viewingBranchIndex, viewingPlayerIndex);
+}
+
+void DataProcessing::invalidateRunSpecific(FrameNum frame, SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t player) {
+	auto& list = allPlayers[player]->at(savestateHookNum)->inputs[branch];
+
+	invalidateRamHashes(frame, savestateHookNum, branch);
+
+	// Jumping has to send the edited frames again, even ones that never ran
+	if(savestateHookNum == jumpInputsHook && branch == jumpInputsBranch) {
+		jumpInputsEnd = std::min(jumpInputsEnd, std::max(frame, (FrameNum)1));
+	}
+
+	// Already never ran from here on
+	if(frame >= list->getValidFrames()) {
+		return;
+	}
+
+	// Every frame after this reads as not ran now, no matter how long the branch is
+	list->invalidateFrameStates(frame);
+	// Screenshots are removed on another thread, the editor never waits on the filesystem
+	framebufferCollector.collect(getFramebufferDir(savestateHookNum, branch).GetPath(), frame, UINT32_MAX);
+
+	if(savestateHookNum == currentSavestateHook && branch == viewingBranchIndex && player == viewingPlayerIndex) {
+		// Refresh all these items
+		// I don't care if it's way off the page, I think wxWidgets handles for this
+		Refresh();
+	}
+}
+
+void DataProcessing::invalidateRamHashes(FrameNum frame, SavestateBlockNum savestateHookNum, BranchNum branch) {
+	auto& ramHashes = allPlayers[0]->at(savestateHookNum)->ramHashes;
+	if(branch < ramHashes.size() && frame < ramHashes[branch].size()) {
+		ramHashes[branch].resize(frame);
+	}
+
+	// Final TAS runs play every hook after the one they started at
+	for(SavestateBlockNum hook = 0; hook <= savestateHookNum; hook++) {
+		allPlayers[0]->at(hook)->finalTasRamHashes.clear();
+	}
+}
+
+void DataProcessing::sendRamHashRanges() {
+	std::vector<uint64_t> addresses;
+	std::vector<uint64_t> lengths;
+	for(auto const& range : HELPERS::splitString(ramHashRanges, ',')) {
+		std::vector<std::string> parts = HELPERS::splitString(range, ':');
+		if(parts.size() == 2) {
+			addresses.push_back(strtoull(parts[0].c_str(), NULL, 16));
+			lengths.push_back(strtoull(parts[1].c_str(), NULL, 16));
 		}
-		frame++;
+	}
+
+	// No ranges turns hashing off
+	if(networkInstance->isConnected()) {
+		ADD_TO_QUEUE(SendRamHashRanges, networkInstance, {
+			data.addresses = addresses;
+			data.lengths   = lengths;
+		})
 	}
 }
 
-void DataProcessing::invalidateRunSpecific(FrameNum frame, SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t player) {
-	auto& list       = allPlayers[player]->at(savestateHookNum)->inputs[branch];
-	std::size_t size = list->size();
-	while(true) {
-		if(frame == size || !getFramestateInfoSpecific(frame, FrameState::RAN, savestateHookNum, branch, player)) {
-			// Refresh all these items
-			// I don't care if it's way off the page, I think wxWidgets handles for this
-			Refresh();
-			break;
-		} else {
-			// Set bit
-			setFramestateInfoSpecific(frame, FrameState::RAN, false, savestateHookNum, branch, player);
-			setFramestateInfoSpecific(frame, FrameState::SAVESTATE, false, savestateHookNum, branch, player);
-			frame++;
+void DataProcessing::sendLagDetection() {
+	uint64_t counterAddress = 0;
+	uint8_t counterSize     = 0;
+	std::vector<std::string> parts = HELPERS::splitString(lagCounter, ':');
+	if(parts.size() == 2) {
+		counterAddress = strtoull(parts[0].c_str(), NULL, 16);
+		counterSize    = strtoul(parts[1].c_str(), NULL, 16);
+	}
+
+	if(networkInstance->isConnected()) {
+		ADD_TO_QUEUE(SendLagDetection, networkInstance, {
+			data.method         = lagDetectionMethod;
+			data.counterAddress = counterAddress;
+			data.counterSize    = counterSize;
+			data.skipLagFrames  = skipLagFrames;
+		})
+	}
+}
+
+void DataProcessing::sendFrameAdvanceStrategy(uint8_t resetStats) {
+	if(networkInstance->isConnected() && frameAdvanceStrategy != FrameAdvanceStrategyType::NUM_OF_FRAME_ADVANCE_STRATEGIES) {
+		ADD_TO_QUEUE(SendFrameAdvanceStrategy, networkInstance, {
+			data.strategy   = frameAdvanceStrategy;
+			data.resetStats = resetStats;
+		})
+	}
+}
+
+void DataProcessing::addSkippedLagFrames(FrameNum frame, uint32_t numOfFrames, ControllerData controllerData) {
+	// The switch held the same inputs for all of them
+	for(uint32_t i = 0; i < numOfFrames; i++) {
+		if(getFramesSize() == frame + i) {
+			addFrameHere();
 		}
+		setControllerDataForAutoRun(controllerData);
+		setFramestateInfo(currentFrame, FrameState::LAG, true);
+		runFrame(true, true, true);
 	}
 }
 
-void DataProcessing::addFrame(FrameNum afterFrame) {
-	// Add this to the vector right after the selected frame
-	uint8_t playerIndex = 0;
-	for(auto& player : allPlayers) {
-		BranchNum branchIndex = 0;
+void DataProcessing::startRecordingInputs() {
+	if(networkInstance->isConnected() && !recordingInputs) {
+		recordingInputs = true;
+		journal.beginGroup();
+		ADD_TO_QUEUE(SendInputRecording, networkInstance, {
+			data.recording        = true;
+			data.savestateHookNum = currentSavestateHook;
+			data.branchIndex      = viewingBranchIndex;
+			data.playerIndex      = viewingPlayerIndex;
+			data.startFrame       = currentRunFrame;
+		})
+	}
+}
 
-		for(auto& branch : player->at(currentSavestateHook)->inputs) {
-			std::shared_ptr<ControllerData> newControllerData = std::make_shared<ControllerData>();
+void DataProcessing::stopRecordingInputs() {
+	if(recordingInputs) {
+		// Recording stays on until the last batch comes back
+		ADD_TO_QUEUE(SendInputRecording, networkInstance, {
+			data.recording        = false;
+			data.savestateHookNum = currentSavestateHook;
+			data.branchIndex      = viewingBranchIndex;
+			data.playerIndex      = viewingPlayerIndex;
+			data.startFrame       = 0;
+		})
+	}
+}
 
-			if(branch->size() == 0) {
-				branch->push_back(newControllerData);
-			} else {
-				auto begin = branch->begin();
-				branch->insert(begin + afterFrame + 1, newControllerData);
+void DataProcessing::appendRecordedInputs(SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t player, FrameNum firstFrame, std::vector<ControllerData>& frames, uint8_t finished) {
+	// The last batch still belongs to the undo step of the recording
+	bool lastBatch = finished && recordingInputs;
+	if(finished) {
+		recordingInputs = false;
+	}
+
+	if(player >= allPlayers.size() || savestateHookNum >= allPlayers[player]->size() || branch >= allPlayers[player]->at(savestateHookNum)->inputs.size()) {
+		if(lastBatch) {
+			journal.endGroup();
+		}
+		return;
+	}
+
+	// Came from the controller, but undone like an edit, every batch joins the same entry
+	std::vector<std::vector<BranchData>> framesBefore;
+	if(journal.isRecording()) {
+		framesBefore = forkSavestateHook(savestateHookNum);
+	}
+
+	// One more than was recorded when done, editing continues from there
+	FrameNum end    = firstFrame + frames.size();
+	FrameNum needed = finished ? end + 1 : end;
+
+	// Every branch of every player has the same length, grow them all in one go instead of a frame at a time
+	for(auto& playerData : allPlayers) {
+		for(auto& branchData : playerData->at(savestateHookNum)->inputs) {
+			if(branchData->size() < needed) {
+				branchData->resize(needed);
 			}
+		}
+	}
 
-			// Invalidate run for the data immidiently after this frame
-			invalidateRunSpecific(afterFrame + 1, currentSavestateHook, branchIndex, playerIndex);
+	// Whatever ran after this came from other inputs
+	invalidateRunSpecific(firstFrame, savestateHookNum, branch, player);
 
-			branchIndex++;
+	auto& list = allPlayers[player]->at(savestateHookNum)->inputs[branch];
+	for(FrameNum i = 0; i < frames.size(); i++) {
+		list->setInputs(firstFrame + i, frames[i]);
+		setFramestateInfoSpecific(firstFrame + i, FrameState::RAN, true, savestateHookNum, branch, player);
+	}
+
+	if(!framesBefore.empty()) {
+		journal.recordReplaceFrames(savestateHookNum, firstFrame, std::move(framesBefore), forkSavestateHook(savestateHookNum));
+	}
+	if(lastBatch) {
+		journal.endGroup();
+	}
+
+	if(savestateHookNum != currentSavestateHook || branch != viewingBranchIndex) {
+		return;
+	}
+
+	// Because of the usability of virtual list controls, just update the length
+	SetItemCount(getInputsList()->size());
+
+	if(finished) {
+		// The switch is paused right after the last recorded frame
+		jumpedToFrame(end);
+	} else {
+		Refresh();
+	}
+}
+
+void DataProcessing::recordRamHash(SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame, uint64_t hash) {
+	if(savestateHookNum >= allPlayers[0]->size()) {
+		return;
+	}
+
+	auto& ramHashes = allPlayers[0]->at(savestateHookNum)->ramHashes;
+	if(branch >= ramHashes.size()) {
+		ramHashes.resize(branch + 1);
+	}
+
+	std::vector<uint64_t>& branchHashes = ramHashes[branch];
+	if(frame < branchHashes.size() && branchHashes[frame] != 0 && branchHashes[frame] != hash && !ramDesyncReported) {
+		wxLogMessage("RAM desync at frame %u: hash %016llX, expected %016llX", frame, (unsigned long long)hash, (unsigned long long)branchHashes[frame]);
+		ramDesyncReported = true;
+	}
+
+	if(frame >= branchHashes.size()) {
+		branchHashes.resize(frame + 1, 0);
+	}
+	branchHashes[frame] = hash;
+}
+
+void DataProcessing::addFrame(FrameNum afterFrame) {
+	// Add this to the vector right after the selected frame
+	insertFrames(afterFrame + 1, 1);
+}
+
+void DataProcessing::insertFrames(FrameNum firstFrame, FrameNum numOfFrames) {
+	for(auto& player : allPlayers) {
+		for(auto& branch : player->at(currentSavestateHook)->inputs) {
+			// An empty branch just gets the frames
+			branch->insert(std::min(firstFrame, (FrameNum)branch->size()), numOfFrames);
 		}
+	}
+
+	journal.recordInsertFrames(currentSavestateHook, firstFrame, numOfFrames);
 
-		playerIndex++;
+	if(deferEdit(firstFrame, true)) {
+		return;
 	}
 
+	// Invalidate run for the data immidiently after this frame
+	invalidateRunAllBranches(firstFrame);
+	editMade(currentSavestateHook, firstFrame);
+
 	// Because of the usability of virtual list controls, just update the length
 	SetItemCount(getInputsList()->size());
 
-	modifyCurrentFrameViews(afterFrame + 1);
+	modifyCurrentFrameViews(firstFrame);
 
 	// Be very careful about refreshing, serious lag can happen if it's done wrong
-	if(IsVisible(afterFrame + 1)) {
+	if(IsVisible(firstFrame)) {
 		Refresh();
 	}
 }
@@ -1134,22 +1594,32 @@ void DataProcessing::removeFrames(FrameNum start, FrameNum end) {
 	// Since only selected frames will ever be selected, this just makes sure
 	// One frame is left over
 	if(end - start != (getFramesSize() - 1)) {
-		uint8_t playerIndex = 0;
+		// Removed frames are kept as slices, so this costs nothing until the chunks around them are written to
+		bool recording = journal.isRecording() && start <= end && end < getFramesSize();
+		std::vector<std::vector<BranchData>> removedFrames;
+
 		for(auto& player : allPlayers) {
-			BranchNum branchIndex = 0;
+			removedFrames.emplace_back();
 			for(auto& branch : player->at(currentSavestateHook)->inputs) {
-				auto beginning = branch->begin();
-				branch->erase(beginning + start, beginning + end + 1);
-
-				// Invalidate run for the data immidiently after this frame
-				invalidateRunSpecific(start, currentSavestateHook, branchIndex, playerIndex);
-
-				branchIndex++;
+				if(recording) {
+					removedFrames.back().push_back(branch->slice(start, end));
+				}
+				branch->erase(start, end);
 			}
+		}
+
+		if(recording) {
+			journal.recordRemoveFrames(currentSavestateHook, start, end - start + 1, removedFrames);
+		}
 
-			playerIndex++;
+		if(deferEdit(start, true)) {
+			return;
 		}
 
+		// Invalidate run for the data immidiently after this frame
+		invalidateRunAllBranches(start);
+		editMade(currentSavestateHook, start);
+
 		// Because of the usability of virtual list controls, just update the length
 		SetItemCount(getInputsList()->size());
 
@@ -1162,6 +1632,402 @@ void DataProcessing::removeFrames(FrameNum start, FrameNum end) {
 	}
 }
 
+void DataProcessing::editMade(SavestateBlockNum savestateHookNum, FrameNum frame) {
+	if(editCallback) {
+		editCallback(savestateHookNum, frame);
+	}
+}
+
+bool DataProcessing::deferEdit(FrameNum frame, bool resizedFrames) {
+	if(editDepth == 0) {
+		return false;
+	}
+
+	editFirstFrame = std::min(editFirstFrame, frame);
+	editResizedFrames |= resizedFrames;
+	return true;
+}
+
+std::vector<std::vector<BranchData>> DataProcessing::forkSavestateHook(SavestateBlockNum savestateHookNum) {
+	std::vector<std::vector<BranchData>> forks;
+	for(auto& player : allPlayers) {
+		forks.emplace_back();
+		for(auto& branch : player->at(savestateHookNum)->inputs) {
+			forks.back().push_back(branch->fork());
+		}
+	}
+	return forks;
+}
+
+void DataProcessing::invalidateRunAllBranches(FrameNum frame) {
+	for(uint8_t playerIndex = 0; playerIndex < allPlayers.size(); playerIndex++) {
+		auto& branches = allPlayers[playerIndex]->at(currentSavestateHook)->inputs;
+		for(BranchNum branchIndex = 0; branchIndex < branches.size(); branchIndex++) {
+			if(frame < branches[branchIndex]->size()) {
+				invalidateRunSpecific(frame, currentSavestateHook, branchIndex, playerIndex);
+			}
+		}
+	}
+}
+
+void DataProcessing::beginEdit(bool replaceFrames) {
+	if(editDepth++ != 0) {
+		return;
+	}
+
+	editFirstFrame    = UINT32_MAX;
+	editResizedFrames = false;
+	editReplaceFrames = replaceFrames;
+
+	if(!replaceFrames) {
+		// A few buttons or sticks are much smaller as changes than as forks of the whole hook
+		// They are made right after each other, so they join into one entry like dragging over frames does
+		return;
+	}
+
+	// The whole batch is one entry in the journal, made of the frames before and after
+	if(journal.isRecording()) {
+		editFramesBefore = forkSavestateHook(currentSavestateHook);
+	}
+	journal.pause();
+}
+
+void DataProcessing::commitEdit() {
+	if(--editDepth != 0) {
+		return;
+	}
+
+	if(editReplaceFrames) {
+		journal.resume();
+	}
+	if(editFirstFrame == UINT32_MAX) {
+		editFramesBefore.clear();
+		return;
+	}
+
+	if(!editFramesBefore.empty()) {
+		journal.recordReplaceFrames(currentSavestateHook, editFirstFrame, std::move(editFramesBefore), forkSavestateHook(currentSavestateHook));
+		editFramesBefore.clear();
+	}
+
+	if(editResizedFrames) {
+		invalidateRunAllBranches(editFirstFrame);
+		// Because of the usability of virtual list controls, just update the length
+		SetItemCount(getInputsList()->size());
+	} else {
+		invalidateRun(editFirstFrame);
+	}
+
+	if(currentFrame > (getFramesSize() - 1)) {
+		setCurrentFrame(getFramesSize() - 1);
+	} else {
+		modifyCurrentFrameViews(currentFrame);
+	}
+
+	editMade(currentSavestateHook, editFirstFrame);
+	Refresh();
+}
+
+void DataProcessing::previewAxisTransform(FrameNum first, FrameNum last, const AxisTransform& transform) {
+	if(!previewOriginal) {
+		previewOriginal = getInputsList()->fork();
+	}
+
+	// Always starts from the original, the chunks outside the range stay shared
+	FrameStore preview(*previewOriginal);
+	transformAxes(preview, first, last, transform);
+	getInputsList()->swap(preview);
+
+	modifyCurrentFrameViews(currentFrame);
+	Refresh();
+}
+
+void DataProcessing::endAxisTransformPreview() {
+	if(previewOriginal) {
+		FrameStore original(*previewOriginal);
+		getInputsList()->swap(original);
+		previewOriginal.reset();
+
+		modifyCurrentFrameViews(currentFrame);
+		Refresh();
+	}
+}
+
+void DataProcessing::applyAxisTransform(FrameNum first, FrameNum last, const AxisTransform& transform) {
+	endAxisTransformPreview();
+
+	beginEdit();
+	transformAxes(*getInputsList(), first, last, transform);
+	deferEdit(first, false);
+	commitEdit();
+}
+
+std::vector<FrameRange> DataProcessing::diffWithBranch(BranchNum other) {
+	BranchData otherFrames = allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs[other];
+	return diffFrames(*getInputsList(), *otherFrames, 0, UINT32_MAX);
+}
+
+MergeResult DataProcessing::mergeFromBranch(BranchNum other, BranchNum base, FrameNum first, FrameNum last, bool preferOther) {
+	auto& branches = allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs;
+	FrameNum size  = getFramesSize();
+
+	beginEdit();
+	// Every branch of the hook keeps the same length, so all of them grow if the other branch changed frames past the end
+	if(branches[other]->size() > size && last >= size) {
+		std::vector<FrameRange> beyond = diffFrames(*branches[other], *branches[base], std::max(first, size), std::min(last, branches[other]->size() - 1));
+		if(!beyond.empty()) {
+			// Only the shorter branches grow, inserting would push the frames of the longer ones along
+			FrameNum needed = beyond.back().last + 1;
+			for(auto& player : allPlayers) {
+				for(auto& branch : player->at(currentSavestateHook)->inputs) {
+					branch->resize(std::max((FrameNum)branch->size(), needed));
+				}
+			}
+			deferEdit(size, true);
+		}
+	}
+	MergeResult result = mergeFrames(*getInputsList(), *branches[other], *branches[base], first, last, preferOther);
+	deferEdit(result.firstChangedFrame, false);
+	commitEdit();
+	return result;
+}
+
+void DataProcessing::undo() {
+	std::vector<JournalEntry*> entries = journal.undoGroup();
+	// Undoing goes through the same functions as editing, which shouldn't record it again
+	journal.pause();
+	Freeze();
+	for(auto const& entry : entries) {
+		applyJournalEntry(*entry, true);
+	}
+	Thaw();
+	journal.resume();
+}
+
+void DataProcessing::redo() {
+	std::vector<JournalEntry*> entries = journal.redoGroup();
+	journal.pause();
+	Freeze();
+	for(auto const& entry : entries) {
+		applyJournalEntry(*entry, false);
+	}
+	Thaw();
+	journal.resume();
+}
+
+bool DataProcessing::viewJournalEntry(const JournalEntry& entry) {
+	// A removed player goes back where it was, so it can be one past the end
+	if(entry.type == JOURNAL_ADD_PLAYER || entry.type == JOURNAL_REMOVE_PLAYER) {
+		return entry.player <= allPlayers.size();
+	}
+
+	if(entry.player >= allPlayers.size()) {
+		return false;
+	}
+
+	// A removed hook goes back where it was, so it can be one past the end
+	SavestateBlockNum numOfHooks = allPlayers[entry.player]->size();
+	if(entry.type == JOURNAL_REMOVE_SAVESTATE_HOOK) {
+		return entry.savestateHookNum <= numOfHooks;
+	}
+
+	if(entry.savestateHookNum >= numOfHooks) {
+		return false;
+	}
+
+	// These change every player and branch of the hook, so the view stays where it is
+	bool wholeSavestateHook = entry.type == JOURNAL_INSERT_FRAMES || entry.type == JOURNAL_REMOVE_FRAMES || entry.type == JOURNAL_REPLACE_FRAMES || entry.type == JOURNAL_ADD_BRANCH;
+	// Same for a removed branch, applying the entry picks the branch to view
+	bool removedBranch      = entry.type == JOURNAL_REMOVE_BRANCH;
+	BranchNum numOfBranches = allPlayers[entry.player]->at(entry.savestateHookNum)->inputs.size();
+	if(removedBranch ? entry.branch > numOfBranches : !wholeSavestateHook && entry.branch >= numOfBranches) {
+		return false;
+	}
+
+	// Switching is slow, only do it when needed
+	if(!wholeSavestateHook && entry.player != viewingPlayerIndex) {
+		setPlayer(entry.player);
+	}
+	if(entry.savestateHookNum != currentSavestateHook) {
+		setSavestateHook(entry.savestateHookNum);
+	}
+	if(!wholeSavestateHook && !removedBranch && entry.branch != viewingBranchIndex) {
+		setBranch(entry.branch);
+	}
+	return true;
+}
+
+void DataProcessing::applyJournalEntry(const JournalEntry& entry, bool undoing) {
+	if(!viewJournalEntry(entry)) {
+		return;
+	}
+
+	switch(entry.type) {
+	case JOURNAL_BUTTONS:
+	case JOURNAL_NUMBER_VALUES: {
+		BranchData list = getInputsList();
+		for(auto const& change : entry.buttons) {
+			if(change.frame < list->size()) {
+				// Xor works both ways
+				list->setButtons(change.frame, list->buttons(change.frame) ^ change.mask);
+			}
+		}
+		for(auto const& change : entry.numberValues) {
+			if(change.frame < list->size()) {
+				list->setAxis(change.frame, change.id, undoing ? change.before : change.after);
+			}
+		}
+
+		FrameNum firstFrame = entry.getFirstFrame();
+		if(firstFrame < list->size()) {
+			invalidateRun(firstFrame);
+			editMade(currentSavestateHook, firstFrame);
+		}
+		modifyCurrentFrameViews(currentFrame);
+		Refresh();
+		break;
+	}
+	case JOURNAL_INSERT_FRAMES:
+		if(undoing) {
+			if(entry.firstFrame + entry.numOfFrames <= getFramesSize()) {
+				removeFrames(entry.firstFrame, entry.firstFrame + entry.numOfFrames - 1);
+			}
+		} else if(entry.firstFrame <= getFramesSize()) {
+			insertFrames(entry.firstFrame, entry.numOfFrames);
+		}
+		break;
+	case JOURNAL_REMOVE_FRAMES:
+		if(undoing) {
+			if(entry.firstFrame > getFramesSize()) {
+				break;
+			}
+
+			// Put the same chunks back
+			for(uint8_t playerIndex = 0; playerIndex < entry.removedFrames.size() && playerIndex < allPlayers.size(); playerIndex++) {
+				auto& branches = allPlayers[playerIndex]->at(currentSavestateHook)->inputs;
+				for(BranchNum branchIndex = 0; branchIndex < entry.removedFrames[playerIndex].size() && branchIndex < branches.size(); branchIndex++) {
+					branches[branchIndex]->splice(entry.firstFrame, *entry.removedFrames[playerIndex][branchIndex]);
+					invalidateRunSpecific(entry.firstFrame, currentSavestateHook, branchIndex, playerIndex);
+				}
+			}
+
+			editMade(currentSavestateHook, entry.firstFrame);
+			SetItemCount(getInputsList()->size());
+			setCurrentFrame(entry.firstFrame);
+			Refresh();
+		} else if(entry.firstFrame + entry.numOfFrames <= getFramesSize()) {
+			removeFrames(entry.firstFrame, entry.firstFrame + entry.numOfFrames - 1);
+		}
+		break;
+	case JOURNAL_ADD_BRANCH:
+		if(undoing) {
+			for(auto& player : allPlayers) {
+				auto& branches = player->at(currentSavestateHook)->inputs;
+				if(entry.branch < branches.size() && branches.size() > 1) {
+					branches.erase(branches.begin() + entry.branch);
+				}
+			}
+
+			auto& ramHashes = allPlayers[0]->at(currentSavestateHook)->ramHashes;
+			if(entry.branch < ramHashes.size()) {
+				ramHashes.erase(ramHashes.begin() + entry.branch);
+			}
+			framebufferCollector.remove(getFramebufferDir(currentSavestateHook, entry.branch).GetPath(), getRemovedFramebuffersDir());
+
+			setBranch(std::min(viewingBranchIndex, (uint16_t)(getNumBranches() - 1)));
+		} else {
+			for(uint8_t playerIndex = 0; playerIndex < entry.branches.size() && playerIndex < allPlayers.size(); playerIndex++) {
+				auto& branches = allPlayers[playerIndex]->at(currentSavestateHook)->inputs;
+				branches.insert(branches.begin() + std::min((std::size_t)entry.branch, branches.size()), entry.branches[playerIndex]);
+			}
+			setBranch(std::min(entry.branch, (BranchNum)(getNumBranches() - 1)));
+		}
+		break;
+	case JOURNAL_REPLACE_FRAMES: {
+		auto& frames = undoing ? entry.framesBefore : entry.framesAfter;
+		for(uint8_t playerIndex = 0; playerIndex < frames.size() && playerIndex < allPlayers.size(); playerIndex++) {
+			auto& branches = allPlayers[playerIndex]->at(currentSavestateHook)->inputs;
+			for(BranchNum branchIndex = 0; branchIndex < frames[playerIndex].size() && branchIndex < branches.size(); branchIndex++) {
+				// Copies the chunk tree, the chunks stay shared with the journal
+				*branches[branchIndex] = *frames[playerIndex][branchIndex];
+			}
+		}
+
+		invalidateRunAllBranches(entry.firstFrame);
+		editMade(currentSavestateHook, entry.firstFrame);
+		SetItemCount(getInputsList()->size());
+		setCurrentFrame(std::min(entry.firstFrame, (FrameNum)(getFramesSize() - 1)));
+		Refresh();
+		break;
+	}
+	case JOURNAL_REMOVE_SAVESTATE_HOOK:
+		if(undoing) {
+			auto& hooks = *allPlayers[entry.player];
+
+			// Make room for the framebuffers again, the ones of the hook itself were deleted
+			SavestateBlockNum end = entry.savestateHookNum;
+			while(savestateHookFramebuffersExist(end)) {
+				end++;
+			}
+			for(SavestateBlockNum i = end; i > entry.savestateHookNum; i--) {
+				moveSavestateHookFramebuffers(i - 1, i);
+			}
+
+			hooks.insert(hooks.begin() + entry.savestateHookNum, entry.savestateHook);
+			// Its framebuffers are gone, so it has to run again
+			if(entry.savestateHookNum < allPlayers[0]->size()) {
+				for(BranchNum branchIndex = 0; branchIndex < entry.savestateHook->inputs.size(); branchIndex++) {
+					invalidateRunSpecific(0, entry.savestateHookNum, branchIndex, entry.player);
+				}
+			}
+
+			setPlayer(entry.player);
+			setSavestateHook(entry.savestateHookNum);
+		} else if(entry.savestateHookNum < allPlayers[entry.player]->size()) {
+			setPlayer(entry.player);
+			removeSavestateHook(entry.savestateHookNum);
+		}
+		break;
+	case JOURNAL_REMOVE_BRANCH:
+		if(undoing) {
+			// Make room for the framebuffers again, the ones of the branch itself were deleted
+			BranchNum end = entry.branch;
+			while(getFramebufferDir(currentSavestateHook, end).DirExists()) {
+				end++;
+			}
+			for(BranchNum i = end; i > entry.branch; i--) {
+				framebufferCollector.move(getFramebufferDir(currentSavestateHook, i - 1).GetPath(), getFramebufferDir(currentSavestateHook, i).GetPath());
+			}
+
+			auto& branches = allPlayers[entry.player]->at(currentSavestateHook)->inputs;
+			branches.insert(branches.begin() + entry.branch, entry.branches[0]);
+
+			auto& ramHashes = allPlayers[0]->at(currentSavestateHook)->ramHashes;
+			if(entry.branch <= ramHashes.size()) {
+				ramHashes.emplace(ramHashes.begin() + entry.branch);
+			}
+
+			// Its framebuffers are gone, so it has to run again
+			invalidateRunSpecific(0, currentSavestateHook, entry.branch, entry.player);
+			setBranch(entry.branch);
+		} else if(entry.branch < getNumBranches()) {
+			removeBranch(entry.branch);
+		}
+		break;
+	case JOURNAL_ADD_PLAYER:
+	case JOURNAL_REMOVE_PLAYER:
+		// Adding one undone is the same as removing it redone
+		if(undoing == (entry.type == JOURNAL_REMOVE_PLAYER)) {
+			allPlayers.insert(allPlayers.begin() + entry.player, entry.playerData);
+			sendPlayerNum();
+			setPlayer(entry.player);
+		} else if(entry.player < allPlayers.size()) {
+			removePlayer(entry.player);
+		}
+		break;
+	}
+}
+
 std::size_t DataProcessing::getFramesSize() const {
 	return getInputsList()->size();
 }
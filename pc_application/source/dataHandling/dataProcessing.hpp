@@ -5,7 +5,9 @@
 #include <uxtheme.h>
 #endif
 
+#include <atomic>
 #include <bitset>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -15,6 +17,7 @@
 #include <memory>
 #include <rapidjson/document.h>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -24,16 +27,21 @@
 #include <wx/itemattr.h>
 #include <wx/listctrl.h>
 #include <wx/menu.h>
+#include <wx/progdlg.h>
 #include <wx/wx.h>
 
 #include "../sharedNetworkCode/networkInterface.hpp"
+#include "axisTransforms.hpp"
+#include "branchDiff.hpp"
 #include "buttonConstants.hpp"
 #include "buttonData.hpp"
+#include "editJournal.hpp"
+#include "framebufferCollector.hpp"
+#include "scriptConverter.hpp"
 
-typedef std::shared_ptr<ControllerData> FrameData;
 typedef std::vector<std::shared_ptr<std::vector<std::shared_ptr<SavestateHook>>>> AllPlayers;
 typedef std::vector<std::shared_ptr<SavestateHook>> AllSavestateHookBlocks;
-typedef std::shared_ptr<std::vector<FrameData>> BranchData;
+typedef std::shared_ptr<FrameStore> BranchData;
 
 class ButtonData;
 
@@ -42,16 +50,39 @@ class DataProcessing : public wxListCtrl {
 private:
 	// Vector storing inputs for current savestate hook
 	// SavestateHookBlock inputsList;
-	// Current input
-	FrameData currentData;
+	// Inputs of the branch being viewed
 	BranchData currentBranchData;
 	// Button data instance (never changes)
 	std::shared_ptr<ButtonData> buttonData;
 	// Vector holding the savestate hook blocks
 	// Is a vector of the players as well
 	AllPlayers allPlayers;
+	// Undo and redo of everything edited by hand
+	EditJournal journal;
+
+	// Between beginEdit and commitEdit, invalidating and refreshing waits until the end
+	uint8_t editDepth = 0;
+	// Earliest frame changed by the batch, UINT32_MAX if nothing was
+	FrameNum editFirstFrame;
+	// Frames were added or removed, so every branch and the list length changed
+	bool editResizedFrames;
+	// Every player and branch of the hook when the batch started, forks so they only cost the chunks the batch writes to
+	std::vector<std::vector<BranchData>> editFramesBefore;
+	// The batch is journaled as the frames before and after, otherwise every edit in it records its own change
+	bool editReplaceFrames;
+	// The branch being viewed before a transform was previewed on it, null when nothing is
+	BranchData previewOriginal;
+
+	// The switch keeps the inputs of frames it ran, so jumping only sends what changed since the last jump
+	// Frames before jumpInputsEnd were sent for these branches of every player and haven't been edited since
+	std::vector<std::weak_ptr<FrameStore>> jumpInputsBranches;
+	SavestateBlockNum jumpInputsHook = 0;
+	BranchNum jumpInputsBranch       = 0;
+	FrameNum jumpInputsEnd           = 1;
 
 	wxFileName projectStart;
+	// Screenshots of frames that have to run again are deleted on its thread
+	FramebufferCollector framebufferCollector;
 
 	bool tethered = false;
 
@@ -68,6 +99,28 @@ private:
 	uint8_t viewingPlayerIndex  = 0;
 	uint16_t viewingBranchIndex = 0;
 
+	// Hex ranges of memory hashed after every frame, "address:size" separated by commas
+	std::string ramHashRanges;
+	// Only the first RAM desync is logged until the hook or branch changes
+	bool ramDesyncReported = false;
+	// The final TAS hashes are stored in the hook it started at
+	SavestateBlockNum finalTasFirstHook = 0;
+
+	LagDetectionMethod lagDetectionMethod = LagDetectionMethod::LAG_DETECTION_NONE;
+	// Hex "address:size" of the counter the game increments when it handles a frame
+	std::string lagCounter;
+	// Auto run keeps the inputs through lag frames instead of spending one on each
+	bool skipLagFrames = false;
+
+	// The fastest one that still matches depends on the game, NUM_OF_FRAME_ADVANCE_STRATEGIES leaves the switch default
+	FrameAdvanceStrategyType frameAdvanceStrategy = FrameAdvanceStrategyType::NUM_OF_FRAME_ADVANCE_STRATEGIES;
+
+	// The switch is recording the real controller, the joystick on the PC is ignored meanwhile
+	// Everything it records is one undo step
+	bool recordingInputs = false;
+	// Auto run is one undo step, every frame would push the edits made by hand out of the journal otherwise
+	bool autoRunJournalGroup = false;
+
 	wxImageList imageList;
 
 	// Using callbacks for inputs
@@ -77,6 +130,7 @@ private:
 	std::function<void(FrameNum, FrameNum, FrameNum)> changingSelectedFrameCallback;
 	std::function<void(uint8_t, uint8_t, bool)> playerInfoCallback;
 	std::function<void(uint16_t, uint16_t, bool)> branchInfoCallback;
+	std::function<void(SavestateBlockNum, FrameNum)> editCallback;
 
 	// Network instance for sending to switch
 	std::shared_ptr<CommunicateWithNetwork> networkInstance;
@@ -112,6 +166,18 @@ private:
 	int frameAdvanceID;
 	int savestateID;
 	int mergeIntoMainBranchID;
+	int jumpToFrameID;
+	int findButtonsID;
+	int findNextID;
+	int findPreviousID;
+	int inputStatisticsID;
+	int transformAxesID;
+	int compareBranchesID;
+
+	// Last buttons searched for, F3 goes to the next press of them
+	ButtonQuery findQuery;
+	bool haveFindQuery = false;
+	wxString findText;
 
 	int insertPaste;
 	bool placePaste;
@@ -136,6 +202,39 @@ private:
 	void onFrameAdvance(wxCommandEvent& event);
 	void onAddSavestate(wxCommandEvent& event);
 	void onMergeIntoMainBranch(wxCommandEvent& event);
+	void onJumpToFrame(wxCommandEvent& event);
+	void onUndo(wxCommandEvent& event);
+	void onRedo(wxCommandEvent& event);
+	void onFindButtons(wxCommandEvent& event);
+	void onFindNext(wxCommandEvent& event);
+	void onFindPrevious(wxCommandEvent& event);
+	void onInputStatistics(wxCommandEvent& event);
+	void onTransformAxes(wxCommandEvent& event);
+	void onCompareBranches(wxCommandEvent& event);
+
+	// Moves to the next or previous frame the find buttons are pressed on
+	void findButtons(bool forward);
+
+	// Adds empty frames in every player and branch of the current hook
+	void insertFrames(FrameNum firstFrame, FrameNum numOfFrames);
+	// Switches to where the entry was made, false if that doesn't exist anymore
+	bool viewJournalEntry(const JournalEntry& entry);
+	void applyJournalEntry(const JournalEntry& entry, bool undoing);
+	void editMade(SavestateBlockNum savestateHookNum, FrameNum frame);
+	// Remembers the frame if in a batch, true if the caller should leave invalidating to commitEdit
+	bool deferEdit(FrameNum frame, bool resizedFrames);
+	// Forks of every player and branch of the hook
+	std::vector<std::vector<BranchData>> forkSavestateHook(SavestateBlockNum savestateHookNum);
+	// Writes the inputs into the frame, journaling only what changed like an edit would
+	void transferControllerDataJournaled(ControllerData controllerData, uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame);
+	void invalidateRunAllBranches(FrameNum frame);
+
+	// Runs the task on its own thread, a progress dialog that can cancel it shows up if it takes a while
+	// False if it was cancelled
+	bool runInBackground(wxString message, ScriptProgress& progress, std::function<void()> task);
+
+	bool savestateHookFramebuffersExist(SavestateBlockNum index);
+	void moveSavestateHookFramebuffers(SavestateBlockNum from, SavestateBlockNum to);
 
 public:
 	static const int LIST_CTRL_ID = 1000;
@@ -149,11 +248,14 @@ public:
 	void setChangingSelectedFrameCallback(std::function<void(FrameNum, FrameNum, FrameNum)> callback);
 	void setPlayerInfoCallback(std::function<void(uint8_t, uint8_t, bool)> callback);
 	void setBranchInfoCallback(std::function<void(uint16_t, uint16_t, bool)> callback);
+	// Called with the earliest frame of every edit, including undo and redo
+	void setEditCallback(std::function<void(SavestateBlockNum, FrameNum)> callback);
 	void triggerCurrentFrameChanges();
 
 	void sendAutoAdvance(uint8_t includeFramebuffer);
 
-	std::string getExportedCurrentPlayer();
+	// False if it was cancelled
+	bool getExportedCurrentPlayer(std::string& exported);
 	void importFromFile(wxFileName importTarget);
 
 	void setProjectStart(wxFileName start) {
@@ -171,6 +273,7 @@ public:
 		for(auto& player : players) {
 			allPlayers.push_back(player);
 		}
+		journal.clear();
 		setPlayer(0);
 	}
 
@@ -197,26 +300,47 @@ public:
 		return allPlayers[player]->at(i)->inputs[viewingBranchIndex]->size();
 	}
 
-	wxFileName getFramebufferPath(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame) {
+	wxFileName getFramebufferDirForSavestateHook(SavestateBlockNum index) {
+		// Doesn't create it, so it can be checked for
+		wxFileName framebufferDir = projectStart;
+		framebufferDir.AppendDir("framebuffers");
+		framebufferDir.AppendDir(wxString::Format("savestate_block_%u", index));
+		return framebufferDir;
+	}
+
+	// Removed framebuffer folders wait here until they are deleted
+	wxString getRemovedFramebuffersDir() {
+		wxFileName removedDir = projectStart;
+		removedDir.AppendDir("framebuffers");
+		removedDir.AppendDir("removed");
+		return removedDir.GetPath();
+	}
+
+	wxFileName getFramebufferDir(SavestateBlockNum savestateHookNum, BranchNum branch) {
 		// The player does not matter in the path
-		wxFileName framebufferFileName = projectStart;
-		framebufferFileName.AppendDir("framebuffers");
-		framebufferFileName.AppendDir(wxString::Format("savestate_block_%u", savestateHookNum));
+		wxFileName framebufferDir = getFramebufferDirForSavestateHook(savestateHookNum);
 
 		if(branch == 0) {
 			// Main branch gets a special name
-			framebufferFileName.AppendDir("branch_main");
+			framebufferDir.AppendDir("branch_main");
 		} else {
-			framebufferFileName.AppendDir(wxString::Format("branch_%u", branch));
+			framebufferDir.AppendDir(wxString::Format("branch_%u", branch));
 		}
 
-		framebufferFileName.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+		return framebufferDir;
+	}
 
+	wxFileName getFramebufferPath(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame) {
+		// Doesn't create the folder either, saving does
+		wxFileName framebufferFileName = getFramebufferDir(savestateHookNum, branch);
 		framebufferFileName.SetName(wxString::Format("frame_%lu_screenshot", frame));
 		framebufferFileName.SetExt("jpg");
 		return framebufferFileName;
 	}
 
+	// Saves a screenshot sent by the switch
+	void saveFramebuffer(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame, std::vector<uint8_t>& buf);
+
 	wxFileName getFramebufferPathForCurrent() {
 		return getFramebufferPath(viewingPlayerIndex, currentSavestateHook, viewingBranchIndex, currentFrame);
 	}
@@ -226,8 +350,6 @@ public:
 		wxFileName framebufferFileName = projectStart;
 		framebufferFileName.AppendDir("framebuffers");
 
-		framebufferFileName.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
-
 		wxString name = "savestate_block_%u_screenshot";
 		framebufferFileName.SetName(wxString::Format(name, index));
 		framebufferFileName.SetExt("jpg");
@@ -250,11 +372,17 @@ public:
 
 	void createSavestateHere();
 	void runFrame(uint8_t forAutoFrame, uint8_t updateFramebuffer, uint8_t includeFramebuffer);
+	// The switch restores the nearest savestate it has and replays the rest, it answers if it couldn't
+	void sendJumpToFrame(FrameNum frame);
+	// Called once the switch is at the frame
+	void jumpedToFrame(FrameNum frame);
+	// The switch didn't jump, the next jump sends every frame again
+	void jumpToFrameFailed(FrameNum frame, SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t inputsMissing);
 
 	// TODO cache this
-	std::shared_ptr<std::vector<std::shared_ptr<ControllerData>>> getInputsList() const;
+	BranchData getInputsList() const;
 
-	std::shared_ptr<ControllerData> getControllerData(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame) const {
+	FrameView getControllerData(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame) const {
 		return allPlayers[player]->at(savestateHookNum)->inputs[branch]->at(frame);
 	}
 
@@ -282,7 +410,7 @@ public:
 		return allPlayers[viewingPlayerIndex]->at(currentSavestateHook)->inputs.size();
 	}
 
-	std::shared_ptr<ControllerData> getFrame(FrameNum frame) const;
+	FrameView getFrame(FrameNum frame) const;
 
 	void scrollToSpecific(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame);
 
@@ -296,6 +424,8 @@ public:
 	uint8_t getButtonCurrent(Btn button) const;
 
 	void setControllerDataForAutoRun(ControllerData controllerData);
+	void beginAutoRun();
+	void endAutoRun();
 
 	// This includes joysticks, accel, gyro, etc...
 	void triggerNumberValues(ControllerNumberValues joystickId, int16_t value);
@@ -317,6 +447,97 @@ public:
 
 	void invalidateRun(FrameNum frame);
 	void invalidateRunSpecific(FrameNum frame, SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t player);
+	// Hashes from this frame on came from different inputs, so are final TAS runs through this hook
+	void invalidateRamHashes(FrameNum frame, SavestateBlockNum savestateHookNum, BranchNum branch);
+
+	void setRamHashRanges(std::string ranges) {
+		ramHashRanges = ranges;
+	}
+
+	std::string getRamHashRanges() {
+		return ramHashRanges;
+	}
+
+	void sendRamHashRanges();
+	// Compares with the hash from the last time this frame ran and keeps the new one
+	void recordRamHash(SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame, uint64_t hash);
+
+	void setLagDetectionMethod(LagDetectionMethod method) {
+		lagDetectionMethod = method;
+	}
+
+	LagDetectionMethod getLagDetectionMethod() {
+		return lagDetectionMethod;
+	}
+
+	void setLagCounter(std::string counter) {
+		lagCounter = counter;
+	}
+
+	std::string getLagCounter() {
+		return lagCounter;
+	}
+
+	void setSkipLagFrames(bool skip) {
+		skipLagFrames = skip;
+	}
+
+	void sendLagDetection();
+
+	void setFrameAdvanceStrategy(FrameAdvanceStrategyType strategy) {
+		frameAdvanceStrategy = strategy;
+	}
+
+	FrameAdvanceStrategyType getFrameAdvanceStrategy() {
+		return frameAdvanceStrategy;
+	}
+
+	void sendFrameAdvanceStrategy(uint8_t resetStats);
+	// Lag frames the switch skipped during auto run still get a frame in the editor, marked as lag
+	void addSkippedLagFrames(FrameNum frame, uint32_t numOfFrames, ControllerData controllerData);
+
+	// Starts from the frame the switch is on, in the current player and branch
+	void startRecordingInputs();
+	void stopRecordingInputs();
+
+	bool isRecordingInputs() {
+		return recordingInputs;
+	}
+
+	// A batch recorded on the switch, overwrites whatever was there and marks it as ran
+	void appendRecordedInputs(SavestateBlockNum savestateHookNum, BranchNum branch, uint8_t player, FrameNum firstFrame, std::vector<ControllerData>& frames, uint8_t finished);
+
+	void setFinalTasFirstHook(SavestateBlockNum savestateHookNum) {
+		finalTasFirstHook = savestateHookNum;
+	}
+
+	std::vector<uint64_t>& getFinalTasRamHashes(SavestateBlockNum savestateHookNum) {
+		return allPlayers[0]->at(savestateHookNum)->finalTasRamHashes;
+	}
+
+	void setFinalTasRamHashes(std::vector<uint64_t> hashes) {
+		getFinalTasRamHashes(finalTasFirstHook) = hashes;
+	}
+
+	void undo();
+	void redo();
+
+	// Applies everything until the matching commitEdit as one edit, with one invalidation, one refresh and one undo step
+	// Can be nested, only the outer one counts
+	// Without replaceFrames the edits journal themselves, only for ones that do, like setting buttons and sticks
+	void beginEdit(bool replaceFrames = true);
+	void commitEdit();
+
+	// Shows the transform on the frames without recording or invalidating anything, until the preview ends
+	void previewAxisTransform(FrameNum first, FrameNum last, const AxisTransform& transform);
+	void endAxisTransformPreview();
+	// Applied as one edit
+	void applyAxisTransform(FrameNum first, FrameNum last, const AxisTransform& transform);
+
+	// Frames where the branch being viewed and another branch of the hook differ
+	std::vector<FrameRange> diffWithBranch(BranchNum other);
+	// Brings what the other branch changed since base into the branch being viewed, applied as one edit
+	MergeResult mergeFromBranch(BranchNum other, BranchNum base, FrameNum first, FrameNum last, bool preferOther);
 
 	void addFrame(FrameNum afterFrame);
 	void addFrameHere();
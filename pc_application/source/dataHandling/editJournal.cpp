@@ -0,0 +1,387 @@
+#include "editJournal.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+// Rough size of a change with its place in the index
+#define JOURNAL_CHANGE_OVERHEAD 32
+// Rough size of a frame in a frame store
+#define JOURNAL_FRAME_BYTES sizeof(FrameChunk) / FRAME_CHUNK_SIZE
+
+FrameNum JournalEntry::getFirstFrame() const {
+	switch(type) {
+	case JOURNAL_BUTTONS: {
+		FrameNum first = UINT32_MAX;
+		for(auto const& change : buttons) {
+			first = std::min(first, change.frame);
+		}
+		return first;
+	}
+	case JOURNAL_NUMBER_VALUES: {
+		FrameNum first = UINT32_MAX;
+		for(auto const& change : numberValues) {
+			first = std::min(first, change.frame);
+		}
+		return first;
+	}
+	case JOURNAL_INSERT_FRAMES:
+	case JOURNAL_REMOVE_FRAMES:
+	case JOURNAL_REPLACE_FRAMES:
+		return firstFrame;
+	default:
+		return 0;
+	}
+}
+
+static std::size_t replacedBytes(const std::vector<std::vector<std::shared_ptr<FrameStore>>>& framesBefore, const std::vector<std::vector<std::shared_ptr<FrameStore>>>& framesAfter) {
+	// Chunks the batch didn't write to are shared by both, only the rest takes memory
+	std::unordered_set<const FrameChunk*> chunksBefore;
+	std::unordered_set<const FrameChunk*> chunksAfter;
+	for(auto const& player : framesBefore) {
+		for(auto const& branch : player) {
+			branch->forEachRun(0, branch->size() - 1, [&](uint32_t frame, const FrameChunk& chunk, uint32_t index, uint32_t count) {
+				chunksBefore.insert(&chunk);
+			});
+		}
+	}
+	for(auto const& player : framesAfter) {
+		for(auto const& branch : player) {
+			branch->forEachRun(0, branch->size() - 1, [&](uint32_t frame, const FrameChunk& chunk, uint32_t index, uint32_t count) {
+				if(!chunksBefore.count(&chunk)) {
+					chunksAfter.insert(&chunk);
+				}
+			});
+		}
+	}
+	return chunksAfter.size() * sizeof(FrameChunk);
+}
+
+static bool isValueChange(JournalEditType type) {
+	return type == JOURNAL_BUTTONS || type == JOURNAL_NUMBER_VALUES;
+}
+
+// True if an edit of this type on the frame does the same thing whether it comes before or after the entry
+static bool canMoveBefore(const JournalEntry& entry, JournalEditType type, SavestateBlockNum savestateHookNum, FrameNum frame) {
+	if(isValueChange(entry.type) && isValueChange(type)) {
+		// Neither moves frames, and the same frame and value is always in the same entry
+		return true;
+	}
+	if(entry.type == JOURNAL_INSERT_FRAMES && isValueChange(type)) {
+		return entry.savestateHookNum != savestateHookNum || frame < entry.firstFrame;
+	}
+	if(isValueChange(entry.type) && type == JOURNAL_INSERT_FRAMES) {
+		return entry.savestateHookNum != savestateHookNum || entry.lastFrame < frame;
+	}
+	return false;
+}
+
+JournalEntry* EditJournal::joinable(JournalEditType type, uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame) {
+	if(undoEntries.empty()) {
+		return nullptr;
+	}
+
+	if(groupDepth != 0) {
+		// Auto run adds a frame, sets its buttons and then its sticks, every frame would be three more entries otherwise
+		for(auto entry = undoEntries.rbegin(); entry != undoEntries.rend() && entry->group == openGroup; entry++) {
+			if(entry->type == type && entry->player == player && entry->savestateHookNum == savestateHookNum && entry->branch == branch) {
+				return &*entry;
+			}
+			if(!canMoveBefore(*entry, type, savestateHookNum, frame)) {
+				return nullptr;
+			}
+		}
+		return nullptr;
+	}
+
+	JournalEntry& last = undoEntries.back();
+	if(last.type != type || last.player != player || last.savestateHookNum != savestateHookNum || last.branch != branch) {
+		return nullptr;
+	}
+
+	auto sinceLast = std::chrono::steady_clock::now() - last.time;
+	if(last.explicitGroup || sinceLast > std::chrono::milliseconds(JOURNAL_COALESCE_MILLISECONDS)) {
+		return nullptr;
+	}
+
+	return &last;
+}
+
+JournalEntry& EditJournal::push(JournalEditType type, uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch) {
+	// Anything undone is gone once something new happens
+	redoEntries.clear();
+
+	JournalEntry entry;
+	entry.type             = type;
+	entry.explicitGroup    = groupDepth != 0;
+	entry.player           = player;
+	entry.savestateHookNum = savestateHookNum;
+	entry.branch           = branch;
+
+	if(groupDepth != 0 && !undoEntries.empty() && undoEntries.back().group == openGroup) {
+		// Another kind of edit inside the same group
+		entry.group = openGroup;
+	} else {
+		entry.group = groupDepth != 0 ? openGroup : nextGroup++;
+		numOfGroups++;
+	}
+
+	undoEntries.push_back(std::move(entry));
+	return undoEntries.back();
+}
+
+void EditJournal::addMemory(JournalEntry& entry, std::size_t bytes) {
+	entry.memoryUsage += bytes;
+	memoryUsage += bytes;
+	entry.time = std::chrono::steady_clock::now();
+	trim();
+}
+
+void EditJournal::trim() {
+	// Never drop the group being recorded
+	while((memoryUsage > JOURNAL_MAX_BYTES || numOfGroups > JOURNAL_MAX_GROUPS) && numOfGroups > 1) {
+		uint32_t oldestGroup = undoEntries.front().group;
+		while(!undoEntries.empty() && undoEntries.front().group == oldestGroup) {
+			memoryUsage -= undoEntries.front().memoryUsage;
+			undoEntries.pop_front();
+		}
+		numOfGroups--;
+	}
+}
+
+void EditJournal::beginGroup() {
+	if(groupDepth == 0) {
+		openGroup = nextGroup++;
+	}
+	groupDepth++;
+}
+
+void EditJournal::endGroup() {
+	groupDepth--;
+}
+
+void EditJournal::recordButtons(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame, uint32_t mask) {
+	if(paused || mask == 0) {
+		return;
+	}
+
+	JournalEntry* entry = joinable(JOURNAL_BUTTONS, player, savestateHookNum, branch, frame);
+	if(entry != nullptr) {
+		auto existing = entry->changeIndex.find(frame);
+		if(existing != entry->changeIndex.end()) {
+			// Toggled again, xor keeps track of the whole thing
+			entry->buttons[existing->second].mask ^= mask;
+			entry->time = std::chrono::steady_clock::now();
+			return;
+		}
+	} else {
+		entry = &push(JOURNAL_BUTTONS, player, savestateHookNum, branch);
+	}
+
+	entry->changeIndex[frame] = entry->buttons.size();
+	entry->buttons.push_back({ frame, mask });
+	entry->lastFrame = std::max(entry->lastFrame, frame);
+	addMemory(*entry, sizeof(JournalButtonChange) + JOURNAL_CHANGE_OVERHEAD);
+}
+
+void EditJournal::recordNumberValue(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame, ControllerNumberValues id, int16_t before, int16_t after) {
+	if(paused || before == after) {
+		return;
+	}
+
+	uint64_t key        = (uint64_t)frame * NUM_OF_FRAME_AXES + id;
+	JournalEntry* entry = joinable(JOURNAL_NUMBER_VALUES, player, savestateHookNum, branch, frame);
+	if(entry != nullptr) {
+		auto existing = entry->changeIndex.find(key);
+		if(existing != entry->changeIndex.end()) {
+			// Dragging a stick sets the same frames over and over, only the first before matters
+			entry->numberValues[existing->second].after = after;
+			entry->time                                 = std::chrono::steady_clock::now();
+			return;
+		}
+	} else {
+		entry = &push(JOURNAL_NUMBER_VALUES, player, savestateHookNum, branch);
+	}
+
+	entry->changeIndex[key] = entry->numberValues.size();
+	entry->numberValues.push_back({ frame, id, before, after });
+	entry->lastFrame = std::max(entry->lastFrame, frame);
+	addMemory(*entry, sizeof(JournalNumberChange) + JOURNAL_CHANGE_OVERHEAD);
+}
+
+void EditJournal::recordInsertFrames(SavestateBlockNum savestateHookNum, FrameNum firstFrame, FrameNum numOfFrames) {
+	if(paused || numOfFrames == 0) {
+		return;
+	}
+
+	// Frames added inside or right after the last blank run just make it longer
+	JournalEntry* entry = joinable(JOURNAL_INSERT_FRAMES, 0, savestateHookNum, 0, firstFrame);
+	if(entry != nullptr && firstFrame >= entry->firstFrame && firstFrame <= entry->firstFrame + entry->numOfFrames) {
+		entry->numOfFrames += numOfFrames;
+		addMemory(*entry, 0);
+		return;
+	}
+
+	entry              = &push(JOURNAL_INSERT_FRAMES, 0, savestateHookNum, 0);
+	entry->firstFrame  = firstFrame;
+	entry->numOfFrames = numOfFrames;
+	addMemory(*entry, sizeof(JournalEntry));
+}
+
+void EditJournal::recordRemoveFrames(SavestateBlockNum savestateHookNum, FrameNum firstFrame, FrameNum numOfFrames, std::vector<std::vector<std::shared_ptr<FrameStore>>> removedFrames) {
+	if(paused || numOfFrames == 0) {
+		return;
+	}
+
+	std::size_t numOfStores = 0;
+	for(auto const& player : removedFrames) {
+		numOfStores += player.size();
+	}
+
+	JournalEntry& entry = push(JOURNAL_REMOVE_FRAMES, 0, savestateHookNum, 0);
+	entry.firstFrame    = firstFrame;
+	entry.numOfFrames   = numOfFrames;
+	entry.removedFrames = std::move(removedFrames);
+	addMemory(entry, sizeof(JournalEntry) + numOfStores * numOfFrames * JOURNAL_FRAME_BYTES);
+}
+
+void EditJournal::recordAddBranch(SavestateBlockNum savestateHookNum, BranchNum branch, std::vector<std::shared_ptr<FrameStore>> branches) {
+	if(paused) {
+		return;
+	}
+
+	// The new branch shares every chunk with the one it came from, so it costs nothing until edited
+	JournalEntry& entry = push(JOURNAL_ADD_BRANCH, 0, savestateHookNum, branch);
+	entry.branches      = std::move(branches);
+	addMemory(entry, sizeof(JournalEntry));
+}
+
+void EditJournal::recordRemoveSavestateHook(uint8_t player, SavestateBlockNum savestateHookNum, std::shared_ptr<SavestateHook> savestateHook) {
+	if(paused) {
+		return;
+	}
+
+	std::size_t numOfFrames = 0;
+	for(auto const& branch : savestateHook->inputs) {
+		numOfFrames += branch->size();
+	}
+
+	JournalEntry& entry = push(JOURNAL_REMOVE_SAVESTATE_HOOK, player, savestateHookNum, 0);
+	entry.savestateHook = savestateHook;
+	addMemory(entry, sizeof(JournalEntry) + numOfFrames * JOURNAL_FRAME_BYTES);
+}
+
+void EditJournal::recordRemoveBranch(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, std::shared_ptr<FrameStore> frames) {
+	if(paused) {
+		return;
+	}
+
+	std::size_t numOfFrames = frames->size();
+	JournalEntry& entry     = push(JOURNAL_REMOVE_BRANCH, player, savestateHookNum, branch);
+	entry.branches.push_back(std::move(frames));
+	addMemory(entry, sizeof(JournalEntry) + numOfFrames * JOURNAL_FRAME_BYTES);
+}
+
+void EditJournal::recordAddPlayer(uint8_t player, std::shared_ptr<std::vector<std::shared_ptr<SavestateHook>>> playerData) {
+	if(paused) {
+		return;
+	}
+
+	// Only blank frames, they cost nothing worth counting
+	JournalEntry& entry = push(JOURNAL_ADD_PLAYER, player, 0, 0);
+	entry.playerData    = std::move(playerData);
+	addMemory(entry, sizeof(JournalEntry));
+}
+
+void EditJournal::recordRemovePlayer(uint8_t player, std::shared_ptr<std::vector<std::shared_ptr<SavestateHook>>> playerData) {
+	if(paused) {
+		return;
+	}
+
+	std::size_t numOfFrames = 0;
+	for(auto const& hook : *playerData) {
+		for(auto const& branch : hook->inputs) {
+			numOfFrames += branch->size();
+		}
+	}
+
+	JournalEntry& entry = push(JOURNAL_REMOVE_PLAYER, player, 0, 0);
+	entry.playerData    = std::move(playerData);
+	addMemory(entry, sizeof(JournalEntry) + numOfFrames * JOURNAL_FRAME_BYTES);
+}
+
+void EditJournal::recordReplaceFrames(SavestateBlockNum savestateHookNum, FrameNum firstFrame, std::vector<std::vector<std::shared_ptr<FrameStore>>> framesBefore, std::vector<std::vector<std::shared_ptr<FrameStore>>> framesAfter) {
+	if(paused) {
+		return;
+	}
+
+	// Batches one after another, like a stick being dragged over a selection, keep the first before
+	JournalEntry* entry = joinable(JOURNAL_REPLACE_FRAMES, 0, savestateHookNum, 0, firstFrame);
+	if(entry != nullptr) {
+		memoryUsage -= entry->memoryUsage;
+		entry->memoryUsage = 0;
+		entry->firstFrame  = std::min(entry->firstFrame, firstFrame);
+		entry->framesAfter = std::move(framesAfter);
+		addMemory(*entry, sizeof(JournalEntry) + replacedBytes(entry->framesBefore, entry->framesAfter));
+		return;
+	}
+
+	entry               = &push(JOURNAL_REPLACE_FRAMES, 0, savestateHookNum, 0);
+	entry->firstFrame   = firstFrame;
+	entry->framesBefore = std::move(framesBefore);
+	entry->framesAfter  = std::move(framesAfter);
+	addMemory(*entry, sizeof(JournalEntry) + replacedBytes(entry->framesBefore, entry->framesAfter));
+}
+
+std::vector<JournalEntry*> EditJournal::undoGroup() {
+	std::vector<JournalEntry*> entries;
+	if(undoEntries.empty()) {
+		return entries;
+	}
+
+	uint32_t group      = undoEntries.back().group;
+	std::size_t redoEnd = redoEntries.size();
+	while(!undoEntries.empty() && undoEntries.back().group == group) {
+		memoryUsage -= undoEntries.back().memoryUsage;
+		redoEntries.push_back(std::move(undoEntries.back()));
+		undoEntries.pop_back();
+	}
+	numOfGroups--;
+
+	// Whatever is recorded next can't join an edit from before the undo
+	if(!undoEntries.empty()) {
+		undoEntries.back().explicitGroup = true;
+	}
+
+	// Pushed newest first, which is the order to undo them in
+	for(std::size_t i = redoEnd; i < redoEntries.size(); i++) {
+		entries.push_back(&redoEntries[i]);
+	}
+	return entries;
+}
+
+std::vector<JournalEntry*> EditJournal::redoGroup() {
+	std::vector<JournalEntry*> entries;
+	if(redoEntries.empty()) {
+		return entries;
+	}
+
+	uint32_t group = redoEntries.back().group;
+	while(!redoEntries.empty() && redoEntries.back().group == group) {
+		memoryUsage += redoEntries.back().memoryUsage;
+		// Redone edits never join whatever is recorded next
+		redoEntries.back().explicitGroup = true;
+		undoEntries.push_back(std::move(redoEntries.back()));
+		redoEntries.pop_back();
+		// The deque doesn't move elements when pushing to the back
+		entries.push_back(&undoEntries.back());
+	}
+	numOfGroups++;
+	return entries;
+}
+
+void EditJournal::clear() {
+	undoEntries.clear();
+	redoEntries.clear();
+	memoryUsage = 0;
+	numOfGroups = 0;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "buttonConstants.hpp"
+#include "frameStore.hpp"
+
+// Edits of the same kind closer together than this are undone as one, like dragging over frames
+#define JOURNAL_COALESCE_MILLISECONDS 500
+// The oldest edits are forgotten once either is passed
+#define JOURNAL_MAX_BYTES (32 * 1024 * 1024)
+#define JOURNAL_MAX_GROUPS 1000
+
+enum JournalEditType : uint8_t {
+	JOURNAL_BUTTONS,
+	JOURNAL_NUMBER_VALUES,
+	JOURNAL_INSERT_FRAMES,
+	JOURNAL_REMOVE_FRAMES,
+	JOURNAL_ADD_BRANCH,
+	JOURNAL_REMOVE_SAVESTATE_HOOK,
+	JOURNAL_REPLACE_FRAMES,
+	JOURNAL_REMOVE_BRANCH,
+	JOURNAL_ADD_PLAYER,
+	JOURNAL_REMOVE_PLAYER,
+};
+
+struct JournalButtonChange {
+	FrameNum frame;
+	// Buttons before xor buttons after, applying it again flips it back
+	uint32_t mask;
+};
+
+struct JournalNumberChange {
+	FrameNum frame;
+	ControllerNumberValues id;
+	int16_t before;
+	int16_t after;
+};
+
+struct JournalEntry {
+	JournalEditType type;
+	// Everything in one group is undone together
+	uint32_t group;
+	// Made between beginGroup and endGroup, nothing else joins it later
+	uint8_t explicitGroup;
+	std::chrono::steady_clock::time_point time;
+
+	uint8_t player;
+	SavestateBlockNum savestateHookNum;
+	BranchNum branch;
+
+	std::vector<JournalButtonChange> buttons;
+	std::vector<JournalNumberChange> numberValues;
+	// Where a frame (and axis) already is in the changes, so repeated edits update it instead of growing
+	std::unordered_map<uint64_t, std::size_t> changeIndex;
+	// Latest frame in the changes
+	FrameNum lastFrame = 0;
+
+	// Inserted, removed or replaced frames, the same in every player and branch of the hook
+	FrameNum firstFrame  = 0;
+	FrameNum numOfFrames = 0;
+	// Removed frames of every player and branch, indexed by player and then branch
+	std::vector<std::vector<std::shared_ptr<FrameStore>>> removedFrames;
+
+	// Every player and branch before and after a batch of edits, forks that only own the chunks the batch wrote to
+	std::vector<std::vector<std::shared_ptr<FrameStore>>> framesBefore;
+	std::vector<std::vector<std::shared_ptr<FrameStore>>> framesAfter;
+
+	// Added branch of every player, or the removed branch of the player it was removed from
+	std::vector<std::shared_ptr<FrameStore>> branches;
+	// Removed savestate hook, only for the player it was removed from
+	std::shared_ptr<SavestateHook> savestateHook;
+	// Every savestate hook of the added or removed player
+	std::shared_ptr<std::vector<std::shared_ptr<SavestateHook>>> playerData;
+
+	std::size_t memoryUsage = 0;
+
+	// Earliest frame the edit touched
+	FrameNum getFirstFrame() const;
+};
+
+// Undo and redo history of everything edited by hand
+// Only the difference is kept for each edit, so undoing is as fast as the edit was
+class EditJournal {
+private:
+	std::deque<JournalEntry> undoEntries;
+	std::vector<JournalEntry> redoEntries;
+
+	std::size_t memoryUsage = 0;
+	uint32_t numOfGroups    = 0;
+	uint32_t nextGroup      = 0;
+
+	uint8_t groupDepth = 0;
+	uint32_t openGroup = 0;
+	// Undo and redo go through the normal editing functions, which shouldn't record again
+	uint8_t paused = 0;
+
+	// The last entry if this edit belongs with it, inside a group an earlier one of the group the edit can be moved in front of
+	JournalEntry* joinable(JournalEditType type, uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame);
+	JournalEntry& push(JournalEditType type, uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch);
+	void addMemory(JournalEntry& entry, std::size_t bytes);
+	// Drops the oldest groups until it fits again
+	void trim();
+
+public:
+	// Everything recorded until the matching endGroup is one undo step, can be nested
+	void beginGroup();
+	void endGroup();
+
+	void pause() {
+		paused++;
+	}
+
+	void resume() {
+		paused--;
+	}
+
+	bool isRecording() {
+		return paused == 0;
+	}
+
+	void recordButtons(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame, uint32_t mask);
+	void recordNumberValue(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, FrameNum frame, ControllerNumberValues id, int16_t before, int16_t after);
+	void recordInsertFrames(SavestateBlockNum savestateHookNum, FrameNum firstFrame, FrameNum numOfFrames);
+	void recordRemoveFrames(SavestateBlockNum savestateHookNum, FrameNum firstFrame, FrameNum numOfFrames, std::vector<std::vector<std::shared_ptr<FrameStore>>> removedFrames);
+	void recordAddBranch(SavestateBlockNum savestateHookNum, BranchNum branch, std::vector<std::shared_ptr<FrameStore>> branches);
+	void recordRemoveSavestateHook(uint8_t player, SavestateBlockNum savestateHookNum, std::shared_ptr<SavestateHook> savestateHook);
+	void recordRemoveBranch(uint8_t player, SavestateBlockNum savestateHookNum, BranchNum branch, std::shared_ptr<FrameStore> frames);
+	void recordAddPlayer(uint8_t player, std::shared_ptr<std::vector<std::shared_ptr<SavestateHook>>> playerData);
+	void recordRemovePlayer(uint8_t player, std::shared_ptr<std::vector<std::shared_ptr<SavestateHook>>> playerData);
+	// First frame is the earliest one the batch changed
+	void recordReplaceFrames(SavestateBlockNum savestateHookNum, FrameNum firstFrame, std::vector<std::vector<std::shared_ptr<FrameStore>>> framesBefore, std::vector<std::vector<std::shared_ptr<FrameStore>>> framesAfter);
+
+	bool canUndo() {
+		return !undoEntries.empty();
+	}
+
+	bool canRedo() {
+		return !redoEntries.empty();
+	}
+
+	// Moves the last group over to redo, the entries are returned newest first and stay valid until the next record
+	std::vector<JournalEntry*> undoGroup();
+	// Moves the last undone group back, the entries are returned oldest first
+	std::vector<JournalEntry*> redoGroup();
+
+	// The inputs were changed in a way the journal can't follow, like loading another project
+	void clear();
+};
@@ -0,0 +1,595 @@
+#include "frameStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+void FrameChunk::move(uint32_t dest, uint32_t src, uint32_t count) {
+	memmove(&buttons[dest], &buttons[src], count * sizeof(buttons[0]));
+	for(auto& column : axes) {
+		memmove(&column[dest], &column[src], count * sizeof(column[0]));
+	}
+	memmove(&frameStates[dest], &frameStates[src], count * sizeof(frameStates[0]));
+	indexButtons(dest, count);
+}
+
+void FrameChunk::copyFrom(const FrameChunk& other, uint32_t dest, uint32_t src, uint32_t count) {
+	memcpy(&buttons[dest], &other.buttons[src], count * sizeof(buttons[0]));
+	for(uint8_t i = 0; i < NUM_OF_FRAME_AXES; i++) {
+		memcpy(&axes[i][dest], &other.axes[i][src], count * sizeof(axes[i][0]));
+	}
+	memcpy(&frameStates[dest], &other.frameStates[src], count * sizeof(frameStates[0]));
+	indexButtons(dest, count);
+}
+
+void FrameChunk::clear(uint32_t first, uint32_t count) {
+	memset(&buttons[first], 0, count * sizeof(buttons[0]));
+	for(auto& column : axes) {
+		memset(&column[first], 0, count * sizeof(column[0]));
+	}
+	memset(&frameStates[first], 0, count * sizeof(frameStates[0]));
+	indexButtons(first, count);
+}
+
+// Bits begin up to but not including end
+static uint64_t bitRange(uint32_t begin, uint32_t end) {
+	uint64_t below = end == 64 ? ~0ULL : (1ULL << end) - 1;
+	return below & ~((1ULL << begin) - 1);
+}
+
+void FrameChunk::setButtons(uint32_t index, uint32_t value) {
+	uint32_t changed = (buttons[index] ^ value) & ((1UL << Btn::BUTTONS_SIZE) - 1);
+	while(changed) {
+		buttonFrames[__builtin_ctz(changed)][index / 64] ^= 1ULL << (index % 64);
+		changed &= changed - 1;
+	}
+	buttons[index] = value;
+}
+
+void FrameChunk::indexButtons(uint32_t first, uint32_t count) {
+	uint32_t end = first + count;
+	while(first < end) {
+		uint32_t word  = first / 64;
+		uint32_t begin = first % 64;
+		uint32_t stop  = std::min<uint32_t>(64, end - word * 64);
+
+		uint64_t bits[Btn::BUTTONS_SIZE] = {};
+		for(uint32_t i = begin; i < stop; i++) {
+			uint32_t held = buttons[word * 64 + i] & ((1UL << Btn::BUTTONS_SIZE) - 1);
+			while(held) {
+				bits[__builtin_ctz(held)] |= 1ULL << i;
+				held &= held - 1;
+			}
+		}
+
+		uint64_t mask = bitRange(begin, stop);
+		for(uint8_t btn = 0; btn < Btn::BUTTONS_SIZE; btn++) {
+			buttonFrames[btn][word] = (buttonFrames[btn][word] & ~mask) | bits[btn];
+		}
+
+		first = word * 64 + stop;
+	}
+}
+
+std::shared_ptr<FrameChunk> FrameStore::blankChunk() {
+	// This reference is never released, so writing always copies it
+	static std::shared_ptr<FrameChunk> chunk = std::make_shared<FrameChunk>();
+	return chunk;
+}
+
+static uint32_t nextPriority() {
+	// Doesn't need to be good, just not follow the order chunks are added in
+	// One per thread, scripts are read into stores on their own thread while the editor keeps going
+	static thread_local uint32_t state = 2463534242;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+ChunkTree FrameStore::makeNode(ChunkRef chunk) {
+	ChunkTree node = std::make_unique<ChunkNode>();
+	node->chunk    = chunk;
+	node->frames   = chunk.size;
+	node->priority = nextPriority();
+	return node;
+}
+
+ChunkTree FrameStore::copyTree(const ChunkTree& node) {
+	if(!node) {
+		return nullptr;
+	}
+
+	// Same shape, so it stays balanced
+	ChunkTree copy = std::make_unique<ChunkNode>();
+	copy->chunk    = node->chunk;
+	copy->frames   = node->frames;
+	copy->priority = node->priority;
+	copy->left     = copyTree(node->left);
+	copy->right    = copyTree(node->right);
+	return copy;
+}
+
+void FrameStore::updateFrames(ChunkNode* node) {
+	node->frames = subtreeFrames(node->left) + node->chunk.size + subtreeFrames(node->right);
+}
+
+ChunkTree FrameStore::merge(ChunkTree left, ChunkTree right) {
+	if(!left) {
+		return right;
+	}
+	if(!right) {
+		return left;
+	}
+
+	if(left->priority > right->priority) {
+		left->right = merge(std::move(left->right), std::move(right));
+		updateFrames(left.get());
+		return left;
+	} else {
+		right->left = merge(std::move(left), std::move(right->left));
+		updateFrames(right.get());
+		return right;
+	}
+}
+
+std::pair<ChunkTree, ChunkTree> FrameStore::split(ChunkTree tree, uint32_t frame) {
+	if(!tree) {
+		return { nullptr, nullptr };
+	}
+
+	uint32_t leftFrames = subtreeFrames(tree->left);
+	uint32_t chunkEnd   = leftFrames + tree->chunk.size;
+	if(frame <= leftFrames) {
+		auto parts = split(std::move(tree->left), frame);
+		tree->left = std::move(parts.second);
+		updateFrames(tree.get());
+		return { std::move(parts.first), std::move(tree) };
+	} else if(frame >= chunkEnd) {
+		auto parts  = split(std::move(tree->right), frame - chunkEnd);
+		tree->right = std::move(parts.first);
+		updateFrames(tree.get());
+		return { std::move(tree), std::move(parts.second) };
+	} else {
+		// Both halves keep pointing at the same data
+		uint32_t offset  = frame - leftFrames;
+		ChunkTree tail   = makeNode({ tree->chunk.data, tree->chunk.first + offset, tree->chunk.size - offset });
+		tree->chunk.size = offset;
+
+		ChunkTree right = merge(std::move(tail), std::move(tree->right));
+		updateFrames(tree.get());
+		return { std::move(tree), std::move(right) };
+	}
+}
+
+ChunkNode* FrameStore::descend(ChunkNode* node, uint32_t& frame, int32_t delta) {
+	while(true) {
+		node->frames += delta;
+		uint32_t leftFrames = subtreeFrames(node->left);
+		if(frame < leftFrames) {
+			node = node->left.get();
+		} else if(frame < leftFrames + node->chunk.size) {
+			frame -= leftFrames;
+			return node;
+		} else {
+			frame -= leftFrames + node->chunk.size;
+			node = node->right.get();
+		}
+	}
+}
+
+void FrameStore::collect(const ChunkNode* node, uint32_t start, uint32_t first, uint32_t last, std::vector<ChunkRef>& refs) {
+	if(node == nullptr || first >= start + node->frames || last < start) {
+		return;
+	}
+
+	uint32_t chunkStart = start + subtreeFrames(node->left);
+	uint32_t chunkEnd   = chunkStart + node->chunk.size;
+	collect(node->left.get(), start, first, last, refs);
+
+	uint32_t from = std::max(first, chunkStart);
+	uint32_t to   = std::min(last + 1, chunkEnd);
+	if(from < to) {
+		refs.push_back({ node->chunk.data, node->chunk.first + from - chunkStart, to - from });
+	}
+
+	collect(node->right.get(), chunkEnd, first, last, refs);
+}
+
+std::pair<ChunkRef*, uint32_t> FrameStore::locate(uint32_t frame) const {
+	ChunkNode* node = descend(root.get(), frame, 0);
+	return { &node->chunk, frame };
+}
+
+FrameChunk& FrameStore::writableChunk(ChunkRef& chunk) {
+	if(chunk.data.use_count() != 1) {
+		std::shared_ptr<FrameChunk> copy = std::make_shared<FrameChunk>();
+		copy->copyFrom(*chunk.data, 0, chunk.first, chunk.size);
+		chunk.data  = copy;
+		chunk.first = 0;
+	} else if(chunk.first != 0) {
+		// Only this store has it, the frames before the slice are garbage
+		chunk.data->move(0, chunk.first, chunk.size);
+		chunk.first = 0;
+	}
+	return *chunk.data;
+}
+
+void FrameStore::mergeAround(uint32_t frame) {
+	if(frame == 0 || frame >= size()) {
+		return;
+	}
+
+	auto parts = split(std::move(root), frame);
+
+	uint32_t headFrame = frame - 1;
+	uint32_t tailFrame = 0;
+	ChunkNode* head    = descend(parts.first.get(), headFrame, 0);
+	ChunkNode* tail    = descend(parts.second.get(), tailFrame, 0);
+
+	// Merging copies frames, only worth it when one of them is a small leftover
+	uint32_t headSize = head->chunk.size;
+	uint32_t tailSize = tail->chunk.size;
+	if(headSize + tailSize <= FRAME_CHUNK_SIZE && std::min(headSize, tailSize) <= FRAME_CHUNK_SIZE / 4) {
+		writableChunk(head->chunk).copyFrom(*tail->chunk.data, headSize, tail->chunk.first, tailSize);
+
+		// The tail is the first chunk of the second part
+		parts.second = split(std::move(parts.second), tailSize).second;
+		headFrame    = frame - 1;
+		descend(parts.first.get(), headFrame, tailSize);
+		head->chunk.size += tailSize;
+	}
+
+	root = merge(std::move(parts.first), std::move(parts.second));
+}
+
+void FrameStore::validateFrameStates(uint32_t frame) {
+	uint32_t current = validFrames;
+	while(current <= frame) {
+		auto location   = locate(current);
+		ChunkRef& chunk = *location.first;
+		uint32_t count  = std::min(chunk.size - location.second, frame - current + 1);
+
+		// Only copy the chunk if there is something to clear
+		uint8_t* states = &chunk.data->frameStates[chunk.first + location.second];
+		if(std::any_of(states, states + count, [](uint8_t state) { return (state & staleStateMask) != state; })) {
+			uint8_t* writable = &writableChunk(chunk).frameStates[location.second];
+			for(uint32_t i = 0; i < count; i++) {
+				writable[i] &= staleStateMask;
+			}
+		}
+		current += count;
+	}
+	validFrames = std::max(validFrames, frame + 1);
+}
+
+void FrameStore::resize(uint32_t size) {
+	uint32_t numOfFrames = this->size();
+	if(size > numOfFrames) {
+		insert(numOfFrames, size - numOfFrames);
+	} else if(size < numOfFrames) {
+		erase(size, numOfFrames - 1);
+	}
+}
+
+void FrameStore::insert(uint32_t frame, uint32_t count) {
+	if(count == 0) {
+		return;
+	}
+
+	// New frames are cleared, so they can stay inside the valid ones
+	if(frame < validFrames) {
+		validFrames += count;
+	}
+
+	// Usually a few frames are added, they fit into the chunk they land in
+	if(root) {
+		bool atEnd        = frame == size();
+		uint32_t location = atEnd ? frame - 1 : frame;
+		uint32_t offset   = location;
+		ChunkNode* node   = descend(root.get(), offset, 0);
+		if(atEnd) {
+			offset++;
+		}
+
+		uint32_t chunkSize = node->chunk.size;
+		if(chunkSize + count <= FRAME_CHUNK_SIZE) {
+			FrameChunk& chunk = writableChunk(node->chunk);
+			chunk.move(offset + count, offset, chunkSize - offset);
+			chunk.clear(offset, count);
+			// Counts above it grow on the way down, the chunk itself after
+			descend(root.get(), location, count);
+			node->chunk.size += count;
+			return;
+		}
+	}
+
+	// Otherwise the new frames get chunks of their own, all sharing the blank one
+	ChunkTree blankChunks;
+	while(count != 0) {
+		uint32_t chunkSize = std::min(count, (uint32_t)FRAME_CHUNK_SIZE);
+		blankChunks        = merge(std::move(blankChunks), makeNode({ blankChunk(), 0, chunkSize }));
+		count -= chunkSize;
+	}
+
+	auto parts = split(std::move(root), frame);
+	root       = merge(merge(std::move(parts.first), std::move(blankChunks)), std::move(parts.second));
+}
+
+void FrameStore::erase(uint32_t first, uint32_t last) {
+	if(first > last || first >= size()) {
+		return;
+	}
+
+	last = std::min(last, size() - 1);
+	if(validFrames > last) {
+		validFrames -= last - first + 1;
+	} else if(validFrames > first) {
+		validFrames = first;
+	}
+
+	auto head = split(std::move(root), first);
+	auto tail = split(std::move(head.second), last - first + 1);
+	// The middle part is freed here
+	root = merge(std::move(head.first), std::move(tail.second));
+
+	mergeAround(first);
+}
+
+std::shared_ptr<FrameStore> FrameStore::slice(uint32_t first, uint32_t last) const {
+	std::shared_ptr<FrameStore> store = std::make_shared<FrameStore>();
+
+	std::vector<ChunkRef> refs;
+	collect(root.get(), 0, first, last, refs);
+	for(auto const& ref : refs) {
+		store->root = merge(std::move(store->root), makeNode(ref));
+	}
+	store->validFrames = std::min(std::max(validFrames, first), last + 1) - first;
+
+	return store;
+}
+
+void FrameStore::splice(uint32_t frame, const FrameStore& other) {
+	if(!other.root) {
+		return;
+	}
+
+	// Whatever comes from other has to run again here
+	invalidateFrameStates(frame);
+
+	uint32_t numOfFrames = other.size();
+	auto parts           = split(std::move(root), frame);
+	root                 = merge(merge(std::move(parts.first), copyTree(other.root)), std::move(parts.second));
+
+	// Later one first so the earlier one is still in the same place
+	mergeAround(frame + numOfFrames);
+	mergeAround(frame);
+}
+
+void FrameStore::forEachRun(uint32_t first, uint32_t last, const std::function<void(uint32_t frame, const FrameChunk& chunk, uint32_t index, uint32_t count)>& callback) const {
+	if(first > last || first >= size()) {
+		return;
+	}
+
+	std::vector<ChunkRef> refs;
+	collect(root.get(), 0, first, last, refs);
+	for(auto const& ref : refs) {
+		callback(first, *ref.data, ref.first, ref.size);
+		first += ref.size;
+	}
+}
+
+std::vector<ChunkRef> FrameStore::getRuns(uint32_t first, uint32_t last) const {
+	std::vector<ChunkRef> refs;
+	if(first <= last && first < size()) {
+		collect(root.get(), 0, first, last, refs);
+	}
+	return refs;
+}
+
+void FrameStore::forEachWritableRun(uint32_t first, uint32_t last, const std::function<void(uint32_t frame, FrameChunk& chunk, uint32_t index, uint32_t count)>& callback) {
+	last = std::min(last, size() - 1);
+	while(first <= last && first < size()) {
+		auto location     = locate(first);
+		FrameChunk& chunk = writableChunk(*location.first);
+		uint32_t count    = std::min(location.first->size - location.second, last - first + 1);
+		callback(first, chunk, location.second, count);
+		first += count;
+	}
+}
+
+uint64_t FrameStore::matchWord(const FrameChunk& chunk, uint32_t word, uint32_t begin, uint32_t end, const ButtonQuery& query, bool before) {
+	uint64_t bits = bitRange(begin, end);
+
+	uint32_t buttons = query.required;
+	while(buttons) {
+		bits &= chunk.buttonFrames[__builtin_ctz(buttons)][word];
+		buttons &= buttons - 1;
+	}
+
+	buttons = query.forbidden & ((1UL << Btn::BUTTONS_SIZE) - 1);
+	while(buttons) {
+		bits &= ~chunk.buttonFrames[__builtin_ctz(buttons)][word];
+		buttons &= buttons - 1;
+	}
+
+	if(query.starts) {
+		// Keep the ones where the frame before didn't match
+		bits &= ~((bits << 1) | ((uint64_t)before << begin));
+	}
+
+	return bits;
+}
+
+uint32_t FrameStore::countMatches(uint32_t first, uint32_t last, const ButtonQuery& query) const {
+	if(first > last || first >= size()) {
+		return 0;
+	}
+
+	std::vector<ChunkRef> refs;
+	collect(root.get(), 0, first, last, refs);
+
+	uint32_t count = 0;
+	// A match continuing from before first doesn't start at first
+	bool before = first != 0 && matches(buttons(first - 1), query);
+	for(auto const& ref : refs) {
+		uint32_t end = ref.first + ref.size;
+		for(uint32_t word = ref.first / 64; word * 64 < end; word++) {
+			uint32_t begin = std::max(ref.first, word * 64);
+			uint32_t stop  = std::min(end, word * 64 + 64);
+			if(begin != ref.first) {
+				before = matches(ref.data->buttons[begin - 1], query);
+			}
+			count += __builtin_popcountll(matchWord(*ref.data, word, begin - word * 64, stop - word * 64, query, before));
+		}
+		before = matches(ref.data->buttons[end - 1], query);
+	}
+
+	return count;
+}
+
+uint32_t FrameStore::findNextMatch(uint32_t frame, const ButtonQuery& query) const {
+	if(frame + 1 >= size()) {
+		return UINT32_MAX;
+	}
+
+	std::vector<ChunkRef> refs;
+	collect(root.get(), 0, frame + 1, size() - 1, refs);
+
+	uint32_t refFrame = frame + 1;
+	bool before       = matches(buttons(frame), query);
+	for(auto const& ref : refs) {
+		uint32_t end = ref.first + ref.size;
+		for(uint32_t word = ref.first / 64; word * 64 < end; word++) {
+			uint32_t begin = std::max(ref.first, word * 64);
+			uint32_t stop  = std::min(end, word * 64 + 64);
+			if(begin != ref.first) {
+				before = matches(ref.data->buttons[begin - 1], query);
+			}
+			uint64_t bits = matchWord(*ref.data, word, begin - word * 64, stop - word * 64, query, before);
+			if(bits) {
+				return refFrame + (word * 64 + __builtin_ctzll(bits) - ref.first);
+			}
+		}
+		before = matches(ref.data->buttons[end - 1], query);
+		refFrame += ref.size;
+	}
+
+	return UINT32_MAX;
+}
+
+uint32_t FrameStore::findPreviousMatch(uint32_t frame, const ButtonQuery& query) const {
+	if(frame == 0 || size() == 0) {
+		return UINT32_MAX;
+	}
+
+	std::vector<ChunkRef> refs;
+	collect(root.get(), 0, 0, std::min(frame, size()) - 1, refs);
+
+	// Walked backwards, so the frame before each ref comes from the ref before it
+	uint32_t refFrame = std::min(frame, size());
+	for(std::size_t i = refs.size(); i-- != 0;) {
+		const ChunkRef& ref = refs[i];
+		refFrame -= ref.size;
+
+		uint32_t end = ref.first + ref.size;
+		for(uint32_t word = (end - 1) / 64; word * 64 + 64 > ref.first; word--) {
+			uint32_t begin = std::max(ref.first, word * 64);
+			uint32_t stop  = std::min(end, word * 64 + 64);
+
+			bool before;
+			if(begin != ref.first) {
+				before = matches(ref.data->buttons[begin - 1], query);
+			} else if(i != 0) {
+				before = matches(refs[i - 1].data->buttons[refs[i - 1].first + refs[i - 1].size - 1], query);
+			} else {
+				before = false;
+			}
+
+			uint64_t bits = matchWord(*ref.data, word, begin - word * 64, stop - word * 64, query, before);
+			if(bits) {
+				return refFrame + (word * 64 + 63 - __builtin_clzll(bits) - ref.first);
+			}
+
+			if(word == 0) {
+				break;
+			}
+		}
+	}
+
+	return UINT32_MAX;
+}
+
+void FrameStore::push_back(const ControllerData& data) {
+	uint32_t frame = size();
+	insert(frame, 1);
+	set(frame, data);
+}
+
+ControllerData FrameStore::get(uint32_t frame) const {
+	auto location         = locate(frame);
+	const ChunkRef& chunk = *location.first;
+	uint32_t index        = chunk.first + location.second;
+
+	ControllerData data;
+	data.buttons = chunk.data->buttons[index];
+	for(uint8_t i = 0; i < NUM_OF_FRAME_AXES; i++) {
+		data.*axisMembers[i] = chunk.data->axes[i][index];
+	}
+	data.frameState = frame < validFrames ? chunk.data->frameStates[index] : chunk.data->frameStates[index] & staleStateMask;
+	return data;
+}
+
+void FrameStore::set(uint32_t frame, const ControllerData& data) {
+	setInputs(frame, data);
+	setFrameState(frame, data.frameState);
+}
+
+void FrameStore::setInputs(uint32_t frame, const ControllerData& data) {
+	auto location     = locate(frame);
+	FrameChunk& chunk = writableChunk(*location.first);
+
+	chunk.setButtons(location.second, data.buttons);
+	for(uint8_t i = 0; i < NUM_OF_FRAME_AXES; i++) {
+		chunk.axes[i][location.second] = data.*axisMembers[i];
+	}
+}
+
+void FrameStore::setInputs(uint32_t frame, uint32_t buttons, const int16_t* axes, uint8_t numOfAxes) {
+	auto location     = locate(frame);
+	FrameChunk& chunk = writableChunk(*location.first);
+
+	chunk.setButtons(location.second, buttons);
+	for(uint8_t i = 0; i < numOfAxes; i++) {
+		chunk.axes[i][location.second] = axes[i];
+	}
+}
+
+void FrameStore::setButtons(uint32_t frame, uint32_t buttons) {
+	auto location = locate(frame);
+	writableChunk(*location.first).setButtons(location.second, buttons);
+}
+
+void FrameStore::setButton(uint32_t frame, Btn button, uint8_t state) {
+	auto location     = locate(frame);
+	FrameChunk& chunk = writableChunk(*location.first);
+	uint32_t buttons  = chunk.buttons[location.second];
+	SET_BIT(buttons, state, button);
+	chunk.setButtons(location.second, buttons);
+}
+
+void FrameStore::setAxis(uint32_t frame, uint8_t id, int16_t value) {
+	auto location = locate(frame);
+	writableChunk(*location.first).axes[id][location.second] = value;
+}
+
+void FrameStore::setFrameState(uint32_t frame, uint8_t state) {
+	validateFrameStates(frame);
+	auto location = locate(frame);
+	writableChunk(*location.first).frameStates[location.second] = state;
+}
+
+void FrameStore::setFrameState(uint32_t frame, FrameState id, uint8_t state) {
+	validateFrameStates(frame);
+	auto location = locate(frame);
+	SET_BIT(writableChunk(*location.first).frameStates[location.second], state, id);
+}
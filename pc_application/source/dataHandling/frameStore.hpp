@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../sharedNetworkCode/buttonData.hpp"
+
+// Sticks, accel and gyro, same order as ControllerNumberValues
+#define NUM_OF_FRAME_AXES 10
+// Frames in one chunk, branches only copy the chunks they write to
+#define FRAME_CHUNK_SIZE 1024
+
+// Columns for a run of frames, can be shared by any number of branches
+struct FrameChunk {
+	uint32_t buttons[FRAME_CHUNK_SIZE]                = {};
+	int16_t axes[NUM_OF_FRAME_AXES][FRAME_CHUNK_SIZE] = {};
+	uint8_t frameStates[FRAME_CHUNK_SIZE]             = {};
+
+	// Frames each button is held on, a bit per frame, kept in step with buttons
+	// Finding and counting buttons goes through 64 frames at a time with it
+	uint64_t buttonFrames[Btn::BUTTONS_SIZE][FRAME_CHUNK_SIZE / 64] = {};
+
+	// Ranges may overlap
+	void move(uint32_t dest, uint32_t src, uint32_t count);
+	void copyFrom(const FrameChunk& other, uint32_t dest, uint32_t src, uint32_t count);
+	void clear(uint32_t first, uint32_t count);
+
+	// Buttons are only written through this, so buttonFrames stays right
+	void setButtons(uint32_t index, uint32_t value);
+	// Rebuilds buttonFrames from buttons after they were copied in
+	void indexButtons(uint32_t first, uint32_t count);
+};
+
+// Frames with every required button held and none of the forbidden ones
+// Forbidding every other button finds frames with exactly the required ones
+struct ButtonQuery {
+	uint32_t required  = 0;
+	uint32_t forbidden = 0;
+	// Only the frames where that starts, like the frame a button is pressed on
+	bool starts = false;
+};
+
+// Part of a chunk used by a store, splitting a chunk in two doesn't copy anything
+struct ChunkRef {
+	std::shared_ptr<FrameChunk> data;
+	uint32_t first;
+	uint32_t size;
+};
+
+// Chunks are kept in a treap ordered by frame, with the frames of every subtree cached
+// Finding, inserting, removing and splicing frames only walks one path down, not every following chunk
+struct ChunkNode {
+	ChunkRef chunk;
+	// Frames in this chunk and everything below it
+	uint32_t frames;
+	// Random, parents always have a higher one, which keeps the tree balanced
+	uint32_t priority;
+	std::unique_ptr<ChunkNode> left;
+	std::unique_ptr<ChunkNode> right;
+};
+
+typedef std::unique_ptr<ChunkNode> ChunkTree;
+
+class FrameView;
+
+// Inputs of one branch stored column by column instead of one allocation per frame
+// Most of the editor walks a single column over many frames, like drawing the list or checking RAN
+// The columns are cut into chunks that are copied on write, so branches cost memory only where they differ
+class FrameStore {
+private:
+	ChunkTree root;
+	// RAN from this frame on is stale and reads as cleared, so invalidating a run doesn't touch every frame
+	// Savestates and lag frames stay, like they did when invalidating cleared RAN one frame at a time
+	uint32_t validFrames = 0;
+
+	// clang-format off
+	static constexpr int16_t ControllerData::* axisMembers[NUM_OF_FRAME_AXES] = {
+		&ControllerData::LS_X, &ControllerData::LS_Y, &ControllerData::RS_X, &ControllerData::RS_Y,
+		&ControllerData::ACCEL_X, &ControllerData::ACCEL_Y, &ControllerData::ACCEL_Z,
+		&ControllerData::GYRO_1, &ControllerData::GYRO_2, &ControllerData::GYRO_3,
+	};
+	// clang-format on
+
+	// Shared by every blank frame until it is written to
+	static std::shared_ptr<FrameChunk> blankChunk();
+
+	static uint32_t subtreeFrames(const ChunkTree& node) {
+		return node ? node->frames : 0;
+	}
+
+	static ChunkTree makeNode(ChunkRef chunk);
+	static ChunkTree copyTree(const ChunkTree& node);
+	static void updateFrames(ChunkNode* node);
+	// Every frame of left comes before every frame of right
+	static ChunkTree merge(ChunkTree left, ChunkTree right);
+	// The first frames of the tree and the rest, a chunk in the way is cut in two without copying
+	static std::pair<ChunkTree, ChunkTree> split(ChunkTree tree, uint32_t frame);
+	// Node holding the frame, frame becomes how far into the chunk it is
+	// Delta is added to the frames of every node on the way, for when the chunk changes size
+	static ChunkNode* descend(ChunkNode* node, uint32_t& frame, int32_t delta);
+	// Parts of chunks holding first to last in order, start is the first frame of node
+	static void collect(const ChunkNode* node, uint32_t start, uint32_t first, uint32_t last, std::vector<ChunkRef>& refs);
+
+	// Chunk holding the frame and how far into the chunk it is
+	std::pair<ChunkRef*, uint32_t> locate(uint32_t frame) const;
+	// Copies the chunk first if anything else still uses it
+	FrameChunk& writableChunk(ChunkRef& chunk);
+	static bool matches(uint32_t buttons, const ButtonQuery& query) {
+		return (buttons & query.required) == query.required && (buttons & query.forbidden) == 0;
+	}
+	// Frames of one word of buttonFrames that match, only the bits from begin up to but not including end
+	// Before is whether the frame before begin matched, starts need it
+	static uint64_t matchWord(const FrameChunk& chunk, uint32_t word, uint32_t begin, uint32_t end, const ButtonQuery& query, bool before);
+
+	// Joins the chunks on either side of frame if one of them is a small leftover
+	void mergeAround(uint32_t frame);
+	// Actually clears the stale frame states up to and including frame, so it can be written to
+	void validateFrameStates(uint32_t frame);
+
+public:
+	// Frame states past getValidFrames are read through this
+	static constexpr uint8_t staleStateMask = (uint8_t)~(1U << FrameState::RAN);
+
+	FrameStore() {}
+
+	FrameStore(const FrameStore& other) {
+		root        = copyTree(other.root);
+		validFrames = other.validFrames;
+	}
+
+	FrameStore& operator=(const FrameStore& other) {
+		root        = copyTree(other.root);
+		validFrames = other.validFrames;
+		return *this;
+	}
+
+	uint32_t size() const {
+		return subtreeFrames(root);
+	}
+
+	// Trades every frame with other without copying anything
+	void swap(FrameStore& other) {
+		std::swap(root, other.root);
+		std::swap(validFrames, other.validFrames);
+	}
+
+	// New frames are empty
+	void resize(uint32_t size);
+	// Inserts empty frames before frame
+	void insert(uint32_t frame, uint32_t count);
+	// Last is included, like a selection in the editor
+	void erase(uint32_t first, uint32_t last);
+	void push_back(const ControllerData& data);
+
+	// A new branch with the same frames, only the tree of chunks is copied
+	std::shared_ptr<FrameStore> fork() const {
+		return std::make_shared<FrameStore>(*this);
+	}
+
+	// Frames first to last as their own store, sharing chunks with this one
+	std::shared_ptr<FrameStore> slice(uint32_t first, uint32_t last) const;
+	// Puts every frame of other before frame, sharing its chunks
+	void splice(uint32_t frame, const FrameStore& other);
+
+	// Walks first to last a run at a time, each run is next to each other in memory starting at index of chunk
+	// Frame states in the chunks are raw, the ones from getValidFrames on are stale
+	void forEachRun(uint32_t first, uint32_t last, const std::function<void(uint32_t frame, const FrameChunk& chunk, uint32_t index, uint32_t count)>& callback) const;
+	// The parts of chunks holding first to last in order, for walking several stores side by side
+	std::vector<ChunkRef> getRuns(uint32_t first, uint32_t last) const;
+	// Same, but every chunk is made writable first, so only the chunks in the range are copied
+	// Buttons still have to go through setButtons
+	void forEachWritableRun(uint32_t first, uint32_t last, const std::function<void(uint32_t frame, FrameChunk& chunk, uint32_t index, uint32_t count)>& callback);
+
+	// Frames first to last that match, answered from buttonFrames instead of reading every frame
+	uint32_t countMatches(uint32_t first, uint32_t last, const ButtonQuery& query) const;
+	// Closest matching frame after or before frame, UINT32_MAX if there isn't one
+	uint32_t findNextMatch(uint32_t frame, const ButtonQuery& query) const;
+	uint32_t findPreviousMatch(uint32_t frame, const ButtonQuery& query) const;
+
+	// Gathers the frame back into the struct sent over the network and saved to disk
+	ControllerData get(uint32_t frame) const;
+	// Replaces everything, including the frame state
+	void set(uint32_t frame, const ControllerData& data);
+	// The frame state belongs to the editor, so it is left alone
+	void setInputs(uint32_t frame, const ControllerData& data);
+	// Only the first numOfAxes axes, the others are left alone
+	void setInputs(uint32_t frame, uint32_t buttons, const int16_t* axes, uint8_t numOfAxes);
+
+	uint32_t buttons(uint32_t frame) const {
+		auto location         = locate(frame);
+		const ChunkRef& chunk = *location.first;
+		return chunk.data->buttons[chunk.first + location.second];
+	}
+
+	int16_t axis(uint32_t frame, uint8_t id) const {
+		auto location         = locate(frame);
+		const ChunkRef& chunk = *location.first;
+		return chunk.data->axes[id][chunk.first + location.second];
+	}
+
+	uint8_t frameState(uint32_t frame) const {
+		auto location         = locate(frame);
+		const ChunkRef& chunk = *location.first;
+		uint8_t state         = chunk.data->frameStates[chunk.first + location.second];
+		return frame < validFrames ? state : state & staleStateMask;
+	}
+
+	void setButtons(uint32_t frame, uint32_t buttons);
+	void setButton(uint32_t frame, Btn button, uint8_t state);
+	void setAxis(uint32_t frame, uint8_t id, int16_t value);
+	void setFrameState(uint32_t frame, uint8_t state);
+	void setFrameState(uint32_t frame, FrameState id, uint8_t state);
+
+	// Every frame from here on reads as never ran
+	void invalidateFrameStates(uint32_t frame) {
+		validFrames = std::min(validFrames, frame);
+	}
+
+	uint32_t getValidFrames() const {
+		return validFrames;
+	}
+
+	FrameView at(uint32_t frame);
+};
+
+// A single frame of a store, cheap to pass around by value
+// Don't hold onto it across frames being added or removed
+class FrameView {
+private:
+	FrameStore* store;
+	uint32_t frame;
+
+public:
+	FrameView(FrameStore* frameStore, uint32_t frameNum) {
+		store = frameStore;
+		frame = frameNum;
+	}
+
+	uint32_t buttons() const {
+		return store->buttons(frame);
+	}
+
+	int16_t axis(uint8_t id) const {
+		return store->axis(frame, id);
+	}
+
+	uint8_t frameState() const {
+		return store->frameState(frame);
+	}
+
+	ControllerData get() const {
+		return store->get(frame);
+	}
+
+	void setInputs(const ControllerData& data) const {
+		store->setInputs(frame, data);
+	}
+
+	void setFrameState(uint8_t state) const {
+		store->setFrameState(frame, state);
+	}
+};
+
+inline FrameView FrameStore::at(uint32_t frame) {
+	return FrameView(this, frame);
+}
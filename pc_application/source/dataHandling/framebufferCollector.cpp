@@ -0,0 +1,197 @@
+#include "framebufferCollector.hpp"
+
+#include <algorithm>
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+FramebufferCollector::FramebufferCollector() {
+	collectThread = std::thread(&FramebufferCollector::collectLoop, this);
+}
+
+bool FramebufferCollector::isQueued(const wxString& directory, FrameNum frame) {
+	for(auto const& job : jobs) {
+		if(!job.removeDirectory && job.directory == directory && frame >= job.firstFrame && frame < job.endFrame) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void FramebufferCollector::collect(wxString directory, FrameNum firstFrame, FrameNum endFrame) {
+	if(firstFrame >= endFrame) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lk(jobsMutex);
+	// Invalidating the same branch again usually covers what is already queued
+	for(auto& job : jobs) {
+		if(!job.removeDirectory && job.directory == directory && firstFrame <= job.endFrame && endFrame >= job.firstFrame) {
+			job.firstFrame = std::min(job.firstFrame, firstFrame);
+			job.endFrame   = std::max(job.endFrame, endFrame);
+			jobsChanged.notify_all();
+			return;
+		}
+	}
+
+	jobs.push_back({ directory, firstFrame, endFrame, nextId++, false });
+	jobsChanged.notify_all();
+}
+
+void FramebufferCollector::keep(wxString directory, FrameNum frame) {
+	std::lock_guard<std::mutex> lk(jobsMutex);
+	std::size_t numOfJobs = jobs.size();
+	for(std::size_t i = 0; i < numOfJobs; i++) {
+		Job& job = jobs[i];
+		if(!job.removeDirectory && job.directory == directory && frame >= job.firstFrame && frame < job.endFrame) {
+			// Cut the frame out, the part after it becomes its own job
+			if(frame + 1 < job.endFrame) {
+				jobs.push_back({ directory, frame + 1, job.endFrame, nextId++, false });
+			}
+			jobs[i].endFrame = frame;
+		}
+	}
+}
+
+bool FramebufferCollector::isWithin(const wxString& directory, const wxString& parent) {
+	return directory == parent || directory.StartsWith(parent + wxFILE_SEP_PATH);
+}
+
+wxString FramebufferCollector::movedDirectory(const wxString& directory, const wxString& from, const wxString& to) {
+	return isWithin(directory, from) ? to + directory.Mid(from.length()) : directory;
+}
+
+void FramebufferCollector::renameLocked(std::unique_lock<std::mutex>& lk, const wxString& from, const wxString& to) {
+	// A directory that is open can't be renamed on every platform, listing one takes a moment
+	listingDone.wait(lk, [&] { return !listing || !isWithin(working, from); });
+
+	// Done with the lock held, so the thread never deletes through the old path after this
+	if(!wxRenameFile(from, to)) {
+		return;
+	}
+
+	for(auto& job : jobs) {
+		job.directory = movedDirectory(job.directory, from, to);
+	}
+	if(!working.IsEmpty()) {
+		working = movedDirectory(working, from, to);
+	}
+}
+
+void FramebufferCollector::move(wxString from, wxString to) {
+	if(!wxDirExists(from)) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lk(jobsMutex);
+	renameLocked(lk, from, to);
+}
+
+void FramebufferCollector::remove(wxString directory, wxString trash) {
+	if(!wxDirExists(directory)) {
+		return;
+	}
+	wxFileName::Mkdir(trash, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+	std::unique_lock<std::mutex> lk(jobsMutex);
+	// A rename is one call, deleting every screenshot in it is left to the thread
+	wxString removed;
+	do {
+		removed = trash + wxFILE_SEP_PATH + wxString::Format("removed_%llu", (unsigned long long)nextRemoved++);
+	} while(wxDirExists(removed));
+	renameLocked(lk, directory, removed);
+
+	// Nothing in it has to be collected anymore
+	for(auto it = jobs.begin(); it != jobs.end();) {
+		if(isWithin(it->directory, removed)) {
+			it = jobs.erase(it);
+		} else {
+			it++;
+		}
+	}
+
+	jobs.push_back({ removed, 0, 0, nextId++, true });
+	jobsChanged.notify_all();
+}
+
+void FramebufferCollector::collectLoop() {
+	std::unique_lock<std::mutex> lk(jobsMutex);
+	while(true) {
+		jobsChanged.wait(lk, [this] { return stopping || !jobs.empty(); });
+		// Stopping still goes through everything queued
+		if(jobs.empty()) {
+			break;
+		}
+
+		if(jobs.front().removeDirectory) {
+			// Nothing else knows about the removed name, so it can be deleted without the lock
+			working = jobs.front().directory;
+			jobs.pop_front();
+			lk.unlock();
+			wxFileName::Rmdir(working, wxPATH_RMDIR_RECURSIVE);
+			lk.lock();
+			working.Clear();
+			continue;
+		}
+
+		// Jobs queued after the listing started might not be in it, so they stay for the next pass
+		working          = jobs.front().directory;
+		uint64_t lastId  = nextId;
+		wxString pattern = "frame_*_screenshot.jpg";
+
+		// One listing for every job in the directory instead of checking each frame
+		// Listed without the lock so the editor never waits on it, renaming this directory waits instead
+		wxString listed = working;
+		listing         = true;
+		lk.unlock();
+
+		std::vector<std::pair<FrameNum, wxString>> screenshots;
+		{
+			wxDir dir;
+			if(wxDir::Exists(listed) && dir.Open(listed)) {
+				wxString name;
+				bool found = dir.GetFirst(&name, pattern, wxDIR_FILES);
+				while(found) {
+					unsigned long frame;
+					if(name.Mid(6).BeforeFirst('_').ToULong(&frame)) {
+						screenshots.push_back({ (FrameNum)frame, name });
+					}
+					found = dir.GetNext(&name);
+				}
+			}
+		}
+
+		lk.lock();
+		listing = false;
+		listingDone.notify_all();
+		lk.unlock();
+
+		for(auto const& screenshot : screenshots) {
+			// Checked right before deleting, a screenshot that was just saved might have been kept
+			// The directory might have been moved or removed meanwhile, working follows it and removed ones have no jobs left
+			lk.lock();
+			if(isQueued(working, screenshot.first)) {
+				wxRemoveFile(working + wxFILE_SEP_PATH + screenshot.second);
+			}
+			lk.unlock();
+		}
+
+		lk.lock();
+		for(auto it = jobs.begin(); it != jobs.end();) {
+			if(!it->removeDirectory && it->directory == working && it->id < lastId) {
+				it = jobs.erase(it);
+			} else {
+				it++;
+			}
+		}
+		working.Clear();
+	}
+}
+
+FramebufferCollector::~FramebufferCollector() {
+	{
+		std::lock_guard<std::mutex> lk(jobsMutex);
+		stopping = true;
+	}
+	jobsChanged.notify_all();
+	collectThread.join();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <wx/wx.h>
+
+#include "buttonConstants.hpp"
+
+// Deletes screenshots of frames that have to run again, and folders that were removed, on its own thread
+// The editor only queues the frames, so invalidating never waits on the filesystem
+class FramebufferCollector {
+private:
+	struct Job {
+		wxString directory;
+		// Frames from first up to but not including end
+		FrameNum firstFrame;
+		FrameNum endFrame;
+		uint64_t id;
+		// The whole directory goes instead
+		bool removeDirectory;
+	};
+
+	std::deque<Job> jobs;
+	uint64_t nextId = 0;
+	// Removed folders are renamed to removed_ plus this until the thread deletes them
+	uint64_t nextRemoved = 0;
+	// Directory being gone through by the thread, empty when idle
+	wxString working;
+	// The thread has working open to list it, which can keep it from being renamed
+	bool listing = false;
+
+	std::mutex jobsMutex;
+	std::condition_variable jobsChanged;
+	std::condition_variable listingDone;
+	std::thread collectThread;
+	bool stopping = false;
+
+	// Only used with the mutex locked
+	bool isQueued(const wxString& directory, FrameNum frame);
+	// Directory is parent or somewhere in it
+	static bool isWithin(const wxString& directory, const wxString& parent);
+	// Directory once from is renamed to to, unchanged if it isn't in from
+	static wxString movedDirectory(const wxString& directory, const wxString& from, const wxString& to);
+	// Only waits on the thread if it is listing something inside from
+	void renameLocked(std::unique_lock<std::mutex>& lk, const wxString& from, const wxString& to);
+	void collectLoop();
+
+public:
+	FramebufferCollector();
+
+	// Every screenshot in the directory from firstFrame on, up to but not including endFrame
+	void collect(wxString directory, FrameNum firstFrame, FrameNum endFrame);
+	// Call before saving a new screenshot, otherwise it could be deleted by an older collect
+	void keep(wxString directory, FrameNum frame);
+	// Renames the folder right away, anything queued in it follows it
+	// Folders have to be moved and removed through here while anything could be queued in them
+	void move(wxString from, wxString to);
+	// Moves the folder into trash right away, it is deleted on the thread
+	// Trash can't be inside anything moved later, or the thread would lose track of it
+	void remove(wxString directory, wxString trash);
+
+	// Finishes every queued job first, otherwise screenshots that have to run again would still be there next time
+	~FramebufferCollector();
+};
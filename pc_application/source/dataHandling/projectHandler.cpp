@@ -58,7 +58,7 @@ void ProjectHandler::loadProject() {
 					uint8_t* bufferPointer       = (uint8_t*)streamBuffer->GetBufferStart();
 					std::size_t bufferSize       = streamBuffer->GetBufferSize();
 
-					BranchData inputs = std::make_shared<std::vector<std::shared_ptr<ControllerData>>>();
+					BranchData inputs = std::make_shared<FrameStore>();
 
 					// Loop through each part and unserialize it
 					// This is 0% endian safe :)
@@ -69,18 +69,28 @@ void ProjectHandler::loadProject() {
 						// Possibility that I will save filespace by making sizeOfControllerData==0 be an empty controller data
 						sizeRead += sizeof(sizeOfControllerData);
 						// Load the data
-						std::shared_ptr<ControllerData> controllerData = std::make_shared<ControllerData>();
+						ControllerData controllerData;
 
-						serializeProtocol.binaryToData<ControllerData>(*controllerData, &bufferPointer[sizeRead], sizeOfControllerData);
+						serializeProtocol.binaryToData<ControllerData>(controllerData, &bufferPointer[sizeRead], sizeOfControllerData);
 						// For now, just add each frame one at a time, no optimization
 						inputs->push_back(controllerData);
 						sizeRead += sizeOfControllerData;
 					}
 
+					// Only the first player has hashes
+					if(branch.HasMember("ramHashes")) {
+						savestateHook->ramHashes.resize(savestateHook->inputs.size() + 1);
+						savestateHook->ramHashes[savestateHook->inputs.size()] = loadRamHashes(projectDir.GetPathWithSep() + wxString::FromUTF8(branch["ramHashes"].GetString()));
+					}
+
 					savestateHook->inputs.push_back(inputs);
 				}
 			}
 
+			if(savestate.HasMember("finalTasRamHashes")) {
+				savestateHook->finalTasRamHashes = loadRamHashes(projectDir.GetPathWithSep() + wxString::FromUTF8(savestate["finalTasRamHashes"].GetString()));
+			}
+
 			std::ifstream dhashFile(projectDir.GetPathWithSep().ToStdString() + std::string(savestate["dHash"].GetString()));
 			savestateHook->dHash = std::string((std::istreambuf_iterator<char>(dhashFile)), (std::istreambuf_iterator<char>()));
 
@@ -107,6 +117,19 @@ void ProjectHandler::loadProject() {
 
 	lastEnteredFtpPath = std::string(jsonSettings["defaultFtpPathForExport"].GetString());
 
+	if(jsonSettings.HasMember("ramHashRanges")) {
+		dataProcessing->setRamHashRanges(std::string(jsonSettings["ramHashRanges"].GetString()));
+	}
+
+	if(jsonSettings.HasMember("lagDetectionMethod")) {
+		dataProcessing->setLagDetectionMethod((LagDetectionMethod)jsonSettings["lagDetectionMethod"].GetUint());
+		dataProcessing->setLagCounter(std::string(jsonSettings["lagCounter"].GetString()));
+	}
+
+	if(jsonSettings.HasMember("frameAdvanceStrategy")) {
+		dataProcessing->setFrameAdvanceStrategy((FrameAdvanceStrategyType)jsonSettings["frameAdvanceStrategy"].GetUint());
+	}
+
 	for(auto const& videoEntryJson : jsonSettings["videos"].GetArray()) {
 		std::shared_ptr<VideoEntry> videoEntry = std::make_shared<VideoEntry>();
 
@@ -164,10 +187,10 @@ void ProjectHandler::saveProject() {
 					wxZlibOutputStream inputsCompressStream(inputsFileStream, compressionLevel, wxZLIB_ZLIB);
 
 					// Kinda annoying, but actually break up the vector and add each part with the size
-					for(auto const& controllerData : *branch) {
+					for(FrameNum frame = 0; frame < branch->size(); frame++) {
 						uint8_t* data;
 						uint32_t dataSize;
-						serializeProtocol.dataToBinary<ControllerData>(*controllerData, &data, &dataSize);
+						serializeProtocol.dataToBinary<ControllerData>(branch->get(frame), &data, &dataSize);
 						uint8_t sizeToPrint = (uint8_t)dataSize;
 						// Probably endian issues
 						inputsCompressStream.WriteAll(&sizeToPrint, sizeof(sizeToPrint));
@@ -187,6 +210,18 @@ void ProjectHandler::saveProject() {
 
 					branchJSON.AddMember("filename", inputs, settingsJSON.GetAllocator());
 
+					if(branchIndexNum < savestateHookBlock->ramHashes.size() && !savestateHookBlock->ramHashes[branchIndexNum].empty()) {
+						wxFileName ramHashesFilename = inputsFilename;
+						ramHashesFilename.SetName("ramHashes");
+						saveRamHashes(wxFileName(getProjectStart().GetPathWithSep() + ramHashesFilename.GetFullPath()), savestateHookBlock->ramHashes[branchIndexNum]);
+
+						rapidjson::Value ramHashes;
+						wxString ramHashesPath = ramHashesFilename.GetFullPath(wxPATH_UNIX);
+						ramHashes.SetString(ramHashesPath.c_str(), ramHashesPath.size(), settingsJSON.GetAllocator());
+
+						branchJSON.AddMember("ramHashes", ramHashes, settingsJSON.GetAllocator());
+					}
+
 					branchesJSON.PushBack(branchJSON, settingsJSON.GetAllocator());
 
 					branchIndexNum++;
@@ -205,6 +240,7 @@ void ProjectHandler::saveProject() {
 				dhashFile.Close();
 
 				wxFileName screenshotFileName = dataProcessing->getFramebufferPathForSavestateHook(savestateHookIndexNum);
+				screenshotFileName.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
 
 				savestateHookBlock->screenshot->SaveFile(screenshotFileName.GetFullPath(), wxBITMAP_TYPE_JPEG);
 
@@ -225,6 +261,19 @@ void ProjectHandler::saveProject() {
 				savestateHookJSON.AddMember("screenshot", screenshot, settingsJSON.GetAllocator());
 				savestateHookJSON.AddMember("branches", branchesJSON, settingsJSON.GetAllocator());
 
+				if(!savestateHookBlock->finalTasRamHashes.empty()) {
+					wxFileName finalTasRamHashesFilename = dhashFilename;
+					finalTasRamHashesFilename.SetName("finalTasRamHashes");
+					finalTasRamHashesFilename.SetExt("bin");
+					saveRamHashes(wxFileName(getProjectStart().GetPathWithSep() + finalTasRamHashesFilename.GetFullPath()), savestateHookBlock->finalTasRamHashes);
+
+					rapidjson::Value finalTasRamHashes;
+					wxString finalTasRamHashesPath = finalTasRamHashesFilename.GetFullPath(wxPATH_UNIX);
+					finalTasRamHashes.SetString(finalTasRamHashesPath.c_str(), finalTasRamHashesPath.size(), settingsJSON.GetAllocator());
+
+					savestateHookJSON.AddMember("finalTasRamHashes", finalTasRamHashes, settingsJSON.GetAllocator());
+				}
+
 				savestateHooksJSON.PushBack(savestateHookJSON, settingsJSON.GetAllocator());
 
 				savestateHookIndexNum++;
@@ -271,6 +320,20 @@ void ProjectHandler::saveProject() {
 
 		settingsJSON.AddMember("defaultFtpPathForExport", defaultFtpPathForExport, settingsJSON.GetAllocator());
 
+		rapidjson::Value ramHashRanges;
+		std::string ramHashRangesString = dataProcessing->getRamHashRanges();
+		ramHashRanges.SetString(ramHashRangesString.c_str(), ramHashRangesString.size(), settingsJSON.GetAllocator());
+
+		settingsJSON.AddMember("ramHashRanges", ramHashRanges, settingsJSON.GetAllocator());
+
+		rapidjson::Value lagCounter;
+		std::string lagCounterString = dataProcessing->getLagCounter();
+		lagCounter.SetString(lagCounterString.c_str(), lagCounterString.size(), settingsJSON.GetAllocator());
+
+		settingsJSON.AddMember("lagDetectionMethod", (unsigned)dataProcessing->getLagDetectionMethod(), settingsJSON.GetAllocator());
+		settingsJSON.AddMember("lagCounter", lagCounter, settingsJSON.GetAllocator());
+		settingsJSON.AddMember("frameAdvanceStrategy", (unsigned)dataProcessing->getFrameAdvanceStrategy(), settingsJSON.GetAllocator());
+
 		rapidjson::Value recentVideoEntries(rapidjson::kArrayType);
 		for(auto const& videoEntry : videoComparisonEntries) {
 			rapidjson::Value newRecentVideo(rapidjson::kObjectType);
@@ -375,6 +438,23 @@ void ProjectHandler::saveProject() {
 	}
 }
 
+void ProjectHandler::saveRamHashes(wxFileName path, std::vector<uint64_t>& hashes) {
+	// Endianness doesn't matter, the PC is the only one reading it
+	wxFFileOutputStream hashesFile(path.GetFullPath(), "wb");
+	hashesFile.WriteAll(hashes.data(), hashes.size() * sizeof(uint64_t));
+	hashesFile.Close();
+}
+
+std::vector<uint64_t> ProjectHandler::loadRamHashes(wxString path) {
+	std::vector<uint64_t> hashes;
+	if(wxFileName(path).FileExists()) {
+		wxFFileInputStream hashesFile(path, "rb");
+		hashes.resize(hashesFile.GetLength() / sizeof(uint64_t));
+		hashesFile.ReadAll(hashes.data(), hashes.size() * sizeof(uint64_t));
+	}
+	return hashes;
+}
+
 void ProjectHandler::newProjectWasCreated() {
 	// For now
 	dataProcessing->sendPlayerNum();
@@ -94,6 +94,10 @@ private:
 	void closeVideoComparisonViewer(VideoComparisonViewer* viewer);
 	void updateVideoComparisonViewers(int delta);
 
+	// RAM hashes are stored raw, they wouldn't compress anyway
+	void saveRamHashes(wxFileName path, std::vector<uint64_t>& hashes);
+	std::vector<uint64_t> loadRamHashes(wxString path);
+
 public:
 	ProjectHandler(wxFrame* parent, DataProcessing* dataProcessingInstance, rapidjson::Document* settings);
 
@@ -102,6 +106,7 @@ public:
 	ADD_NETWORK_CALLBACK_MAP(RecieveGameFramebuffer)
 	ADD_NETWORK_CALLBACK_MAP(RecieveApplicationConnected)
 	ADD_NETWORK_CALLBACK_MAP(RecieveLogging)
+	ADD_NETWORK_CALLBACK_MAP(RecieveBinaryLogging)
 	ADD_NETWORK_CALLBACK_MAP(RecieveMemoryRegion)
 
 	void loadProject();
@@ -19,6 +19,9 @@ TasRunner::TasRunner(wxFrame* parent, std::shared_ptr<CommunicateWithNetwork> ne
 	hookSelectionSizer->Add(firstSavestateHook, 0);
 	hookSelectionSizer->Add(lastSavestateHook, 0);
 
+	fastForwardCheckbox = new wxCheckBox(this, wxID_ANY, "Fast forward and verify checkpoints");
+	fastForwardCheckbox->SetToolTip("Run as fast as the emulator allows and compare the screen to each savestate hook, Yuzu only");
+
 	startTasHomebrew = HELPERS::getBitmapButton(parent, mainSettings, "startTasHomebrewButton");
 	// startTasArduino  = HELPERS::getBitmapButton(parent, mainSettings, "startTasArduinoButton");
 
@@ -33,6 +36,7 @@ TasRunner::TasRunner(wxFrame* parent, std::shared_ptr<CommunicateWithNetwork> ne
 	stopTas->Bind(wxEVT_BUTTON, &TasRunner::onStopTasPressed, this);
 
 	mainSizer->Add(hookSelectionSizer, 1, wxEXPAND | wxALL);
+	mainSizer->Add(fastForwardCheckbox, 0, wxEXPAND | wxALL);
 	mainSizer->Add(startTasHomebrew, 1, wxEXPAND | wxALL);
 	// mainSizer->Add(startTasArduino, 1, wxEXPAND | wxALL);
 	mainSizer->Add(stopTas, 1, wxEXPAND | wxALL);
@@ -66,11 +70,12 @@ void TasRunner::onStartTasHomebrewPressed(wxCommandEvent& event) {
 
 				for(SavestateBlockNum hook = firstHook; hook <= lastHook; hook++) {
 					// Always first branch
-					for(auto const& controllerData : *(player->at(hook)->inputs[0])) {
+					BranchData inputs = player->at(hook)->inputs[0];
+					for(FrameNum frame = 0; frame < inputs->size(); frame++) {
 						// Continually write the savestate hook data in one unbroken stream
 						uint8_t* data;
 						uint32_t dataSize;
-						serializeProtocol.dataToBinary<ControllerData>(*controllerData, &data, &dataSize);
+						serializeProtocol.dataToBinary<ControllerData>(inputs->get(frame), &data, &dataSize);
 						uint8_t sizeToPrint = (uint8_t)dataSize;
 						// Probably endian issues
 						fileStream.WriteAll(&sizeToPrint, sizeof(sizeToPrint));
@@ -122,11 +127,33 @@ void TasRunner::onStartTasHomebrewPressed(wxCommandEvent& event) {
 				}
 			}
 
-			// clang-format off
+			// The screen at the start of every later hook should match its screenshot
+			std::vector<uint32_t> checkpointFrames;
+			std::vector<uint64_t> checkpointDhashes;
+			if(fastForwardCheckbox->GetValue()) {
+				auto& firstPlayer  = allPlayers[0];
+				uint32_t hookStart = 0;
+				for(SavestateBlockNum hook = firstHook; hook <= lastHook; hook++) {
+					if(hook != firstHook && firstPlayer->at(hook)->dHash != "") {
+						checkpointFrames.push_back(hookStart);
+						checkpointDhashes.push_back(HELPERS::calculatePackedDhash(firstPlayer->at(hook)->screenshot->ConvertToImage()));
+					}
+					hookStart += firstPlayer->at(hook)->inputs[0]->size();
+				}
+			}
+
+			// RAM is compared to the last run from the same hook, the editor runs are a frame off
+			dataProcessing->setFinalTasFirstHook(firstHook);
+			std::vector<uint64_t> expectedRamHashes = dataProcessing->getFinalTasRamHashes(firstHook);
+
 			ADD_TO_QUEUE(SendStartFinalTas, networkInstance, {
-				data.scriptPaths = scriptPaths;
+				data.scriptPaths         = scriptPaths;
+				data.fastForward         = fastForwardCheckbox->GetValue();
+				data.checkpointFrames    = checkpointFrames;
+				data.checkpointDhashes   = checkpointDhashes;
+				data.checkpointTolerance = (*mainSettings)["finalTasCheckpointTolerance"].GetInt();
+				data.expectedRamHashes   = expectedRamHashes;
 			})
-			// clang-format on
 		} else {
 			// Not connected, cannot run final TAS with homebrew then
 			wxMessageDialog connectedDialog(this, "You must connect to your switch in order to run using this method", "Not Connected", wxOK | wxICON_ERROR);
@@ -25,6 +25,9 @@ private:
 	wxSpinCtrl* firstSavestateHook;
 	wxSpinCtrl* lastSavestateHook;
 
+	// Runs without realtime and only checks the screen at the start of every savestate hook
+	wxCheckBox* fastForwardCheckbox;
+
 	wxBitmapButton* startTasHomebrew;
 	wxBitmapButton* startTasArduino;
 	// More will be added as needed
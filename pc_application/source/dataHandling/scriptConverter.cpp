@@ -0,0 +1,266 @@
+#include "scriptConverter.hpp"
+
+#include <charconv>
+#include <cstring>
+
+// Axes set by a line with that many parts
+static constexpr uint8_t axesInParts[] = { 0, 0, 2, 4, 7, 10 };
+
+static bool isSeparator(char c) {
+	return c == ' ' || c == '\t';
+}
+
+uint8_t ScriptConverter::numOfAxes(uint8_t numOfParts) {
+	return axesInParts[numOfParts];
+}
+
+bool ScriptConverter::readNumbers(const char* cursor, const char* end, int16_t* numbers, uint8_t count) {
+	uint8_t numOfNumbers = 0;
+	while(true) {
+		const char* numberEnd = (const char*)memchr(cursor, ';', end - cursor);
+		if(numberEnd == nullptr) {
+			numberEnd = end;
+		}
+
+		if(numOfNumbers == count) {
+			return false;
+		}
+
+		// Anything that isn't a number is 0, like strtol
+		long number = 0;
+		std::from_chars(cursor, numberEnd, number);
+		numbers[numOfNumbers++] = number;
+
+		if(numberEnd == end) {
+			return numOfNumbers == count;
+		}
+		cursor = numberEnd + 1;
+	}
+}
+
+uint32_t ScriptConverter::readButtons(const char* cursor, const char* end) const {
+	uint32_t buttons = 0;
+	if(end - cursor == 4 && memcmp(cursor, "NONE", 4) == 0) {
+		return buttons;
+	}
+
+	while(cursor < end) {
+		const char* nameEnd = (const char*)memchr(cursor, ';', end - cursor);
+		if(nameEnd == nullptr) {
+			nameEnd = end;
+		}
+
+		std::size_t length = nameEnd - cursor;
+		// Names that don't belong to any button are ignored
+		for(uint8_t btn = 0; btn < Btn::BUTTONS_SIZE; btn++) {
+			if(length != 0 && buttonNames[btn].size() == length && memcmp(buttonNames[btn].data(), cursor, length) == 0) {
+				buttons |= 1UL << btn;
+				break;
+			}
+		}
+
+		cursor = nameEnd + 1;
+	}
+
+	return buttons;
+}
+
+bool ScriptConverter::readLine(const char*& cursor, const char* end, ScriptLine& line) const {
+	while(cursor < end) {
+		const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+		if(lineEnd == nullptr) {
+			lineEnd = end;
+		}
+
+		const char* part = cursor;
+		cursor           = lineEnd == end ? end : lineEnd + 1;
+
+		// Windows line endings
+		if(lineEnd != part && lineEnd[-1] == '\r') {
+			lineEnd--;
+		}
+
+		while(part != lineEnd && isSeparator(*part)) {
+			part++;
+		}
+		if(part == lineEnd) {
+			continue;
+		}
+
+		const char* partEnd = part;
+		while(partEnd != lineEnd && !isSeparator(*partEnd)) {
+			partEnd++;
+		}
+
+		line.frame      = 0;
+		line.numOfParts = 0;
+		line.buttons    = 0;
+		std::from_chars(part, partEnd, line.frame);
+
+		for(uint8_t partNum = SCRIPT_PART_BUTTONS; partNum <= SCRIPT_PART_GYRO; partNum++) {
+			part = partEnd;
+			while(part != lineEnd && isSeparator(*part)) {
+				part++;
+			}
+			if(part == lineEnd) {
+				break;
+			}
+
+			partEnd = part;
+			while(partEnd != lineEnd && !isSeparator(*partEnd)) {
+				partEnd++;
+			}
+
+			if(partNum == SCRIPT_PART_BUTTONS) {
+				line.buttons = readButtons(part, partEnd);
+			} else {
+				uint8_t firstAxis = axesInParts[partNum - 1];
+				// A malformed part ends the line
+				if(!readNumbers(part, partEnd, &line.axes[firstAxis], axesInParts[partNum] - firstAxis)) {
+					break;
+				}
+			}
+
+			line.numOfParts = partNum;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+bool ScriptConverter::readScript(const std::string& text, FrameStore& frames, ScriptProgress* progress) const {
+	const char* start  = text.data();
+	const char* cursor = start;
+	const char* end    = start + text.size();
+
+	if(progress != nullptr) {
+		progress->total = text.size();
+	}
+
+	ScriptLine line;
+	bool haveFirstFrame         = false;
+	FrameNum firstFrame         = 0;
+	FrameNum lastReadFrame      = 0;
+	uint32_t linesUntilProgress = linesPerProgress;
+	while(readLine(cursor, end, line)) {
+		if(!haveFirstFrame) {
+			// This is the first script frame, it will be put at the start
+			firstFrame     = line.frame;
+			haveFirstFrame = true;
+		}
+
+		// Nowhere to put frames from before the first one
+		if(line.frame < firstFrame) {
+			continue;
+		}
+
+		FrameNum frame = line.frame - firstFrame;
+		if(frame >= frames.size()) {
+			// Frames skipped by the script are left empty
+			frames.resize(frame + 1);
+		}
+		lastReadFrame = frame;
+
+		if(line.numOfParts != 0) {
+			frames.setInputs(frame, line.buttons, line.axes, axesInParts[line.numOfParts]);
+		}
+
+		if(progress != nullptr && --linesUntilProgress == 0) {
+			linesUntilProgress = linesPerProgress;
+			progress->done     = cursor - start;
+			if(progress->cancelled) {
+				return false;
+			}
+		}
+	}
+
+	if(!haveFirstFrame) {
+		return false;
+	}
+
+	// Remove all frames after the data
+	frames.resize(lastReadFrame + 1);
+	return true;
+}
+
+void ScriptConverter::writeNumber(std::string& text, int64_t number) {
+	char buffer[21];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+	text.append(buffer, result.ptr);
+}
+
+void ScriptConverter::writeLine(std::string& text, FrameNum number, const FrameChunk& chunk, uint32_t index) const {
+	if(!text.empty()) {
+		text += '\n';
+	}
+
+	writeNumber(text, number);
+	text += ' ';
+
+	uint32_t buttons = chunk.buttons[index];
+	if(buttons == 0) {
+		// Sometimes, it's nothing, so push a constant
+		text += "NONE";
+	} else {
+		bool firstButton = true;
+		for(uint8_t btn = 0; btn < Btn::BUTTONS_SIZE; btn++) {
+			if((buttons >> btn) & 1) {
+				if(!firstButton) {
+					text += ';';
+				}
+				text += buttonNames[btn];
+				firstButton = false;
+			}
+		}
+	}
+
+	for(uint8_t partNum = SCRIPT_PART_LEFT_STICK; partNum <= SCRIPT_PART_GYRO; partNum++) {
+		text += ' ';
+		for(uint8_t axis = axesInParts[partNum - 1]; axis < axesInParts[partNum]; axis++) {
+			if(axis != axesInParts[partNum - 1]) {
+				text += ';';
+			}
+			writeNumber(text, chunk.axes[axis][index]);
+		}
+	}
+}
+
+bool ScriptConverter::writeFrames(const FrameStore& frames, FrameNum first, FrameNum last, FrameNum number, std::string& text, ScriptProgress* progress) const {
+	if(first > last || first >= frames.size()) {
+		return true;
+	}
+
+	last = std::min(last, frames.size() - 1);
+	// Lines are about this long, saves growing the text over and over
+	text.reserve(text.size() + (std::size_t)(last - first + 1) * 48);
+
+	uint32_t validFrames = frames.getValidFrames();
+	bool cancelled       = false;
+	frames.forEachRun(first, last, [&](uint32_t frame, const FrameChunk& chunk, uint32_t index, uint32_t count) {
+		if(cancelled) {
+			return;
+		}
+
+		for(uint32_t i = 0; i < count; i++) {
+			// Keeping empty ones there clutters things, ones that ran still count
+			uint8_t state = frame + i < validFrames ? chunk.frameStates[index + i] : chunk.frameStates[index + i] & FrameStore::staleStateMask;
+			bool empty    = chunk.buttons[index + i] == 0 && state == 0;
+			for(uint8_t axis = 0; empty && axis < NUM_OF_FRAME_AXES; axis++) {
+				empty = chunk.axes[axis][index + i] == 0;
+			}
+
+			if(!empty) {
+				writeLine(text, number + (frame + i - first), chunk, index + i);
+			}
+		}
+
+		if(progress != nullptr) {
+			progress->done += count;
+			cancelled = progress->cancelled;
+		}
+	});
+
+	return !cancelled;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "../sharedNetworkCode/buttonData.hpp"
+#include "buttonConstants.hpp"
+#include "frameStore.hpp"
+
+// Parts of a line after the frame number, in order, a line can stop after any of them
+enum ScriptLinePart : uint8_t {
+	SCRIPT_PART_BUTTONS = 1,
+	SCRIPT_PART_LEFT_STICK,
+	SCRIPT_PART_RIGHT_STICK,
+	SCRIPT_PART_ACCEL,
+	SCRIPT_PART_GYRO,
+};
+
+struct ScriptLine {
+	FrameNum frame;
+	// How many parts were read, the frame keeps whatever it had for the rest
+	uint8_t numOfParts;
+	uint32_t buttons;
+	// Same order as ControllerNumberValues
+	int16_t axes[NUM_OF_FRAME_AXES];
+};
+
+// Shared with the thread converting, which checks cancelled every so often
+struct ScriptProgress {
+	std::atomic<uint64_t> done { 0 };
+	std::atomic<uint64_t> total { 0 };
+	std::atomic_bool cancelled { false };
+};
+
+// Reads and writes scripts, one frame per line:
+// frame buttons(separated by ; or NONE) LX;LY RX;RY AX;AY;AZ G1;G2;G3
+// Works straight on the text and the stores without allocating per line and without wx, so it can run on its own thread
+class ScriptConverter {
+private:
+	// Lines between checking for cancel and updating progress
+	static constexpr uint32_t linesPerProgress = 4096;
+
+	std::string buttonNames[Btn::BUTTONS_SIZE];
+
+	// Numbers separated by ; up to the end of the part, false if there aren't exactly count of them
+	static bool readNumbers(const char* cursor, const char* end, int16_t* numbers, uint8_t count);
+	uint32_t readButtons(const char* cursor, const char* end) const;
+
+	static void writeNumber(std::string& text, int64_t number);
+	void writeLine(std::string& text, FrameNum number, const FrameChunk& chunk, uint32_t index) const;
+
+public:
+	// Axes set by a line with that many parts
+	static uint8_t numOfAxes(uint8_t numOfParts);
+
+	void setButtonName(Btn button, std::string name) {
+		buttonNames[button] = name;
+	}
+
+	// Reads the line at cursor and moves cursor to the start of the next, false once the text is done
+	// Blank lines are skipped
+	bool readLine(const char*& cursor, const char* end, ScriptLine& line) const;
+
+	// Overwrites frames from the start like importing a file does, then cuts the store after the last frame read
+	// False if nothing was read or it was cancelled, the store is garbage then
+	bool readScript(const std::string& text, FrameStore& frames, ScriptProgress* progress) const;
+
+	// Appends the frames first to last that aren't empty, first is written as number
+	// False if it was cancelled
+	bool writeFrames(const FrameStore& frames, FrameNum first, FrameNum last, FrameNum number, std::string& text, ScriptProgress* progress) const;
+};
@@ -171,6 +171,27 @@ wxString HELPERS::calculateDhash(wxImage image, int dhashWidth, int dhashHeight)
 	return wxString(dhash, sizeof(dhash));
 }
 
+uint64_t HELPERS::calculatePackedDhash(wxImage image) {
+	// Has to match ScreenshotHandler::packDhash on the switch
+	const int packedWidth  = 9;
+	const int packedHeight = 8;
+	wxImage copy           = image.ConvertToGreyscale();
+	copy.Rescale(packedWidth, packedHeight, wxIMAGE_QUALITY_BOX_AVERAGE);
+	unsigned char* imagePointer = copy.GetData();
+	uint64_t dhash              = 0;
+	for(int y = 0; y < packedHeight; y++) {
+		for(int x = 0; x < packedWidth - 1; x++) {
+			int thisPixelPointer     = ((y * packedWidth) + x) * 3;
+			unsigned char leftPixel  = imagePointer[thisPixelPointer];
+			unsigned char rightPixel = imagePointer[thisPixelPointer + 3];
+			if(leftPixel > rightPixel) {
+				dhash |= 1ULL << (y * (packedWidth - 1) + x);
+			}
+		}
+	}
+	return dhash;
+}
+
 const int HELPERS::getHammingDistance(wxString string1, wxString string2) {
 	int counter = 0;
 	for(int i = 0; i < string1.size(); i++) {
@@ -181,6 +202,10 @@ const int HELPERS::getHammingDistance(wxString string1, wxString string2) {
 	return counter;
 }
 
+const int HELPERS::getHammingDistance(uint64_t hash1, uint64_t hash2) {
+	return __builtin_popcountll(hash1 ^ hash2);
+}
+
 wxBitmap* HELPERS::getDefaultSavestateScreenshot() {
 	wxImage defaultImg(1280, 720);
 	// Set all of it to a pretty grey
@@ -54,8 +54,11 @@ namespace HELPERS {
 
 	wxImage getImageFromJPEGData(std::vector<uint8_t> jpegBuffer);
 	wxString calculateDhash(wxImage image, int dhashWidth, int dhashHeight);
+	// Same format as the dHash sent by the switch, 9x8 grid packed into 64 bits
+	uint64_t calculatePackedDhash(wxImage image);
 
 	const int getHammingDistance(wxString string1, wxString string2);
+	const int getHammingDistance(uint64_t hash1, uint64_t hash2);
 
 	wxBitmap* getDefaultSavestateScreenshot();
 
@@ -4,7 +4,9 @@
 #include <cstdint>
 #include <memory>
 
+#include "binaryLogging.hpp"
 #include "buttonData.hpp"
+#include "inputRecording.hpp"
 
 // clang-format off
 #define DEFINE_STRUCT(Flag, body, ...) \
@@ -35,6 +37,19 @@ enum DataFlag : uint8_t {
 	RecieveApplicationConnected,
 	RecieveGameMemoryInfo,
 	RecieveAutoRunControllerData,
+	RecieveBinaryLogging,
+	SendLuaScript,
+	RecieveFinalTasCheckpoint,
+	RecieveFinalTasFinished,
+	SendRewindOptions,
+	SendJumpToFrame,
+	RecieveJumpToFrame,
+	SendRamHashRanges,
+	SendLagDetection,
+	SendFrameAdvanceStrategy,
+	RecieveFrameAdvanceStats,
+	SendInputRecording,
+	RecieveRecordedInputs,
 	NUM_OF_FLAGS,
 };
 
@@ -60,9 +75,36 @@ enum SendInfo : uint8_t {
 	STOP_FULL_SPEED,
 	PAUSE_FULL_SPEED,
 	STOP_FINAL_TAS,
+	// Runs a frame but only sends back the dHash, no JPEG
+	RUN_BLANK_FRAME_DHASH_ONLY,
+	// Sends back RecieveFrameAdvanceStats for every strategy
+	GET_FRAME_ADVANCE_STATS,
 };
 
 // This is used by the switch to determine size, a vector is always send back enyway
+// How the switch decides the game didn't run its logic during a frame
+enum LagDetectionMethod : uint8_t {
+	LAG_DETECTION_NONE,
+	// A counter the game increments every logic frame stayed the same
+	LAG_DETECTION_RAM_COUNTER,
+	// Nothing on screen changed, slow on the switch
+	LAG_DETECTION_FRAMEBUFFER,
+	// The game didn't read the controllers, only where the backend can tell
+	LAG_DETECTION_INPUT_POLL,
+	NUM_OF_LAG_DETECTION_METHODS,
+};
+
+// How the switch runs the game for exactly one frame
+enum FrameAdvanceStrategyType : uint8_t {
+	// Wait for vsync, unpause, wait for vsync, pause again, the debug handle is closed in between
+	FRAME_ADVANCE_VSYNC_UNPAUSE,
+	// Keeps the debug handle and only resumes the threads for one vsync
+	FRAME_ADVANCE_SINGLE_VSYNC,
+	// The emulator runs one frame itself
+	FRAME_ADVANCE_EMULATOR_STEP,
+	NUM_OF_FRAME_ADVANCE_STRATEGIES,
+};
+
 enum MemoryRegionTypes : uint8_t {
 	Bit8 = 0,
 	Bit16,
@@ -103,7 +145,20 @@ namespace Protocol {
 		// Set by auto advance
 		uint8_t controllerDataIncluded;
 		ControllerData controllerData;
-	, self.buf, self.fromFrameAdvance, self.frame, self.savestateHookNum, self.branchIndex, self.playerIndex, self.controllerDataIncluded, self.controllerData)
+		// Packed 64 bit dHash computed on the switch, buf can be empty
+		uint8_t dhashIncluded;
+		uint64_t dhash;
+		// The advance is acknowledged first, the capture is sent later tagged with the same frame
+		uint8_t captureFollows;
+		uint8_t fromCaptureWorker;
+		// XXH64 of the ranges set with SendRamHashRanges, read right after the frame
+		uint8_t ramHashIncluded;
+		uint64_t ramHash;
+		// Set with SendLagDetection, isLagFrame is about the last frame that ran
+		uint8_t isLagFrame;
+		// Lag frames run before this one with the same inputs, auto advance only
+		uint32_t lagFramesSkipped;
+	, self.buf, self.fromFrameAdvance, self.frame, self.savestateHookNum, self.branchIndex, self.playerIndex, self.controllerDataIncluded, self.controllerData, self.dhashIncluded, self.dhash, self.captureFollows, self.fromCaptureWorker, self.ramHashIncluded, self.ramHash, self.isLagFrame, self.lagFramesSkipped)
 
 	// Recieve a ton of game and user info
 	DEFINE_STRUCT(RecieveGameInfo,
@@ -122,7 +177,16 @@ namespace Protocol {
 	// Needs to have number of controllers set right, TODO
 	DEFINE_STRUCT(SendStartFinalTas,
 		std::vector<std::string> scriptPaths;
-	, self.scriptPaths)
+		// Run frames as fast as the backend accepts them, only Yuzu and the simulated build can
+		uint8_t fastForward;
+		// Number of frames run before each check, with the dHash the screen should have then
+		std::vector<uint32_t> checkpointFrames;
+		std::vector<uint64_t> checkpointDhashes;
+		// Hamming distance still counted as a match
+		uint8_t checkpointTolerance;
+		// RAM hash after each frame from the last run, index is the number of frames run minus one
+		std::vector<uint64_t> expectedRamHashes;
+	, self.scriptPaths, self.fastForward, self.checkpointFrames, self.checkpointDhashes, self.checkpointTolerance, self.expectedRamHashes)
 
 	DEFINE_STRUCT(SendLogging,
 		std::string log;
@@ -155,6 +219,124 @@ namespace Protocol {
 		std::string log;
 	, self.log)
 
+	// Batch of events from the ring buffer logger, expanded into text by the PC
+	DEFINE_STRUCT(RecieveBinaryLogging,
+		std::vector<BinaryLogEvent> events;
+	, self.events)
+
+	// Path on the switch, an empty path stops the running script
+	DEFINE_STRUCT(SendLuaScript,
+		std::string path;
+		// Instructions onFrame can run each frame, 0 for the default
+		uint32_t instructionBudget;
+	, self.path, self.instructionBudget)
+
+	DEFINE_STRUCT(RecieveFinalTasCheckpoint,
+		uint32_t frame;
+		uint64_t expectedDhash;
+		uint64_t dhash;
+		uint16_t hammingDistance;
+		uint8_t matched;
+	, self.frame, self.expectedDhash, self.dhash, self.hammingDistance, self.matched)
+
+	// The TAS ended, was stopped, or desynced at a checkpoint
+	DEFINE_STRUCT(RecieveFinalTasFinished,
+		uint32_t framesRun;
+		uint64_t elapsedNanoseconds;
+		uint8_t fastForward;
+		uint8_t desynced;
+		// Empty unless RAM hash ranges are set
+		std::vector<uint64_t> ramHashes;
+		// First frame where the RAM hash didn't match the last run, UINT32_MAX if none
+		uint32_t ramMismatchFrame;
+	, self.framesRun, self.elapsedNanoseconds, self.fastForward, self.desynced, self.ramHashes, self.ramMismatchFrame)
+
+	// Savestates are kept in memory every interval frames while advancing, 0 turns the ring off
+	DEFINE_STRUCT(SendRewindOptions,
+		uint32_t interval;
+		uint64_t memoryBudget;
+	, self.interval, self.memoryBudget)
+
+	// Restores the nearest savestate before frame and replays the rest
+	// inputs holds every player for each frame from firstFrame up to frame, in that order
+	DEFINE_STRUCT(SendJumpToFrame,
+		uint32_t frame;
+		uint16_t savestateHookNum;
+		uint16_t branchIndex;
+		uint8_t playerIndex;
+		uint8_t includeFramebuffer;
+		uint32_t firstFrame;
+		uint8_t numOfPlayers;
+		std::vector<ControllerData> inputs;
+	, self.frame, self.savestateHookNum, self.branchIndex, self.playerIndex, self.includeFramebuffer, self.firstFrame, self.numOfPlayers, self.inputs)
+
+	// If it didn't succeed the game wasn't touched, the frames have to be run normally
+	DEFINE_STRUCT(RecieveJumpToFrame,
+		uint32_t frame;
+		uint16_t savestateHookNum;
+		uint16_t branchIndex;
+		uint8_t succeeded;
+		// Frame the restored savestate was taken after
+		uint32_t restoredFrame;
+		uint32_t framesReplayed;
+		uint64_t elapsedNanoseconds;
+	, self.frame, self.savestateHookNum, self.branchIndex, self.succeeded, self.restoredFrame, self.framesReplayed, self.elapsedNanoseconds)
+
+	// Memory hashed after every frame advance, empty to stop hashing
+	DEFINE_STRUCT(SendRamHashRanges,
+		std::vector<uint64_t> addresses;
+		std::vector<uint64_t> lengths;
+	, self.addresses, self.lengths)
+
+	// counterAddress and counterSize are only used with LAG_DETECTION_RAM_COUNTER, size is at most 8
+	DEFINE_STRUCT(SendLagDetection,
+		LagDetectionMethod method;
+		uint64_t counterAddress;
+		uint8_t counterSize;
+		// Auto advance keeps running with the same inputs until the game isn't lagging
+		uint8_t skipLagFrames;
+	, self.method, self.counterAddress, self.counterSize, self.skipLagFrames)
+
+	// Unsupported strategies are ignored, the switch keeps the one it has
+	DEFINE_STRUCT(SendFrameAdvanceStrategy,
+		FrameAdvanceStrategyType strategy;
+		uint8_t resetStats;
+	, self.strategy, self.resetStats)
+
+	// Times are from the start of the advance until the game is paused again
+	DEFINE_STRUCT(RecieveFrameAdvanceStats,
+		FrameAdvanceStrategyType strategy;
+		uint8_t supported;
+		uint8_t active;
+		uint32_t frames;
+		uint64_t averageNanoseconds;
+		uint64_t minNanoseconds;
+		uint64_t medianNanoseconds;
+		uint64_t percentile99Nanoseconds;
+		uint64_t maxNanoseconds;
+	, self.strategy, self.supported, self.active, self.frames, self.averageNanoseconds, self.minNanoseconds, self.medianNanoseconds, self.percentile99Nanoseconds, self.maxNanoseconds)
+
+	// The game runs in realtime and the real controller is recorded into this player every frame
+	// Stopping pauses the game and sends whatever is left with finished set
+	DEFINE_STRUCT(SendInputRecording,
+		uint8_t recording;
+		uint16_t savestateHookNum;
+		uint16_t branchIndex;
+		uint8_t playerIndex;
+		uint32_t startFrame;
+	, self.recording, self.savestateHookNum, self.branchIndex, self.playerIndex, self.startFrame)
+
+	// deltas is numOfFrames frames encoded with encodeInputDelta, decode with decodeInputBatch
+	DEFINE_STRUCT(RecieveRecordedInputs,
+		uint16_t savestateHookNum;
+		uint16_t branchIndex;
+		uint8_t playerIndex;
+		uint32_t firstFrame;
+		uint32_t numOfFrames;
+		std::vector<uint8_t> deltas;
+		uint8_t finished;
+	, self.savestateHookNum, self.branchIndex, self.playerIndex, self.firstFrame, self.numOfFrames, self.deltas, self.finished)
+
 	// Recieve done, with mostly everything as an enum value
 	DEFINE_STRUCT(RecieveFlag,
 		RecieveInfo actFlag;
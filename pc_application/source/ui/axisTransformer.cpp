@@ -0,0 +1,127 @@
+#include "axisTransformer.hpp"
+
+AxisTransformer::AxisTransformer(wxWindow* parent, DataProcessing* dataProcessingInstance, FrameNum first, FrameNum last)
+	: wxDialog(parent, wxID_ANY, "Transform Sticks And Motion", wxDefaultPosition, wxDefaultSize, wxDEFAULT_DIALOG_STYLE) {
+	dataProcessing = dataProcessingInstance;
+	firstFrame     = first;
+	lastFrame      = last;
+
+	mainSizer = new wxBoxSizer(wxVERTICAL);
+
+	wxString groupChoices[AxisGroup::NUM_OF_AXIS_GROUPS];
+
+	groupChoices[AxisGroup::AXIS_GROUP_LEFT_STICK]  = "Left Stick";
+	groupChoices[AxisGroup::AXIS_GROUP_RIGHT_STICK] = "Right Stick";
+	groupChoices[AxisGroup::AXIS_GROUP_ACCEL]       = "Accelerometer";
+	groupChoices[AxisGroup::AXIS_GROUP_GYRO]        = "Gyroscope";
+
+	wxString typeChoices[AxisTransformType::NUM_OF_AXIS_TRANSFORMS];
+
+	typeChoices[AxisTransformType::AXIS_TRANSFORM_SCALE]         = "Scale";
+	typeChoices[AxisTransformType::AXIS_TRANSFORM_CLAMP]         = "Clamp";
+	typeChoices[AxisTransformType::AXIS_TRANSFORM_ROTATE]        = "Rotate";
+	typeChoices[AxisTransformType::AXIS_TRANSFORM_SET_ANGLE]     = "Set Angle";
+	typeChoices[AxisTransformType::AXIS_TRANSFORM_SET_MAGNITUDE] = "Set Magnitude";
+	typeChoices[AxisTransformType::AXIS_TRANSFORM_SMOOTH]        = "Smooth";
+
+	wxStaticText* rangeLabel = new wxStaticText(this, wxID_ANY, wxString::Format("Frames %u to %u", firstFrame, lastFrame));
+
+	groupChoice = new wxChoice(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, AxisGroup::NUM_OF_AXIS_GROUPS, groupChoices);
+	typeChoice  = new wxChoice(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, AxisTransformType::NUM_OF_AXIS_TRANSFORMS, typeChoices);
+	groupChoice->SetSelection(AxisGroup::AXIS_GROUP_LEFT_STICK);
+	typeChoice->SetSelection(AxisTransformType::AXIS_TRANSFORM_SCALE);
+
+	amountLabel = new wxStaticText(this, wxID_ANY, wxEmptyString);
+	amountEntry = new wxSpinCtrlDouble(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS, -100000, 100000, 0, 1);
+	amountEntry->SetDigits(2);
+
+	previewCheckbox = new wxCheckBox(this, wxID_ANY, "Preview");
+	previewCheckbox->SetValue(true);
+
+	groupChoice->Bind(wxEVT_CHOICE, &AxisTransformer::onChanged, this);
+	typeChoice->Bind(wxEVT_CHOICE, &AxisTransformer::onTypeChanged, this);
+	amountEntry->Bind(wxEVT_SPINCTRLDOUBLE, &AxisTransformer::onAmountChanged, this);
+	previewCheckbox->Bind(wxEVT_CHECKBOX, &AxisTransformer::onChanged, this);
+
+	mainSizer->Add(rangeLabel, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(groupChoice, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(typeChoice, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(amountLabel, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(amountEntry, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(previewCheckbox, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(CreateStdDialogButtonSizer(wxOK | wxCANCEL), 0, wxEXPAND | wxALL, 5);
+
+	setupAmount();
+
+	SetSizer(mainSizer);
+	mainSizer->SetSizeHints(this);
+	Layout();
+	Fit();
+	Center(wxBOTH);
+
+	updatePreview();
+}
+
+void AxisTransformer::setupAmount() {
+	switch(typeChoice->GetSelection()) {
+	case AxisTransformType::AXIS_TRANSFORM_SCALE:
+		amountLabel->SetLabel("Factor");
+		amountEntry->SetIncrement(0.1);
+		amountEntry->SetValue(1);
+		break;
+	case AxisTransformType::AXIS_TRANSFORM_CLAMP:
+		amountLabel->SetLabel("Maximum Length");
+		amountEntry->SetIncrement(100);
+		amountEntry->SetValue(ButtonData::axisMax);
+		break;
+	case AxisTransformType::AXIS_TRANSFORM_ROTATE:
+		amountLabel->SetLabel("Degrees Counterclockwise");
+		amountEntry->SetIncrement(1);
+		amountEntry->SetValue(0);
+		break;
+	case AxisTransformType::AXIS_TRANSFORM_SET_ANGLE:
+		amountLabel->SetLabel("Degrees From Right");
+		amountEntry->SetIncrement(1);
+		amountEntry->SetValue(90);
+		break;
+	case AxisTransformType::AXIS_TRANSFORM_SET_MAGNITUDE:
+		amountLabel->SetLabel("Length");
+		amountEntry->SetIncrement(100);
+		amountEntry->SetValue(ButtonData::axisMax);
+		break;
+	case AxisTransformType::AXIS_TRANSFORM_SMOOTH:
+		amountLabel->SetLabel("Frames Averaged");
+		amountEntry->SetIncrement(2);
+		amountEntry->SetValue(5);
+		break;
+	}
+}
+
+void AxisTransformer::updatePreview() {
+	if(previewCheckbox->GetValue()) {
+		dataProcessing->previewAxisTransform(firstFrame, lastFrame, getTransform());
+	} else {
+		dataProcessing->endAxisTransformPreview();
+	}
+}
+
+void AxisTransformer::onTypeChanged(wxCommandEvent& event) {
+	setupAmount();
+	updatePreview();
+}
+
+void AxisTransformer::onChanged(wxCommandEvent& event) {
+	updatePreview();
+}
+
+void AxisTransformer::onAmountChanged(wxSpinDoubleEvent& event) {
+	updatePreview();
+}
+
+AxisTransform AxisTransformer::getTransform() {
+	AxisTransform transform;
+	transform.group  = (AxisGroup)groupChoice->GetSelection();
+	transform.type   = (AxisTransformType)typeChoice->GetSelection();
+	transform.amount = amountEntry->GetValue();
+	return transform;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <wx/spinctrl.h>
+#include <wx/wx.h>
+
+#include "../dataHandling/axisTransforms.hpp"
+#include "../dataHandling/dataProcessing.hpp"
+
+// Picks a transform for the sticks or motion of a range of frames, previewing it in the editor while it is changed
+// The caller applies it or ends the preview once this closes
+class AxisTransformer : public wxDialog {
+private:
+	DataProcessing* dataProcessing;
+	FrameNum firstFrame;
+	FrameNum lastFrame;
+
+	wxBoxSizer* mainSizer;
+
+	wxChoice* groupChoice;
+	wxChoice* typeChoice;
+	wxStaticText* amountLabel;
+	wxSpinCtrlDouble* amountEntry;
+	wxCheckBox* previewCheckbox;
+
+	// Sets the label and a sensible starting amount
+	void setupAmount();
+	void updatePreview();
+
+	void onTypeChanged(wxCommandEvent& event);
+	void onChanged(wxCommandEvent& event);
+	void onAmountChanged(wxSpinDoubleEvent& event);
+
+public:
+	AxisTransformer(wxWindow* parent, DataProcessing* dataProcessingInstance, FrameNum first, FrameNum last);
+
+	AxisTransform getTransform();
+};
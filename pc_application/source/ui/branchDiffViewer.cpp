@@ -0,0 +1,138 @@
+#include "branchDiffViewer.hpp"
+
+#include <wx/stopwatch.h>
+
+BranchDiffViewer::BranchDiffViewer(wxWindow* parent, DataProcessing* dataProcessingInstance)
+	: wxDialog(parent, wxID_ANY, "Compare Branches", wxDefaultPosition, wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER) {
+	dataProcessing = dataProcessingInstance;
+
+	mainSizer = new wxBoxSizer(wxVERTICAL);
+
+	wxArrayString branchChoices;
+	branchChoices.Add("Main Branch");
+	for(BranchNum i = 1; i < dataProcessing->getNumBranches(); i++) {
+		branchChoices.Add(wxString::Format("Branch %d", i));
+	}
+
+	BranchNum currentBranch = dataProcessing->getCurrentBranch();
+
+	wxStaticText* currentLabel = new wxStaticText(this, wxID_ANY, wxString::Format("Comparing %s with", branchChoices[currentBranch]));
+	otherChoice                = new wxChoice(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, branchChoices);
+	otherChoice->SetSelection(currentBranch == 0 ? 1 : 0);
+
+	summary = new wxStaticText(this, wxID_ANY, wxEmptyString);
+
+	rangesList = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxSize(400, 300), wxLC_REPORT | wxLC_HRULES);
+	rangesList->InsertColumn(0, "First Frame", wxLIST_FORMAT_CENTER, 120);
+	rangesList->InsertColumn(1, "Last Frame", wxLIST_FORMAT_CENTER, 120);
+	rangesList->InsertColumn(2, "Frames", wxLIST_FORMAT_CENTER, 120);
+
+	// Whatever the other branch changed since this one is brought in, usually where both were forked from
+	wxStaticText* baseLabel = new wxStaticText(this, wxID_ANY, "Merge changes made since");
+	baseChoice              = new wxChoice(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, branchChoices);
+	baseChoice->SetSelection(0);
+
+	preferOtherCheckbox = new wxCheckBox(this, wxID_ANY, "Prefer the other branch when both changed a frame");
+	mergeButton         = new wxButton(this, wxID_ANY, "Merge Into This Branch");
+	mergeButton->SetToolTip("Merges the selected ranges, or every range if none are selected");
+
+	otherChoice->Bind(wxEVT_CHOICE, &BranchDiffViewer::onOtherChanged, this);
+	rangesList->Bind(wxEVT_LIST_ITEM_SELECTED, &BranchDiffViewer::onRangeSelected, this);
+	mergeButton->Bind(wxEVT_BUTTON, &BranchDiffViewer::onMerge, this);
+
+	mainSizer->Add(currentLabel, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(otherChoice, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(summary, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(rangesList, 1, wxEXPAND | wxALL, 5);
+	mainSizer->Add(baseLabel, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(baseChoice, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(preferOtherCheckbox, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(mergeButton, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(CreateStdDialogButtonSizer(wxOK), 0, wxEXPAND | wxALL, 5);
+
+	updateDiff();
+
+	SetSizer(mainSizer);
+	mainSizer->SetSizeHints(this);
+	Layout();
+	Fit();
+	Center(wxBOTH);
+}
+
+void BranchDiffViewer::updateDiff() {
+	wxStopWatch stopWatch;
+	ranges = dataProcessing->diffWithBranch(otherChoice->GetSelection());
+	long took = stopWatch.Time();
+
+	FrameNum differentFrames = 0;
+	for(FrameRange range : ranges) {
+		differentFrames += range.last - range.first + 1;
+	}
+
+	wxString text = wxString::Format("%u frames differ in %u ranges, found in %ld ms", differentFrames, (unsigned int)ranges.size(), took);
+	if(ranges.size() > maxShownRanges) {
+		text += wxString::Format(", showing the first %u", (unsigned int)maxShownRanges);
+	}
+	summary->SetLabel(text);
+
+	rangesList->Freeze();
+	rangesList->DeleteAllItems();
+	for(std::size_t i = 0; i < ranges.size() && i < maxShownRanges; i++) {
+		rangesList->InsertItem(i, wxString::Format("%u", ranges[i].first));
+		rangesList->SetItem(i, 1, wxString::Format("%u", ranges[i].last));
+		rangesList->SetItem(i, 2, wxString::Format("%u", ranges[i].last - ranges[i].first + 1));
+	}
+	rangesList->Thaw();
+
+	mergeButton->Enable(!ranges.empty());
+}
+
+void BranchDiffViewer::onOtherChanged(wxCommandEvent& event) {
+	updateDiff();
+}
+
+void BranchDiffViewer::onRangeSelected(wxListEvent& event) {
+	dataProcessing->setCurrentFrame(ranges[event.GetIndex()].first);
+}
+
+void BranchDiffViewer::onMerge(wxCommandEvent& event) {
+	BranchNum other  = otherChoice->GetSelection();
+	BranchNum base   = baseChoice->GetSelection();
+	bool preferOther = preferOtherCheckbox->GetValue();
+
+	FrameNum changedFrames = 0;
+	std::vector<FrameRange> conflicts;
+	auto addResult = [&](const MergeResult& result) {
+		changedFrames += result.changedFrames;
+		conflicts.insert(conflicts.end(), result.conflicts.begin(), result.conflicts.end());
+	};
+
+	// Every range goes into one undo step
+	dataProcessing->beginEdit();
+	long item = rangesList->GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
+	if(item == wxNOT_FOUND) {
+		addResult(dataProcessing->mergeFromBranch(other, base, 0, UINT32_MAX, preferOther));
+	} else {
+		while(item != wxNOT_FOUND) {
+			addResult(dataProcessing->mergeFromBranch(other, base, ranges[item].first, ranges[item].last, preferOther));
+			item = rangesList->GetNextItem(item, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
+		}
+	}
+	dataProcessing->commitEdit();
+
+	FrameNum conflictingFrames = 0;
+	for(FrameRange range : conflicts) {
+		conflictingFrames += range.last - range.first + 1;
+	}
+
+	if(conflicts.empty()) {
+		wxMessageDialog mergedDialog(this, wxString::Format("%u frames changed", changedFrames), "Merged", wxOK | wxICON_INFORMATION);
+		mergedDialog.ShowModal();
+	} else {
+		wxMessageDialog mergedDialog(this, wxString::Format("%u frames changed\n%u frames were changed differently in both branches, starting at frame %u, %s was kept there", changedFrames, conflictingFrames, conflicts[0].first, preferOther ? "the other branch" : "this branch"), "Merged With Conflicts", wxOK | wxICON_WARNING);
+		mergedDialog.ShowModal();
+		dataProcessing->setCurrentFrame(conflicts[0].first);
+	}
+
+	updateDiff();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <wx/listctrl.h>
+#include <wx/wx.h>
+
+#include "../dataHandling/branchDiff.hpp"
+#include "../dataHandling/dataProcessing.hpp"
+
+// Frames where the branch being viewed differs from another branch of the hook, and merging them in
+// Selecting a range jumps the editor to it
+class BranchDiffViewer : public wxDialog {
+private:
+	// The list stays quick when the branches have nothing to do with each other
+	static constexpr std::size_t maxShownRanges = 5000;
+
+	DataProcessing* dataProcessing;
+	std::vector<FrameRange> ranges;
+
+	wxBoxSizer* mainSizer;
+
+	wxChoice* otherChoice;
+	wxStaticText* summary;
+	wxListCtrl* rangesList;
+	wxChoice* baseChoice;
+	wxCheckBox* preferOtherCheckbox;
+	wxButton* mergeButton;
+
+	void updateDiff();
+
+	void onOtherChanged(wxCommandEvent& event);
+	void onRangeSelected(wxListEvent& event);
+	void onMerge(wxCommandEvent& event);
+
+public:
+	BranchDiffViewer(wxWindow* parent, DataProcessing* dataProcessingInstance);
+};
@@ -0,0 +1,53 @@
+#include "inputStatistics.hpp"
+
+InputStatistics::InputStatistics(wxWindow* parent, std::shared_ptr<ButtonData> buttons, BranchData frames, long firstSelected, long lastSelected)
+	: wxDialog(parent, wxID_ANY, "Input Statistics", wxDefaultPosition, wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER) {
+	mainSizer = new wxBoxSizer(wxVERTICAL);
+
+	FrameNum lastFrame = frames->size() - 1;
+	bool haveSelection = firstSelected != -1;
+
+	summary = new wxStaticText(this, wxID_ANY, haveSelection ? wxString::Format("%u frames, %ld selected", frames->size(), lastSelected - firstSelected + 1) : wxString::Format("%u frames", frames->size()));
+
+	statisticsList = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxSize(500, 400), wxLC_REPORT | wxLC_SINGLE_SEL | wxLC_HRULES);
+
+	statisticsList->InsertColumn(0, "Button", wxLIST_FORMAT_CENTER, wxLIST_AUTOSIZE);
+	statisticsList->InsertColumn(1, "Frames Held", wxLIST_FORMAT_CENTER, wxLIST_AUTOSIZE);
+	statisticsList->InsertColumn(2, "Presses", wxLIST_FORMAT_CENTER, wxLIST_AUTOSIZE);
+	if(haveSelection) {
+		statisticsList->InsertColumn(3, "Held In Selection", wxLIST_FORMAT_CENTER, wxLIST_AUTOSIZE);
+		statisticsList->InsertColumn(4, "Pressed In Selection", wxLIST_FORMAT_CENTER, wxLIST_AUTOSIZE);
+	}
+
+	// Every count comes from the button bitmaps of the chunks, so this is quick even for long TASes
+	long row = 0;
+	for(auto const& button : buttons->buttonMapping) {
+		ButtonQuery held;
+		held.required = 1UL << button.first;
+
+		ButtonQuery pressed = held;
+		pressed.starts      = true;
+
+		statisticsList->InsertItem(row, wxString::FromUTF8(button.second->normalName));
+		statisticsList->SetItem(row, 1, wxString::Format("%u", frames->countMatches(0, lastFrame, held)));
+		statisticsList->SetItem(row, 2, wxString::Format("%u", frames->countMatches(0, lastFrame, pressed)));
+		if(haveSelection) {
+			statisticsList->SetItem(row, 3, wxString::Format("%u", frames->countMatches(firstSelected, lastSelected, held)));
+			statisticsList->SetItem(row, 4, wxString::Format("%u", frames->countMatches(firstSelected, lastSelected, pressed)));
+		}
+		row++;
+	}
+
+	for(int column = 0; column < statisticsList->GetColumnCount(); column++) {
+		statisticsList->SetColumnWidth(column, wxLIST_AUTOSIZE_USEHEADER);
+	}
+
+	mainSizer->Add(summary, 0, wxEXPAND | wxALL, 5);
+	mainSizer->Add(statisticsList, 1, wxEXPAND | wxALL);
+
+	SetSizer(mainSizer);
+	mainSizer->SetSizeHints(this);
+	Layout();
+	Fit();
+	Center(wxBOTH);
+}
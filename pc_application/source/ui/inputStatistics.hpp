@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory>
+#include <wx/listctrl.h>
+#include <wx/wx.h>
+
+#include "../dataHandling/buttonData.hpp"
+#include "../dataHandling/dataProcessing.hpp"
+
+// How often each button is held and pressed in a branch, and in the selection if there is one
+class InputStatistics : public wxDialog {
+private:
+	wxBoxSizer* mainSizer;
+
+	wxStaticText* summary;
+	wxListCtrl* statisticsList;
+
+public:
+	// Selection is -1 if nothing is selected
+	InputStatistics(wxWindow* parent, std::shared_ptr<ButtonData> buttons, BranchData frames, long firstSelected, long lastSelected);
+};
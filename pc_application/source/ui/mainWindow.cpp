@@ -41,6 +41,13 @@ MainWindow::MainWindow()
 			SEND_QUEUE_DATA(SendSetNumControllers)
 			SEND_QUEUE_DATA(SendAddMemoryRegion)
 			SEND_QUEUE_DATA(SendStartFinalTas)
+			SEND_QUEUE_DATA(SendLuaScript)
+			SEND_QUEUE_DATA(SendRewindOptions)
+			SEND_QUEUE_DATA(SendJumpToFrame)
+			SEND_QUEUE_DATA(SendRamHashRanges)
+			SEND_QUEUE_DATA(SendLagDetection)
+			SEND_QUEUE_DATA(SendFrameAdvanceStrategy)
+			SEND_QUEUE_DATA(SendInputRecording)
 		},
 		[](CommunicateWithNetwork* self) {
 			RECIEVE_QUEUE_DATA(RecieveFlag)
@@ -48,7 +55,13 @@ MainWindow::MainWindow()
 			RECIEVE_QUEUE_DATA(RecieveGameFramebuffer)
 			RECIEVE_QUEUE_DATA(RecieveApplicationConnected)
 			RECIEVE_QUEUE_DATA(RecieveLogging)
+			RECIEVE_QUEUE_DATA(RecieveBinaryLogging)
 			RECIEVE_QUEUE_DATA(RecieveMemoryRegion)
+			RECIEVE_QUEUE_DATA(RecieveFinalTasCheckpoint)
+			RECIEVE_QUEUE_DATA(RecieveFinalTasFinished)
+			RECIEVE_QUEUE_DATA(RecieveJumpToFrame)
+			RECIEVE_QUEUE_DATA(RecieveFrameAdvanceStats)
+			RECIEVE_QUEUE_DATA(RecieveRecordedInputs)
 		});
 
 	// DataProcessing can now start with the networking instance
@@ -153,7 +166,8 @@ void MainWindow::OnSize(wxSizeEvent& event) {
 }
 
 void MainWindow::onIdle(wxIdleEvent& event) {
-	if(IsShown()) {
+	// While recording on the switch, the real controller there is the input
+	if(IsShown() && !dataProcessingInstance->isRecordingInputs()) {
 		// Listen to joystick
 		bottomUI->listenToJoystick();
 	}
@@ -166,7 +180,13 @@ void MainWindow::onIdle(wxIdleEvent& event) {
 	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveGameFramebuffer)
 	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveApplicationConnected)
 	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveLogging)
+	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveBinaryLogging)
 	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveMemoryRegion)
+	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveFinalTasCheckpoint)
+	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveFinalTasFinished)
+	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveJumpToFrame)
+	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveFrameAdvanceStats)
+	PROCESS_NETWORK_CALLBACKS(networkInstance, RecieveRecordedInputs)
 
 	if(!IsBeingDeleted()) {
 		event.RequestMore();
@@ -181,27 +201,99 @@ void MainWindow::handleNetworkQueues() {
 	ADD_NETWORK_CALLBACK(RecieveLogging, {
 		wxLogMessage(wxString("SWITCH: " + data.log));
 	})
+	ADD_NETWORK_CALLBACK(RecieveBinaryLogging, {
+		// The switch only sends IDs and arguments, the text is made here
+		for(auto const& event : data.events) {
+			wxLogMessage(wxString("SWITCH: " + formatLogEvent(event)));
+		}
+	})
+	ADD_NETWORK_CALLBACK(RecieveFinalTasCheckpoint, {
+		if(data.matched) {
+			wxLogMessage("Final TAS checkpoint at frame %u matched (distance %u)", data.frame, data.hammingDistance);
+		} else {
+			wxLogMessage("Final TAS desynced at frame %u: dHash %016llX, expected %016llX (distance %u)", data.frame, (unsigned long long)data.dhash, (unsigned long long)data.expectedDhash, data.hammingDistance);
+		}
+	})
+	ADD_NETWORK_CALLBACK(RecieveFinalTasFinished, {
+		double seconds = data.elapsedNanoseconds / 1000000000.0;
+		wxLogMessage("Final TAS %s after %u frames in %.2f seconds (%.0f FPS%s)", data.desynced ? "desynced" : "stopped", data.framesRun, seconds, seconds == 0 ? 0 : data.framesRun / seconds, data.fastForward ? ", fast forward" : "");
+		if(data.ramMismatchFrame != UINT32_MAX) {
+			// Keep the hashes that are known to be good
+			wxLogMessage("Final TAS RAM hash didn't match the last run after %u frames", data.ramMismatchFrame);
+		} else if(!data.ramHashes.empty()) {
+			dataProcessingInstance->setFinalTasRamHashes(data.ramHashes);
+		}
+	})
+	ADD_NETWORK_CALLBACK(RecieveJumpToFrame, {
+		if(data.succeeded) {
+			// The user could have switched away while it was replaying
+			if(data.savestateHookNum == dataProcessingInstance->getCurrentSavestateHook() && data.branchIndex == dataProcessingInstance->getCurrentBranch()) {
+				dataProcessingInstance->jumpedToFrame(data.frame);
+			}
+			wxLogMessage("Jumped to frame %u from the savestate after frame %u, replayed %u frames in %.1f ms", data.frame, data.restoredFrame, data.framesReplayed, data.elapsedNanoseconds / 1000000.0);
+		} else {
+			dataProcessingInstance->jumpToFrameFailed(data.frame, data.savestateHookNum, data.branchIndex, data.inputsMissing);
+		}
+	})
+	ADD_NETWORK_CALLBACK(RecieveFrameAdvanceStats, {
+		const char* names[] = { "Vsync Unpause", "Single Vsync", "Emulator Step" };
+		if(!data.supported) {
+			wxLogMessage("Frame advance %s: not supported here", names[data.strategy]);
+		} else if(data.frames == 0) {
+			wxLogMessage("Frame advance %s%s: not run yet", names[data.strategy], data.active ? " (active)" : "");
+		} else {
+			wxLogMessage("Frame advance %s%s: %u frames, average %.2f ms, min %.2f ms, median %.2f ms, 99th %.2f ms, max %.2f ms", names[data.strategy], data.active ? " (active)" : "", data.frames, data.averageNanoseconds / 1000000.0, data.minNanoseconds / 1000000.0, data.medianNanoseconds / 1000000.0, data.percentile99Nanoseconds / 1000000.0, data.maxNanoseconds / 1000000.0);
+		}
+	})
 	// clang-format on
 
+	ADD_NETWORK_CALLBACK(RecieveRecordedInputs, {
+		std::vector<ControllerData> frames = decodeInputBatch(data.deltas, data.numOfFrames);
+		if(frames.size() != data.numOfFrames) {
+			wxLogMessage("Recorded inputs from frame %u were malformed, %u frames are missing", data.firstFrame, data.numOfFrames);
+			frames.resize(data.numOfFrames);
+		}
+		dataProcessingInstance->appendRecordedInputs(data.savestateHookNum, data.branchIndex, data.playerIndex, data.firstFrame, frames, data.finished);
+		if(data.finished) {
+			wxLogMessage("Recorded inputs up to frame %u", data.firstFrame + data.numOfFrames);
+			bottomUI->refreshDataViews(true);
+		}
+	})
+
 	ADD_NETWORK_CALLBACK(RecieveGameFramebuffer, {
 		uint8_t framebufferIncluded = data.buf.size() == 0 ? false : true;
 		if(framebufferIncluded) {
 			bottomUI->recieveGameFramebuffer(data.buf);
 		}
+		if(data.fromCaptureWorker) {
+			// The advance was already acknowledged, just save the capture for that frame
+			if(data.fromFrameAdvance == 1 && framebufferIncluded) {
+				dataProcessingInstance->saveFramebuffer(data.playerIndex, data.savestateHookNum, data.branchIndex, data.frame, data.buf);
+			}
+			return;
+		}
 		if(data.fromFrameAdvance == 1) {
 			sideUI->enableAdvance();
+			// Lag frames skipped during auto run come before this one
+			FrameNum frame = data.frame + data.lagFramesSkipped;
+			if(data.lagFramesSkipped != 0 && data.controllerDataIncluded) {
+				dataProcessingInstance->addSkippedLagFrames(data.frame, data.lagFramesSkipped, data.controllerData);
+			}
+			if(data.ramHashIncluded) {
+				dataProcessingInstance->recordRamHash(data.savestateHookNum, data.branchIndex, frame, data.ramHash);
+			}
 			if(framebufferIncluded) {
-				wxFileName framebufferFileName = dataProcessingInstance->getFramebufferPath(data.playerIndex, data.savestateHookNum, data.branchIndex, data.frame);
-				wxFile file(framebufferFileName.GetFullPath(), wxFile::write);
-				file.Write(data.buf.data(), data.buf.size());
-				file.Close();
+				dataProcessingInstance->saveFramebuffer(data.playerIndex, data.savestateHookNum, data.branchIndex, frame, data.buf);
 			}
-			if(dataProcessingInstance->getNumOfFramesInSavestateHook(data.savestateHookNum, data.playerIndex) == data.frame) {
+			if(dataProcessingInstance->getNumOfFramesInSavestateHook(data.savestateHookNum, data.playerIndex) == frame) {
 				dataProcessingInstance->addFrameHere();
 			}
 			if(data.controllerDataIncluded) {
 				dataProcessingInstance->setControllerDataForAutoRun(data.controllerData);
+				dataProcessingInstance->setFramestateInfo(dataProcessingInstance->getCurrentFrame(), FrameState::LAG, data.isLagFrame);
 				dataProcessingInstance->runFrame(true, true, true);
+			} else {
+				dataProcessingInstance->setFramestateInfoSpecific(data.frame, FrameState::LAG, data.isLagFrame, data.savestateHookNum, data.branchIndex, data.playerIndex);
 			}
 			if(sideUI->getAutoRunActive()) {
 				autoFrameAdvanceTimer->StartOnce(sideUI->getAutoRunDelay());
@@ -246,6 +338,14 @@ void MainWindow::addMenuBar() {
 	toggleDebugMenuID   = NewControlId();
 	openGameCorruptorID = NewControlId();
 	runFinalTasID       = NewControlId();
+	runLuaScriptID      = NewControlId();
+	stopLuaScriptID     = NewControlId();
+	setRamHashRangesID  = NewControlId();
+	setLagDetectionID   = NewControlId();
+
+	setFrameAdvanceStrategyID = NewControlId();
+	getFrameAdvanceStatsID    = NewControlId();
+	toggleInputRecordingID    = NewControlId();
 
 	fileMenu->Append(saveProject, "Save Project\tCtrl+S");
 	fileMenu->Append(exportAsText, "Export To Text Format\tCtrl+Alt+E");
@@ -265,6 +365,13 @@ void MainWindow::addMenuBar() {
 	fileMenu->Append(selectIPID, "Set Switch IP\tCtrl+I");
 	fileMenu->Append(toggleLoggingID, "Toggle Logging\tCtrl+Shift+L");
 	fileMenu->Append(toggleDebugMenuID, "Toggle Debug Menu\tCtrl+D");
+	fileMenu->Append(runLuaScriptID, "Run Lua Script On Switch\tCtrl+Alt+R");
+	fileMenu->Append(stopLuaScriptID, "Stop Lua Script On Switch\tCtrl+Alt+T");
+	fileMenu->Append(setRamHashRangesID, "Set RAM Hash Ranges\tCtrl+Alt+H");
+	fileMenu->Append(setLagDetectionID, "Set Lag Detection\tCtrl+Alt+G");
+	fileMenu->Append(setFrameAdvanceStrategyID, "Set Frame Advance Strategy\tCtrl+Alt+F");
+	fileMenu->Append(getFrameAdvanceStatsID, "Show Frame Advance Timing\tCtrl+Alt+Y");
+	fileMenu->Append(toggleInputRecordingID, "Toggle Recording Inputs On Switch\tCtrl+Alt+K");
 	// Not finished as of now
 	// fileMenu->Append(openGameCorruptorID, "Open Game Corruptor\tCtrl+B");
 
@@ -321,8 +428,11 @@ void MainWindow::handleMenuBar(wxCommandEvent& commandEvent) {
 			*/
 
 			// User sets their own name
-			ScriptExporter scriptExporter(this, projectHandler, dataProcessingInstance->getExportedCurrentPlayer());
-			scriptExporter.ShowModal();
+			std::string exported;
+			if(dataProcessingInstance->getExportedCurrentPlayer(exported)) {
+				ScriptExporter scriptExporter(this, projectHandler, exported);
+				scriptExporter.ShowModal();
+			}
 
 		} else if(id == importAsText) {
 			wxFileDialog openFileDialog(this, _("Open Script file"), "", "", "Text files (*.txt)|*.txt|nx-TAS script files (*.ssctf)|*.ssctf", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
@@ -332,6 +442,79 @@ void MainWindow::handleMenuBar(wxCommandEvent& commandEvent) {
 
 				dataProcessingInstance->importFromFile(importPath);
 			}
+		} else if(id == runLuaScriptID) {
+			// The script is on the switch, so the path is typed in
+			wxString luaPath = wxGetTextFromUser("Please set the path of the Lua script on the switch", "Run Lua script", "/switas/script.lua");
+			if(!luaPath.empty()) {
+				uint32_t budget = mainSettings.HasMember("luaInstructionBudget") ? mainSettings["luaInstructionBudget"].GetUint() : 0;
+				ADD_TO_QUEUE(SendLuaScript, networkInstance, {
+					data.path              = luaPath.ToStdString();
+					data.instructionBudget = budget;
+				})
+			}
+		} else if(id == stopLuaScriptID) {
+			// clang-format off
+			ADD_TO_QUEUE(SendLuaScript, networkInstance, {
+				data.path              = "";
+				data.instructionBudget = 0;
+			})
+			// clang-format on
+		} else if(id == setRamHashRangesID) {
+			// Empty turns hashing off, so cancel has to be told apart
+			wxTextEntryDialog rangesDialog(this, "Hex ranges of memory to hash after every frame, like 1000:200,8000:1000", "RAM hash ranges", wxString::FromUTF8(dataProcessingInstance->getRamHashRanges()));
+			if(rangesDialog.ShowModal() == wxID_OK) {
+				dataProcessingInstance->setRamHashRanges(rangesDialog.GetValue().ToStdString());
+				dataProcessingInstance->sendRamHashRanges();
+			}
+		} else if(id == setLagDetectionID) {
+			// Same order as LagDetectionMethod
+			wxArrayString methods;
+			methods.Add("None");
+			methods.Add("RAM Counter");
+			methods.Add("Framebuffer Unchanged");
+			methods.Add("Input Polls (Yuzu Only)");
+			wxSingleChoiceDialog methodDialog(this, "How the switch tells a frame lagged", "Lag detection", methods);
+			methodDialog.SetSelection(dataProcessingInstance->getLagDetectionMethod());
+			if(methodDialog.ShowModal() == wxID_OK) {
+				LagDetectionMethod method = (LagDetectionMethod)methodDialog.GetSelection();
+				if(method == LagDetectionMethod::LAG_DETECTION_RAM_COUNTER) {
+					wxTextEntryDialog counterDialog(this, "Hex address and size of the counter the game increments every frame it handles, like 8000:4", "Lag counter", wxString::FromUTF8(dataProcessingInstance->getLagCounter()));
+					if(counterDialog.ShowModal() != wxID_OK) {
+						return;
+					}
+					dataProcessingInstance->setLagCounter(counterDialog.GetValue().ToStdString());
+				}
+				dataProcessingInstance->setLagDetectionMethod(method);
+				dataProcessingInstance->sendLagDetection();
+			}
+		} else if(id == setFrameAdvanceStrategyID) {
+			// Same order as FrameAdvanceStrategyType
+			wxArrayString strategies;
+			strategies.Add("Vsync Unpause (Switch)");
+			strategies.Add("Single Vsync (Switch 3.0.0+)");
+			strategies.Add("Emulator Step (Yuzu)");
+			wxSingleChoiceDialog strategyDialog(this, "How the switch runs one frame, compare the timing and RAM hashes to pick one", "Frame advance strategy", strategies);
+			if(dataProcessingInstance->getFrameAdvanceStrategy() != FrameAdvanceStrategyType::NUM_OF_FRAME_ADVANCE_STRATEGIES) {
+				strategyDialog.SetSelection(dataProcessingInstance->getFrameAdvanceStrategy());
+			}
+			if(strategyDialog.ShowModal() == wxID_OK) {
+				dataProcessingInstance->setFrameAdvanceStrategy((FrameAdvanceStrategyType)strategyDialog.GetSelection());
+				dataProcessingInstance->sendFrameAdvanceStrategy(true);
+			}
+		} else if(id == getFrameAdvanceStatsID) {
+			// clang-format off
+			ADD_TO_QUEUE(SendFlag, networkInstance, {
+				data.actFlag = SendInfo::GET_FRAME_ADVANCE_STATS;
+			})
+			// clang-format on
+		} else if(id == toggleInputRecordingID) {
+			if(dataProcessingInstance->isRecordingInputs()) {
+				dataProcessingInstance->stopRecordingInputs();
+			} else {
+				// The game runs in realtime, frame advancing can't happen at the same time
+				sideUI->untether();
+				dataProcessingInstance->startRecordingInputs();
+			}
 		} else if(id == runFinalTasID) {
 			// Open the run final TAS dialog and untether
 			sideUI->untether();
@@ -373,8 +556,14 @@ bool MainWindow::askForIP() {
 void MainWindow::onClose(wxCloseEvent& event) {
 	REMOVE_NETWORK_CALLBACK(RecieveApplicationConnected)
 	REMOVE_NETWORK_CALLBACK(RecieveLogging)
+	REMOVE_NETWORK_CALLBACK(RecieveBinaryLogging)
 	REMOVE_NETWORK_CALLBACK(RecieveGameFramebuffer)
 	REMOVE_NETWORK_CALLBACK(RecieveFlag)
+	REMOVE_NETWORK_CALLBACK(RecieveFinalTasCheckpoint)
+	REMOVE_NETWORK_CALLBACK(RecieveFinalTasFinished)
+	REMOVE_NETWORK_CALLBACK(RecieveJumpToFrame)
+	REMOVE_NETWORK_CALLBACK(RecieveFrameAdvanceStats)
+	REMOVE_NETWORK_CALLBACK(RecieveRecordedInputs)
 
 	// Close project dialog and save
 	projectHandler->saveProject();
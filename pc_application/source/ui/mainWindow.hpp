@@ -68,6 +68,13 @@ private:
 	wxWindowID toggleDebugMenuID;
 	wxWindowID openGameCorruptorID;
 	wxWindowID runFinalTasID;
+	wxWindowID runLuaScriptID;
+	wxWindowID stopLuaScriptID;
+	wxWindowID setRamHashRangesID;
+	wxWindowID setLagDetectionID;
+	wxWindowID setFrameAdvanceStrategyID;
+	wxWindowID getFrameAdvanceStatsID;
+	wxWindowID toggleInputRecordingID;
 
 	void handlePreviousWindowTransform();
 
@@ -111,6 +111,9 @@ SavestateSelection::SavestateSelection(wxFrame* parent, rapidjson::Document* set
 		// Initial is 10
 		selectFrameAutomatically = new wxSpinCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS, 0, 100, 10);
 		selectFrameAutomatically->SetToolTip("Select frame automatically at or below this hamming distance");
+
+		dhashOnlyCheckbox = new wxCheckBox(this, wxID_ANY, "Only compare dHash when auto advancing");
+		dhashOnlyCheckbox->SetToolTip("Skip sending screenshots until the dHash computed on the switch is close enough");
 	}
 
 	autoIncrementDelay = new wxSpinCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS, 0, 5000, 0);
@@ -157,6 +160,7 @@ SavestateSelection::SavestateSelection(wxFrame* parent, rapidjson::Document* set
 	if(savestateLoadDialog) {
 		fullSizer->Add(hammingDistance, 0, wxEXPAND);
 		fullSizer->Add(selectFrameAutomatically, 0, wxEXPAND);
+		fullSizer->Add(dhashOnlyCheckbox, 0, wxEXPAND);
 	}
 
 	fullSizer->Add(autoIncrementDelay, 0, wxEXPAND);
@@ -203,6 +207,7 @@ void SavestateSelection::setTargetFrame(wxBitmap* targetBitmap, std::string targ
 	// Called when it's a load dialog
 	goalFrame->setBitmap(targetBitmap);
 	rightDHash->SetLabel(wxString::FromUTF8(targetDhash));
+	targetPackedDhash = HELPERS::calculatePackedDhash(targetBitmap->ConvertToImage());
 }
 
 void SavestateSelection::onAutoFrameAdvanceTimer(wxTimerEvent& event) {
@@ -225,20 +230,53 @@ void SavestateSelection::onIdle(wxIdleEvent& event) {
 
 void SavestateSelection::registerFramebufferCallback() {
 	ADD_NETWORK_CALLBACK(RecieveGameFramebuffer, {
+		// Wait for the capture itself
+		if(data.captureFollows) {
+			return;
+		}
+
 		if(!operationSuccessful) {
 			playButton->Enable();
 			frameAdvanceButton->Enable();
 			autoFrameAdvanceButton->Enable();
 			okButton->Enable();
 
+			if(data.buf.size() == 0) {
+				// Only the dHash was sent, ask for the JPEG once the frame is close enough
+				if(savestateLoadDialog && data.dhashIncluded) {
+					uint16_t hamming = HELPERS::getHammingDistance(data.dhash, targetPackedDhash);
+					leftDHash->SetLabel(wxString::Format("%016llX", (unsigned long long)data.dhash));
+					hammingDistance->SetLabel(wxString::Format("%d", hamming));
+					if(hamming <= selectFrameAutomatically->GetValue()) {
+						// clang-format off
+						ADD_TO_QUEUE(SendFlag, networkInstance, {
+							data.actFlag = SendInfo::GET_FRAMEBUFFER;
+						})
+						// clang-format on
+						return;
+					}
+				}
+				if(autoFrameEnabled) {
+					autoFrameAdvanceTimer->StartOnce(autoIncrementDelay->GetValue());
+				}
+				return;
+			}
+
 			wxImage screenshot = HELPERS::getImageFromJPEGData(data.buf);
 			currentFrame->setBitmap(new wxBitmap(screenshot));
 			wxString hash   = HELPERS::calculateDhash(screenshot, dhashWidth, dhashHeight);
 			leftDhashString = hash.ToStdString();
 
 			if(savestateLoadDialog) {
-				leftDHash->SetLabel(hash);
-				uint16_t hamming = HELPERS::getHammingDistance(hash, rightDHash->GetLabel());
+				uint16_t hamming;
+				if(data.dhashIncluded) {
+					// No need to compare the long dHash if the switch sent one
+					leftDHash->SetLabel(wxString::Format("%016llX", (unsigned long long)data.dhash));
+					hamming = HELPERS::getHammingDistance(data.dhash, targetPackedDhash);
+				} else {
+					leftDHash->SetLabel(hash);
+					hamming = HELPERS::getHammingDistance(hash, rightDHash->GetLabel());
+				}
 				hammingDistance->SetLabel(wxString::Format("%d", hamming));
 				if(hamming <= selectFrameAutomatically->GetValue()) {
 					wxMessageDialog useFrameDialog(this, "This frame is very similar to the target frame, use it?", "Use this frame", (0x00000002 | 0x00000008) | 0x00000010 | 0x00000000);
@@ -288,9 +326,12 @@ void SavestateSelection::frameAdvance() {
 	autoFrameAdvanceButton->Disable();
 	okButton->Disable();
 
+	// Hash only frames are much faster, no JPEG has to be sent or decoded
+	uint8_t dhashOnly = savestateLoadDialog && autoFrameEnabled && dhashOnlyCheckbox->GetValue();
+
 	// clang-format off
 	ADD_TO_QUEUE(SendFlag, networkInstance, {
-		data.actFlag = SendInfo::RUN_BLANK_FRAME;
+		data.actFlag = dhashOnly ? SendInfo::RUN_BLANK_FRAME_DHASH_ONLY : SendInfo::RUN_BLANK_FRAME;
 	})
 	// clang-format on
 }
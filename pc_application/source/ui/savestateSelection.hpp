@@ -83,6 +83,9 @@ private:
 
 	std::string leftDhashString;
 
+	// Packed version of the target dHash, compared against the one sent by the switch
+	uint64_t targetPackedDhash = 0;
+
 	// Will be set if the dialog is supposed to load savestates, not create the first one
 	bool savestateLoadDialog;
 
@@ -94,6 +97,9 @@ private:
 	wxSpinCtrl* selectFrameAutomatically;
 	wxSpinCtrl* autoIncrementDelay;
 
+	// Only recieve the dHash while auto advancing, the JPEG is requested on a match
+	wxCheckBox* dhashOnlyCheckbox;
+
 	// To view the frames, will use if needed
 	DrawingCanvasBitmap* currentScreen;
 	// Only use with savestate loading
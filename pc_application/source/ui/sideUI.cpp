@@ -183,10 +183,15 @@ SideUI::SideUI(wxFrame* parentFrame, rapidjson::Document* settings, std::shared_
 
 	autoRunWithFramebuffer    = new wxCheckBox(parentFrame, wxID_ANY, "Include Screenshot");
 	autoRunWithControllerData = new wxCheckBox(parentFrame, wxID_ANY, "Include Controller Data");
+	autoRunSkipLagFrames      = new wxCheckBox(parentFrame, wxID_ANY, "Skip Lag Frames");
+
+	autoRunSkipLagFrames->SetToolTip("Hold the inputs through lag frames, needs lag detection set");
 
 	autoRunWithFramebuffer->SetValue(true);
 	autoRunWithControllerData->SetValue(true);
 
+	autoRunSkipLagFrames->Bind(wxEVT_CHECKBOX, &SideUI::onSkipLagFramesToggled, this);
+
 	autoFrameSizer->Add(autoFrameStart, 0, wxEXPAND | wxALL);
 	autoFrameSizer->Add(autoFrameEnd, 0, wxEXPAND | wxALL);
 
@@ -194,6 +199,7 @@ SideUI::SideUI(wxFrame* parentFrame, rapidjson::Document* settings, std::shared_
 	verticalBoxSizer->Add(autoRunFramesPerSecond, 0, wxEXPAND | wxALL);
 	verticalBoxSizer->Add(autoRunWithFramebuffer, 0, wxEXPAND | wxALL);
 	verticalBoxSizer->Add(autoRunWithControllerData, 0, wxEXPAND | wxALL);
+	verticalBoxSizer->Add(autoRunSkipLagFrames, 0, wxEXPAND | wxALL);
 
 	sizer->Add(verticalBoxSizer, 0, wxEXPAND | wxALL);
 
@@ -323,7 +329,9 @@ void SideUI::onSavestateHookModifyPressed(wxCommandEvent& event) {
 
 			inputData->invalidateRun(0);
 
-			modifySavestateSelection.getNewScreenshot()->SaveFile(inputData->getFramebufferPathForCurrentFramebuf().GetFullPath(), wxBITMAP_TYPE_JPEG);
+			wxFileName screenshotFileName = inputData->getFramebufferPathForCurrentFramebuf();
+			screenshotFileName.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+			modifySavestateSelection.getNewScreenshot()->SaveFile(screenshotFileName.GetFullPath(), wxBITMAP_TYPE_JPEG);
 
 			inputData->setSavestateHook(inputData->getCurrentSavestateHook());
 
@@ -370,7 +378,9 @@ bool SideUI::createSavestateHook() {
 			blocks[blocks.size() - 1]->dHash      = savestateSelection.getNewDhash();
 			blocks[blocks.size() - 1]->screenshot = savestateSelection.getNewScreenshot();
 
-			savestateSelection.getNewScreenshot()->SaveFile(inputData->getFramebufferPathForCurrentFramebuf().GetFullPath(), wxBITMAP_TYPE_JPEG);
+			wxFileName screenshotFileName = inputData->getFramebufferPathForCurrentFramebuf();
+			screenshotFileName.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+			savestateSelection.getNewScreenshot()->SaveFile(screenshotFileName.GetFullPath(), wxBITMAP_TYPE_JPEG);
 
 			inputData->setSavestateHook(blocks.size() - 1);
 
@@ -439,6 +449,20 @@ void SideUI::tether() {
 	autoFrameEnd->Enable(true);
 	inputData->setTethered(true);
 
+	// The switch keeps savestates while advancing so going back to a frame doesn't need a full replay
+	if(networkInterface->isConnected()) {
+		uint32_t interval     = mainSettings->HasMember("rewindStateInterval") ? (*mainSettings)["rewindStateInterval"].GetUint() : 30;
+		uint64_t memoryBudget = mainSettings->HasMember("rewindMemoryBudgetMB") ? (*mainSettings)["rewindMemoryBudgetMB"].GetUint() : 256;
+		ADD_TO_QUEUE(SendRewindOptions, networkInterface, {
+			data.interval     = interval;
+			data.memoryBudget = memoryBudget * 1024 * 1024;
+		})
+
+		inputData->sendRamHashRanges();
+		inputData->sendLagDetection();
+		inputData->sendFrameAdvanceStrategy(false);
+	}
+
 	tethered = true;
 }
 
@@ -446,6 +470,7 @@ void SideUI::onStartAutoFramePressed(wxCommandEvent& event) {
 	// autoTimer.Start(1000 / (float)autoRunFramesPerSecond->GetValue(), wxTIMER_CONTINUOUS);
 	autoRunActive = true;
 	autoFrameStart->Disable();
+	inputData->beginAutoRun();
 	sendAutoRunData();
 }
 
@@ -462,4 +487,10 @@ void SideUI::sendAutoRunData() {
 void SideUI::onEndAutoFramePressed(wxCommandEvent& event) {
 	autoRunActive = false;
 	autoFrameStart->Enable();
+	inputData->endAutoRun();
+}
+
+void SideUI::onSkipLagFramesToggled(wxCommandEvent& event) {
+	inputData->setSkipLagFrames(autoRunSkipLagFrames->GetValue());
+	inputData->sendLagDetection();
 }
\ No newline at end of file
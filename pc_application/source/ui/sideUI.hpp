@@ -79,6 +79,7 @@ private:
 
 	wxCheckBox* autoRunWithFramebuffer;
 	wxCheckBox* autoRunWithControllerData;
+	wxCheckBox* autoRunSkipLagFrames;
 
 	// Minimum size of this widget (it just gets too small normally)
 	static constexpr float minimumSize = 1 / 4;
@@ -102,6 +103,7 @@ private:
 	void onBranchRemovePressed(wxCommandEvent& event);
 	void onStartAutoFramePressed(wxCommandEvent& event);
 	void onEndAutoFramePressed(wxCommandEvent& event);
+	void onSkipLagFramesToggled(wxCommandEvent& event);
 
 public:
 	SideUI(wxFrame* parentFrame, rapidjson::Document* settings, std::shared_ptr<ProjectHandler> projHandler, wxBoxSizer* sizer, DataProcessing* input, std::shared_ptr<CommunicateWithNetwork> networkImp, std::function<void()> runFrameCallback);
@@ -130,7 +130,10 @@ private:
 	// this can be set by anybody and will determine if networking continues
 	std::atomic_bool keepReading;
 
-	bool handleSocketError(const char* extraMessage);
+	bool handleSocketError(const char* extraMessage) {
+		return handleSocketError(networkConnection, extraMessage);
+	}
+	bool handleSocketError(CSimpleSocket* socket, const char* extraMessage);
 	void handleFatalError();
 #ifdef CLIENT_IMP
 	void waitForIPSelection();
@@ -154,6 +157,7 @@ public:
 	ADD_QUEUE(SendFlag)
 	ADD_QUEUE(SendLogging)
 	ADD_QUEUE(RecieveLogging)
+	ADD_QUEUE(RecieveBinaryLogging)
 	ADD_QUEUE(RecieveFlag)
 	ADD_QUEUE(RecieveApplicationConnected)
 	ADD_QUEUE(SendTrackMemoryRegion)
@@ -161,6 +165,18 @@ public:
 	ADD_QUEUE(RecieveMemoryRegion)
 	ADD_QUEUE(SendAddMemoryRegion)
 	ADD_QUEUE(SendStartFinalTas)
+	ADD_QUEUE(SendLuaScript)
+	ADD_QUEUE(RecieveFinalTasCheckpoint)
+	ADD_QUEUE(RecieveFinalTasFinished)
+	ADD_QUEUE(SendRewindOptions)
+	ADD_QUEUE(SendJumpToFrame)
+	ADD_QUEUE(RecieveJumpToFrame)
+	ADD_QUEUE(SendRamHashRanges)
+	ADD_QUEUE(SendLagDetection)
+	ADD_QUEUE(SendFrameAdvanceStrategy)
+	ADD_QUEUE(RecieveFrameAdvanceStats)
+	ADD_QUEUE(SendInputRecording)
+	ADD_QUEUE(RecieveRecordedInputs)
 
 	CommunicateWithNetwork(std::function<void(CommunicateWithNetwork*)> sendCallback, std::function<void(CommunicateWithNetwork*)> recieveCallback);
 
@@ -0,0 +1,116 @@
+#include "binaryLogger.hpp"
+
+BinaryLogger::BinaryLogger(std::shared_ptr<CommunicateWithNetwork> networkImp) {
+	networkInstance = networkImp;
+
+	for(size_t i = 0; i < BINARY_LOG_CAPACITY; i++) {
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	enqueuePosition.store(0, std::memory_order_relaxed);
+	droppedEvents.store(0, std::memory_order_relaxed);
+
+	keepDraining = true;
+	drainThread  = std::make_unique<std::thread>(&BinaryLogger::drainLoop, this);
+}
+
+void BinaryLogger::log(LogEventId id, uint64_t arg0, uint64_t arg1, uint64_t arg2, uint64_t arg3) {
+	Cell* cell;
+	size_t position = enqueuePosition.load(std::memory_order_relaxed);
+	while(true) {
+		cell              = &cells[position & (BINARY_LOG_CAPACITY - 1)];
+		size_t sequence   = cell->sequence.load(std::memory_order_acquire);
+		intptr_t distance = (intptr_t)sequence - (intptr_t)position;
+		if(distance == 0) {
+			// Cell is free, try to claim it
+			if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if(distance < 0) {
+			// Full, the drain thread hasn't caught up
+			droppedEvents.fetch_add(1, std::memory_order_relaxed);
+			return;
+		} else {
+			position = enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->event.id        = id;
+	cell->event.timestamp = getTimestamp();
+	cell->event.args[0]   = arg0;
+	cell->event.args[1]   = arg1;
+	cell->event.args[2]   = arg2;
+	cell->event.args[3]   = arg3;
+	cell->sequence.store(position + 1, std::memory_order_release);
+}
+
+bool BinaryLogger::pop(BinaryLogEvent& event) {
+	Cell* cell        = &cells[dequeuePosition & (BINARY_LOG_CAPACITY - 1)];
+	size_t sequence   = cell->sequence.load(std::memory_order_acquire);
+	intptr_t distance = (intptr_t)sequence - (intptr_t)(dequeuePosition + 1);
+	if(distance < 0) {
+		// Empty, or a writer hasn't finished this cell yet
+		return false;
+	}
+
+	event = cell->event;
+	cell->sequence.store(dequeuePosition + BINARY_LOG_CAPACITY, std::memory_order_release);
+	dequeuePosition++;
+	return true;
+}
+
+void BinaryLogger::drainLoop() {
+#ifdef __SWITCH__
+	// Lowest priority, the game and the main loop always come first
+	svcSetThreadPriority(CUR_THREAD_HANDLE, 0x3F);
+	remove("/SwiTAS_log.bin");
+	FILE* logFile = fopen("/SwiTAS_log.bin", "wb");
+#endif
+
+	std::vector<BinaryLogEvent> events;
+	while(keepDraining) {
+		BinaryLogEvent event;
+		while(pop(event)) {
+			events.push_back(event);
+		}
+
+		uint64_t dropped = droppedEvents.exchange(0, std::memory_order_relaxed);
+		if(dropped != 0) {
+			BinaryLogEvent droppedEvent = { 0 };
+			droppedEvent.id             = LogEventId::LOG_EVENTS_DROPPED;
+			droppedEvent.timestamp      = getTimestamp();
+			droppedEvent.args[0]        = dropped;
+			events.push_back(droppedEvent);
+		}
+
+		if(!events.empty()) {
+#ifdef __SWITCH__
+			// Raw structs, the PC can read them back with formatLogEvent
+			if(logFile != NULL) {
+				fwrite(events.data(), sizeof(BinaryLogEvent), events.size(), logFile);
+				fflush(logFile);
+			}
+#endif
+
+			if(networkInstance->isConnected()) {
+				ADD_TO_QUEUE(RecieveBinaryLogging, networkInstance, {
+					data.events = events;
+				})
+			}
+
+			events.clear();
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(BINARY_LOG_DRAIN_MILLISECONDS));
+	}
+
+#ifdef __SWITCH__
+	if(logFile != NULL) {
+		fclose(logFile);
+	}
+#endif
+}
+
+BinaryLogger::~BinaryLogger() {
+	keepDraining = false;
+	drainThread->join();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// Has to be a power of two
+#define BINARY_LOG_CAPACITY 1024
+// How often the drain thread empties the ring buffer
+#define BINARY_LOG_DRAIN_MILLISECONDS 20
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef __SWITCH__
+#include <plog/Log.h>
+#include <switch.h>
+#endif
+
+#include "sharedNetworkCode/binaryLogging.hpp"
+#include "sharedNetworkCode/networkInterface.hpp"
+
+// Lock free ring buffer, logging from any thread is just a few atomics and a copy
+// Based on the bounded MPMC queue by Dmitry Vyukov, with a single consumer
+class BinaryLogger {
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		BinaryLogEvent event;
+	};
+
+	Cell cells[BINARY_LOG_CAPACITY];
+	std::atomic<size_t> enqueuePosition;
+	// Only touched by the drain thread
+	size_t dequeuePosition = 0;
+
+	std::atomic<uint64_t> droppedEvents;
+
+	std::shared_ptr<CommunicateWithNetwork> networkInstance;
+
+	std::atomic_bool keepDraining;
+	std::unique_ptr<std::thread> drainThread;
+
+	bool pop(BinaryLogEvent& event);
+	void drainLoop();
+
+	static uint64_t getTimestamp() {
+#ifdef __SWITCH__
+		return armTicksToNs(armGetSystemTick());
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+public:
+	BinaryLogger(std::shared_ptr<CommunicateWithNetwork> networkImp);
+
+	// Never blocks, if the buffer is full the event is counted as dropped
+	void log(LogEventId id, uint64_t arg0 = 0, uint64_t arg1 = 0, uint64_t arg2 = 0, uint64_t arg3 = 0);
+
+	~BinaryLogger();
+};
@@ -30,26 +30,26 @@ const std::unordered_map<Btn, HidControllerKeys> btnToHidKeys {
 	{ Btn::RS, KEY_RSTICK },
 };
 #else
-const std::unordered_map<Btn, int> btnToHidKeys {
-	//{ Btn::A, KEY_A },
-	//{ Btn::B, KEY_B },
-	//{ Btn::X, KEY_X },
-	//{ Btn::Y, KEY_Y },
-	//{ Btn::L, KEY_L },
-	//{ Btn::R, KEY_R },
-	//{ Btn::ZL, KEY_ZL },
-	//{ Btn::ZR, KEY_ZR },
-	//{ Btn::SL, KEY_SL },
-	//{ Btn::SR, KEY_SR },
-	//{ Btn::DUP, KEY_DUP },
-	//{ Btn::DDOWN, KEY_DDOWN },
-	//{ Btn::DLEFT, KEY_DLEFT },
-	//{ Btn::DRIGHT, KEY_DRIGHT },
-	//{ Btn::PLUS, KEY_PLUS },
-	//{ Btn::MINUS, KEY_MINUS },
-	//{ Btn::HOME, KEY_HOME },
-	//{ Btn::CAPT, KEY_CAPTURE },
-	//{ Btn::LS, KEY_LSTICK },
-	//{ Btn::RS, KEY_RSTICK },
+// Same bits as libnx, which is what Yuzu uses too
+// Home and capture aren't given to games on Yuzu
+const std::unordered_map<Btn, uint64_t> btnToHidKeys {
+	{ Btn::A, 1ULL << 0 },
+	{ Btn::B, 1ULL << 1 },
+	{ Btn::X, 1ULL << 2 },
+	{ Btn::Y, 1ULL << 3 },
+	{ Btn::LS, 1ULL << 4 },
+	{ Btn::RS, 1ULL << 5 },
+	{ Btn::L, 1ULL << 6 },
+	{ Btn::R, 1ULL << 7 },
+	{ Btn::ZL, 1ULL << 8 },
+	{ Btn::ZR, 1ULL << 9 },
+	{ Btn::PLUS, 1ULL << 10 },
+	{ Btn::MINUS, 1ULL << 11 },
+	{ Btn::DLEFT, 1ULL << 12 },
+	{ Btn::DUP, 1ULL << 13 },
+	{ Btn::DRIGHT, 1ULL << 14 },
+	{ Btn::DDOWN, 1ULL << 15 },
+	{ Btn::SL, 1ULL << 24 },
+	{ Btn::SR, 1ULL << 25 },
 };
 #endif
\ No newline at end of file
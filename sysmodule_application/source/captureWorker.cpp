@@ -0,0 +1,130 @@
+#include "captureWorker.hpp"
+
+CaptureWorker::CaptureWorker(std::shared_ptr<CommunicateWithNetwork> networkImp, std::shared_ptr<BinaryLogger> logger, ScreenshotHandler* screenshot) {
+	networkInstance   = networkImp;
+	binaryLogger      = logger;
+	screenshotHandler = screenshot;
+
+	for(uint8_t i = 0; i < CAPTURE_BUFFER_COUNT; i++) {
+		buffers[i].reserve(JPEG_BUF_SIZE);
+	}
+
+	workerThread = std::make_unique<std::thread>(&CaptureWorker::workerLoop, this);
+}
+
+bool CaptureWorker::hasFreeBuffer() {
+	std::unique_lock<std::mutex> lock(captureMutex);
+	for(uint8_t i = 0; i < CAPTURE_BUFFER_COUNT; i++) {
+		if(!bufferBusy[i]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CaptureWorker::requestCapture(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex) {
+	{
+		std::unique_lock<std::mutex> lock(captureMutex);
+
+		int8_t freeBuffer = -1;
+		for(uint8_t i = 0; i < CAPTURE_BUFFER_COUNT; i++) {
+			if(!bufferBusy[i]) {
+				freeBuffer = i;
+				break;
+			}
+		}
+
+		if(freeBuffer == -1) {
+			binaryLogger->log(LogEventId::LOG_CAPTURE_SKIPPED, frame);
+			return false;
+		}
+
+		bufferBusy[freeBuffer] = true;
+
+		CaptureRequest request;
+		request.bufferIndex            = freeBuffer;
+		request.linkedWithFrameAdvance = linkedWithFrameAdvance;
+		request.includeFramebuffer     = includeFramebuffer;
+		request.frame                  = frame;
+		request.savestateHookNum       = savestateHookNum;
+		request.branchIndex            = branchIndex;
+		request.playerIndex            = playerIndex;
+		requests.push(request);
+	}
+
+	requestCv.notify_one();
+	return true;
+}
+
+void CaptureWorker::waitForCapture() {
+	std::unique_lock<std::mutex> lock(captureMutex);
+	idleCv.wait(lock, [this] { return requests.empty() && !capturing; });
+}
+
+void CaptureWorker::workerLoop() {
+	while(true) {
+		CaptureRequest request;
+
+		{
+			std::unique_lock<std::mutex> lock(captureMutex);
+			requestCv.wait(lock, [this] { return !keepRunning || !requests.empty(); });
+
+			if(!keepRunning) {
+				return;
+			}
+
+			request = requests.front();
+			requests.pop();
+			capturing = true;
+		}
+
+		std::vector<uint8_t>& buf = buffers[request.bufferIndex];
+		if(request.includeFramebuffer) {
+			screenshotHandler->writeFramebuffer(buf);
+		} else {
+			buf.clear();
+		}
+
+		uint64_t dhash        = 0;
+		uint8_t dhashIncluded = screenshotHandler->calculateDhash(dhash);
+
+		{
+			// The screen has been read, the game is free to continue
+			std::unique_lock<std::mutex> lock(captureMutex);
+			capturing = false;
+		}
+		idleCv.notify_all();
+
+		ADD_TO_QUEUE(RecieveGameFramebuffer, networkInstance, {
+			data.buf                    = buf;
+			data.fromFrameAdvance       = request.linkedWithFrameAdvance;
+			data.frame                  = request.frame;
+			data.savestateHookNum       = request.savestateHookNum;
+			data.branchIndex            = request.branchIndex;
+			data.playerIndex            = request.playerIndex;
+			data.controllerDataIncluded = false;
+			data.dhashIncluded          = dhashIncluded;
+			data.dhash                  = dhash;
+			data.captureFollows         = false;
+			data.fromCaptureWorker      = true;
+			data.ramHashIncluded        = false;
+			data.ramHash                = 0;
+			data.isLagFrame             = false;
+			data.lagFramesSkipped       = 0;
+		})
+
+		{
+			std::unique_lock<std::mutex> lock(captureMutex);
+			bufferBusy[request.bufferIndex] = false;
+		}
+	}
+}
+
+CaptureWorker::~CaptureWorker() {
+	{
+		std::unique_lock<std::mutex> lock(captureMutex);
+		keepRunning = false;
+	}
+	requestCv.notify_all();
+	workerThread->join();
+}
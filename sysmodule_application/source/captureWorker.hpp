@@ -0,0 +1,71 @@
+#pragma once
+
+// Each buffer is JPEG_BUF_SIZE, keep this small for the heap
+#define CAPTURE_BUFFER_COUNT 2
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#ifdef __SWITCH__
+#include <plog/Log.h>
+#include <switch.h>
+#endif
+
+#include "binaryLogger.hpp"
+#include "screenshotHandler.hpp"
+#include "sharedNetworkCode/networkInterface.hpp"
+
+struct CaptureRequest {
+	uint8_t bufferIndex;
+	uint8_t linkedWithFrameAdvance;
+	uint8_t includeFramebuffer;
+	uint32_t frame;
+	uint16_t savestateHookNum;
+	uint32_t branchIndex;
+	uint8_t playerIndex;
+};
+
+// Captures the screen on another thread so frame advance doesn't wait on it
+// The game still has to stay paused until the screen has been read
+class CaptureWorker {
+private:
+	std::shared_ptr<CommunicateWithNetwork> networkInstance;
+	std::shared_ptr<BinaryLogger> binaryLogger;
+	ScreenshotHandler* screenshotHandler;
+
+	// Allocated once, captures never allocate a JPEG buffer
+	std::vector<uint8_t> buffers[CAPTURE_BUFFER_COUNT];
+	uint8_t bufferBusy[CAPTURE_BUFFER_COUNT] = { false };
+
+	std::queue<CaptureRequest> requests;
+	uint8_t capturing   = false;
+	uint8_t keepRunning = true;
+
+	std::mutex captureMutex;
+	// Wakes up the worker
+	std::condition_variable requestCv;
+	// Wakes up anybody waiting for the screen to be read
+	std::condition_variable idleCv;
+
+	std::unique_ptr<std::thread> workerThread;
+
+	void workerLoop();
+
+public:
+	CaptureWorker(std::shared_ptr<CommunicateWithNetwork> networkImp, std::shared_ptr<BinaryLogger> logger, ScreenshotHandler* screenshot);
+
+	bool hasFreeBuffer();
+
+	// Returns false if every buffer is busy, the capture is skipped instead of blocking
+	bool requestCapture(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex);
+
+	// Has to be called before unpausing, otherwise the wrong frame gets captured
+	void waitForCapture();
+
+	~CaptureWorker();
+};
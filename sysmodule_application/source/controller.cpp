@@ -43,6 +43,17 @@ ControllerHandler::ControllerHandler(std::shared_ptr<CommunicateWithNetwork> net
 	setInput();
 }
 
+#ifdef SIMULATED
+ControllerHandler::ControllerHandler(std::shared_ptr<CommunicateWithNetwork> networkImp, std::shared_ptr<SimulatedPlatform> platform) {
+	networkInstance   = networkImp;
+	simulatedPlatform = platform;
+	simulatedIndex    = simulatedPlatform->attachController();
+
+	clearState();
+	setInput();
+}
+#endif
+
 void ControllerHandler::setFrame(ControllerData controllerData) {
 	clearState();
 // Set data one at a time
@@ -57,6 +68,9 @@ void ControllerHandler::setFrame(ControllerData controllerData) {
 		}
 	}
 #endif
+#ifdef SIMULATED
+	state = controllerData;
+#endif
 
 	setInput();
 }
@@ -78,22 +92,23 @@ void ControllerHandler::setFrame(u64 buttons, JoystickPosition& left, JoystickPo
 std::shared_ptr<ControllerData> ControllerHandler::getControllerData() {
 	std::shared_ptr<ControllerData> newControllerData = std::make_shared<ControllerData>();
 
-	for(auto const& button : btnToHidKeys) {
 #ifdef __SWITCH__
+	for(auto const& button : btnToHidKeys) {
 		if(state.buttons & button.second) {
 			SET_BIT(newControllerData->buttons, true, button.first);
 		} else {
 			SET_BIT(newControllerData->buttons, false, button.first);
 		}
-#endif
 	}
 
-#ifdef __SWITCH__
 	newControllerData->LS_X = state.joysticks[JOYSTICK_LEFT].dx;
 	newControllerData->LS_Y = state.joysticks[JOYSTICK_LEFT].dy;
 	newControllerData->RS_X = state.joysticks[JOYSTICK_RIGHT].dx;
 	newControllerData->RS_Y = state.joysticks[JOYSTICK_RIGHT].dy;
 #endif
+#ifdef SIMULATED
+	*newControllerData = state;
+#endif
 
 	// Accel TODO
 
@@ -109,4 +124,9 @@ ControllerHandler::~ControllerHandler() {
 	if(R_FAILED(rc))
 		fatalThrow(rc);
 #endif
+#ifdef SIMULATED
+	if(simulatedPlatform) {
+		simulatedPlatform->detachController(simulatedIndex);
+	}
+#endif
 }
\ No newline at end of file
@@ -11,6 +11,10 @@
 #include "buttonData.hpp"
 #include "screenshotHandler.hpp"
 
+#ifdef SIMULATED
+#include "simulatedPlatform.hpp"
+#endif
+
 class ControllerHandler {
 	// Create one for each controller index
 private:
@@ -22,10 +26,19 @@ private:
 	Result rc;
 #endif
 
+#ifdef SIMULATED
+	std::shared_ptr<SimulatedPlatform> simulatedPlatform;
+	uint8_t simulatedIndex;
+	ControllerData state;
+#endif
+
 	std::shared_ptr<CommunicateWithNetwork> networkInstance;
 
 public:
 	ControllerHandler(std::shared_ptr<CommunicateWithNetwork> networkImp);
+#ifdef SIMULATED
+	ControllerHandler(std::shared_ptr<CommunicateWithNetwork> networkImp, std::shared_ptr<SimulatedPlatform> platform);
+#endif
 
 	void setFrame(ControllerData controllerData);
 #ifdef __SWITCH__
@@ -39,6 +52,9 @@ public:
 		state.joysticks[JOYSTICK_LEFT].dy  = 0;
 		state.joysticks[JOYSTICK_RIGHT].dx = 0;
 		state.joysticks[JOYSTICK_RIGHT].dy = 0;
+#endif
+#ifdef SIMULATED
+		state = ControllerData();
 #endif
 	}
 
@@ -48,6 +64,11 @@ public:
 		if(R_FAILED(rc)) {
 			fatalThrow(rc);
 		}
+#endif
+#ifdef SIMULATED
+		if(simulatedPlatform) {
+			simulatedPlatform->setControllerState(simulatedIndex, state);
+		}
 #endif
 	}
 
@@ -29,6 +29,8 @@ typedef void(emu_loadrom)(void* ctx, char* filename);
 // bool emu.delgamegenie(string str) ignored
 typedef void(emu_print)(void* ctx, uint8_t mode);
 typedef uint8_t*(emu_getscreenpixel)(void* ctx, int x, int y, bool getemuscreen);
+// Not in FCEUX, copies the whole screen as RGBA into buf, returns false if buf is smaller than width * height * 4
+typedef uint8_t(emu_getscreenframebuffer)(void* ctx, uint8_t* buf, uint64_t size, int* width, int* height, bool getemuscreen);
 
 // ROM Library (handled differently since the games are bigger)
 
@@ -40,6 +42,8 @@ typedef void(rom_writebyte)(void* ctx, uint64_t address, uint8_t byte);
 
 typedef uint8_t(memory_readbyteunsigned)(void* ctx, uint64_t address);
 typedef uint8_t*(memory_readbyterange)(void* ctx, uint64_t address, uint64_t length);
+// Not in FCEUX, reads count ranges in one call, back to back into buf
+typedef uint8_t(memory_readbyteranges)(void* ctx, const uint64_t* addresses, const uint64_t* lengths, uint64_t count, uint8_t* buf);
 typedef int8_t(memory_readbytesigned)(void* ctx, uint64_t address);
 // memory.readword(int addressLow, [int addressHigh]) ignored
 // memory.readwordunsigned(int addressLow, [int addressHigh]) ignored
@@ -72,11 +76,25 @@ typedef uint64_t(joypad_immediate)(void* ctx, uint8_t player);
 typedef void(joypad_set)(void* ctx, uint8_t player, uint64_t input);
 
 // Joystick, accel and gyro based on enums
+enum JoypadAxis : uint8_t {
+	JOYPAD_LS_X,
+	JOYPAD_LS_Y,
+	JOYPAD_RS_X,
+	JOYPAD_RS_Y,
+	JOYPAD_ACCEL_X,
+	JOYPAD_ACCEL_Y,
+	JOYPAD_ACCEL_Z,
+	JOYPAD_GYRO_1,
+	JOYPAD_GYRO_2,
+	JOYPAD_GYRO_3,
+};
 typedef int16_t(joypad_readjoystick)(void* ctx, uint8_t player, uint8_t type);
 // Disable input entering from outside the script, this allows the script to set input without interruption
 typedef void(joypad_enableoutsideinput)(void* ctx, uint8_t enable);
 // Set number of joysticks in use
 typedef void(joypad_setnumjoypads)(void* ctx, uint8_t numofplayers);
+// Not in FCEUX, how many times the game has read the controllers, it stays the same on lag frames
+typedef uint64_t(joypad_getpollcount)(void* ctx);
 
 // Input Library
 
@@ -87,7 +105,12 @@ typedef void(joypad_setnumjoypads)(void* ctx, uint8_t numofplayers);
 // Keyboard machanism based on enums
 typedef uint8_t(input_ispressed)(void* ctx, uint8_t key);
 
-// Savestate Library implemented in dll
+// Savestate Library implemented in dll, except for the raw state the rewind ring keeps in memory
+
+// Not in FCEUX, writes the whole emulator state into buf and returns its size, nothing is written if size is too small
+typedef uint64_t(savestate_savetomemory)(void* ctx, uint8_t* buf, uint64_t size);
+// Not in FCEUX, returns false if the state is from another game or another version of Yuzu
+typedef uint8_t(savestate_loadfrommemory)(void* ctx, const uint8_t* buf, uint64_t size);
 
 // Movie Library implemented in dll
 
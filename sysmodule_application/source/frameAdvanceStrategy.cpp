@@ -0,0 +1,148 @@
+#include "frameAdvanceStrategy.hpp"
+#include "mainLoopHandler.hpp"
+
+void FrameAdvanceStats::record(uint64_t nanoseconds) {
+	if(samples.size() < FRAME_ADVANCE_STATS_SAMPLES) {
+		samples.push_back(nanoseconds);
+	} else {
+		samples[nextSample] = nanoseconds;
+	}
+	nextSample = (nextSample + 1) % FRAME_ADVANCE_STATS_SAMPLES;
+
+	frames++;
+	totalNanoseconds += nanoseconds;
+	minNanoseconds = std::min(minNanoseconds, nanoseconds);
+	maxNanoseconds = std::max(maxNanoseconds, nanoseconds);
+}
+
+void FrameAdvanceStats::reset() {
+	samples.clear();
+	nextSample       = 0;
+	frames           = 0;
+	totalNanoseconds = 0;
+	minNanoseconds   = UINT64_MAX;
+	maxNanoseconds   = 0;
+}
+
+uint64_t FrameAdvanceStats::getPercentile(uint8_t percent) {
+	if(samples.empty()) {
+		return 0;
+	}
+
+	std::vector<uint64_t> sorted = samples;
+	size_t index                 = sorted.size() * percent / 100;
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
+
+void FrameAdvanceStrategy::waitForVsync() {
+	mainLoop->waitForVsync();
+}
+
+void FrameAdvanceStrategy::waitForCapture() {
+	// The screen can't change until the capture is done
+	mainLoop->captureWorker->waitForCapture();
+}
+
+void FrameAdvanceStrategy::pauseGame() {
+	mainLoop->pauseGame();
+}
+
+void FrameAdvanceStrategy::unpauseApp() {
+	mainLoop->unpauseApp();
+}
+
+void FrameAdvanceStrategy::setPaused(uint8_t paused) {
+	mainLoop->isPaused = paused;
+}
+
+#ifdef __SWITCH__
+Handle FrameAdvanceStrategy::getDebugHandle() {
+	return mainLoop->applicationDebug;
+}
+#endif
+
+void FrameAdvanceStrategy::runFrame() {
+	uint64_t start = MainLoop::getNanoseconds();
+	advance();
+	stats.record(MainLoop::getNanoseconds() - start);
+}
+
+uint8_t VsyncUnpauseStrategy::isSupported() {
+	// Yuzu has no vsync event to wait on
+#ifdef YUZU
+	return false;
+#else
+	return true;
+#endif
+}
+
+void VsyncUnpauseStrategy::advance() {
+	waitForVsync();
+	unpauseApp();
+	waitForVsync();
+	pauseGame();
+}
+
+#ifdef __SWITCH__
+void SingleVsyncStrategy::drainDebugEvents(Handle debug) {
+	uint8_t event[0x40];
+	while(R_SUCCEEDED(svcGetDebugEvent(event, debug))) {
+	}
+}
+#endif
+
+uint8_t SingleVsyncStrategy::isSupported() {
+	uint8_t supported = false;
+#ifdef __SWITCH__
+	// Continuing every thread at once needs 3.0.0
+	supported = hosversionAtLeast(3, 0, 0);
+#endif
+#ifdef SIMULATED
+	supported = true;
+#endif
+	return supported;
+}
+
+void SingleVsyncStrategy::advance() {
+	waitForCapture();
+#ifdef __SWITCH__
+	// The handle stays open the whole time, attaching again is what makes the other strategy slow
+	Handle debug = getDebugHandle();
+	drainDebugEvents(debug);
+	// Exception handled, exception events enabled, continue all threads
+	svcContinueDebugEvent(debug, 1 | 2 | 4, NULL, 0);
+	waitForVsync();
+	svcBreakDebugProcess(debug);
+#endif
+#ifdef SIMULATED
+	unpauseApp();
+	waitForVsync();
+	pauseGame();
+#endif
+}
+
+uint8_t EmulatorStepStrategy::isSupported() {
+	uint8_t supported = false;
+#ifdef YUZU
+	supported = mainLoop->getYuzuSyscalls()->function_emu_frameadvance != nullptr;
+#endif
+#ifdef SIMULATED
+	supported = true;
+#endif
+	return supported;
+}
+
+void EmulatorStepStrategy::advance() {
+	waitForCapture();
+#ifdef YUZU
+	// Yuzu runs exactly one frame and stays paused
+	std::shared_ptr<Syscalls> yuzuSyscalls = mainLoop->getYuzuSyscalls();
+	yuzuSyscalls->function_emu_frameadvance(yuzuSyscalls->getYuzuInstance());
+	setPaused(false);
+	pauseGame();
+#endif
+#ifdef SIMULATED
+	mainLoop->getSimulatedPlatform()->stepFrame();
+#endif
+}
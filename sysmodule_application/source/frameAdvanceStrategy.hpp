@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifdef __SWITCH__
+#include <switch.h>
+#endif
+
+#include "sharedNetworkCode/networkingStructures.hpp"
+
+// Only the newest frames are kept for the median and 99th percentile
+#define FRAME_ADVANCE_STATS_SAMPLES 512
+
+class MainLoop;
+
+class FrameAdvanceStats {
+private:
+	// Ring of the newest frame times
+	std::vector<uint64_t> samples;
+	size_t nextSample = 0;
+
+	uint32_t frames           = 0;
+	uint64_t totalNanoseconds = 0;
+	uint64_t minNanoseconds   = UINT64_MAX;
+	uint64_t maxNanoseconds   = 0;
+
+public:
+	void record(uint64_t nanoseconds);
+	void reset();
+
+	uint32_t getFrames() {
+		return frames;
+	}
+
+	uint64_t getAverage() {
+		return frames == 0 ? 0 : totalNanoseconds / frames;
+	}
+
+	uint64_t getMin() {
+		return frames == 0 ? 0 : minNanoseconds;
+	}
+
+	uint64_t getMax() {
+		return maxNanoseconds;
+	}
+
+	// Out of the newest samples only
+	uint64_t getPercentile(uint8_t percent);
+};
+
+// One way of running the game for exactly one frame, the game is paused before and after
+// Which one is fastest and still correct depends on the game, so they can be switched and compared
+class FrameAdvanceStrategy {
+private:
+	FrameAdvanceStats stats;
+
+protected:
+	MainLoop* mainLoop;
+
+	// Strategies can't be friends of MainLoop themselves, so they go through these
+	void waitForVsync();
+	void waitForCapture();
+	void pauseGame();
+	void unpauseApp();
+	void setPaused(uint8_t paused);
+#ifdef __SWITCH__
+	Handle getDebugHandle();
+#endif
+
+public:
+	FrameAdvanceStrategy(MainLoop* loop)
+		: mainLoop(loop) {}
+
+	virtual ~FrameAdvanceStrategy() {}
+
+	virtual FrameAdvanceStrategyType getType() = 0;
+	virtual uint8_t isSupported()              = 0;
+	virtual void advance()                     = 0;
+
+	// Times advance
+	void runFrame();
+
+	FrameAdvanceStats& getStats() {
+		return stats;
+	}
+};
+
+// What frame advancing has always done, at least two vsyncs a frame
+class VsyncUnpauseStrategy : public FrameAdvanceStrategy {
+public:
+	VsyncUnpauseStrategy(MainLoop* loop)
+		: FrameAdvanceStrategy(loop) {}
+
+	FrameAdvanceStrategyType getType() override {
+		return FrameAdvanceStrategyType::FRAME_ADVANCE_VSYNC_UNPAUSE;
+	}
+
+	uint8_t isSupported() override;
+	void advance() override;
+};
+
+// Resumes right away and pauses at the next vsync, one vsync a frame
+// The game resumes partway through a frame, so check the hashes still match the other strategies
+class SingleVsyncStrategy : public FrameAdvanceStrategy {
+private:
+#ifdef __SWITCH__
+	// Debug events have to be handled before the process can continue
+	void drainDebugEvents(Handle debug);
+#endif
+
+public:
+	SingleVsyncStrategy(MainLoop* loop)
+		: FrameAdvanceStrategy(loop) {}
+
+	FrameAdvanceStrategyType getType() override {
+		return FrameAdvanceStrategyType::FRAME_ADVANCE_SINGLE_VSYNC;
+	}
+
+	uint8_t isSupported() override;
+	void advance() override;
+};
+
+// The emulator runs exactly one frame, no vsync to wait on
+class EmulatorStepStrategy : public FrameAdvanceStrategy {
+public:
+	EmulatorStepStrategy(MainLoop* loop)
+		: FrameAdvanceStrategy(loop) {}
+
+	FrameAdvanceStrategyType getType() override {
+		return FrameAdvanceStrategyType::FRAME_ADVANCE_EMULATOR_STEP;
+	}
+
+	uint8_t isSupported() override;
+	void advance() override;
+};
@@ -0,0 +1,40 @@
+#include "inputRecorder.hpp"
+
+void InputRecorder::start(uint16_t hook, uint16_t branch, uint8_t player, uint32_t startFrame) {
+	recording        = true;
+	savestateHookNum = hook;
+	branchIndex      = branch;
+	playerIndex      = player;
+	batchFirstFrame  = startFrame;
+	batchFrames      = 0;
+	previous         = ControllerData();
+	deltas.clear();
+	deltas.reserve(INPUT_RECORDING_BATCH_FRAMES * 4);
+}
+
+void InputRecorder::stop() {
+	recording = false;
+}
+
+void InputRecorder::addSamples(const ControllerData& controllerData, uint32_t frames) {
+	for(uint32_t i = 0; i < frames; i++) {
+		encodeInputDelta(previous, controllerData, deltas);
+		previous = controllerData;
+		batchFrames++;
+	}
+}
+
+void InputRecorder::takeBatch(Protocol::Struct_RecieveRecordedInputs& batch) {
+	batch.savestateHookNum = savestateHookNum;
+	batch.branchIndex      = branchIndex;
+	batch.playerIndex      = playerIndex;
+	batch.firstFrame       = batchFirstFrame;
+	batch.numOfFrames      = batchFrames;
+	batch.deltas           = std::move(deltas);
+
+	batchFirstFrame += batchFrames;
+	batchFrames = 0;
+	previous    = ControllerData();
+	deltas.clear();
+	deltas.reserve(INPUT_RECORDING_BATCH_FRAMES * 4);
+}
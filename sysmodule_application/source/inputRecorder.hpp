@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sharedNetworkCode/networkingStructures.hpp"
+
+// Frames sent to the PC at once, half a second of gameplay
+#define INPUT_RECORDING_BATCH_FRAMES 30
+
+// Keeps the inputs of the real controller while the game runs in realtime
+// They are sent in batches of deltas, one message a frame would flood the PC
+class InputRecorder {
+private:
+	uint8_t recording = false;
+
+	uint16_t savestateHookNum = 0;
+	uint16_t branchIndex      = 0;
+	uint8_t playerIndex       = 0;
+
+	// First frame of the batch being filled
+	uint32_t batchFirstFrame = 0;
+	uint32_t batchFrames     = 0;
+	std::vector<uint8_t> deltas;
+	// The first frame of every batch is compared with a blank ControllerData
+	ControllerData previous;
+
+public:
+	void start(uint16_t hook, uint16_t branch, uint8_t player, uint32_t startFrame);
+	void stop();
+
+	uint8_t isRecording() {
+		return recording;
+	}
+
+	uint8_t getPlayerIndex() {
+		return playerIndex;
+	}
+
+	// Every frame that ran since the last sample held these inputs
+	void addSamples(const ControllerData& controllerData, uint32_t frames);
+
+	uint8_t isBatchFull() {
+		return batchFrames >= INPUT_RECORDING_BATCH_FRAMES;
+	}
+
+	// Fills everything but finished and starts the next batch
+	void takeBatch(Protocol::Struct_RecieveRecordedInputs& batch);
+};
@@ -17,6 +17,13 @@
 #include "controller.hpp"
 #include "mainLoopHandler.hpp"
 
+#ifdef SIMULATED
+#include "scripting/gui.hpp"
+#include "simulatedClient.hpp"
+#include <csignal>
+#include <thread>
+#endif
+
 #ifdef __SWITCH__
 extern "C" {
 // Sysmodules should not use applet*.
@@ -174,6 +181,191 @@ int main(int argc, char* argv[]) {
 }
 #endif
 
+// Runs the sysmodule as a normal Linux program, without arguments the PC app can connect to it
+// --bench N runs N frame advances against a built in client and prints the timings
+// --unthrottled removes the 60 FPS vsync limit
+// --expect-dhash HASH fails if the final screen doesn't match, for catching regressions
+// --lua PATH loads a Lua script, its onFrame runs on every advance
+// --lua-bench N compares the Lua memory reading functions with N values and exits
+// --gui-bench FONT times drawing an overlay with the given TTF font and exits
+// --final-tas PATH fast forwards through a final TAS script, one per player, and exits
+// --checkpoint FRAME HASH checks the dHash after that many final TAS frames, fails on a desync
+// --rewind-bench N advances N frames, then edits one and jumps back with the savestate ring
+// --ram-hash ADDR SIZE hashes that range of memory after every frame, can be given more than once
+// --save-ram-hashes PATH writes the final TAS RAM hashes, one per line
+// --expect-ram-hashes PATH compares the final TAS RAM hashes with a file from --save-ram-hashes
+// --lag-detection METHOD marks lag frames in the bench, counter, framebuffer or poll
+// --skip-lag runs the bench like the auto advance and skips lag frames
+// --advance-strategy NAME frame advances with vsync, single or step, to compare them
+#ifdef SIMULATED
+int main(int argc, char* argv[]) {
+	// A client closing its socket while a message is being sent shouldn't kill the process
+	signal(SIGPIPE, SIG_IGN);
+
+	uint32_t benchFrames  = 0;
+	uint8_t unthrottled   = false;
+	uint8_t checkDhash    = false;
+	uint64_t expectedHash = 0;
+	std::string luaPath;
+	uint32_t luaBenchValues = 0;
+	std::string guiBenchFont;
+	uint32_t rewindBenchFrames = 0;
+	std::vector<uint64_t> ramHashAddresses;
+	std::vector<uint64_t> ramHashLengths;
+	std::string saveRamHashesPath;
+	LagDetectionMethod lagMethod = LagDetectionMethod::LAG_DETECTION_NONE;
+	uint8_t skipLag              = false;
+	int advanceStrategy          = -1;
+	uint32_t recordBenchFrames   = 0;
+	Protocol::Struct_SendStartFinalTas finalTas;
+	finalTas.fastForward         = true;
+	finalTas.checkpointTolerance = 0;
+
+	for(int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		if(arg == "--bench" && i + 1 < argc) {
+			benchFrames = strtoul(argv[++i], NULL, 10);
+		} else if(arg == "--unthrottled") {
+			unthrottled = true;
+		} else if(arg == "--expect-dhash" && i + 1 < argc) {
+			checkDhash   = true;
+			expectedHash = strtoull(argv[++i], NULL, 16);
+		} else if(arg == "--lua" && i + 1 < argc) {
+			luaPath = argv[++i];
+		} else if(arg == "--lua-bench" && i + 1 < argc) {
+			luaBenchValues = strtoul(argv[++i], NULL, 10);
+		} else if(arg == "--gui-bench" && i + 1 < argc) {
+			guiBenchFont = argv[++i];
+		} else if(arg == "--final-tas" && i + 1 < argc) {
+			finalTas.scriptPaths.push_back(argv[++i]);
+		} else if(arg == "--checkpoint" && i + 2 < argc) {
+			finalTas.checkpointFrames.push_back(strtoul(argv[++i], NULL, 10));
+			finalTas.checkpointDhashes.push_back(strtoull(argv[++i], NULL, 16));
+		} else if(arg == "--rewind-bench" && i + 1 < argc) {
+			rewindBenchFrames = strtoul(argv[++i], NULL, 10);
+		} else if(arg == "--ram-hash" && i + 2 < argc) {
+			ramHashAddresses.push_back(strtoull(argv[++i], NULL, 16));
+			ramHashLengths.push_back(strtoull(argv[++i], NULL, 16));
+		} else if(arg == "--lag-detection" && i + 1 < argc) {
+			std::string method(argv[++i]);
+			if(method == "counter") {
+				lagMethod = LagDetectionMethod::LAG_DETECTION_RAM_COUNTER;
+			} else if(method == "framebuffer") {
+				lagMethod = LagDetectionMethod::LAG_DETECTION_FRAMEBUFFER;
+			} else if(method == "poll") {
+				lagMethod = LagDetectionMethod::LAG_DETECTION_INPUT_POLL;
+			}
+		} else if(arg == "--skip-lag") {
+			skipLag = true;
+		} else if(arg == "--advance-strategy" && i + 1 < argc) {
+			std::string strategy(argv[++i]);
+			if(strategy == "vsync") {
+				advanceStrategy = FrameAdvanceStrategyType::FRAME_ADVANCE_VSYNC_UNPAUSE;
+			} else if(strategy == "single") {
+				advanceStrategy = FrameAdvanceStrategyType::FRAME_ADVANCE_SINGLE_VSYNC;
+			} else if(strategy == "step") {
+				advanceStrategy = FrameAdvanceStrategyType::FRAME_ADVANCE_EMULATOR_STEP;
+			}
+		} else if(arg == "--record-bench" && i + 1 < argc) {
+			recordBenchFrames = strtoul(argv[++i], NULL, 10);
+		} else if(arg == "--save-ram-hashes" && i + 1 < argc) {
+			saveRamHashesPath = argv[++i];
+		} else if(arg == "--expect-ram-hashes" && i + 1 < argc) {
+			FILE* file = fopen(argv[++i], "r");
+			if(file == NULL) {
+				printf("Could not open %s\n", argv[i]);
+				return 1;
+			}
+			unsigned long long hash;
+			while(fscanf(file, "%llx", &hash) == 1) {
+				finalTas.expectedRamHashes.push_back(hash);
+			}
+			fclose(file);
+		} else {
+			printf("Usage: %s [--bench frames] [--unthrottled] [--expect-dhash hash] [--lua path] [--lua-bench values] [--gui-bench font] [--final-tas path] [--checkpoint frame hash] [--rewind-bench frames] [--ram-hash addr size] [--save-ram-hashes path] [--expect-ram-hashes path] [--lag-detection method] [--skip-lag] [--advance-strategy name] [--record-bench frames]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if(!guiBenchFont.empty()) {
+		Gui gui;
+		if(!gui.loadFont(guiBenchFont)) {
+			printf("Could not load font %s\n", guiBenchFont.c_str());
+		}
+		gui.benchmark(1000);
+		return 0;
+	}
+
+	MainLoop mainLoop;
+	mainLoop.getSimulatedPlatform()->setThrottled(!unthrottled);
+	mainLoop.setRamHashRanges(ramHashAddresses, ramHashLengths);
+
+	if(luaBenchValues != 0) {
+		mainLoop.runLuaBenchmark(luaBenchValues, 1000);
+		return 0;
+	}
+
+	if(rewindBenchFrames != 0) {
+		return mainLoop.runRewindBenchmark(rewindBenchFrames) ? 0 : 1;
+	}
+
+	if(!luaPath.empty()) {
+		mainLoop.loadLuaScript(luaPath, 0);
+	}
+
+	if(!finalTas.scriptPaths.empty()) {
+		uint8_t succeeded = mainLoop.startFinalTas(finalTas);
+
+		if(!saveRamHashesPath.empty()) {
+			FILE* file = fopen(saveRamHashesPath.c_str(), "w");
+			if(file != NULL) {
+				for(uint64_t hash : mainLoop.getFinalTasRamHashes()) {
+					fprintf(file, "%016llx\n", (unsigned long long)hash);
+				}
+				fclose(file);
+			}
+		}
+
+		return succeeded ? 0 : 1;
+	}
+
+	if(benchFrames == 0 && recordBenchFrames == 0) {
+		while(true) {
+			mainLoop.mainLoopHandler();
+		}
+	}
+
+	SimulatedClient client(benchFrames);
+	client.setLagDetection(lagMethod, skipLag);
+	if(recordBenchFrames != 0) {
+		client.setRecordBench(recordBenchFrames, mainLoop.getSimulatedPlatform());
+	}
+	if(advanceStrategy != -1) {
+		client.setFrameAdvanceStrategy((FrameAdvanceStrategyType)advanceStrategy);
+	}
+	std::thread clientThread(&SimulatedClient::run, &client);
+
+	while(!client.isDone()) {
+		mainLoop.mainLoopHandler();
+	}
+
+	clientThread.join();
+	client.printResults();
+	printf("Game frames: %llu\n", (unsigned long long)mainLoop.getSimulatedPlatform()->getFrameCount());
+
+	if(!client.hasSucceeded()) {
+		return 1;
+	}
+
+	if(checkDhash && client.getLastDhash() != expectedHash) {
+		printf("dHash mismatch, expected %016llx\n", (unsigned long long)expectedHash);
+		return 1;
+	}
+
+	return 0;
+}
+#endif
+
 // Leaving the possibility open for a standalone exe later
 // http://www.equestionanswers.com/c/c-explicit-linking.php
 // https://stackoverflow.com/a/13256146/9329945
@@ -198,6 +390,15 @@ DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), emu_unpause)
 DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), emu_message)
 DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), emu_framecount)
 DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), emu_emulating)
+DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), emu_getscreenpixel)
+DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), emu_getscreenframebuffer)
+DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), memory_readbyterange)
+DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), memory_readbyteranges)
+DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), savestate_savetomemory)
+DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), savestate_loadfrommemory)
+DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), joypad_getpollcount)
+DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), joypad_read)
+DLL_EXPORT SET_YUZU_FUNC(mainLoop.getYuzuSyscalls(), joypad_readjoystick)
 // clang-format on
 // Etc...
 #endif
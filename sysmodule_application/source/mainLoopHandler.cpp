@@ -4,6 +4,15 @@ MainLoop::MainLoop() {
 #ifdef __SWITCH__
 	LOGD << "Start networking";
 #endif
+#ifdef YUZU
+	yuzuSyscalls = std::make_shared<Syscalls>();
+	screenshotHandler.setYuzuSyscalls(yuzuSyscalls);
+#endif
+#ifdef SIMULATED
+	simulatedPlatform = std::make_shared<SimulatedPlatform>();
+	screenshotHandler.setSimulatedPlatform(simulatedPlatform);
+#endif
+
 	// Start networking with set queues
 	networkInstance = std::make_shared<CommunicateWithNetwork>(
 		[](CommunicateWithNetwork* self) {
@@ -13,6 +22,12 @@ MainLoop::MainLoop() {
 			SEND_QUEUE_DATA(RecieveApplicationConnected)
 			SEND_QUEUE_DATA(RecieveLogging)
 			SEND_QUEUE_DATA(RecieveMemoryRegion)
+			SEND_QUEUE_DATA(RecieveBinaryLogging)
+			SEND_QUEUE_DATA(RecieveFinalTasCheckpoint)
+			SEND_QUEUE_DATA(RecieveFinalTasFinished)
+			SEND_QUEUE_DATA(RecieveJumpToFrame)
+			SEND_QUEUE_DATA(RecieveFrameAdvanceStats)
+			SEND_QUEUE_DATA(RecieveRecordedInputs)
 		},
 		[](CommunicateWithNetwork* self) {
 			RECIEVE_QUEUE_DATA(SendFlag)
@@ -22,8 +37,48 @@ MainLoop::MainLoop() {
 			RECIEVE_QUEUE_DATA(SendSetNumControllers)
 			RECIEVE_QUEUE_DATA(SendAddMemoryRegion)
 			RECIEVE_QUEUE_DATA(SendStartFinalTas)
+			RECIEVE_QUEUE_DATA(SendLuaScript)
+			RECIEVE_QUEUE_DATA(SendRewindOptions)
+			RECIEVE_QUEUE_DATA(SendJumpToFrame)
+			RECIEVE_QUEUE_DATA(SendRamHashRanges)
+			RECIEVE_QUEUE_DATA(SendLagDetection)
+			RECIEVE_QUEUE_DATA(SendFrameAdvanceStrategy)
+			RECIEVE_QUEUE_DATA(SendInputRecording)
 		});
 
+	binaryLogger  = std::make_shared<BinaryLogger>(networkInstance);
+	captureWorker = std::make_unique<CaptureWorker>(networkInstance, binaryLogger, &screenshotHandler);
+
+	frameAdvanceStrategies[FrameAdvanceStrategyType::FRAME_ADVANCE_VSYNC_UNPAUSE] = std::make_unique<VsyncUnpauseStrategy>(this);
+	frameAdvanceStrategies[FrameAdvanceStrategyType::FRAME_ADVANCE_SINGLE_VSYNC]  = std::make_unique<SingleVsyncStrategy>(this);
+	frameAdvanceStrategies[FrameAdvanceStrategyType::FRAME_ADVANCE_EMULATOR_STEP] = std::make_unique<EmulatorStepStrategy>(this);
+#ifdef YUZU
+	frameAdvanceStrategy = frameAdvanceStrategies[FrameAdvanceStrategyType::FRAME_ADVANCE_EMULATOR_STEP].get();
+#else
+	frameAdvanceStrategy = frameAdvanceStrategies[FrameAdvanceStrategyType::FRAME_ADVANCE_VSYNC_UNPAUSE].get();
+#endif
+
+	luaScripting = std::make_shared<LuaScripting>();
+#ifdef YUZU
+	luaScripting->setYuzuSyscalls(yuzuSyscalls);
+#endif
+	luaScripting->setMemoryReader([this](uint64_t addr, uint8_t* buf, uint64_t size) {
+		return readMemory(addr, buf, size);
+	});
+	luaScripting->setInputSetter([this](uint8_t player, ControllerData& controllerData) {
+		if(player < controllers.size()) {
+			controllers[player]->setFrame(controllerData);
+		}
+	});
+	luaScripting->setErrorHandler([this](std::string message) {
+#ifdef SIMULATED
+		printf("%s\n", message.c_str());
+#endif
+		ADD_TO_QUEUE(RecieveLogging, networkInstance, {
+			data.log = message;
+		})
+	});
+
 #ifdef __SWITCH__
 	LOGD << "Open display";
 	ViDisplay disp;
@@ -96,14 +151,27 @@ void MainLoop::mainLoopHandler() {
 					// pauseApp();
 				}
 			}
+#endif
+#ifdef SIMULATED
+			if(!applicationOpened) {
+				gameName = "Simulated Game";
+				ADD_TO_QUEUE(RecieveApplicationConnected, networkInstance, {
+					data.applicationName      = gameName;
+					data.applicationProgramId = applicationProgramId;
+					data.applicationProcessId = applicationProcessId;
+				})
+
+				applicationOpened = true;
+			}
+
+			// The fake game keeps running in realtime while unpaused
+			simulatedPlatform->update();
 #endif
 		} else {
 			// I believe this means that there is no application running
 			// If there was just an application open, let the PC know
 			if(applicationOpened) {
-#ifdef __SWITCH__
-				LOGD << "Application closed";
-#endif
+				binaryLogger->log(LogEventId::LOG_APPLICATION_CLOSED);
 				// clang-format off
 			ADD_TO_QUEUE(RecieveFlag, networkInstance, {
 				data.actFlag = RecieveInfo::APPLICATION_DISCONNECTED;
@@ -116,16 +184,12 @@ void MainLoop::mainLoopHandler() {
 
 	if(networkInstance->isConnected()) {
 		if(!internetConnected) {
-#ifdef __SWITCH__
-			LOGD << "Internet connected";
-#endif
+			binaryLogger->log(LogEventId::LOG_INTERNET_CONNECTED);
 			internetConnected = true;
 		}
 	} else {
 		if(internetConnected) {
-#ifdef __SWITCH__
-			LOGD << "Internet disconnected";
-#endif
+			binaryLogger->log(LogEventId::LOG_INTERNET_DISCONNECTED);
 			internetConnected = false;
 
 			// Force unpause to not get user stuck if network cuts out
@@ -138,10 +202,32 @@ void MainLoop::mainLoopHandler() {
 		handleNetworkUpdates();
 	}
 
+	// Cheap unless the interval has passed
+	updateControllerCount(false);
+
 	// Match first controller inputs as often as possible
 	if(!isPaused) {
+		uint32_t passedVsyncs = 0;
+		if(luaScripting->isLoaded() || inputRecorder.isRecording()) {
+			passedVsyncs = countPassedVsyncs();
+		}
+
+		if(inputRecorder.isRecording()) {
+			recordRealInputs(passedVsyncs);
+		}
+
 		// TODO handle when running final TAS
-		matchFirstControllerToTASController(0);
+		// The game only reads input once a frame, polling every loop would just compete with it for HID
+		auto now = std::chrono::steady_clock::now();
+		if(now - lastControllerMirror >= controllerMirrorInterval) {
+			matchFirstControllerToTASController(inputRecorder.isRecording() ? inputRecorder.getPlayerIndex() : 0);
+			lastControllerMirror = now;
+		}
+
+		// While paused, Lua is run by the frame advance instead
+		if(luaScripting->isLoaded() && passedVsyncs != 0) {
+			luaScripting->runFrame();
+		}
 	}
 
 	std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -155,7 +241,7 @@ void MainLoop::handleNetworkUpdates() {
 			matchFirstControllerToTASController(data.playerIndex);
 			runSingleFrame(true, data.includeFramebuffer, true, data.frame, data.savestateHookNum, data.branchIndex, data.playerIndex);
 		} else {
-			controllers[data.playerIndex]->setFrame(data.controllerData);
+			setEditorInput(data.playerIndex, data.controllerData);
 		}
 	})
 
@@ -169,6 +255,7 @@ void MainLoop::handleNetworkUpdates() {
 		*/
 
 	CHECK_QUEUE(networkInstance, SendFlag, {
+		binaryLogger->log(LogEventId::LOG_RECIEVED_FLAG, data.actFlag);
 		if(data.actFlag == SendInfo::PAUSE_DEBUG) {
 			// Precaution to prevent the app getting stuck without the
 			// User able to unpause it
@@ -183,13 +270,16 @@ void MainLoop::handleNetworkUpdates() {
 				lastNanoseconds = 0;
 			}
 		} else if(data.actFlag == SendInfo::GET_FRAMEBUFFER) {
-			if(applicationOpened) {
-				// For now, unsupported
-				// screenshotHandler.writeFramebuffer(networkInstance, 0, 0, 0, 0);
+			// Resend the current frame, the app has to be paused
+			if(applicationOpened && isPaused) {
+				sendFramebuffer(false, true, false, 0, 0, 0, 0);
 			}
 		} else if(data.actFlag == SendInfo::RUN_BLANK_FRAME) {
 			matchFirstControllerToTASController(0);
 			runSingleFrame(false, true, false, 0, 0, 0, 0);
+		} else if(data.actFlag == SendInfo::RUN_BLANK_FRAME_DHASH_ONLY) {
+			matchFirstControllerToTASController(0);
+			runSingleFrame(false, false, false, 0, 0, 0, 0);
 		} else if(data.actFlag == SendInfo::START_TAS_MODE) {
 			// pauseApp(false, true, false, 0, 0, 0, 0);
 		} else if(data.actFlag == SendInfo::PAUSE) {
@@ -203,14 +293,14 @@ void MainLoop::handleNetworkUpdates() {
 			lastNanoseconds = 0;
 		} else if(data.actFlag == SendInfo::STOP_FINAL_TAS) {
 			finalTasShouldRun = false;
+		} else if(data.actFlag == SendInfo::GET_FRAME_ADVANCE_STATS) {
+			sendFrameAdvanceStats();
 		}
 	})
 
 	// clang-format off
 	CHECK_QUEUE(networkInstance, SendSetNumControllers, {
-		#ifdef __SWITCH__
-		LOGD << "Set controller number";
-		#endif
+		binaryLogger->log(LogEventId::LOG_SET_CONTROLLER_NUMBER, data.size);
 		setControllerNumber(data.size);
 	})
 	// clang-format on
@@ -233,11 +323,169 @@ void MainLoop::handleNetworkUpdates() {
 	// clang-format off
 	CHECK_QUEUE(networkInstance, SendStartFinalTas, {
 		finalTasShouldRun = true;
-		runFinalTas(data.scriptPaths);
+		runFinalTas(data);
+	})
+	// clang-format on
+
+	CHECK_QUEUE(networkInstance, SendLuaScript, {
+		if(data.path.empty()) {
+			luaScripting->endScript();
+		} else {
+			loadLuaScript(data.path, data.instructionBudget);
+		}
+	})
+
+	// clang-format off
+	CHECK_QUEUE(networkInstance, SendRewindOptions, {
+		savestateRing.setOptions(data.interval, data.memoryBudget);
+	})
+
+	CHECK_QUEUE(networkInstance, SendJumpToFrame, {
+		jumpToFrame(data);
+	})
+
+	CHECK_QUEUE(networkInstance, SendRamHashRanges, {
+		ramHashAddresses = data.addresses;
+		ramHashLengths   = data.lengths;
 	})
 	// clang-format on
 
-	// TODO add logic to handle lua scripting
+	CHECK_QUEUE(networkInstance, SendLagDetection, {
+		lagDetectionMethod = data.method;
+		lagCounterAddress  = data.counterAddress;
+		lagCounterSize     = data.counterSize;
+		skipLagFrames      = data.skipLagFrames;
+
+		uint64_t value;
+		if(lagDetectionMethod != LagDetectionMethod::LAG_DETECTION_NONE && !readLagValue(value)) {
+			// clang-format off
+			ADD_TO_QUEUE(RecieveLogging, networkInstance, {
+				data.log = "This lag detection method doesn't work here, no frames will be marked as lag";
+			})
+			// clang-format on
+		}
+	})
+
+	CHECK_QUEUE(networkInstance, SendFrameAdvanceStrategy, {
+		setFrameAdvanceStrategy(data.strategy, data.resetStats);
+	})
+
+	CHECK_QUEUE(networkInstance, SendInputRecording, {
+		if(data.recording) {
+			startInputRecording(data);
+		} else {
+			stopInputRecording();
+		}
+	})
+}
+
+void MainLoop::startInputRecording(Protocol::Struct_SendInputRecording& request) {
+	if(!applicationOpened || inputRecorder.isRecording()) {
+		return;
+	}
+
+#ifndef YUZU
+	// The real controller is recorded through the TAS controller it is copied into
+	if(request.playerIndex >= controllers.size()) {
+		// clang-format off
+		ADD_TO_QUEUE(RecieveLogging, networkInstance, {
+			data.log = "The player to record into doesn't have a controller";
+		})
+		// clang-format on
+		return;
+	}
+#endif
+
+	inputRecorder.start(request.savestateHookNum, request.branchIndex, request.playerIndex, request.startFrame);
+	// Frames from before now aren't part of the recording
+	countPassedVsyncs();
+
+	if(isPaused) {
+		waitForVsync();
+		unpauseApp();
+		lastNanoseconds = 0;
+	}
+}
+
+void MainLoop::stopInputRecording() {
+	if(!inputRecorder.isRecording()) {
+		return;
+	}
+
+	waitForVsync();
+	pauseApp(false, true, false, 0, 0, 0, 0);
+	lastNanoseconds = 0;
+
+	// Whatever ran after the last sample, on the switch the vsync above already took it
+	recordRealInputs(countPassedVsyncs());
+	sendRecordedInputs(true);
+	inputRecorder.stop();
+}
+
+void MainLoop::recordRealInputs(uint32_t frames) {
+	if(frames == 0) {
+		return;
+	}
+
+	ControllerData controllerData;
+	readRecordedInput(controllerData);
+	inputRecorder.addSamples(controllerData, frames);
+
+	if(inputRecorder.isBatchFull()) {
+		sendRecordedInputs(false);
+	}
+}
+
+void MainLoop::sendRecordedInputs(uint8_t finished) {
+	ADD_TO_QUEUE(RecieveRecordedInputs, networkInstance, {
+		inputRecorder.takeBatch(data);
+		data.finished = finished;
+	})
+}
+
+void MainLoop::readRecordedInput(ControllerData& controllerData) {
+	uint8_t player = inputRecorder.getPlayerIndex();
+#ifdef YUZU
+	// Yuzu gives the real controller to the game directly
+	yuzuSyscalls->readJoypad(player, controllerData);
+#else
+	if(player < controllers.size()) {
+		controllerData = *controllers[player]->getControllerData();
+	}
+#endif
+}
+
+void MainLoop::setFrameAdvanceStrategy(FrameAdvanceStrategyType type, uint8_t resetStats) {
+	if(type >= FrameAdvanceStrategyType::NUM_OF_FRAME_ADVANCE_STRATEGIES || !frameAdvanceStrategies[type]->isSupported()) {
+		// clang-format off
+		ADD_TO_QUEUE(RecieveLogging, networkInstance, {
+			data.log = "This frame advance strategy doesn't work here, keeping the current one";
+		})
+		// clang-format on
+		return;
+	}
+
+	frameAdvanceStrategy = frameAdvanceStrategies[type].get();
+	if(resetStats) {
+		frameAdvanceStrategy->getStats().reset();
+	}
+}
+
+void MainLoop::sendFrameAdvanceStats() {
+	for(auto& strategy : frameAdvanceStrategies) {
+		FrameAdvanceStats& stats = strategy->getStats();
+		ADD_TO_QUEUE(RecieveFrameAdvanceStats, networkInstance, {
+			data.strategy                = strategy->getType();
+			data.supported               = strategy->isSupported();
+			data.active                  = strategy.get() == frameAdvanceStrategy;
+			data.frames                  = stats.getFrames();
+			data.averageNanoseconds      = stats.getAverage();
+			data.minNanoseconds          = stats.getMin();
+			data.medianNanoseconds       = stats.getPercentile(50);
+			data.percentile99Nanoseconds = stats.getPercentile(99);
+			data.maxNanoseconds          = stats.getMax();
+		})
+	}
 }
 
 void MainLoop::sendGameInfo() {
@@ -248,9 +496,9 @@ void MainLoop::sendGameInfo() {
 		// Will get more info via
 		// https://github.com/switchbrew/switch-examples/blob/master/account/source/main.c
 
-		uint64_t addr = 0;
 		pauseApp(false, true, false, 0, 0, 0, 0);
 #ifdef __SWITCH__
+		uint64_t addr = 0;
 		while(true) {
 			MemoryInfo info = { 0 };
 			uint32_t pageinfo;
@@ -293,44 +541,64 @@ char* MainLoop::getAppName(u64 application_id) {
 }
 #endif
 
-uint8_t MainLoop::getNumControllers() {
-#ifdef __SWITCH__
+uint8_t MainLoop::scanNumControllers() {
 	uint8_t num = 0;
 
+#ifdef __SWITCH__
 	hidScanInput();
 	for(int i = 0; i < 10; i++) {
 		if(hidIsControllerConnected((HidControllerID)i)) {
 			num++;
 		}
 	}
+#endif
 
-	return num;
+#ifdef SIMULATED
+	num = simulatedPlatform->getNumControllers();
 #endif
+
+	return num;
+}
+
+void MainLoop::updateControllerCount(uint8_t force) {
+	auto now = std::chrono::steady_clock::now();
+	if(force || now - lastControllerScan >= controllerScanInterval) {
+		numControllersCache = scanNumControllers();
+		lastControllerScan  = now;
+	}
 }
 
 void MainLoop::setControllerNumber(uint8_t numOfControllers) {
-#ifdef __SWITCH__
 	controllers.clear();
+	// Recorded inputs are per player, they don't mean anything anymore
+	editorInputs.clear();
+	savestateRing.clear();
 	// Wait for all controllers to be disconnected
-	LOGD << (int)getNumControllers();
-	while(getNumControllers() != 0) {
+#ifdef __SWITCH__
+	LOGD << (int)scanNumControllers();
+#endif
+	while(scanNumControllers() != 0) {
 		std::this_thread::sleep_for(std::chrono::milliseconds(1));
 	}
 	for(uint8_t i = 0; i < numOfControllers; i++) {
+#ifdef SIMULATED
+		controllers.push_back(std::make_unique<ControllerHandler>(networkInstance, simulatedPlatform));
+#else
 		controllers.push_back(std::make_unique<ControllerHandler>(networkInstance));
+#endif
 	}
+	updateControllerCount(true);
 	// clang-format off
 	ADD_TO_QUEUE(RecieveFlag, networkInstance, {
 		data.actFlag = RecieveInfo::CONTROLLERS_CONNECTED;
 	})
 	// clang-format on
 	// Now, user is required to reconnect any controllers manually
-#endif
 }
 
-void MainLoop::runFinalTas(std::vector<std::string> scriptPaths) {
+uint8_t MainLoop::runFinalTas(Protocol::Struct_SendStartFinalTas& options) {
 	std::vector<FILE*> files;
-	for(auto const& path : scriptPaths) {
+	for(auto const& path : options.scriptPaths) {
 		files.push_back(fopen(path.c_str(), "rb"));
 	}
 
@@ -340,21 +608,56 @@ void MainLoop::runFinalTas(std::vector<std::string> scriptPaths) {
 	unpauseApp();
 	lastNanoseconds = 0;
 
-	while(true) {
+	uint8_t fastForward = options.fastForward && setFastForward(true);
+	if(options.fastForward && !fastForward) {
+		// clang-format off
+		ADD_TO_QUEUE(RecieveLogging, networkInstance, {
+			data.log = "Fast forward is not supported here, running in realtime";
+		})
+		// clang-format on
+	}
+
+	uint64_t startNanoseconds = getNanoseconds();
+	uint32_t framesRun        = 0;
+	size_t nextCheckpoint     = 0;
+	uint8_t finished          = false;
+	uint8_t desynced          = false;
+	uint32_t ramMismatchFrame = UINT32_MAX;
+
+	finalTasRamHashes.clear();
+
+	while(!finished && !desynced) {
 		// Run half a second of data before checking network
 		if(!finalTasShouldRun)
 			break;
 
 		for(uint8_t i = 0; i < 30; i++) {
-			// File reading can't slow down at all
+			// Checked before the frame, so a checkpoint at the very end still runs
+			while(nextCheckpoint < options.checkpointFrames.size() && options.checkpointFrames[nextCheckpoint] <= framesRun) {
+				if(options.checkpointFrames[nextCheckpoint] == framesRun && !checkFinalTasCheckpoint(framesRun, options.checkpointDhashes[nextCheckpoint], options.checkpointTolerance)) {
+					desynced = true;
+				}
+				nextCheckpoint++;
+			}
 
+			if(desynced) {
+				break;
+			}
+
+			// File reading can't slow down at all
 			for(uint8_t player = 0; player < filesSize; player++) {
 				// Based on code in project handler without compression
 				uint8_t controllerSize;
-				readFullFileData(files[player], &controllerSize, sizeof(controllerSize));
+				if(files[player] == NULL || !readFullFileData(files[player], &controllerSize, sizeof(controllerSize))) {
+					finished = true;
+					break;
+				}
 
 				uint8_t controllerDataBuf[controllerSize];
-				readFullFileData(files[player], controllerDataBuf, sizeof(controllerDataBuf));
+				if(!readFullFileData(files[player], controllerDataBuf, sizeof(controllerDataBuf))) {
+					finished = true;
+					break;
+				}
 
 				ControllerData data;
 				serializeProtocol.binaryToData<ControllerData>(data, controllerDataBuf, controllerSize);
@@ -362,16 +665,115 @@ void MainLoop::runFinalTas(std::vector<std::string> scriptPaths) {
 				controllers[player]->setFrame(data);
 			}
 
+			if(finished) {
+				break;
+			}
+
+			luaScripting->runFrame();
+
 			// Either put this before or after
-			waitForVsync();
+			waitForFinalTasFrame(fastForward);
+			framesRun++;
+
+			if(!ramHashAddresses.empty()) {
+				// 0 keeps the place of a frame that couldn't be read
+				uint64_t ramHash = 0;
+				hashRam(ramHash);
+				finalTasRamHashes.push_back(ramHash);
+
+				uint64_t expected = framesRun <= options.expectedRamHashes.size() ? options.expectedRamHashes[framesRun - 1] : 0;
+				if(ramHash != 0 && expected != 0 && ramHash != expected) {
+					ramMismatchFrame = framesRun;
+					desynced         = true;
+#ifdef SIMULATED
+					printf("RAM hash mismatch after %u frames: %016llx, expected %016llx\n", framesRun, (unsigned long long)ramHash, (unsigned long long)expected);
+#endif
+					break;
+				}
+			}
 		}
 
 		handleNetworkUpdates();
 	}
 
+	if(fastForward) {
+		setFastForward(false);
+	}
+
+	uint64_t elapsedNanoseconds = getNanoseconds() - startNanoseconds;
+#ifdef SIMULATED
+	printf("Final TAS %s after %u frames in %.3f seconds\n", desynced ? "desynced" : "stopped", framesRun, elapsedNanoseconds / 1000000000.0);
+#endif
+
+	ADD_TO_QUEUE(RecieveFinalTasFinished, networkInstance, {
+		data.framesRun          = framesRun;
+		data.elapsedNanoseconds = elapsedNanoseconds;
+		data.fastForward        = fastForward;
+		data.desynced           = desynced;
+		data.ramHashes          = finalTasRamHashes;
+		data.ramMismatchFrame   = ramMismatchFrame;
+	})
+
 	for(auto const& file : files) {
-		fclose(file);
+		if(file != NULL) {
+			fclose(file);
+		}
+	}
+
+	return !desynced;
+}
+
+uint8_t MainLoop::setFastForward(uint8_t enabled) {
+	uint8_t succeeded = false;
+#ifdef YUZU
+	if(yuzuSyscalls->function_emu_speedmode && yuzuSyscalls->function_emu_frameadvance && yuzuSyscalls->function_emu_pause && yuzuSyscalls->function_emu_unpause) {
+		void* instance = yuzuSyscalls->getYuzuInstance();
+		if(enabled) {
+			// Paused so every frame is an explicit frame advance, unthrottled so they return right away
+			yuzuSyscalls->function_emu_speedmode(instance, (char*)"maximum");
+			yuzuSyscalls->function_emu_pause(instance);
+		} else {
+			yuzuSyscalls->function_emu_speedmode(instance, (char*)"normal");
+			yuzuSyscalls->function_emu_unpause(instance);
+		}
+		succeeded = true;
+	}
+#endif
+#ifdef SIMULATED
+	if(enabled) {
+		wasThrottled = simulatedPlatform->isThrottled();
+		simulatedPlatform->setThrottled(false);
+	} else {
+		simulatedPlatform->setThrottled(wasThrottled);
 	}
+	succeeded = true;
+#endif
+	return succeeded;
+}
+
+uint8_t MainLoop::checkFinalTasCheckpoint(uint32_t frame, uint64_t expectedDhash, uint8_t tolerance) {
+	uint64_t dhash = 0;
+	if(!screenshotHandler.calculateDhash(dhash)) {
+		// Nothing to compare against, don't stop the TAS for it
+		return true;
+	}
+
+	uint16_t hammingDistance = __builtin_popcountll(dhash ^ expectedDhash);
+	uint8_t matched          = hammingDistance <= tolerance;
+
+#ifdef SIMULATED
+	printf("Checkpoint at frame %u: %016llx, expected %016llx, %s\n", frame, (unsigned long long)dhash, (unsigned long long)expectedDhash, matched ? "matched" : "DESYNC");
+#endif
+
+	ADD_TO_QUEUE(RecieveFinalTasCheckpoint, networkInstance, {
+		data.frame           = frame;
+		data.expectedDhash   = expectedDhash;
+		data.dhash           = dhash;
+		data.hammingDistance = hammingDistance;
+		data.matched         = matched;
+	})
+
+	return matched;
 }
 
 #ifdef __SWITCH__
@@ -391,15 +793,267 @@ GameMemoryInfo MainLoop::getGameMemoryInfo(MemoryInfo memInfo) {
 
 void MainLoop::runSingleFrame(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint8_t autoAdvance, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex) {
 	if(isPaused) {
-#ifdef __SWITCH__
-		LOGD << "Running frame";
+		binaryLogger->log(LogEventId::LOG_RUNNING_FRAME, frame);
+		// Blank frames don't belong to any frame of the TAS
+		uint8_t rewindable = linkedWithFrameAdvance && canRewind();
+		if(rewindable) {
+			prepareRewindFrame(frame, savestateHookNum, branchIndex);
+		}
+
+		uint64_t lagValueBefore = 0;
+		uint8_t detectLag       = linkedWithFrameAdvance && readLagValue(lagValueBefore);
+		lagFramesSkipped        = 0;
+
+		while(true) {
+			// Lua sees the paused game and can override the inputs for this frame
+			luaScripting->runFrame();
+			frameAdvanceStrategy->runFrame();
+
+			uint64_t lagValueAfter = 0;
+			lastFrameLagged        = detectLag && readLagValue(lagValueAfter) && lagValueAfter == lagValueBefore;
+			if(!lastFrameLagged || !autoAdvance || !skipLagFrames || lagFramesSkipped == MAX_SKIPPED_LAG_FRAMES) {
+				break;
+			}
+
+			// The game never read the inputs, so they are held for another frame
+			binaryLogger->log(LogEventId::LOG_RUNNING_FRAME, frame);
+			lagFramesSkipped++;
+		}
+
+		acknowledgeFrame(linkedWithFrameAdvance, includeFramebuffer, autoAdvance, frame, savestateHookNum, branchIndex, playerIndex);
+
+		if(rewindable) {
+			if(lagFramesSkipped != 0) {
+				// The PC adds the skipped frames in front, so the frames after this don't line up anymore
+				savestateRing.invalidateFrom(frame);
+			} else {
+				finishRewindFrame(frame);
+			}
+		}
+
+		lastFrameLagged  = false;
+		lagFramesSkipped = 0;
+	}
+}
+
+uint8_t MainLoop::readLagValue(uint64_t& value) {
+	uint8_t succeeded = false;
+	switch(lagDetectionMethod) {
+	case LagDetectionMethod::LAG_DETECTION_RAM_COUNTER:
+		value     = 0;
+		succeeded = lagCounterSize != 0 && lagCounterSize <= sizeof(value) && readMemory(lagCounterAddress, (uint8_t*)&value, lagCounterSize);
+		break;
+	case LagDetectionMethod::LAG_DETECTION_FRAMEBUFFER:
+		// Don't read the screen at the same time as the worker
+		captureWorker->waitForCapture();
+		succeeded = screenshotHandler.hashFramebuffer(value);
+		break;
+	case LagDetectionMethod::LAG_DETECTION_INPUT_POLL:
+		// The switch can't see another process reading HID
+#ifdef YUZU
+		succeeded = yuzuSyscalls->readInputPollCount(value);
 #endif
-		waitForVsync();
-		unpauseApp();
-		waitForVsync();
-		pauseApp(linkedWithFrameAdvance, includeFramebuffer, autoAdvance, frame, savestateHookNum, branchIndex, playerIndex);
+#ifdef SIMULATED
+		value     = simulatedPlatform->getInputPollCount();
+		succeeded = true;
+#endif
+		break;
+	default:
+		break;
+	}
+	return succeeded;
+}
+
+void MainLoop::prepareRewindFrame(uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex) {
+	savestateRing.setContext(savestateHookNum, branchIndex);
+
+	editorInputs.resize(controllers.size());
+	// Throws away the states after this frame if it was run differently before
+	savestateRing.recordInputs(frame, editorInputs);
+
+	// Whatever the first advance starts from is what everything else can be replayed from
+	if(savestateRing.isEmpty() && frame != 0 && saveEmulatorState(savestateBuf)) {
+		savestateRing.addState(frame - 1, savestateBuf);
+	}
+}
+
+void MainLoop::finishRewindFrame(uint32_t frame) {
+	if(savestateRing.wantsState(frame) && saveEmulatorState(savestateBuf)) {
+		savestateRing.addState(frame, savestateBuf);
+	}
+}
+
+void MainLoop::replayFrame() {
+#ifdef YUZU
+	yuzuSyscalls->function_emu_frameadvance(yuzuSyscalls->getYuzuInstance());
+#endif
+#ifdef SIMULATED
+	simulatedPlatform->unpause();
+	simulatedPlatform->waitForVsync();
+	simulatedPlatform->pause();
+#endif
+}
+
+void MainLoop::jumpToFrame(Protocol::Struct_SendJumpToFrame& request) {
+	uint64_t startNanoseconds = getNanoseconds();
+	uint32_t restoredFrame    = 0;
+	uint32_t framesReplayed   = 0;
+	uint8_t succeeded         = false;
+	uint8_t inputsMissing     = false;
+
+	if(isPaused && canRewind() && request.numOfPlayers == controllers.size() && request.numOfPlayers != 0) {
+		savestateRing.setContext(request.savestateHookNum, request.branchIndex);
+
+		// Editing a frame makes every state after it useless
+		uint32_t firstDifference = savestateRing.findFirstDifference(request.firstFrame, request.numOfPlayers, request.inputs);
+		if(firstDifference != UINT32_MAX) {
+			savestateRing.invalidateFrom(firstDifference);
+		}
+
+		uint32_t numOfFrames = request.inputs.size() / request.numOfPlayers;
+		uint8_t inputsFit    = request.frame < request.firstFrame + numOfFrames;
+
+		uint8_t hasState = inputsFit && savestateRing.restoreNearest(request.frame, restoredFrame, savestateBuf);
+		// Every frame between the state and the target needs inputs to replay, the PC only sent the ones after firstFrame
+		for(uint32_t frame = restoredFrame + 1; hasState && frame < request.firstFrame && frame <= request.frame; frame++) {
+			if(!savestateRing.getInputs(frame, request.numOfPlayers)) {
+				inputsMissing = true;
+				break;
+			}
+		}
+
+		if(hasState && !inputsMissing) {
+			// The capture worker reads the screen, it can't change under it
+			captureWorker->waitForCapture();
+
+			if(loadEmulatorState(savestateBuf)) {
+#ifdef YUZU
+				// Replaying only takes longer without it
+				if(yuzuSyscalls->function_emu_speedmode) {
+					yuzuSyscalls->function_emu_speedmode(yuzuSyscalls->getYuzuInstance(), (char*)"maximum");
+				}
+#endif
+#ifdef SIMULATED
+				uint8_t throttled = simulatedPlatform->isThrottled();
+				simulatedPlatform->setThrottled(false);
+#endif
+
+				for(uint32_t frame = restoredFrame + 1; frame <= request.frame; frame++) {
+					if(frame < request.firstFrame) {
+						const std::vector<ControllerData>& recorded = *savestateRing.getInputs(frame, request.numOfPlayers);
+						for(uint8_t player = 0; player < request.numOfPlayers; player++) {
+							ControllerData input = recorded[player];
+							setEditorInput(player, input);
+						}
+					} else {
+						size_t offset = (size_t)(frame - request.firstFrame) * request.numOfPlayers;
+						for(uint8_t player = 0; player < request.numOfPlayers; player++) {
+							setEditorInput(player, request.inputs[offset + player]);
+						}
+					}
+					savestateRing.recordInputs(frame, editorInputs);
+
+					replayFrame();
+					framesReplayed++;
+
+					finishRewindFrame(frame);
+				}
+
+#ifdef YUZU
+				if(yuzuSyscalls->function_emu_speedmode) {
+					yuzuSyscalls->function_emu_speedmode(yuzuSyscalls->getYuzuInstance(), (char*)"normal");
+				}
+#endif
+#ifdef SIMULATED
+				simulatedPlatform->setThrottled(throttled);
+#endif
+				succeeded = true;
+			}
+		}
+	}
+
+	uint64_t elapsedNanoseconds = getNanoseconds() - startNanoseconds;
+#ifdef SIMULATED
+	printf("Jump to frame %u %s, restored frame %u and replayed %u frames in %.3f ms, %zu states using %llu bytes\n", request.frame, succeeded ? "succeeded" : "failed", restoredFrame, framesReplayed, elapsedNanoseconds / 1000000.0, savestateRing.getNumOfStates(), (unsigned long long)savestateRing.getMemoryUsed());
+#endif
+
+	if(succeeded) {
+		sendFramebuffer(false, request.includeFramebuffer, false, request.frame, request.savestateHookNum, request.branchIndex, request.playerIndex);
+	}
+
+	ADD_TO_QUEUE(RecieveJumpToFrame, networkInstance, {
+		data.frame              = request.frame;
+		data.savestateHookNum   = request.savestateHookNum;
+		data.branchIndex        = request.branchIndex;
+		data.succeeded          = succeeded;
+		data.inputsMissing      = inputsMissing;
+		data.restoredFrame      = restoredFrame;
+		data.framesReplayed     = framesReplayed;
+		data.elapsedNanoseconds = elapsedNanoseconds;
+	})
+}
+
+#ifdef SIMULATED
+uint8_t MainLoop::runRewindBenchmark(uint32_t frames) {
+	setControllerNumber(1);
+	simulatedPlatform->setThrottled(false);
+	pauseApp(false, false, false, 0, 0, 0, 0);
+
+	// Moves the player around without getting stuck on the edge of the screen
+	std::vector<ControllerData> inputs(frames);
+	for(uint32_t i = 0; i < frames; i++) {
+		inputs[i].LS_X = (i / 40) % 2 ? -20000 : 20000;
+		inputs[i].LS_Y = (i / 70) % 2 ? -12000 : 12000;
+		if(i % 7 == 0) {
+			SET_BIT(inputs[i].buttons, true, Btn::A);
+		}
+	}
+
+	uint64_t startNanoseconds = getNanoseconds();
+	for(uint32_t frame = 1; frame <= frames; frame++) {
+		setEditorInput(0, inputs[frame - 1]);
+		runSingleFrame(true, false, false, frame, 0, 0, 0);
 	}
+	printf("Advanced %u frames in %.3f ms, %zu states using %llu bytes\n", frames, (getNanoseconds() - startNanoseconds) / 1000000.0, savestateRing.getNumOfStates(), (unsigned long long)savestateRing.getMemoryUsed());
+
+	std::vector<uint8_t> originalState;
+	simulatedPlatform->saveState(originalState);
+
+	Protocol::Struct_SendJumpToFrame request;
+	request.frame              = frames;
+	request.savestateHookNum   = 0;
+	request.branchIndex        = 0;
+	request.playerIndex        = 0;
+	request.includeFramebuffer = false;
+	request.firstFrame         = 1;
+	request.numOfPlayers       = 1;
+	request.inputs             = inputs;
+
+	// Editing a frame in the middle only replays from the state before it
+	uint32_t editedIndex = frames / 2;
+	request.inputs[editedIndex].LS_X = -request.inputs[editedIndex].LS_X;
+	jumpToFrame(request);
+	std::vector<uint8_t> editedState;
+	simulatedPlatform->saveState(editedState);
+
+	// Undoing it has to give back exactly the same game
+	request.inputs[editedIndex].LS_X = -request.inputs[editedIndex].LS_X;
+	jumpToFrame(request);
+	std::vector<uint8_t> restoredState;
+	simulatedPlatform->saveState(restoredState);
+
+	// Going back without edits, the switch already has every input before the frame
+	request.frame      = frames / 3;
+	request.firstFrame = request.frame;
+	request.inputs     = { inputs[request.frame - 1] };
+	jumpToFrame(request);
+
+	uint8_t diverged = editedState != originalState;
+	uint8_t matched  = restoredState == originalState;
+	printf("Edited run %s, state after undoing the edit %s\n", diverged ? "diverged" : "DID NOT DIVERGE", matched ? "matches" : "DOES NOT MATCH");
+	return diverged && matched;
 }
+#endif
 
 void MainLoop::clearEveryController() {
 	for(uint8_t i = 0; i < controllers.size(); i++) {
@@ -409,134 +1063,252 @@ void MainLoop::clearEveryController() {
 }
 
 void MainLoop::pauseApp(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint8_t autoAdvance, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex) {
+	if(!isPaused) {
+		pauseGame();
+		acknowledgeFrame(linkedWithFrameAdvance, includeFramebuffer, autoAdvance, frame, savestateHookNum, branchIndex, playerIndex);
+	}
+}
+
+void MainLoop::pauseGame() {
 	// This is aborting for some reason
 	if(!isPaused) {
 		// Debug application again
 
+		binaryLogger->log(LogEventId::LOG_PAUSING);
 #ifdef __SWITCH__
-		LOGD << "Pausing";
-		rc = svcDebugActiveProcess(&applicationDebug, applicationProcessId);
-		if(lastNanoseconds != 0) {
-			LOGD << "Time taken between frames: " << (int)((armTicksToNs(armGetSystemTick()) - lastNanoseconds) / 1000000);
-		}
+		rc       = svcDebugActiveProcess(&applicationDebug, applicationProcessId);
 		isPaused = true;
 #endif
+#ifdef YUZU
+		yuzuSyscalls->function_emu_pause(yuzuSyscalls->getYuzuInstance());
+		isPaused = true;
+#endif
+#ifdef SIMULATED
+		simulatedPlatform->pause();
+		isPaused = true;
+#endif
+		if(lastNanoseconds != 0) {
+			binaryLogger->log(LogEventId::LOG_FRAME_TIME, (getNanoseconds() - lastNanoseconds) / 1000000);
+		}
+	}
+}
 
-		if(networkInstance->isConnected()) {
-			// Framebuffers should not be stored in memory unless they will be sent over internet
-			std::vector<uint8_t> jpegBuf;
-			std::string dhash;
-
-			if(includeFramebuffer) {
-				screenshotHandler.writeFramebuffer(jpegBuf, dhash);
+void MainLoop::acknowledgeFrame(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint8_t autoAdvance, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex) {
+	if(networkInstance->isConnected()) {
+		// Acknowledge the advance now, the capture is sent by the worker afterwards
+		uint8_t captureFollows = captureWorker->hasFreeBuffer();
+
+		uint64_t ramHash        = 0;
+		uint8_t ramHashIncluded = hashRam(ramHash);
+
+		ADD_TO_QUEUE(RecieveGameFramebuffer, networkInstance, {
+			data.fromFrameAdvance       = linkedWithFrameAdvance;
+			data.frame                  = frame;
+			data.savestateHookNum       = savestateHookNum;
+			data.branchIndex            = branchIndex;
+			data.playerIndex            = playerIndex;
+			data.controllerDataIncluded = autoAdvance;
+			if(autoAdvance) {
+				data.controllerData = *controllers[0]->getControllerData();
 			}
+			data.dhashIncluded     = false;
+			data.captureFollows    = captureFollows;
+			data.fromCaptureWorker = false;
+			data.ramHashIncluded   = ramHashIncluded;
+			data.ramHash           = ramHash;
+			data.isLagFrame        = lastFrameLagged;
+			data.lagFramesSkipped  = lagFramesSkipped;
+		})
+
+		if(captureFollows) {
+			// The PC puts the skipped lag frames first, the capture belongs to the frame after them
+			captureWorker->requestCapture(linkedWithFrameAdvance, includeFramebuffer, frame + lagFramesSkipped, savestateHookNum, branchIndex, playerIndex);
+		}
 
-			ADD_TO_QUEUE(RecieveGameFramebuffer, networkInstance, {
-				data.buf = jpegBuf;
-				// if(includeFramebuffer) {
-				//	data.dhash = dhash;
-				//}
-				data.fromFrameAdvance       = linkedWithFrameAdvance;
-				data.frame                  = frame;
-				data.savestateHookNum       = savestateHookNum;
-				data.branchIndex            = branchIndex;
-				data.playerIndex            = playerIndex;
-				data.controllerDataIncluded = autoAdvance;
-				if(autoAdvance) {
-					data.controllerData = *controllers[0]->getControllerData();
+		// TODO set main and handle types correctly
+		// Every region is read in one go, then split up
+		std::vector<uint64_t> regionAddresses(currentMemoryRegions.size());
+		std::vector<uint64_t> regionLengths(currentMemoryRegions.size());
+		uint64_t totalLength = 0;
+		for(uint16_t i = 0; i < currentMemoryRegions.size(); i++) {
+			regionAddresses[i] = 0; // currentMemoryRegions[i].func.Eval();
+			regionLengths[i]   = getMemoryRegionSize(currentMemoryRegions[i]);
+			totalLength += regionLengths[i];
+		}
+
+		std::vector<uint8_t> allRegions(totalLength);
+		if(!currentMemoryRegions.empty()) {
+			readMemoryRanges(regionAddresses, regionLengths, allRegions.data());
+		}
+
+		uint64_t regionOffset = 0;
+		for(uint16_t i = 0; i < currentMemoryRegions.size(); i++) {
+			uint8_t isUnsigned = currentMemoryRegions[i].u;
+
+			MemoryRegionTypes type = currentMemoryRegions[i].type;
+			std::vector<uint8_t> bytes(allRegions.begin() + regionOffset, allRegions.begin() + regionOffset + regionLengths[i]);
+			std::string stringVersion;
+			regionOffset += regionLengths[i];
+
+			switch(type) {
+			case MemoryRegionTypes::Bit8:
+				if(isUnsigned) {
+					stringVersion = std::to_string(*(uint8_t*)bytes.data());
+				} else {
+					stringVersion = std::to_string(*(int8_t*)bytes.data());
 				}
+				break;
+			case MemoryRegionTypes::Bit16:
+				if(isUnsigned) {
+					stringVersion = std::to_string(*(uint16_t*)bytes.data());
+				} else {
+					stringVersion = std::to_string(*(int16_t*)bytes.data());
+				}
+				break;
+			case MemoryRegionTypes::Bit32:
+				if(isUnsigned) {
+					stringVersion = std::to_string(*(uint32_t*)bytes.data());
+				} else {
+					stringVersion = std::to_string(*(int32_t*)bytes.data());
+				}
+				break;
+			case MemoryRegionTypes::Bit64:
+				if(isUnsigned) {
+					stringVersion = std::to_string(*(uint64_t*)bytes.data());
+				} else {
+					stringVersion = std::to_string(*(int64_t*)bytes.data());
+				}
+				break;
+			case MemoryRegionTypes::Float:
+				stringVersion = std::to_string(*(float*)bytes.data());
+				break;
+			case MemoryRegionTypes::Double:
+				stringVersion = std::to_string(*(double*)bytes.data());
+				break;
+			case MemoryRegionTypes::Bool:
+				stringVersion = *(bool*)bytes.data() ? "1" : "0";
+				break;
+			case MemoryRegionTypes::CharPointer:
+				stringVersion = std::string((const char*)bytes.data(), bytes.size());
+				break;
+			case MemoryRegionTypes::ByteArray:
+				// Unused
+				stringVersion = "";
+				break;
+			default:
+				break;
+			}
+
+			ADD_TO_QUEUE(RecieveMemoryRegion, networkInstance, {
+				data.memory               = bytes;
+				data.stringRepresentation = stringVersion;
+				data.index                = i;
 			})
+		}
 
-			// TODO set main and handle types correctly
-			// Put data into a vector<uint_t> first
-			for(uint16_t i = 0; i < currentMemoryRegions.size(); i++) {
-				uint64_t addr      = 0; // currentMemoryRegions[i].func.Eval();
-				uint8_t isUnsigned = currentMemoryRegions[i].u;
-
-				MemoryRegionTypes type = currentMemoryRegions[i].type;
-				std::vector<uint8_t> bytes;
-				std::string stringVersion;
-
-				switch(type) {
-				case MemoryRegionTypes::Bit8:
-					bytes = getMemory(addr, sizeof(uint8_t));
-					if(isUnsigned) {
-						stringVersion = std::to_string(*(uint8_t*)bytes.data());
-					} else {
-						stringVersion = std::to_string(*(int8_t*)bytes.data());
-					}
-					break;
-				case MemoryRegionTypes::Bit16:
-					bytes = getMemory(addr, sizeof(uint16_t));
-					if(isUnsigned) {
-						stringVersion = std::to_string(*(uint16_t*)bytes.data());
-					} else {
-						stringVersion = std::to_string(*(int16_t*)bytes.data());
-					}
-					break;
-				case MemoryRegionTypes::Bit32:
-					bytes = getMemory(addr, sizeof(uint32_t));
-					if(isUnsigned) {
-						stringVersion = std::to_string(*(uint32_t*)bytes.data());
-					} else {
-						stringVersion = std::to_string(*(int32_t*)bytes.data());
-					}
-					break;
-				case MemoryRegionTypes::Bit64:
-					bytes = getMemory(addr, sizeof(uint64_t));
-					if(isUnsigned) {
-						stringVersion = std::to_string(*(uint64_t*)bytes.data());
-					} else {
-						stringVersion = std::to_string(*(int64_t*)bytes.data());
+		/*
+					for(auto const& memoryRegion : memoryRegions) {
+						std::vector<uint8_t> buf(memoryRegion.second);
+						svcReadDebugProcessMemory(buf.data(), applicationDebug, memoryRegion.first, memoryRegion.second);
+
+						ADD_TO_QUEUE(RecieveMemoryRegion, networkInstance, {
+							data.startByte = memoryRegion.first;
+							data.size      = memoryRegion.second;
+							data.memory    = buf;
+						})
 					}
-					break;
-				case MemoryRegionTypes::Float:
-					bytes         = getMemory(addr, sizeof(float));
-					stringVersion = std::to_string(*(float*)bytes.data());
-					break;
-				case MemoryRegionTypes::Double:
-					bytes         = getMemory(addr, sizeof(double));
-					stringVersion = std::to_string(*(double*)bytes.data());
-					break;
-				case MemoryRegionTypes::Bool:
-					bytes         = getMemory(addr, sizeof(bool));
-					stringVersion = *(bool*)bytes.data() ? "1" : "0";
-					break;
-				case MemoryRegionTypes::CharPointer:
-					bytes         = getMemory(addr, currentMemoryRegions[i].size);
-					stringVersion = std::string((const char*)bytes.data(), bytes.size());
-					break;
-				case MemoryRegionTypes::ByteArray:
-					bytes = getMemory(addr, currentMemoryRegions[i].size);
-					// Unused
-					stringVersion = "";
-					break;
-				}
+					*/
+	}
+}
 
-				ADD_TO_QUEUE(RecieveMemoryRegion, networkInstance, {
-					data.memory               = bytes;
-					data.stringRepresentation = stringVersion;
-					data.index                = i;
-				})
-			}
+void MainLoop::sendFramebuffer(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint8_t autoAdvance, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex) {
+	// Don't read the screen at the same time as the worker
+	captureWorker->waitForCapture();
 
-			/*
-						for(auto const& memoryRegion : memoryRegions) {
-							std::vector<uint8_t> buf(memoryRegion.second);
-							svcReadDebugProcessMemory(buf.data(), applicationDebug, memoryRegion.first, memoryRegion.second);
+	// Framebuffers should not be stored in memory unless they will be sent over internet
+	std::vector<uint8_t> jpegBuf;
+	if(includeFramebuffer) {
+		screenshotHandler.writeFramebuffer(jpegBuf);
+	}
 
-							ADD_TO_QUEUE(RecieveMemoryRegion, networkInstance, {
-								data.startByte = memoryRegion.first;
-								data.size      = memoryRegion.second;
-								data.memory    = buf;
-							})
-						}
-						*/
+	// The dHash is always sent, it's tiny and the PC doesn't have to decode the JPEG
+	uint64_t dhash        = 0;
+	uint8_t dhashIncluded = screenshotHandler.calculateDhash(dhash);
+
+	uint64_t ramHash        = 0;
+	uint8_t ramHashIncluded = hashRam(ramHash);
+
+	ADD_TO_QUEUE(RecieveGameFramebuffer, networkInstance, {
+		data.buf                    = jpegBuf;
+		data.fromFrameAdvance       = linkedWithFrameAdvance;
+		data.frame                  = frame;
+		data.savestateHookNum       = savestateHookNum;
+		data.branchIndex            = branchIndex;
+		data.playerIndex            = playerIndex;
+		data.controllerDataIncluded = autoAdvance;
+		if(autoAdvance) {
+			data.controllerData = *controllers[0]->getControllerData();
 		}
+		data.dhashIncluded     = dhashIncluded;
+		data.dhash             = dhash;
+		data.captureFollows    = false;
+		data.fromCaptureWorker = false;
+		data.ramHashIncluded   = ramHashIncluded;
+		data.ramHash           = ramHash;
+		data.isLagFrame        = false;
+		data.lagFramesSkipped  = 0;
+	})
+}
+
+uint8_t MainLoop::hashRam(uint64_t& hash) {
+	if(ramHashAddresses.empty()) {
+		return false;
+	}
+
+	ramHasher.reset();
+	ramHashChunk.resize(RAM_HASH_CHUNK_SIZE);
+
+	// Small ranges are batched into one read, big ones are split up, every read fills the chunk
+	std::vector<uint64_t> batchAddresses;
+	std::vector<uint64_t> batchLengths;
+	uint64_t batchSize = 0;
+
+	auto hashBatch = [&]() {
+		uint8_t succeeded = readMemoryRanges(batchAddresses, batchLengths, ramHashChunk.data());
+		ramHasher.update(ramHashChunk.data(), batchSize);
+		batchAddresses.clear();
+		batchLengths.clear();
+		batchSize = 0;
+		return succeeded;
+	};
+
+	for(size_t i = 0; i < ramHashAddresses.size() && i < ramHashLengths.size(); i++) {
+		uint64_t addr      = ramHashAddresses[i];
+		uint64_t remaining = ramHashLengths[i];
+		while(remaining != 0) {
+			uint64_t size = std::min(remaining, RAM_HASH_CHUNK_SIZE - batchSize);
+			batchAddresses.push_back(addr);
+			batchLengths.push_back(size);
+			batchSize += size;
+			addr += size;
+			remaining -= size;
+
+			if(batchSize == RAM_HASH_CHUNK_SIZE && !hashBatch()) {
+				return false;
+			}
+		}
+	}
+
+	if(batchSize != 0 && !hashBatch()) {
+		return false;
 	}
+
+	hash = ramHasher.digest();
+	return true;
 }
 
 uint8_t MainLoop::checkSleep() {
+#ifdef __SWITCH__
 	// Wait for one millisecond
 	if(R_SUCCEEDED(waitSingle(sleepModeWaiter, 1000000 * 1))) {
 		PscPmState pscState;
@@ -555,8 +1327,11 @@ uint8_t MainLoop::checkSleep() {
 			}
 		}
 	}
+#endif
+	return false;
 }
 uint8_t MainLoop::checkAwaken() {
+#ifdef __SWITCH__
 	// Wait for one millisecond
 	if(R_SUCCEEDED(waitSingle(sleepModeWaiter, 1000000 * 1))) {
 		PscPmState pscState;
@@ -575,10 +1350,13 @@ uint8_t MainLoop::checkAwaken() {
 			}
 		}
 	}
+#endif
+	return false;
 }
 
 void MainLoop::matchFirstControllerToTASController(uint8_t player) {
 #ifdef __SWITCH__
+	// Only scan when a real controller is known to exist, the count is cached
 	if(getNumControllers() > controllers.size() && controllers.size() != 0) {
 		hidScanInput();
 		// This should get the first non-TAS controller
@@ -593,6 +1371,12 @@ void MainLoop::matchFirstControllerToTASController(uint8_t player) {
 		controllers[player]->setFrame(buttons, left, right);
 	}
 #endif
+#ifdef SIMULATED
+	ControllerData physical;
+	if(player < controllers.size() && simulatedPlatform->readPhysicalController(physical)) {
+		controllers[player]->setFrame(physical);
+	}
+#endif
 }
 
 MainLoop::~MainLoop() {
@@ -600,12 +1384,17 @@ MainLoop::~MainLoop() {
 	LOGD << "Exiting app";
 	rc = hiddbgReleaseHdlsWorkBuffer();
 	hiddbgExit();
-#endif
 
 	pscPmModuleFinalize(&sleepModule);
 	pscPmModuleClose(&sleepModule);
 	eventClose(&sleepModule.event);
+#endif
 
 	// Make absolutely sure the app is unpaused on close
 	reset();
+
+	// Every thread has to be joined before the queues go away
+	captureWorker.reset();
+	binaryLogger.reset();
+	networkInstance->endNetwork();
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
@@ -17,7 +18,17 @@
 #include "yuzuSyscalls.hpp"
 #endif
 
+#ifdef SIMULATED
+#include "simulatedPlatform.hpp"
+#endif
+
+#include "binaryLogger.hpp"
+#include "captureWorker.hpp"
 #include "controller.hpp"
+#include "frameAdvanceStrategy.hpp"
+#include "inputRecorder.hpp"
+#include "ramHasher.hpp"
+#include "savestateRing.hpp"
 #include "scripting/luaScripting.hpp"
 #include "sharedNetworkCode/networkInterface.hpp"
 #include "sharedNetworkCode/serializeUnserializeData.hpp"
@@ -29,7 +40,14 @@ struct MemoryRegionInfo {
 	uint64_t size;
 };
 
+// Memory is hashed in reads of at most this size
+#define RAM_HASH_CHUNK_SIZE 0x100000
+// Auto advance stops skipping after this many lag frames in a row, loading screens can take a while
+#define MAX_SKIPPED_LAG_FRAMES 60
+
 class MainLoop {
+	friend class FrameAdvanceStrategy;
+
 private:
 	uint64_t applicationProcessId = 0;
 	uint64_t applicationProgramId = 0;
@@ -46,22 +64,28 @@ private:
 
 	PscPmModule sleepModule;
 	Waiter sleepModeWaiter;
+#endif
 
 	uint64_t lastNanoseconds = 0;
-#endif
 
 #ifdef YUZU
 	std::shared_ptr<Syscalls> yuzuSyscalls;
 #endif
 
+#ifdef SIMULATED
+	std::shared_ptr<SimulatedPlatform> simulatedPlatform;
+#endif
+
 #ifdef __SWITCH__
 	Event vsyncEvent;
 #endif
 
 	std::vector<std::unique_ptr<ControllerHandler>> controllers;
 	std::shared_ptr<CommunicateWithNetwork> networkInstance;
+	std::shared_ptr<BinaryLogger> binaryLogger;
 
 	ScreenshotHandler screenshotHandler;
+	std::unique_ptr<CaptureWorker> captureWorker;
 	std::shared_ptr<LuaScripting> luaScripting;
 
 	// int memoryRegionCompiler;
@@ -70,14 +94,19 @@ private:
 
 	uint8_t isPaused = false;
 
-	void readFullFileData(FILE* file, void* bufPtr, int size) {
+	// Returns false at the end of the file
+	uint8_t readFullFileData(FILE* file, void* bufPtr, int size) {
 		int sizeActuallyRead = 0;
 		uint8_t* buf         = (uint8_t*)bufPtr;
 
 		while(sizeActuallyRead != size) {
-			int bytesRead = fread(&buf[sizeActuallyRead], size - sizeActuallyRead, 1, file);
+			int bytesRead = fread(&buf[sizeActuallyRead], 1, size - sizeActuallyRead, file);
+			if(bytesRead == 0) {
+				return false;
+			}
 			sizeActuallyRead += bytesRead;
 		}
+		return true;
 	}
 
 #ifdef __SWITCH__
@@ -99,17 +128,129 @@ private:
 
 	// void prepareMemoryRegionMath(mu::Parser& parser, std::string func);
 
+	// Returns false if the game's memory can't be read right now
+	uint8_t readMemory(uint64_t addr, uint8_t* buf, uint64_t size) {
+		uint8_t succeeded = false;
+#ifdef __SWITCH__
+		// The debug handle only exists while paused
+		if(isPaused) {
+			succeeded = R_SUCCEEDED(svcReadDebugProcessMemory(buf, applicationDebug, addr, size));
+		}
+#endif
+#ifdef YUZU
+		succeeded = yuzuSyscalls->readMemory(addr, buf, size);
+#endif
+#ifdef SIMULATED
+		succeeded = simulatedPlatform->readMemory(addr, buf, size);
+#endif
+		return succeeded;
+	}
+
+	static uint64_t getMemoryRegionSize(MemoryRegionInfo& region) {
+		switch(region.type) {
+		case MemoryRegionTypes::Bit8:
+			return sizeof(uint8_t);
+		case MemoryRegionTypes::Bit16:
+			return sizeof(uint16_t);
+		case MemoryRegionTypes::Bit32:
+			return sizeof(uint32_t);
+		case MemoryRegionTypes::Bit64:
+			return sizeof(uint64_t);
+		case MemoryRegionTypes::Float:
+			return sizeof(float);
+		case MemoryRegionTypes::Double:
+			return sizeof(double);
+		case MemoryRegionTypes::Bool:
+			return sizeof(bool);
+		default:
+			return region.size;
+		}
+	}
+
+	// Every range is written back to back into buf, Yuzu can do it in one call
+	uint8_t readMemoryRanges(std::vector<uint64_t>& addresses, std::vector<uint64_t>& lengths, uint8_t* buf) {
+#ifdef YUZU
+		return yuzuSyscalls->readMemoryRanges(addresses.data(), lengths.data(), addresses.size(), buf);
+#else
+		uint8_t succeeded = true;
+		for(size_t i = 0; i < addresses.size(); i++) {
+			if(!readMemory(addresses[i], buf, lengths[i])) {
+				memset(buf, 0, lengths[i]);
+				succeeded = false;
+			}
+			buf += lengths[i];
+		}
+		return succeeded;
+#endif
+	}
+
+	// Hashed after every frame so desyncs show up right where they happen
+	std::vector<uint64_t> ramHashAddresses;
+	std::vector<uint64_t> ramHashLengths;
+	std::vector<uint8_t> ramHashChunk;
+	RamHasher ramHasher;
+	// Returns false if no ranges are set or some of the memory can't be read
+	uint8_t hashRam(uint64_t& hash);
+
+	LagDetectionMethod lagDetectionMethod = LagDetectionMethod::LAG_DETECTION_NONE;
+	uint64_t lagCounterAddress            = 0;
+	uint8_t lagCounterSize                = 0;
+	uint8_t skipLagFrames                 = false;
+	// Sent with the acknowledgement of the frame advance that is running
+	uint8_t lastFrameLagged   = false;
+	uint32_t lagFramesSkipped = 0;
+	// The frame lagged if this is the same before and after it
+	// Returns false if detection is off or the method doesn't work on this backend
+	uint8_t readLagValue(uint64_t& value);
+
 	std::vector<uint8_t> getMemory(uint64_t addr, uint64_t size) {
 		std::vector<uint8_t> region(size);
-		svcReadDebugProcessMemory(region.data(), applicationDebug, addr, size);
+		readMemory(addr, region.data(), size);
 		return region;
 	}
 
+	// Used to call Lua and record inputs once per frame while the game is running
+	// Frames since the last call, more than one if the loop fell behind the emulator
+	uint32_t countPassedVsyncs() {
+		uint32_t passed = 0;
+#ifdef __SWITCH__
+		passed = R_SUCCEEDED(eventWait(&vsyncEvent, 0));
+#endif
+#ifdef YUZU
+		if(yuzuSyscalls->function_emu_framecount) {
+			uint64_t frameCount = yuzuSyscalls->function_emu_framecount(yuzuSyscalls->getYuzuInstance());
+			// Loading a savestate can make it go backwards
+			passed         = frameCount > lastVsyncFrame ? frameCount - lastVsyncFrame : 0;
+			lastVsyncFrame = frameCount;
+		}
+#endif
+#ifdef SIMULATED
+		uint64_t frameCount = simulatedPlatform->getFrameCount();
+		passed              = frameCount > lastVsyncFrame ? frameCount - lastVsyncFrame : 0;
+		lastVsyncFrame      = frameCount;
+#endif
+		return passed;
+	}
+	uint64_t lastVsyncFrame = 0;
+
+	static uint64_t getNanoseconds() {
+#ifdef __SWITCH__
+		return armTicksToNs(armGetSystemTick());
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
 #ifdef __SWITCH__
 	GameMemoryInfo getGameMemoryInfo(MemoryInfo memInfo);
 #endif
 
 	void pauseApp(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint8_t autoAdvance, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex);
+	// pauseApp is both of these, frame advancing needs to look at the game in between
+	// Frame advancing goes through frameAdvanceStrategy instead of pausing itself
+	void pauseGame();
+	void acknowledgeFrame(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint8_t autoAdvance, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex);
+	void sendFramebuffer(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint8_t autoAdvance, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex);
 
 	void waitForVsync() {
 #ifdef __SWITCH__
@@ -118,19 +259,51 @@ private:
 			fatalThrow(rc);
 			// svcSleepThread(1000000 * 1);
 #endif
+#ifdef SIMULATED
+		simulatedPlatform->waitForVsync();
+#endif
+	}
+
+	// When fast forwarding Yuzu is paused, frames only run when asked for
+	void waitForFinalTasFrame(uint8_t fastForward) {
+#ifdef YUZU
+		if(fastForward) {
+			yuzuSyscalls->function_emu_frameadvance(yuzuSyscalls->getYuzuInstance());
+			return;
+		}
+#endif
+		waitForVsync();
 	}
 
 	void unpauseApp() {
 		if(isPaused) {
+			// The screen can't change until the capture is done
+			captureWorker->waitForCapture();
 #ifdef __SWITCH__
 			// Unpause application
-			lastNanoseconds = armTicksToNs(armGetSystemTick());
+			lastNanoseconds = getNanoseconds();
 			svcCloseHandle(applicationDebug);
 			isPaused = false;
+#endif
+#ifdef YUZU
+			lastNanoseconds = getNanoseconds();
+			yuzuSyscalls->function_emu_unpause(yuzuSyscalls->getYuzuInstance());
+			isPaused = false;
+#endif
+#ifdef SIMULATED
+			lastNanoseconds = getNanoseconds();
+			simulatedPlatform->unpause();
+			isPaused = false;
 #endif
 		}
 	}
 
+	// Indexed by FrameAdvanceStrategyType, each keeps its own timing
+	std::unique_ptr<FrameAdvanceStrategy> frameAdvanceStrategies[FrameAdvanceStrategyType::NUM_OF_FRAME_ADVANCE_STRATEGIES];
+	FrameAdvanceStrategy* frameAdvanceStrategy;
+	void setFrameAdvanceStrategy(FrameAdvanceStrategyType type, uint8_t resetStats);
+	void sendFrameAdvanceStats();
+
 	// This assumes that the app is paused
 	void runSingleFrame(uint8_t linkedWithFrameAdvance, uint8_t includeFramebuffer, uint8_t autoAdvance, uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex, uint8_t playerIndex);
 
@@ -138,6 +311,7 @@ private:
 
 	void reset() {
 		// For now, just this
+		inputRecorder.stop();
 		unpauseApp();
 	}
 
@@ -145,13 +319,104 @@ private:
 	// to match a TAS controller, so you don't get stuck while in TAS mode
 	void matchFirstControllerToTASController(uint8_t player);
 
+	InputRecorder inputRecorder;
+	void startInputRecording(Protocol::Struct_SendInputRecording& request);
+	void stopInputRecording();
+	// The frames that passed ran with whatever the game was last given, so this has to be before the controllers change
+	void recordRealInputs(uint32_t frames);
+	void sendRecordedInputs(uint8_t finished);
+	// Inputs the game is getting for the recorded player, blank if they can't be read
+	void readRecordedInput(ControllerData& controllerData);
+
 	// Deletes all controllers upon being started, hid:dbg as well as normal
 	// controllers. Otherwise, it sets the number of hid:dbg controllers
 	void setControllerNumber(uint8_t numOfControllers);
-	uint8_t getNumControllers();
+	// Returns the cached number, doesn't touch HID
+	uint8_t getNumControllers() {
+		return numControllersCache;
+	}
+	uint8_t scanNumControllers();
+	// Rescans at most every controllerScanInterval, or right away if forced
+	void updateControllerCount(uint8_t force);
+
+	// Controller count changes rarely, scanning every loop competes with the game
+	static constexpr std::chrono::milliseconds controllerScanInterval { 500 };
+	std::chrono::steady_clock::time_point lastControllerScan;
+	// Mirroring the real controller while running, about twice a frame so no frame misses it
+	static constexpr std::chrono::milliseconds controllerMirrorInterval { 8 };
+	std::chrono::steady_clock::time_point lastControllerMirror;
+	uint8_t numControllersCache = 0;
 
 	uint8_t finalTasShouldRun;
-	void runFinalTas(std::vector<std::string> scriptPaths);
+	// Every RAM hash of the last final TAS, sent back so the next run can be compared
+	std::vector<uint64_t> finalTasRamHashes;
+	// Returns false if a checkpoint didn't match
+	uint8_t runFinalTas(Protocol::Struct_SendStartFinalTas& options);
+	// Returns false if the backend can't run faster than realtime
+	uint8_t setFastForward(uint8_t enabled);
+	// Returns false if the screen doesn't match the checkpoint
+	uint8_t checkFinalTasCheckpoint(uint32_t frame, uint64_t expectedDhash, uint8_t tolerance);
+
+#ifdef SIMULATED
+	uint8_t wasThrottled = true;
+#endif
+
+	SavestateRing savestateRing;
+	// Reused so every state doesn't allocate
+	std::vector<uint8_t> savestateBuf;
+	// What the editor sent for the next frame, the controllers can't be read back on every backend
+	std::vector<ControllerData> editorInputs;
+
+	void setEditorInput(uint8_t player, ControllerData& controllerData) {
+		if(editorInputs.size() < controllers.size()) {
+			editorInputs.resize(controllers.size());
+		}
+		editorInputs[player] = controllerData;
+		controllers[player]->setFrame(controllerData);
+	}
+
+	// Returns false if this backend can't keep savestates in memory
+	uint8_t saveEmulatorState(std::vector<uint8_t>& buf) {
+		uint8_t succeeded = false;
+#ifdef YUZU
+		succeeded = yuzuSyscalls->saveState(buf);
+#endif
+#ifdef SIMULATED
+		simulatedPlatform->saveState(buf);
+		succeeded = true;
+#endif
+		return succeeded;
+	}
+
+	uint8_t loadEmulatorState(const std::vector<uint8_t>& buf) {
+		uint8_t succeeded = false;
+#ifdef YUZU
+		succeeded = yuzuSyscalls->loadState(buf);
+#endif
+#ifdef SIMULATED
+		succeeded = simulatedPlatform->loadState(buf);
+#endif
+		return succeeded;
+	}
+
+	// The state of a Lua script can't be rewound, so the ring isn't used while one is loaded
+	uint8_t canRewind() {
+		uint8_t supported = false;
+#ifdef YUZU
+		supported = yuzuSyscalls->hasMemorySavestates() && yuzuSyscalls->function_emu_frameadvance;
+#endif
+#ifdef SIMULATED
+		supported = true;
+#endif
+		return supported && savestateRing.isEnabled() && !luaScripting->isLoaded();
+	}
+
+	// Called around a frame advance from the editor, keeps the inputs and maybe a savestate
+	void prepareRewindFrame(uint32_t frame, uint16_t savestateHookNum, uint32_t branchIndex);
+	void finishRewindFrame(uint32_t frame);
+	// Runs one frame as fast as possible, the app stays paused and nothing is sent
+	void replayFrame();
+	void jumpToFrame(Protocol::Struct_SendJumpToFrame& request);
 
 	uint8_t checkSleep();
 	uint8_t checkAwaken();
@@ -165,7 +430,41 @@ public:
 	}
 #endif
 
+#ifdef SIMULATED
+	std::shared_ptr<SimulatedPlatform> getSimulatedPlatform() {
+		return simulatedPlatform;
+	}
+
+	void runLuaBenchmark(uint32_t numOfValues, uint32_t frames) {
+		luaScripting->benchmark(SIMULATED_RAM_BASE + SCRATCH_MEMORY, numOfValues, frames);
+	}
+
+	// Advances through frames, edits one in the middle and jumps back to the end
+	uint8_t runRewindBenchmark(uint32_t frames);
+
+	void setRamHashRanges(std::vector<uint64_t> addresses, std::vector<uint64_t> lengths) {
+		ramHashAddresses = addresses;
+		ramHashLengths   = lengths;
+	}
+
+	std::vector<uint64_t>& getFinalTasRamHashes() {
+		return finalTasRamHashes;
+	}
+
+	// One controller per script, like the PC sets up before starting
+	uint8_t startFinalTas(Protocol::Struct_SendStartFinalTas& options) {
+		setControllerNumber(options.scriptPaths.size());
+		finalTasShouldRun = true;
+		return runFinalTas(options);
+	}
+#endif
+
 	void mainLoopHandler();
 
+	void loadLuaScript(std::string path, uint32_t instructionBudget) {
+		luaScripting->setInstructionBudget(instructionBudget);
+		luaScripting->loadScript(path);
+	}
+
 	~MainLoop();
 };
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "ramHasher.hpp"
+
+void RamHasher::reset(uint64_t hashSeed) {
+	seed            = hashSeed;
+	accumulators[0] = seed + PRIME_1 + PRIME_2;
+	accumulators[1] = seed + PRIME_2;
+	accumulators[2] = seed;
+	accumulators[3] = seed - PRIME_1;
+	totalSize       = 0;
+	stripeSize      = 0;
+}
+
+void RamHasher::update(const uint8_t* buf, uint64_t size) {
+	totalSize += size;
+
+	// Finish the stripe left over from last time first
+	if(stripeSize != 0) {
+		uint64_t needed = sizeof(stripe) - stripeSize;
+		if(size < needed) {
+			memcpy(&stripe[stripeSize], buf, size);
+			stripeSize += size;
+			return;
+		}
+		memcpy(&stripe[stripeSize], buf, needed);
+		consumeStripe(stripe);
+		buf += needed;
+		size -= needed;
+		stripeSize = 0;
+	}
+
+	// The bulk of the memory goes straight through
+	const uint8_t* end = buf + size - (size % sizeof(stripe));
+	while(buf < end) {
+		consumeStripe(buf);
+		buf += sizeof(stripe);
+	}
+
+	stripeSize = size % sizeof(stripe);
+	memcpy(stripe, buf, stripeSize);
+}
+
+uint64_t RamHasher::digest() {
+	uint64_t hash;
+	if(totalSize >= sizeof(stripe)) {
+		hash = rotateLeft(accumulators[0], 1) + rotateLeft(accumulators[1], 7) + rotateLeft(accumulators[2], 12) + rotateLeft(accumulators[3], 18);
+		hash = mergeRound(hash, accumulators[0]);
+		hash = mergeRound(hash, accumulators[1]);
+		hash = mergeRound(hash, accumulators[2]);
+		hash = mergeRound(hash, accumulators[3]);
+	} else {
+		hash = seed + PRIME_5;
+	}
+
+	hash += totalSize;
+
+	const uint8_t* pointer = stripe;
+	const uint8_t* end     = stripe + stripeSize;
+	while(pointer + 8 <= end) {
+		hash ^= round(0, read64(pointer));
+		hash = rotateLeft(hash, 27) * PRIME_1 + PRIME_4;
+		pointer += 8;
+	}
+	if(pointer + 4 <= end) {
+		hash ^= (uint64_t)read32(pointer) * PRIME_1;
+		hash = rotateLeft(hash, 23) * PRIME_2 + PRIME_3;
+		pointer += 4;
+	}
+	while(pointer < end) {
+		hash ^= (*pointer) * PRIME_5;
+		hash = rotateLeft(hash, 11) * PRIME_1;
+		pointer++;
+	}
+
+	hash ^= hash >> 33;
+	hash *= PRIME_2;
+	hash ^= hash >> 29;
+	hash *= PRIME_3;
+	hash ^= hash >> 32;
+	return hash;
+}
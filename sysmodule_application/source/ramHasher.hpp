@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Streaming XXH64, memory is hashed as it is read so it never has to be in one buffer
+// https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+class RamHasher {
+private:
+	static constexpr uint64_t PRIME_1 = 11400714785074694791ULL;
+	static constexpr uint64_t PRIME_2 = 14029467366897019727ULL;
+	static constexpr uint64_t PRIME_3 = 1609587929392839161ULL;
+	static constexpr uint64_t PRIME_4 = 9650029242287828579ULL;
+	static constexpr uint64_t PRIME_5 = 2870177450012600261ULL;
+
+	uint64_t seed;
+	uint64_t accumulators[4];
+	uint64_t totalSize;
+	// Input that didn't fill a whole 32 byte stripe yet
+	uint8_t stripe[32];
+	uint8_t stripeSize;
+
+	static inline uint64_t rotateLeft(uint64_t value, uint8_t bits) {
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	static inline uint64_t read64(const uint8_t* pointer) {
+		uint64_t value;
+		memcpy(&value, pointer, sizeof(value));
+		return value;
+	}
+
+	static inline uint32_t read32(const uint8_t* pointer) {
+		uint32_t value;
+		memcpy(&value, pointer, sizeof(value));
+		return value;
+	}
+
+	static inline uint64_t round(uint64_t accumulator, uint64_t input) {
+		accumulator += input * PRIME_2;
+		accumulator = rotateLeft(accumulator, 31);
+		return accumulator * PRIME_1;
+	}
+
+	static inline uint64_t mergeRound(uint64_t hash, uint64_t accumulator) {
+		hash ^= round(0, accumulator);
+		return hash * PRIME_1 + PRIME_4;
+	}
+
+	void consumeStripe(const uint8_t* pointer) {
+		accumulators[0] = round(accumulators[0], read64(pointer));
+		accumulators[1] = round(accumulators[1], read64(pointer + 8));
+		accumulators[2] = round(accumulators[2], read64(pointer + 16));
+		accumulators[3] = round(accumulators[3], read64(pointer + 24));
+	}
+
+public:
+	RamHasher(uint64_t hashSeed = 0) {
+		reset(hashSeed);
+	}
+
+	void reset(uint64_t hashSeed = 0);
+	void update(const uint8_t* buf, uint64_t size);
+	// Doesn't change the state, more can be added afterwards
+	uint64_t digest();
+
+	static uint64_t hash(const uint8_t* buf, uint64_t size) {
+		RamHasher hasher;
+		hasher.update(buf, size);
+		return hasher.digest();
+	}
+};
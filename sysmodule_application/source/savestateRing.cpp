@@ -0,0 +1,253 @@
+#include "savestateRing.hpp"
+
+void SavestateRing::writeVarint(std::vector<uint8_t>& buf, uint64_t value) {
+	while(value >= 0x80) {
+		buf.push_back((uint8_t)value | 0x80);
+		value >>= 7;
+	}
+	buf.push_back((uint8_t)value);
+}
+
+uint64_t SavestateRing::readVarint(const uint8_t*& pointer) {
+	uint64_t value = 0;
+	uint8_t shift  = 0;
+	while(*pointer & 0x80) {
+		value |= (uint64_t)(*pointer & 0x7F) << shift;
+		shift += 7;
+		pointer++;
+	}
+	value |= (uint64_t)*pointer << shift;
+	pointer++;
+	return value;
+}
+
+void SavestateRing::encodeDelta(const std::vector<uint8_t>& from, const std::vector<uint8_t>& to, std::vector<uint8_t>& delta) {
+	const size_t size = to.size();
+	size_t i          = 0;
+
+	while(i < size) {
+		// Skip the unchanged bytes, a word at a time while possible
+		size_t zeroStart = i;
+		while(i + sizeof(uint64_t) <= size) {
+			uint64_t fromWord;
+			uint64_t toWord;
+			memcpy(&fromWord, &from[i], sizeof(uint64_t));
+			memcpy(&toWord, &to[i], sizeof(uint64_t));
+			if(fromWord != toWord) {
+				break;
+			}
+			i += sizeof(uint64_t);
+		}
+		while(i < size && from[i] == to[i]) {
+			i++;
+		}
+
+		// Unchanged bytes at the end don't need a record
+		if(i == size) {
+			break;
+		}
+
+		// The literal ends at the next run long enough to be worth skipping
+		size_t literalStart = i;
+		size_t equalRun     = 0;
+		while(i < size && equalRun < SAVESTATE_RING_MIN_ZERO_RUN) {
+			equalRun = from[i] == to[i] ? equalRun + 1 : 0;
+			i++;
+		}
+		if(equalRun == SAVESTATE_RING_MIN_ZERO_RUN) {
+			i -= SAVESTATE_RING_MIN_ZERO_RUN;
+		}
+
+		writeVarint(delta, literalStart - zeroStart);
+		writeVarint(delta, i - literalStart);
+		for(size_t j = literalStart; j < i; j++) {
+			delta.push_back(from[j] ^ to[j]);
+		}
+	}
+}
+
+void SavestateRing::applyDelta(std::vector<uint8_t>& state, const std::vector<uint8_t>& delta) {
+	const uint8_t* pointer = delta.data();
+	const uint8_t* end     = delta.data() + delta.size();
+	uint8_t* target        = state.data();
+
+	while(pointer < end) {
+		target += readVarint(pointer);
+		uint64_t literalSize = readVarint(pointer);
+		for(uint64_t i = 0; i < literalSize; i++) {
+			target[i] ^= pointer[i];
+		}
+		target += literalSize;
+		pointer += literalSize;
+	}
+}
+
+void SavestateRing::setOptions(uint32_t stateInterval, uint64_t budget) {
+	interval     = stateInterval;
+	memoryBudget = budget;
+
+	if(interval == 0) {
+		clear();
+	} else {
+		evict();
+	}
+}
+
+void SavestateRing::setContext(uint16_t hook, uint32_t branch) {
+	if(hook != savestateHookNum || branch != branchIndex) {
+		clear();
+		savestateHookNum = hook;
+		branchIndex      = branch;
+	}
+}
+
+void SavestateRing::clear() {
+	entries.clear();
+	lastState.clear();
+	frameInputs.clear();
+	statesSinceKeyframe = 0;
+	memoryUsed          = 0;
+}
+
+uint8_t SavestateRing::wantsState(uint32_t frame) {
+	if(interval == 0 || frame % interval != 0) {
+		return false;
+	}
+	return entries.empty() || frame > entries.back().frame;
+}
+
+void SavestateRing::addState(uint32_t frame, const std::vector<uint8_t>& state) {
+	SavestateRingEntry entry;
+	entry.frame = frame;
+	// A keyframe is also needed if the last one is too big to ever be evicted
+	entry.isKeyframe = lastState.size() != state.size() || statesSinceKeyframe >= SAVESTATE_RING_KEYFRAME_INTERVAL || memoryUsed > memoryBudget;
+
+	if(entry.isKeyframe) {
+		entry.data          = state;
+		statesSinceKeyframe = 0;
+	} else {
+		encodeDelta(lastState, state, entry.data);
+		statesSinceKeyframe++;
+	}
+
+	memoryUsed += entry.data.size();
+	entries.push_back(std::move(entry));
+	lastState = state;
+
+	evict();
+}
+
+void SavestateRing::evict() {
+	while(memoryUsed > memoryBudget) {
+		// Find where the second group starts, the newest group always stays
+		size_t nextKeyframe = 1;
+		while(nextKeyframe < entries.size() && !entries[nextKeyframe].isKeyframe) {
+			nextKeyframe++;
+		}
+		if(nextKeyframe == entries.size()) {
+			break;
+		}
+
+		for(size_t i = 0; i < nextKeyframe; i++) {
+			memoryUsed -= entries.front().data.size();
+			entries.pop_front();
+		}
+	}
+}
+
+void SavestateRing::recordInputs(uint32_t frame, const std::vector<ControllerData>& inputs) {
+	if(frame < frameInputs.size() && !frameInputs[frame].empty()) {
+		uint8_t same = frameInputs[frame].size() == inputs.size();
+		for(size_t i = 0; same && i < inputs.size(); i++) {
+			same = sameInput(frameInputs[frame][i], inputs[i]);
+		}
+		if(!same) {
+			invalidateFrom(frame);
+		}
+	}
+
+	if(frame >= frameInputs.size()) {
+		frameInputs.resize(frame + 1);
+	}
+	frameInputs[frame] = inputs;
+}
+
+uint32_t SavestateRing::findFirstDifference(uint32_t firstFrame, uint8_t numOfPlayers, const std::vector<ControllerData>& inputs) {
+	if(numOfPlayers == 0) {
+		return UINT32_MAX;
+	}
+
+	uint32_t numOfFrames = inputs.size() / numOfPlayers;
+	for(uint32_t i = 0; i < numOfFrames; i++) {
+		uint32_t frame = firstFrame + i;
+		if(frame >= frameInputs.size()) {
+			// Nothing after this was ever run
+			break;
+		}
+
+		std::vector<ControllerData>& recorded = frameInputs[frame];
+		if(recorded.empty()) {
+			continue;
+		}
+		if(recorded.size() != numOfPlayers) {
+			return frame;
+		}
+		for(uint8_t player = 0; player < numOfPlayers; player++) {
+			if(!sameInput(recorded[player], inputs[i * numOfPlayers + player])) {
+				return frame;
+			}
+		}
+	}
+
+	return UINT32_MAX;
+}
+
+const std::vector<ControllerData>* SavestateRing::getInputs(uint32_t frame, uint8_t numOfPlayers) {
+	if(frame >= frameInputs.size() || frameInputs[frame].size() != numOfPlayers || numOfPlayers == 0) {
+		return nullptr;
+	}
+	return &frameInputs[frame];
+}
+
+void SavestateRing::invalidateFrom(uint32_t frame) {
+	uint8_t removed = false;
+	while(!entries.empty() && entries.back().frame >= frame) {
+		memoryUsed -= entries.back().data.size();
+		entries.pop_back();
+		removed = true;
+	}
+
+	if(removed) {
+		// lastState is gone, start a new group with the next state
+		lastState.clear();
+	}
+
+	if(frame < frameInputs.size()) {
+		frameInputs.resize(frame);
+	}
+}
+
+uint8_t SavestateRing::restoreNearest(uint32_t frame, uint32_t& stateFrame, std::vector<uint8_t>& state) {
+	// Newest entry that isn't past the frame
+	size_t index = entries.size();
+	while(index != 0 && entries[index - 1].frame > frame) {
+		index--;
+	}
+	if(index == 0) {
+		return false;
+	}
+	index--;
+
+	size_t keyframe = index;
+	while(!entries[keyframe].isKeyframe) {
+		keyframe--;
+	}
+
+	state = entries[keyframe].data;
+	for(size_t i = keyframe + 1; i <= index; i++) {
+		applyDelta(state, entries[i].data);
+	}
+
+	stateFrame = entries[index].frame;
+	return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "buttonData.hpp"
+
+// Frames between states unless the PC says otherwise
+#define SAVESTATE_RING_DEFAULT_INTERVAL 30
+#define SAVESTATE_RING_DEFAULT_BUDGET (256ULL * 1024 * 1024)
+// Every this many states a full copy is stored, the rest are deltas from the state before
+// Restoring applies at most this many deltas
+#define SAVESTATE_RING_KEYFRAME_INTERVAL 16
+// Equal bytes shorter than this stay inside a literal, a new record would be bigger
+#define SAVESTATE_RING_MIN_ZERO_RUN 8
+
+struct SavestateRingEntry {
+	// The state is from right after this frame ran
+	uint32_t frame;
+	uint8_t isKeyframe;
+	// The full state for keyframes, otherwise the delta from the entry before
+	std::vector<uint8_t> data;
+};
+
+// Emulator savestates kept in memory while frame advancing, going back to an earlier frame
+// Restores the nearest state and only replays what is left instead of the whole savestate hook
+// Only one savestate hook and branch is kept at a time, changing either clears the ring
+class SavestateRing {
+private:
+	std::deque<SavestateRingEntry> entries;
+	// Full copy of the newest state, the next delta is made against it
+	std::vector<uint8_t> lastState;
+	uint8_t statesSinceKeyframe = 0;
+	uint64_t memoryUsed         = 0;
+
+	uint32_t interval     = SAVESTATE_RING_DEFAULT_INTERVAL;
+	uint64_t memoryBudget = SAVESTATE_RING_DEFAULT_BUDGET;
+
+	uint16_t savestateHookNum = 0;
+	uint32_t branchIndex      = 0;
+
+	// Inputs of every player on each frame that was run, the index is the frame
+	std::vector<std::vector<ControllerData>> frameInputs;
+
+	// frameState only matters to the editor
+	static uint8_t sameInput(const ControllerData& a, const ControllerData& b) {
+		return a.buttons == b.buttons && a.LS_X == b.LS_X && a.LS_Y == b.LS_Y && a.RS_X == b.RS_X && a.RS_Y == b.RS_Y && a.ACCEL_X == b.ACCEL_X && a.ACCEL_Y == b.ACCEL_Y && a.ACCEL_Z == b.ACCEL_Z && a.GYRO_1 == b.GYRO_1 && a.GYRO_2 == b.GYRO_2 && a.GYRO_3 == b.GYRO_3;
+	}
+
+	// Deltas are pairs of a run of unchanged bytes and a run of XORed bytes, lengths are varints
+	// Most of the game's memory doesn't change in a few frames, so they are tiny
+	static void encodeDelta(const std::vector<uint8_t>& from, const std::vector<uint8_t>& to, std::vector<uint8_t>& delta);
+	static void applyDelta(std::vector<uint8_t>& state, const std::vector<uint8_t>& delta);
+	static void writeVarint(std::vector<uint8_t>& buf, uint64_t value);
+	static uint64_t readVarint(const uint8_t*& pointer);
+
+	// Drops the oldest keyframes along with their deltas until the budget fits
+	void evict();
+
+public:
+	// An interval of 0 turns the ring off
+	void setOptions(uint32_t stateInterval, uint64_t budget);
+	// Clears everything if this is a different savestate hook or branch
+	void setContext(uint16_t hook, uint32_t branch);
+	void clear();
+
+	uint8_t isEnabled() {
+		return interval != 0;
+	}
+
+	uint8_t isEmpty() {
+		return entries.empty();
+	}
+
+	// True if a state should be kept for this frame
+	uint8_t wantsState(uint32_t frame);
+	// Frames have to be added in order, invalidate first to go back
+	void addState(uint32_t frame, const std::vector<uint8_t>& state);
+
+	// If the frame was run before with other inputs, every state from then on is thrown away
+	void recordInputs(uint32_t frame, const std::vector<ControllerData>& inputs);
+	// inputs has numOfPlayers entries for each frame starting at firstFrame
+	// Returns the first frame that differs from what was run, UINT32_MAX if none do
+	uint32_t findFirstDifference(uint32_t firstFrame, uint8_t numOfPlayers, const std::vector<ControllerData>& inputs);
+	// Inputs recorded for the frame, null if it wasn't run or had another number of players
+	const std::vector<ControllerData>* getInputs(uint32_t frame, uint8_t numOfPlayers);
+	// States on or after this frame came from inputs that don't exist anymore
+	void invalidateFrom(uint32_t frame);
+
+	// Rebuilds the newest state at or before frame, returns false if there is none
+	uint8_t restoreNearest(uint32_t frame, uint32_t& stateFrame, std::vector<uint8_t>& state);
+
+	uint64_t getMemoryUsed() {
+		return memoryUsed;
+	}
+
+	size_t getNumOfStates() {
+		return entries.size();
+	}
+};
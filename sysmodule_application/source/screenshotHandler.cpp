@@ -2,80 +2,189 @@
 
 ScreenshotHandler::ScreenshotHandler() {}
 
-void ScreenshotHandler::writeFramebuffer(std::vector<uint8_t>& buf, std::string& dhash) {
+void ScreenshotHandler::writeFramebuffer(std::vector<uint8_t>& buf) {
 	buf.resize(JPEG_BUF_SIZE);
-	uint64_t outSize;
-	uint8_t succeeded = true;
+	uint64_t outSize  = 0;
+	uint8_t succeeded = false;
 
 #ifdef __SWITCH__
 	rc        = capsscCaptureJpegScreenShot(&outSize, buf.data(), JPEG_BUF_SIZE, ViLayerStack::ViLayerStack_ApplicationForDebug, INT64_MAX);
 	succeeded = R_SUCCEEDED(rc);
-#else
-	succeeded = true;
 #endif
+	// There is no JPEG encoder in the tree, the simulated platform only provides the dHash
 
 	if(succeeded) {
 		buf.resize(outSize);
+	} else {
+		buf.clear();
 	}
-	// Technically this can fail, TODO handle that case
-	/*
+}
+
+uint8_t ScreenshotHandler::calculateDhash(uint64_t& dhash) {
+	// Sum of luminance for every cell, averaged at the end
+	uint32_t cellSums[DHASH_PACKED_WIDTH * DHASH_PACKED_HEIGHT]   = { 0 };
+	uint32_t cellCounts[DHASH_PACKED_WIDTH * DHASH_PACKED_HEIGHT] = { 0 };
 
 #ifdef __SWITCH__
-	capsscOpenRawScreenShotReadStream(&outSize, &outSize, &outSize, ViLayerStack::ViLayerStack_ApplicationForDebug, INT64_MAX);
-
-	const int dhashChunkWidth  = (1280 / dhashWidth);
-	const int dhashChunkHeight = (720 / dhashHeight);
-
-	// Calculate dhash
-	// Resize width to 16
-	// Resize height to 15
-	double leftPixel;
-	double rightPixel;
-	uint8_t haveSetRightPixel = false;
-	char hash[dhashChunkWidth * (dhashChunkHeight - 1)];
-	// For loops for resized pixels
-	for(uint16_t y = 0; y < dhashHeight; y++) {
-		for(uint16_t x = 0; x < dhashWidth; x++) {
-			uint8_t tempPixelBuf[dhashChunkWidth * 4];
-			uint32_t allPixelsCombined = 0;
-
-			for(uint8_t subRow = 0; subRow < dhashChunkHeight; subRow++) {
-				// Only read the RGB portions
-				uint64_t offset = (y * dhashChunkHeight) * (1280 * 4) + subRow * (1280 * 4) + (x * dhashChunkWidth * 4);
-				readFullScreenshotStream(tempPixelBuf, sizeof(tempPixelBuf), offset);
-
-				for(uint8_t i = 0; i < dhashChunkWidth; i++) {
-					allPixelsCombined += tempPixelBuf[i * 4];
-					allPixelsCombined += tempPixelBuf[i * 4 + 1];
-					allPixelsCombined += tempPixelBuf[i * 4 + 2];
-				}
+	uint64_t streamSize;
+	uint64_t width;
+	uint64_t height;
+	rc = capsscOpenRawScreenShotReadStream(&streamSize, &width, &height, ViLayerStack::ViLayerStack_ApplicationForDebug, INT64_MAX);
+	if(R_FAILED(rc)) {
+		return false;
+	}
+
+	// Only a few scanlines per cell are read, the raw stream is 3.6MB
+	std::vector<uint8_t> scanline(width * 4);
+	for(uint8_t cellY = 0; cellY < DHASH_PACKED_HEIGHT; cellY++) {
+		for(uint8_t sample = 0; sample < DHASH_ROW_SAMPLES; sample++) {
+			// Center the samples in the cell
+			uint64_t y = ((cellY * DHASH_ROW_SAMPLES + sample) * 2 + 1) * height / (DHASH_PACKED_HEIGHT * DHASH_ROW_SAMPLES * 2);
+			readFullScreenshotStream(scanline.data(), scanline.size(), y * width * 4);
+
+			// Every fourth pixel is plenty for a 9 wide grid
+			for(uint64_t x = 0; x < width; x += 4) {
+				uint8_t cell = cellY * DHASH_PACKED_WIDTH + (x * DHASH_PACKED_WIDTH / width);
+				cellSums[cell] += getLuminance(scanline[x * 4], scanline[x * 4 + 1], scanline[x * 4 + 2]);
+				cellCounts[cell]++;
 			}
+		}
+	}
+
+	capsscCloseRawScreenShotReadStream();
+#endif
+
+#ifdef YUZU
+	if(!yuzuSyscalls) {
+		return false;
+	}
 
-			double average = (double)allPixelsCombined / (dhashChunkHeight * (dhashChunkWidth * 3));
-			if(!haveSetRightPixel) {
-				// First pixel. set left
-				leftPixel         = average;
-				haveSetRightPixel = true;
-			} else {
-				// Set right pixel, compare to previous, then move
-				rightPixel = average;
-				if(leftPixel > rightPixel) {
-					hash[x - 1] = '1';
-				} else {
-					hash[x - 1] = '0';
+	// Either one copy of the whole screen or a few single pixels, the samples are the same
+	int width  = YUZU_SCREEN_WIDTH;
+	int height = YUZU_SCREEN_HEIGHT;
+	std::function<uint8_t*(int x, int y)> getPixel;
+	if(yuzuSyscalls->hasBulkFramebuffer()) {
+		if(!yuzuSyscalls->readScreenFramebuffer(yuzuFramebuffer, width, height)) {
+			return false;
+		}
+		getPixel = [&](int x, int y) { return &yuzuFramebuffer[(y * width + x) * 4]; };
+	} else if(yuzuSyscalls->function_emu_getscreenpixel) {
+		getPixel = [&](int x, int y) { return yuzuSyscalls->function_emu_getscreenpixel(yuzuSyscalls->getYuzuInstance(), x, y, true); };
+	} else {
+		return false;
+	}
+
+	// 4x4 samples per cell, much cheaper than reading the entire screen one pixel at a time
+	for(uint8_t cellY = 0; cellY < DHASH_PACKED_HEIGHT; cellY++) {
+		for(uint8_t cellX = 0; cellX < DHASH_PACKED_WIDTH; cellX++) {
+			uint8_t cell = cellY * DHASH_PACKED_WIDTH + cellX;
+			for(uint8_t sampleY = 0; sampleY < 4; sampleY++) {
+				for(uint8_t sampleX = 0; sampleX < 4; sampleX++) {
+					int x          = ((cellX * 4 + sampleX) * 2 + 1) * width / (DHASH_PACKED_WIDTH * 4 * 2);
+					int y          = ((cellY * 4 + sampleY) * 2 + 1) * height / (DHASH_PACKED_HEIGHT * 4 * 2);
+					uint8_t* pixel = getPixel(x, y);
+					cellSums[cell] += getLuminance(pixel[0], pixel[1], pixel[2]);
+					cellCounts[cell]++;
 				}
-				leftPixel = rightPixel;
 			}
 		}
 	}
+#endif
+
+#ifdef SIMULATED
+	if(!simulatedPlatform) {
+		return false;
+	}
+
+	// Same sampling as the switch, the generated screen is read by scanline
+	std::vector<uint8_t> scanline(SIMULATED_SCREEN_WIDTH * 4);
+	for(uint8_t cellY = 0; cellY < DHASH_PACKED_HEIGHT; cellY++) {
+		for(uint8_t sample = 0; sample < DHASH_ROW_SAMPLES; sample++) {
+			uint16_t y = ((cellY * DHASH_ROW_SAMPLES + sample) * 2 + 1) * SIMULATED_SCREEN_HEIGHT / (DHASH_PACKED_HEIGHT * DHASH_ROW_SAMPLES * 2);
+			simulatedPlatform->readFramebufferRow(y, scanline.data());
+
+			for(uint16_t x = 0; x < SIMULATED_SCREEN_WIDTH; x += 4) {
+				uint8_t cell = cellY * DHASH_PACKED_WIDTH + (x * DHASH_PACKED_WIDTH / SIMULATED_SCREEN_WIDTH);
+				cellSums[cell] += getLuminance(scanline[x * 4], scanline[x * 4 + 1], scanline[x * 4 + 2]);
+				cellCounts[cell]++;
+			}
+		}
+	}
+#endif
+
+	uint8_t grid[DHASH_PACKED_WIDTH * DHASH_PACKED_HEIGHT];
+	for(uint8_t i = 0; i < sizeof(grid); i++) {
+		if(cellCounts[i] == 0) {
+			// Nothing was read, no platform to read from
+			return false;
+		}
+		grid[i] = cellSums[i] / cellCounts[i];
+	}
+
+	dhash = packDhash(grid);
+	return true;
+}
+
+uint8_t ScreenshotHandler::hashFramebuffer(uint64_t& hash) {
+	RamHasher hasher;
+
+#ifdef __SWITCH__
+	uint64_t streamSize;
+	uint64_t width;
+	uint64_t height;
+	rc = capsscOpenRawScreenShotReadStream(&streamSize, &width, &height, ViLayerStack::ViLayerStack_ApplicationForDebug, INT64_MAX);
+	if(R_FAILED(rc)) {
+		return false;
+	}
+
+	// The whole stream has to be read, a row at a time
+	std::vector<uint8_t> scanline(width * 4);
+	for(uint64_t y = 0; y < height; y++) {
+		readFullScreenshotStream(scanline.data(), scanline.size(), y * scanline.size());
+		hasher.update(scanline.data(), scanline.size());
+	}
 
 	capsscCloseRawScreenShotReadStream();
+#endif
 
-	dhash.assign(hash, sizeof(hash));
-#else
-	succeeded = true;
+#ifdef YUZU
+	int width  = YUZU_SCREEN_WIDTH;
+	int height = YUZU_SCREEN_HEIGHT;
+	if(!yuzuSyscalls || !yuzuSyscalls->hasBulkFramebuffer() || !yuzuSyscalls->readScreenFramebuffer(yuzuFramebuffer, width, height)) {
+		// A pixel at a time would be far too slow
+		return false;
+	}
+	hasher.update(yuzuFramebuffer.data(), yuzuFramebuffer.size());
+#endif
+
+#ifdef SIMULATED
+	if(!simulatedPlatform) {
+		return false;
+	}
+
+	std::vector<uint8_t> scanline(SIMULATED_SCREEN_WIDTH * 4);
+	for(uint16_t y = 0; y < SIMULATED_SCREEN_HEIGHT; y++) {
+		simulatedPlatform->readFramebufferRow(y, scanline.data());
+		hasher.update(scanline.data(), scanline.size());
+	}
 #endif
-*/
+
+	hash = hasher.digest();
+	return true;
+}
+
+uint64_t ScreenshotHandler::packDhash(uint8_t* grid) {
+	uint64_t dhash = 0;
+	for(uint8_t y = 0; y < DHASH_PACKED_HEIGHT; y++) {
+		for(uint8_t x = 0; x < DHASH_PACKED_WIDTH - 1; x++) {
+			uint8_t leftPixel  = grid[y * DHASH_PACKED_WIDTH + x];
+			uint8_t rightPixel = grid[y * DHASH_PACKED_WIDTH + x + 1];
+			if(leftPixel > rightPixel) {
+				dhash |= 1ULL << (y * (DHASH_PACKED_WIDTH - 1) + x);
+			}
+		}
+	}
+	return dhash;
 }
 
 #ifdef __SWITCH__
@@ -5,6 +5,12 @@
 
 #define JPEG_BUF_SIZE 0x80000
 
+// Packed dHash is a 9x8 grayscale grid, each row gives 8 bits
+#define DHASH_PACKED_WIDTH 9
+#define DHASH_PACKED_HEIGHT 8
+// Number of scanlines averaged per grid row, the full stream is never read
+#define DHASH_ROW_SAMPLES 4
+
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
@@ -12,28 +18,71 @@
 #include <string>
 #include <vector>
 
+#include "ramHasher.hpp"
+
 #ifdef __SWITCH__
 #include <plog/Log.h>
 #include <switch.h>
 #endif
 
+#ifdef YUZU
+#include "yuzuSyscalls.hpp"
+#include <functional>
+#include <memory>
+#endif
+
+#ifdef SIMULATED
+#include "simulatedPlatform.hpp"
+#include <memory>
+#endif
+
 class ScreenshotHandler {
 private:
-	const uint8_t dhashWidth  = 80;
-	const uint8_t dhashHeight = 45;
-
 #ifdef __SWITCH__
 	Result rc;
 #endif
 
+#ifdef YUZU
+	std::shared_ptr<Syscalls> yuzuSyscalls;
+	// Reused between frames, the whole screen is 3.6MB
+	std::vector<uint8_t> yuzuFramebuffer;
+#endif
+
+#ifdef SIMULATED
+	std::shared_ptr<SimulatedPlatform> simulatedPlatform;
+#endif
+
 #ifdef __SWITCH__
 	void readFullScreenshotStream(uint8_t* buf, uint64_t size, uint64_t offset);
 #endif
 
+	static uint8_t getLuminance(uint8_t r, uint8_t g, uint8_t b) {
+		return (r * 77 + g * 150 + b * 29) >> 8;
+	}
+
+	// Compare each cell to the one on its right, same order as the PC
+	static uint64_t packDhash(uint8_t* grid);
+
 public:
 	ScreenshotHandler();
 
-	void writeFramebuffer(std::vector<uint8_t>& buf, std::string& dhash);
+#ifdef YUZU
+	void setYuzuSyscalls(std::shared_ptr<Syscalls> syscalls) {
+		yuzuSyscalls = syscalls;
+	}
+#endif
+
+#ifdef SIMULATED
+	void setSimulatedPlatform(std::shared_ptr<SimulatedPlatform> platform) {
+		simulatedPlatform = platform;
+	}
+#endif
+
+	void writeFramebuffer(std::vector<uint8_t>& buf);
+	// Returns false if the screen could not be read
+	uint8_t calculateDhash(uint64_t& dhash);
+	// XXH64 of every pixel, for telling if anything at all changed
+	uint8_t hashFramebuffer(uint64_t& hash);
 
 	~ScreenshotHandler();
 };
\ No newline at end of file
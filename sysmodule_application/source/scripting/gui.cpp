@@ -1,3 +1,4 @@
+#define STB_TRUETYPE_IMPLEMENTATION
 #include "gui.hpp"
 
 Gui::Gui() {
@@ -67,14 +68,9 @@ Gui::Gui() {
 		fatalThrow(rc);
 	}
 
-	// Make Framebuffer linear to make things easier
-	// Imma too dumb to figure out the raw format
-	// 4 bytes per pixel (outstride)
-	rc = framebufferMakeLinear(&framebuf);
-	if(R_FAILED(rc)) {
-		nwindowClose(&window);
-		fatalThrow(rc);
-	}
+	// Not made linear, drawing writes the swizzled layout directly
+	// A linear framebuffer gets converted in full on every flush, even if one pixel changed
+	// 2 bytes per pixel
 
 	static PlFontData stdFontData, extFontData;
 
@@ -101,31 +97,452 @@ Gui::Gui() {
 	stbtt_InitFont(&extNintendoFont, fontBuffer, stbtt_GetFontOffsetForIndex(fontBuffer, 0));
 
 	savedJpegFramebuffer = (uint8_t*)malloc(JPEG_BUF_SIZE);
+#else
+	softwareFramebuffer.resize(FRAMEBUFFER_WIDTH * FRAMEBUFFER_ALIGNED_HEIGHT);
+	currentBuffer = (uint8_t*)softwareFramebuffer.data();
 #endif
 }
 
-void Gui::startFrame() {
-// Dequeue
-#ifdef __SWITCH__
-	currentBuffer = (uint8_t*)framebufferBegin(&framebuf, nullptr);
+#ifndef __SWITCH__
+uint8_t Gui::loadFont(std::string path) {
+	FILE* fontFile = fopen(path.c_str(), "rb");
+	if(fontFile == NULL) {
+		return false;
+	}
+
+	fseek(fontFile, 0, SEEK_END);
+	stdFontData.resize(ftell(fontFile));
+	fseek(fontFile, 0, SEEK_SET);
+	size_t bytesRead = fread(stdFontData.data(), 1, stdFontData.size(), fontFile);
+	fclose(fontFile);
+
+	if(bytesRead != stdFontData.size() || !stbtt_InitFont(&stdFont, stdFontData.data(), stbtt_GetFontOffsetForIndex(stdFontData.data(), 0))) {
+		return false;
+	}
+
+	// Glyphs from the old font are useless now
+	glyphAtlases.clear();
+	atlasPixels.clear();
+	fontLoaded = true;
+	fullRedraw = true;
+	return true;
+}
 #endif
+
+void Gui::startFrame() {
+	commands.clear();
 }
 
 void Gui::endFrame() {
-// Flush
+	dirtyRects.clear();
+
+	if(fullRedraw) {
+		addDirtyRect(GuiRect { 0, 0, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT });
+		fullRedraw = false;
+	} else {
+		// Commands are matched up by order, one that changed dirties both its old and new area
+		size_t numOfCommon = std::min(commands.size(), lastCommands.size());
+		for(size_t i = 0; i < numOfCommon; i++) {
+			if(!(commands[i] == lastCommands[i])) {
+				addDirtyRect(lastCommands[i].bounds);
+				addDirtyRect(commands[i].bounds);
+			}
+		}
+		for(size_t i = numOfCommon; i < commands.size(); i++) {
+			addDirtyRect(commands[i].bounds);
+		}
+		for(size_t i = numOfCommon; i < lastCommands.size(); i++) {
+			addDirtyRect(lastCommands[i].bounds);
+		}
+	}
+
+	// Nothing changed, the single framebuffer still holds the last frame
+	if(!dirtyRects.empty()) {
+#ifdef __SWITCH__
+		// Dequeue
+		currentBuffer = (uint8_t*)framebufferBegin(&framebuf, nullptr);
+#endif
+
+		for(GuiRect& dirty : dirtyRects) {
+			// Transparent, the game shows through
+			fillRect(dirty, Color { 0, 0, 0, 0 }, dirty);
+			for(GuiCommand& command : commands) {
+				if(command.bounds.intersects(dirty)) {
+					runCommand(command, dirty);
+				}
+			}
+		}
+
 #ifdef __SWITCH__
-	framebufferEnd(&framebuf);
+		// Flush
+		framebufferEnd(&framebuf);
 #endif
+	}
+
+	lastCommands.swap(commands);
 }
 
 void Gui::setPixel(uint32_t x, uint32_t y, Color color) {
-// Outstride is 4 and bytes per pixel is 4
+	drawRect(x, y, 1, 1, color);
+}
+
+void Gui::drawRect(int32_t x, int32_t y, int32_t width, int32_t height, Color color) {
+	GuiCommand command;
+	command.type  = GUI_RECT;
+	command.x1    = x;
+	command.y1    = y;
+	command.x2    = width;
+	command.y2    = height;
+	command.color = color;
+	command.size  = 0;
+	addCommand(command);
+}
+
+void Gui::drawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Color color) {
+	GuiCommand command;
+	command.type  = GUI_LINE;
+	command.x1    = x1;
+	command.y1    = y1;
+	command.x2    = x2;
+	command.y2    = y2;
+	command.color = color;
+	command.size  = 0;
+	addCommand(command);
+}
+
+void Gui::drawText(int32_t x, int32_t y, std::string text, uint32_t size, Color color) {
+	GuiCommand command;
+	command.type  = GUI_TEXT;
+	command.x1    = x;
+	command.y1    = y;
+	command.x2    = 0;
+	command.y2    = 0;
+	command.color = color;
+	command.size  = size;
+	command.text  = std::move(text);
+	addCommand(command);
+}
+
+int32_t Gui::measureText(std::string text, uint32_t size) {
+	GlyphAtlas& atlas = getAtlas(size);
+	float width       = 0;
+	size_t i          = 0;
+	while(i < text.size()) {
+		Glyph* glyph = getGlyph(atlas, size, decodeUtf8(text, i));
+		if(glyph != nullptr) {
+			width += glyph->advance;
+		}
+	}
+	return (int32_t)width;
+}
+
+stbtt_fontinfo* Gui::getFont(uint32_t codepoint, int& glyphIndex) {
 #ifdef __SWITCH__
-	uint32_t offset                 = getPixelOffset(x, y);
-	((Color*)currentBuffer)[offset] = color;
+	glyphIndex = stbtt_FindGlyphIndex(&stdNintendoFont, codepoint);
+	if(glyphIndex != 0) {
+		return &stdNintendoFont;
+	}
+	// Icons are only in the extended font
+	glyphIndex = stbtt_FindGlyphIndex(&extNintendoFont, codepoint);
+	return &extNintendoFont;
+#else
+	if(!fontLoaded) {
+		return nullptr;
+	}
+	glyphIndex = stbtt_FindGlyphIndex(&stdFont, codepoint);
+	return &stdFont;
 #endif
 }
 
+GlyphAtlas& Gui::getAtlas(uint32_t size) {
+	auto found = glyphAtlases.find(size);
+	if(found != glyphAtlases.end()) {
+		return found->second;
+	}
+
+	GlyphAtlas& atlas = glyphAtlases[size];
+	atlas.ascent      = 0;
+
+	int glyphIndex;
+	stbtt_fontinfo* font = getFont('A', glyphIndex);
+	if(font != nullptr) {
+		int ascent, descent, lineGap;
+		stbtt_GetFontVMetrics(font, &ascent, &descent, &lineGap);
+		atlas.ascent = (int32_t)(ascent * stbtt_ScaleForPixelHeight(font, size) + 0.5f);
+	}
+
+	return atlas;
+}
+
+Glyph* Gui::getGlyph(GlyphAtlas& atlas, uint32_t size, uint32_t codepoint) {
+	auto cached = atlas.glyphs.find(codepoint);
+	if(cached != atlas.glyphs.end()) {
+		return &cached->second;
+	}
+
+	int glyphIndex;
+	stbtt_fontinfo* font = getFont(codepoint, glyphIndex);
+	if(font == nullptr) {
+		return nullptr;
+	}
+
+	float scale = stbtt_ScaleForPixelHeight(font, size);
+	int advance, leftBearing, x0, y0, x1, y1;
+	stbtt_GetGlyphHMetrics(font, glyphIndex, &advance, &leftBearing);
+	stbtt_GetGlyphBitmapBox(font, glyphIndex, scale, scale, &x0, &y0, &x1, &y1);
+
+	Glyph glyph;
+	glyph.width       = x1 - x0;
+	glyph.height      = y1 - y0;
+	glyph.xOffset     = x0;
+	glyph.yOffset     = y0;
+	glyph.advance     = advance * scale;
+	glyph.atlasOffset = atlasPixels.size();
+
+	std::vector<uint8_t> coverage(glyph.width * glyph.height);
+	if(!coverage.empty()) {
+		stbtt_MakeGlyphBitmap(font, coverage.data(), glyph.width, glyph.height, glyph.width, scale, scale, glyphIndex);
+	}
+
+	// Converted once here, drawing only has to pick the tint
+	atlasPixels.reserve(atlasPixels.size() + coverage.size());
+	for(uint8_t value : coverage) {
+		Color pixel;
+		pixel.r = 15;
+		pixel.g = 15;
+		pixel.b = 15;
+		pixel.a = value >> 4;
+		atlasPixels.push_back(pixel);
+	}
+
+	return &(atlas.glyphs[codepoint] = glyph);
+}
+
+uint32_t Gui::decodeUtf8(const std::string& text, size_t& i) {
+	uint8_t first = text[i++];
+	if(first < 0x80) {
+		return first;
+	}
+
+	uint8_t numOfExtra = first >= 0xF0 ? 3 : first >= 0xE0 ? 2 : first >= 0xC0 ? 1 : 0;
+	uint32_t codepoint = first & (0x3F >> numOfExtra);
+	while(numOfExtra != 0 && i < text.size()) {
+		codepoint = (codepoint << 6) | (text[i++] & 0x3F);
+		numOfExtra--;
+	}
+	return codepoint;
+}
+
+GuiRect Gui::getBounds(GuiCommand& command) {
+	switch(command.type) {
+	case GUI_RECT:
+		return GuiRect { command.x1, command.y1, command.x1 + command.x2, command.y1 + command.y2 };
+	case GUI_LINE:
+		return GuiRect { std::min(command.x1, command.x2), std::min(command.y1, command.y2), std::max(command.x1, command.x2) + 1, std::max(command.y1, command.y2) + 1 };
+	case GUI_TEXT: {
+		// Exact box of the glyphs, accents and descenders can go past the line
+		GlyphAtlas& atlas = getAtlas(command.size);
+		GuiRect bounds { command.x1, command.y1, command.x1, command.y1 };
+		float penX = command.x1;
+		size_t i   = 0;
+		while(i < command.text.size()) {
+			Glyph* glyph = getGlyph(atlas, command.size, decodeUtf8(command.text, i));
+			if(glyph == nullptr) {
+				continue;
+			}
+			int32_t glyphX = (int32_t)penX + glyph->xOffset;
+			int32_t glyphY = command.y1 + atlas.ascent + glyph->yOffset;
+			if(glyph->width != 0 && glyph->height != 0) {
+				GuiRect glyphRect { glyphX, glyphY, glyphX + glyph->width, glyphY + glyph->height };
+				bounds = bounds.isEmpty() ? glyphRect : bounds.unite(glyphRect);
+			}
+			penX += glyph->advance;
+		}
+		return bounds;
+	}
+	}
+
+	return GuiRect { 0, 0, 0, 0 };
+}
+
+void Gui::addCommand(GuiCommand& command) {
+	command.bounds = getBounds(command).intersection(GuiRect { 0, 0, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT });
+	commands.push_back(std::move(command));
+}
+
+void Gui::addDirtyRect(GuiRect rect) {
+	rect = rect.intersection(GuiRect { 0, 0, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT });
+	if(rect.isEmpty()) {
+		return;
+	}
+
+	// Overlapping rectangles are merged so nothing is drawn twice
+	for(size_t i = 0; i < dirtyRects.size();) {
+		if(dirtyRects[i].intersects(rect)) {
+			rect = rect.unite(dirtyRects[i]);
+			dirtyRects.erase(dirtyRects.begin() + i);
+			i = 0;
+		} else {
+			i++;
+		}
+	}
+	dirtyRects.push_back(rect);
+
+	if(dirtyRects.size() > GUI_MAX_DIRTY_RECTS) {
+		GuiRect bounds = dirtyRects[0];
+		for(GuiRect& dirty : dirtyRects) {
+			bounds = bounds.unite(dirty);
+		}
+		dirtyRects.clear();
+		dirtyRects.push_back(bounds);
+	}
+}
+
+void Gui::fillSpan(int32_t y, int32_t x1, int32_t x2, Color color) {
+	Color* pixels = (Color*)currentBuffer;
+	int32_t x     = x1;
+
+	// Groups of 8 pixels are contiguous in the swizzled layout, single pixels until the span lines up
+	while(x < x2 && (x & 7) != 0) {
+		pixels[getPixelOffset(x, y)] = color;
+		x++;
+	}
+
+	Color group[8];
+	std::fill(group, group + 8, color);
+	while(x + 8 <= x2) {
+		memcpy(&pixels[getPixelOffset(x, y)], group, sizeof(group));
+		x += 8;
+	}
+
+	while(x < x2) {
+		pixels[getPixelOffset(x, y)] = color;
+		x++;
+	}
+}
+
+void Gui::fillRect(GuiRect rect, Color color, GuiRect clip) {
+	rect = rect.intersection(clip);
+	if(rect.isEmpty()) {
+		return;
+	}
+
+	for(int32_t y = rect.y1; y < rect.y2; y++) {
+		fillSpan(y, rect.x1, rect.x2, color);
+	}
+}
+
+void Gui::rasterLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Color color, GuiRect clip) {
+	if(x1 == x2 || y1 == y2) {
+		fillRect(GuiRect { std::min(x1, x2), std::min(y1, y2), std::max(x1, x2) + 1, std::max(y1, y2) + 1 }, color, clip);
+		return;
+	}
+
+	// Bresenham, but the pixels on one row are written as a single span
+	int32_t dx       = std::abs(x2 - x1);
+	int32_t dy       = -std::abs(y2 - y1);
+	int32_t stepX    = x1 < x2 ? 1 : -1;
+	int32_t stepY    = y1 < y2 ? 1 : -1;
+	int32_t err      = dx + dy;
+	int32_t runStart = x1;
+
+	while(true) {
+		uint8_t done  = x1 == x2 && y1 == y2;
+		int32_t nextX = x1;
+		int32_t nextY = y1;
+		if(!done) {
+			int32_t err2 = err * 2;
+			if(err2 >= dy) {
+				err += dy;
+				nextX += stepX;
+			}
+			if(err2 <= dx) {
+				err += dx;
+				nextY += stepY;
+			}
+		}
+
+		if(done || nextY != y1) {
+			if(y1 >= clip.y1 && y1 < clip.y2) {
+				int32_t left  = std::max(std::min(runStart, x1), clip.x1);
+				int32_t right = std::min(std::max(runStart, x1) + 1, clip.x2);
+				if(left < right) {
+					fillSpan(y1, left, right, color);
+				}
+			}
+			runStart = nextX;
+		}
+
+		if(done) {
+			break;
+		}
+
+		x1 = nextX;
+		y1 = nextY;
+	}
+}
+
+void Gui::rasterText(int32_t x, int32_t y, const std::string& text, uint32_t size, Color color, GuiRect clip) {
+	GlyphAtlas& atlas = getAtlas(size);
+	Color* pixels     = (Color*)currentBuffer;
+
+	// Every coverage level maps to the text color at that alpha
+	Color tint[16];
+	for(uint8_t i = 0; i < 16; i++) {
+		tint[i]   = color;
+		tint[i].a = (i * color.a + 7) / 15;
+	}
+
+	float penX       = x;
+	int32_t baseline = y + atlas.ascent;
+	size_t i         = 0;
+	while(i < text.size()) {
+		Glyph* glyph = getGlyph(atlas, size, decodeUtf8(text, i));
+		if(glyph == nullptr) {
+			continue;
+		}
+
+		int32_t glyphX  = (int32_t)penX + glyph->xOffset;
+		int32_t glyphY  = baseline + glyph->yOffset;
+		GuiRect visible = GuiRect { glyphX, glyphY, glyphX + glyph->width, glyphY + glyph->height }.intersection(clip);
+
+		if(!visible.isEmpty()) {
+			for(int32_t py = visible.y1; py < visible.y2; py++) {
+				Color* row = &atlasPixels[glyph->atlasOffset + (py - glyphY) * glyph->width];
+				for(int32_t px = visible.x1; px < visible.x2; px++) {
+					uint8_t coverage = row[px - glyphX].a;
+					if(coverage == 15) {
+						pixels[getPixelOffset(px, py)] = tint[15];
+					} else if(coverage != 0) {
+						// Edges are mixed with what is under them, otherwise they cut holes in boxes
+						Color& under = pixels[getPixelOffset(px, py)];
+						under.r      = (color.r * coverage + under.r * (15 - coverage)) / 15;
+						under.g      = (color.g * coverage + under.g * (15 - coverage)) / 15;
+						under.b      = (color.b * coverage + under.b * (15 - coverage)) / 15;
+						under.a      = std::max<uint8_t>(under.a, tint[coverage].a);
+					}
+				}
+			}
+		}
+
+		penX += glyph->advance;
+	}
+}
+
+void Gui::runCommand(GuiCommand& command, GuiRect clip) {
+	switch(command.type) {
+	case GUI_RECT:
+		fillRect(GuiRect { command.x1, command.y1, command.x1 + command.x2, command.y1 + command.y2 }, command.color, clip);
+		break;
+	case GUI_LINE:
+		rasterLine(command.x1, command.y1, command.x2, command.y2, command.color, clip);
+		break;
+	case GUI_TEXT:
+		rasterText(command.x1, command.y1, command.text, command.size, command.color, clip);
+		break;
+	}
+}
+
 void Gui::takeScreenshot(std::string path) {
 #ifdef __SWITCH__
 	uint64_t outSize;
@@ -138,6 +555,57 @@ void Gui::takeScreenshot(std::string path) {
 #endif
 }
 
+#ifdef SIMULATED
+void Gui::benchmark(uint32_t frames) {
+	Color background;
+	background.r = 0;
+	background.g = 0;
+	background.b = 0;
+	background.a = 10;
+	Color white;
+	white.r = 15;
+	white.g = 15;
+	white.b = 15;
+	white.a = 15;
+
+	printf("Gui benchmark: %u frames%s\n", frames, fontLoaded ? "" : ", no font so text is skipped");
+
+	// The second pass redraws the whole screen every frame, like before dirty rectangles
+	for(uint8_t alwaysRedraw = 0; alwaysRedraw < 2; alwaysRedraw++) {
+		lastCommands.clear();
+		fullRedraw = true;
+
+		double total = 0;
+		double worst = 0;
+		for(uint32_t frame = 0; frame < frames; frame++) {
+			auto start = std::chrono::steady_clock::now();
+
+			startFrame();
+			drawRect(16, 16, 360, 232, background);
+			drawLine(24, 52, 368, 52, white);
+			drawText(24, 20, "Frame " + std::to_string(frame), 24, white);
+			for(uint8_t watch = 0; watch < 8; watch++) {
+				// The first watch changes every frame, the rest once a second
+				uint32_t value = watch == 0 ? frame * 7 : (frame / 60) * (watch + 1);
+				char line[64];
+				snprintf(line, sizeof(line), "0x%08X: %u", 0x8000000 + watch * 4, value);
+				drawText(24, 60 + watch * 22, line, 18, white);
+			}
+			if(alwaysRedraw) {
+				fullRedraw = true;
+			}
+			endFrame();
+
+			double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+			total += elapsed;
+			worst = std::max(worst, elapsed);
+		}
+
+		printf("  %-18s avg %8.1f us   max %8.1f us\n", alwaysRedraw ? "full redraw" : "dirty rectangles", total / frames, worst);
+	}
+}
+#endif
+
 Gui::~Gui() {
 // Close everything
 #ifdef __SWITCH__
@@ -1,15 +1,22 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #ifdef __SWITCH__
 #include <switch.h>
 #endif
 
+#ifdef SIMULATED
+#include <chrono>
+#endif
+
 #define JPEG_BUF_SIZE 0x80000
-#define STB_TRUETYPE_IMPLEMENTATION
 
 #include <stb_truetype.h>
 
@@ -19,14 +26,87 @@ extern "C" u64 __nx_vi_layer_id;
 
 #define FRAMEBUFFER_WIDTH 1280
 #define FRAMEBUFFER_HEIGHT 720
+// Block linear is made of blocks 32 pixels wide and 128 rows tall, the height is padded to a full block
+#define FRAMEBUFFER_ALIGNED_HEIGHT ((FRAMEBUFFER_HEIGHT + 127) & ~127)
+// Past this many dirty rectangles they are merged into one, checking them all costs more than overdraw
+#define GUI_MAX_DIRTY_RECTS 16
 
 // Libtesla color
 // RGBA4444
 // Even on yuzu, this is the same
 struct Color {
 	uint16_t r : 4, g : 4, b : 4, a : 4;
+
+	bool operator==(const Color& other) const {
+		return r == other.r && g == other.g && b == other.b && a == other.a;
+	}
 } __attribute__((packed));
 
+// Half open, x2 and y2 are not part of the rectangle
+struct GuiRect {
+	int32_t x1;
+	int32_t y1;
+	int32_t x2;
+	int32_t y2;
+
+	bool isEmpty() const {
+		return x1 >= x2 || y1 >= y2;
+	}
+
+	bool intersects(const GuiRect& other) const {
+		return x1 < other.x2 && other.x1 < x2 && y1 < other.y2 && other.y1 < y2;
+	}
+
+	GuiRect intersection(const GuiRect& other) const {
+		return GuiRect { std::max(x1, other.x1), std::max(y1, other.y1), std::min(x2, other.x2), std::min(y2, other.y2) };
+	}
+
+	GuiRect unite(const GuiRect& other) const {
+		return GuiRect { std::min(x1, other.x1), std::min(y1, other.y1), std::max(x2, other.x2), std::max(y2, other.y2) };
+	}
+};
+
+enum GuiCommandType : uint8_t {
+	GUI_RECT,
+	GUI_LINE,
+	GUI_TEXT,
+};
+
+// Drawing is deferred, so a frame can be compared to the last one before anything is written
+struct GuiCommand {
+	GuiCommandType type;
+	// Rect is x, y, width, height, line is both endpoints, text only uses x and y
+	int32_t x1;
+	int32_t y1;
+	int32_t x2;
+	int32_t y2;
+	Color color;
+	uint32_t size;
+	std::string text;
+	// Area the command can touch, clipped to the screen
+	GuiRect bounds;
+
+	bool operator==(const GuiCommand& other) const {
+		return type == other.type && x1 == other.x1 && y1 == other.y1 && x2 == other.x2 && y2 == other.y2 && color == other.color && size == other.size && text == other.text;
+	}
+};
+
+// A rasterized glyph, stored in the atlas as white RGBA4444 with the coverage as alpha
+struct Glyph {
+	int16_t width;
+	int16_t height;
+	int16_t xOffset;
+	int16_t yOffset;
+	float advance;
+	uint32_t atlasOffset;
+};
+
+// All the glyphs used so far at one pixel size
+struct GlyphAtlas {
+	int32_t ascent;
+	std::unordered_map<uint32_t, Glyph> glyphs;
+};
+
 class Gui {
 private:
 #ifdef __SWITCH__
@@ -36,40 +116,91 @@ private:
 	Framebuffer framebuf;
 	// Error handling for everything
 	Result rc;
-	// Current pointer to the graphics data
-	uint8_t* currentBuffer;
 	uint8_t* savedJpegFramebuffer;
+#else
+	// Same swizzled layout as the real framebuffer, so the drawing code is the same everywhere
+	std::vector<Color> softwareFramebuffer;
 #endif
+	// Current pointer to the graphics data
+	uint8_t* currentBuffer;
 
 #ifdef __SWITCH__
 	stbtt_fontinfo stdNintendoFont;
 	stbtt_fontinfo extNintendoFont;
 #else
 	stbtt_fontinfo stdFont;
+	std::vector<uint8_t> stdFontData;
+	uint8_t fontLoaded = false;
 #endif
 
-#ifdef __SWITCH__
-	inline u32 getPixelOffset(u32 x, u32 y) {
-		// Swizzling pattern:
-		//    y6,y5,y4,y3,y2,y1,y0,x7,x6,x5,x4,x3,x2,x1,x0
-		// -> x7,x6,x5,y6,y5,y4,y3,x4,y2,y1,x3,y0,x2,x1,x0
+	std::unordered_map<uint32_t, GlyphAtlas> glyphAtlases;
+	std::vector<Color> atlasPixels;
+
+	std::vector<GuiCommand> commands;
+	std::vector<GuiCommand> lastCommands;
+	std::vector<GuiRect> dirtyRects;
+	// The framebuffer starts with garbage in it
+	uint8_t fullRedraw = true;
+
+	inline uint32_t getPixelOffset(uint32_t x, uint32_t y) {
+		// Swizzling pattern within a block:
+		//    y6,y5,y4,y3,y2,y1,y0,x4,x3,x2,x1,x0
+		// -> y6,y5,y4,y3,x4,y2,y1,x3,y0,x2,x1,x0
 		// Bits x0-4 and y0-6 are from memory layout spec (see TRM 20.1.2 - Block Linear) and libnx hardcoded values
-		constexpr u32 x_mask = (__builtin_ctz(FRAMEBUFFER_WIDTH) - 1) << 5;
-		const u32 swizzled_x = ((x & x_mask) * 128) + ((x & 0b00010000) * 8) + ((x & 0b00001000) * 2) + (x & 0b00000111);
-		const u32 swizzled_y = ((y & 0b1111000) * 32) + ((y & 0b0000110) * 16) + ((y & 0b0000001) * 8);
-		return swizzled_x + swizzled_y;
+		// Blocks are 32x128 pixels and laid out row by row
+		const uint32_t block      = ((y >> 7) * (FRAMEBUFFER_WIDTH >> 5) + (x >> 5)) * 4096;
+		const uint32_t swizzled_x = ((x & 0b00010000) * 8) + ((x & 0b00001000) * 2) + (x & 0b00000111);
+		const uint32_t swizzled_y = ((y & 0b1111000) * 32) + ((y & 0b0000110) * 16) + ((y & 0b0000001) * 8);
+		return block + swizzled_x + swizzled_y;
 	}
-#endif
+
+	// Returns the font that has this codepoint, with the glyph index inside that font
+	stbtt_fontinfo* getFont(uint32_t codepoint, int& glyphIndex);
+	GlyphAtlas& getAtlas(uint32_t size);
+	Glyph* getGlyph(GlyphAtlas& atlas, uint32_t size, uint32_t codepoint);
+	static uint32_t decodeUtf8(const std::string& text, size_t& i);
+
+	GuiRect getBounds(GuiCommand& command);
+	void addCommand(GuiCommand& command);
+	void addDirtyRect(GuiRect rect);
+
+	// x2 is exclusive, both are already clipped
+	void fillSpan(int32_t y, int32_t x1, int32_t x2, Color color);
+	void fillRect(GuiRect rect, Color color, GuiRect clip);
+	void rasterLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Color color, GuiRect clip);
+	void rasterText(int32_t x, int32_t y, const std::string& text, uint32_t size, Color color, GuiRect clip);
+	void runCommand(GuiCommand& command, GuiRect clip);
 
 public:
 	Gui();
 
+#ifndef __SWITCH__
+	// There is no shared font off the switch, text is skipped until one is loaded
+	uint8_t loadFont(std::string path);
+#endif
+
+	// Commands are collected between these, only the areas that changed since the last frame are redrawn
 	void startFrame();
 	void endFrame();
 
 	void setPixel(uint32_t x, uint32_t y, Color color);
+	void drawRect(int32_t x, int32_t y, int32_t width, int32_t height, Color color);
+	void drawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2, Color color);
+	// y is the top of the line, size is in pixels
+	void drawText(int32_t x, int32_t y, std::string text, uint32_t size, Color color);
+	int32_t measureText(std::string text, uint32_t size);
+
+	// Redraws everything next frame, for when something else wrote to the layer
+	void invalidate() {
+		fullRedraw = true;
+	}
 
 	void takeScreenshot(std::string path);
 
+#ifdef SIMULATED
+	// Draws a frame counter and some RAM watches, prints the time per frame with and without dirty rectangles
+	void benchmark(uint32_t frames);
+#endif
+
 	~Gui();
-};
\ No newline at end of file
+};
@@ -5,68 +5,425 @@ LuaScripting::LuaScripting() {
 	// https://github.com/yuzu-emu/yuzu/wiki/Building-for-Windows
 	// https://sol2.readthedocs.io/en/latest/api/function.html
 	// https://sol2.readthedocs.io/en/latest/tutorial/all-the-things.html
-	luaState.open_libraries(sol::lib::base, sol::lib::package, sol::lib::coroutine, sol::lib::string, sol::lib::os, sol::lib::math, sol::lib::table, sol::lib::bit32, sol::lib::io, sol::lib::utf8);
 }
 
 void LuaScripting::loadScript(std::string path) {
-	luaPath = path;
+	endScript();
 
-	luaExecutionThread = std::make_unique<std::thread>(&LuaScripting::luaThread, this);
+	FILE* file = fopen(path.c_str(), "rb");
+	if(file == NULL) {
+		if(errorHandler) {
+			errorHandler("Lua script " + path + " could not be opened");
+		}
+		return;
+	}
+
+	std::string source;
+	char buf[4096];
+	size_t bytesRead;
+	while((bytesRead = fread(buf, 1, sizeof(buf), file)) != 0) {
+		source.append(buf, bytesRead);
+	}
+	fclose(file);
+
+	// Same chunk name load_file would use, so tracebacks show the path
+	loadSource(source, "@" + path);
+}
+
+void LuaScripting::loadSource(const std::string& source, const std::string& chunkName) {
+	endScript();
+
+	// Fresh state every time, nothing from the last script sticks around
+	luaState = std::make_unique<sol::state>();
+	luaState->open_libraries(sol::lib::base, sol::lib::package, sol::lib::coroutine, sol::lib::string, sol::lib::os, sol::lib::math, sol::lib::table, sol::lib::bit32, sol::lib::io, sol::lib::utf8);
+	registerSyscalls();
+
+	uint64_t sourceHash = hashSource(source);
+	auto cached         = bytecodeCache.find(sourceHash);
+
+	sol::load_result currentScript;
+	if(cached != bytecodeCache.end()) {
+		currentScript = luaState->load_buffer(cached->second.data(), cached->second.size(), chunkName, sol::load_mode::binary);
+	} else {
+		currentScript = luaState->load_buffer(source.data(), source.size(), chunkName, sol::load_mode::text);
+	}
+
+	if(!currentScript.valid()) {
+		sol::error err = currentScript;
+		if(errorHandler) {
+			errorHandler("Lua script failed to load: " + std::string(err.what()));
+		}
+		currentScript = sol::load_result();
+		luaState.reset();
+		return;
+	}
+
+	if(cached == bytecodeCache.end()) {
+		// Debug info is kept, errors still point at the right line
+		lua_State* L = luaState->lua_state();
+		std::string bytecode;
+		lua_pushvalue(L, currentScript.stack_index());
+		lua_dump(L, &LuaScripting::writeBytecode, &bytecode, 0);
+		lua_pop(L, 1);
+		bytecodeCache[sourceHash] = bytecode;
+	}
+
+	scriptLoaded = true;
+	frameNum     = 0;
+
+	// The body only sets things up, it gets the same budget as a frame
+	sol::protected_function body = currentScript;
+	if(!callWithBudget(body)) {
+		return;
+	}
+
+	onFrame = (*luaState)["onFrame"];
+	if(!onFrame.valid()) {
+		if(errorHandler) {
+			errorHandler("Lua script does not define onFrame");
+		}
+		endScript();
+	}
 }
 
 void LuaScripting::endScript() {
 	scriptLoaded = false;
+	// Has to be released before the state
+	onFrame = sol::lua_nil;
+	memoryViews.clear();
+	luaState.reset();
 }
 
-void LuaScripting::luaThread() {
-	sol::load_result currentScript = luaState.load_file(luaPath);
-	if(!currentScript.valid()) {
-		/*
-		sol::error err = currentScript;
-		std::cerr << "failde to load string-based script in the program" << err.what() << std::endl;
-		*/
-		// TODO handle errors
+void LuaScripting::runFrame() {
+	if(scriptLoaded) {
+		for(auto& view : memoryViews) {
+			view->refresh(memoryReader);
+		}
+		callWithBudget(onFrame);
+		frameNum++;
+	}
+}
+
+uint64_t LuaScripting::hashSource(const std::string& source) {
+	// FNV-1a, only used to tell scripts apart
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for(char c : source) {
+		hash ^= (uint8_t)c;
+		hash *= 0x100000001b3ULL;
 	}
+	return hash;
+}
+
+int LuaScripting::writeBytecode(lua_State* L, const void* data, size_t size, void* userdata) {
+	((std::string*)userdata)->append((const char*)data, size);
+	return 0;
+}
 
-	sol::protected_function_result currentScriptResult = currentScript();
+void LuaScripting::budgetHook(lua_State* L, lua_Debug* ar) {
+	luaL_error(L, "instruction budget exceeded");
 }
 
-void LuaScripting::sendSyscall(std::function<void()> func) {
-	syscallReady = true;
-	std::unique_lock<std::mutex> lk(syscallMutex);
-	syscallCv.wait(lk, [this] { return ready; });
+uint8_t LuaScripting::callWithBudget(sol::protected_function& func) {
+	lua_State* L   = luaState->lua_state();
+	uint8_t failed = false;
+	std::string errorMessage;
 
-	// Run the syscalls provided by yuzu or otherwise
-	func();
-	processed    = true;
-	syscallReady = false;
+	{
+		// The result has to be gone before the state can be closed
+		lua_sethook(L, &LuaScripting::budgetHook, LUA_MASKCOUNT, instructionBudget);
+		sol::protected_function_result result = func();
+		lua_sethook(L, nullptr, 0, 0);
+
+		if(!result.valid()) {
+			sol::error err = result;
+			failed         = true;
+			errorMessage   = err.what();
+		}
+	}
+
+	if(failed) {
+		if(errorHandler) {
+			errorHandler("Lua script stopped: " + errorMessage);
+		}
+		endScript();
+		return false;
+	}
 
-	lk.unlock();
-	syscallCv.notify_one();
+	return true;
 }
 
-void LuaScripting::callMainloop() {
-	// https://en.cppreference.com/w/cpp/thread/condition_variable
-	// 10 syscalls handled a time
-	for(uint8_t i = 0; i < 10; i++) {
-		// Somehow, inform syscall (if a syscall is waiting at the moment) through the condition variabke
-		// Continue if a syscall is avalible at the beginning of this loop and break otherwise
-		// A max of 10 syscalls will be handled at a time
-		if(syscallReady) {
-			{
-				std::lock_guard<std::mutex> lk(syscallMutex);
-				ready = true;
-			}
-			syscallCv.notify_one();
-			// wait for lua to run syscalls
+void LuaScripting::registerSyscalls() {
+	sol::table switas = luaState->create_named_table("switas");
+
+	switas.set_function("readMemory", &LuaScripting::readMemory, this);
+	switas.set_function("readMemoryBatch", &LuaScripting::readMemoryBatch, this);
+	switas.set_function("mapMemory", &LuaScripting::mapMemory, this);
+	switas.set_function("setInputs", &LuaScripting::setInputs, this);
+	switas.set_function("frame", [this]() { return frameNum; });
+
+	// Only created through switas.mapMemory
+	// clang-format off
+	luaState->new_usertype<MemoryView>("MemoryView", sol::no_constructor,
+		"u8", &MemoryView::u8,
+		"s8", &MemoryView::s8,
+		"u16", &MemoryView::u16,
+		"s16", &MemoryView::s16,
+		"u32", &MemoryView::u32,
+		"s32", &MemoryView::s32,
+		"u64", &MemoryView::u64,
+		"s64", &MemoryView::s64,
+		"f32", &MemoryView::f32,
+		"f64", &MemoryView::f64,
+		"array", &MemoryView::array,
+		"valid", &MemoryView::isValid,
+		"address", &MemoryView::getAddress,
+		"size", &MemoryView::getSize);
+	// clang-format on
+
+	// Masks, so scripts can do switas.button.A | switas.button.B
+	sol::table buttons = switas.create_named("button");
+	const char* buttonNames[] = { "A", "B", "X", "Y", "L", "R", "ZL", "ZR", "SL", "SR", "DUP", "DDOWN", "DLEFT", "DRIGHT", "PLUS", "MINUS", "HOME", "CAPT", "LS", "RS" };
+	for(uint8_t i = 0; i < Btn::BUTTONS_SIZE; i++) {
+		buttons[buttonNames[i]] = 1U << i;
+	}
+}
 
-			{
-				// Gain back control
-				std::unique_lock<std::mutex> lk(syscallMutex);
-				syscallCv.wait(lk, [this] { return processed; });
+uint8_t LuaScripting::getTypeSize(LuaMemoryType type) {
+	switch(type) {
+	case LUA_U8:
+	case LUA_S8:
+		return 1;
+	case LUA_U16:
+	case LUA_S16:
+		return 2;
+	case LUA_U32:
+	case LUA_S32:
+	case LUA_F32:
+		return 4;
+	default:
+		return 8;
+	}
+}
+
+uint8_t LuaScripting::parseType(const std::string& name, LuaMemoryType& type) {
+	static const std::unordered_map<std::string, LuaMemoryType> types {
+		{ "u8", LUA_U8 },
+		{ "s8", LUA_S8 },
+		{ "u16", LUA_U16 },
+		{ "s16", LUA_S16 },
+		{ "u32", LUA_U32 },
+		{ "s32", LUA_S32 },
+		{ "u64", LUA_U64 },
+		{ "s64", LUA_S64 },
+		{ "f32", LUA_F32 },
+		{ "f64", LUA_F64 },
+	};
+
+	auto found = types.find(name);
+	if(found == types.end()) {
+		return false;
+	}
+	type = found->second;
+	return true;
+}
+
+sol::object LuaScripting::decodeValue(LuaMemoryType type, uint8_t* bytes) {
+	lua_State* L = luaState->lua_state();
+
+// Memcpy so unaligned addresses are fine
+// clang-format off
+#define DECODE_VALUE(Type, LuaType) { \
+	Type value; \
+	memcpy(&value, bytes, sizeof(Type)); \
+	return sol::make_object(L, (LuaType)value); \
+}
+	// clang-format on
+
+	switch(type) {
+	case LUA_U8:
+		DECODE_VALUE(uint8_t, int64_t)
+	case LUA_S8:
+		DECODE_VALUE(int8_t, int64_t)
+	case LUA_U16:
+		DECODE_VALUE(uint16_t, int64_t)
+	case LUA_S16:
+		DECODE_VALUE(int16_t, int64_t)
+	case LUA_U32:
+		DECODE_VALUE(uint32_t, int64_t)
+	case LUA_S32:
+		DECODE_VALUE(int32_t, int64_t)
+	case LUA_U64:
+		DECODE_VALUE(uint64_t, int64_t)
+	case LUA_S64:
+		DECODE_VALUE(int64_t, int64_t)
+	case LUA_F32:
+		DECODE_VALUE(float, double)
+	case LUA_F64:
+		DECODE_VALUE(double, double)
+	}
+
+#undef DECODE_VALUE
+
+	return sol::make_object(L, sol::lua_nil);
+}
+
+sol::object LuaScripting::readMemory(const std::string& typeName, uint64_t addr) {
+	LuaMemoryType type;
+	if(!parseType(typeName, type)) {
+		throw sol::error("unknown memory type " + typeName);
+	}
+
+	uint8_t bytes[8];
+	if(!memoryReader || !memoryReader(addr, bytes, getTypeSize(type))) {
+		return sol::make_object(luaState->lua_state(), sol::lua_nil);
+	}
+
+	return decodeValue(type, bytes);
+}
+
+sol::table LuaScripting::readMemoryBatch(sol::table requests) {
+	std::vector<BatchEntry> entries;
+	entries.reserve(requests.size());
+
+	for(size_t i = 1; i <= requests.size(); i++) {
+		sol::table request = requests[i];
+		BatchEntry entry;
+		std::string typeName = request[1];
+		if(!parseType(typeName, entry.type)) {
+			throw sol::error("unknown memory type " + typeName);
+		}
+		entry.addr  = request[2];
+		entry.index = i;
+		entries.push_back(entry);
+	}
+
+	sol::table results = luaState->create_table(entries.size(), 0);
+	if(!memoryReader) {
+		return results;
+	}
+
+	// Sort by address and merge nearby values, so a struct is one read instead of dozens
+	std::sort(entries.begin(), entries.end(), [](const BatchEntry& a, const BatchEntry& b) { return a.addr < b.addr; });
+
+	std::vector<uint8_t> rangeBuf;
+	size_t rangeStart = 0;
+	while(rangeStart < entries.size()) {
+		uint64_t startAddr = entries[rangeStart].addr;
+		uint64_t endAddr   = startAddr + getTypeSize(entries[rangeStart].type);
+
+		size_t rangeEnd = rangeStart + 1;
+		while(rangeEnd < entries.size() && entries[rangeEnd].addr <= endAddr + LUA_BATCH_MERGE_GAP) {
+			endAddr = std::max(endAddr, entries[rangeEnd].addr + getTypeSize(entries[rangeEnd].type));
+			rangeEnd++;
+		}
+
+		rangeBuf.resize(endAddr - startAddr);
+		if(memoryReader(startAddr, rangeBuf.data(), rangeBuf.size())) {
+			for(size_t i = rangeStart; i < rangeEnd; i++) {
+				results[entries[i].index] = decodeValue(entries[i].type, &rangeBuf[entries[i].addr - startAddr]);
 			}
-		} else {
-			break;
 		}
+
+		rangeStart = rangeEnd;
+	}
+
+	return results;
+}
+
+std::shared_ptr<MemoryView> LuaScripting::mapMemory(uint64_t addr, uint64_t size) {
+	if(size == 0) {
+		throw sol::error("memory view can't be empty");
+	}
+
+	std::shared_ptr<MemoryView> view = std::make_shared<MemoryView>(addr, size);
+	// Readable right away, not just from the next frame on
+	if(memoryReader) {
+		view->refresh(memoryReader);
 	}
-}
\ No newline at end of file
+	memoryViews.push_back(view);
+	return view;
+}
+
+void LuaScripting::setInputs(uint8_t player, uint32_t buttons, int16_t lsX, int16_t lsY, int16_t rsX, int16_t rsY) {
+	if(inputSetter) {
+		ControllerData controllerData;
+		controllerData.buttons = buttons;
+		controllerData.LS_X    = lsX;
+		controllerData.LS_Y    = lsY;
+		controllerData.RS_X    = rsX;
+		controllerData.RS_Y    = rsY;
+		inputSetter(player, controllerData);
+	}
+}
+
+#ifdef SIMULATED
+void LuaScripting::benchmark(uint64_t addr, uint32_t numOfValues, uint32_t frames) {
+	// Each one sums the same u32 values every frame
+	const char* scripts[][2] = {
+		{ "readMemory",
+			"local sum = 0\n"
+			"function onFrame()\n"
+			"	sum = 0\n"
+			"	for i = 0, COUNT - 1 do\n"
+			"		sum = sum + switas.readMemory(\"u32\", BASE + i * 4)\n"
+			"	end\n"
+			"end\n" },
+		{ "readMemoryBatch",
+			"local requests = {}\n"
+			"for i = 0, COUNT - 1 do requests[i + 1] = { \"u32\", BASE + i * 4 } end\n"
+			"local sum = 0\n"
+			"function onFrame()\n"
+			"	sum = 0\n"
+			"	for _, value in ipairs(switas.readMemoryBatch(requests)) do\n"
+			"		sum = sum + value\n"
+			"	end\n"
+			"end\n" },
+		{ "mapMemory",
+			"local view = switas.mapMemory(BASE, COUNT * 4)\n"
+			"local sum = 0\n"
+			"function onFrame()\n"
+			"	sum = 0\n"
+			"	for i = 0, COUNT - 1 do\n"
+			"		sum = sum + view:u32(i * 4)\n"
+			"	end\n"
+			"end\n" },
+	};
+
+	char header[128];
+	snprintf(header, sizeof(header), "local BASE = %llu\nlocal COUNT = %u\n", (unsigned long long)addr, numOfValues);
+
+	// The budget would stop the slow versions with a lot of values
+	uint32_t oldBudget = instructionBudget;
+	instructionBudget  = std::numeric_limits<int>::max();
+
+	printf("Lua benchmark: %u u32 values, %u frames\n", numOfValues, frames);
+	for(auto& script : scripts) {
+		std::string source = std::string(header) + script[1];
+		bytecodeCache.erase(hashSource(source));
+
+		auto start = std::chrono::steady_clock::now();
+		loadSource(source, script[0]);
+		double coldLoad = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		loadSource(source, script[0]);
+		double cachedLoad = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		if(!scriptLoaded) {
+			printf("  %s failed to load\n", script[0]);
+			continue;
+		}
+
+		start = std::chrono::steady_clock::now();
+		for(uint32_t i = 0; i < frames; i++) {
+			runFrame();
+		}
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		printf("  %-16s %10.0f values/ms %9.2f us/frame   load %7.1f us cold, %7.1f us cached\n", script[0], (double)numOfValues * frames / elapsed, elapsed * 1000.0 / frames, coldLoad, cachedLoad);
+	}
+
+	endScript();
+	instructionBudget = oldBudget;
+}
+#endif
@@ -1,12 +1,22 @@
 #pragma once
 
-#include <atomic>
-#include <condition_variable>
+// Instructions a single call of onFrame can run before it is aborted
+#define LUA_DEFAULT_INSTRUCTION_BUDGET 1000000
+// Addresses in a batch this close together are read with one memory read
+#define LUA_BATCH_MERGE_GAP 64
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <memory>
-#include <mutex>
 #include <sol/sol.hpp>
 #include <string>
-#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #ifdef __SWITCH__
 #include <switch.h>
@@ -16,27 +26,76 @@
 #include "../yuzuSyscalls.hpp"
 #endif
 
+#include "../buttonData.hpp"
+#include "memoryView.hpp"
+
+enum LuaMemoryType : uint8_t {
+	LUA_U8,
+	LUA_S8,
+	LUA_U16,
+	LUA_S16,
+	LUA_U32,
+	LUA_S32,
+	LUA_U64,
+	LUA_S64,
+	LUA_F32,
+	LUA_F64,
+};
+
+// Scripts define onFrame, which is called synchronously by the main loop once per frame
+// Every syscall is a direct function call, nothing waits on another thread
 class LuaScripting {
 private:
-	sol::state luaState;
+	std::unique_ptr<sol::state> luaState;
 	uint8_t scriptLoaded = false;
-	std::unique_ptr<std::thread> luaExecutionThread;
+	sol::protected_function onFrame;
 
-	std::string luaPath;
+	uint32_t instructionBudget = LUA_DEFAULT_INSTRUCTION_BUDGET;
+	// Number of times onFrame has been called since the script was loaded
+	uint32_t frameNum = 0;
+
+	// Every view is refreshed right before onFrame
+	std::vector<std::shared_ptr<MemoryView>> memoryViews;
+
+	// Compiled chunks keyed by the hash of their source, reloading skips the compiler
+	std::unordered_map<uint64_t, std::string> bytecodeCache;
 
 #ifdef YUZU
 	std::shared_ptr<Syscalls> yuzuSyscalls;
 #endif
 
-	std::atomic_bool syscallReady = false;
-	uint8_t ready                 = false;
-	uint8_t processed             = false;
-	std::mutex syscallMutex;
-	std::condition_variable syscallCv;
+	// Provided by the main loop, returns false if the memory can't be read right now
+	std::function<uint8_t(uint64_t addr, uint8_t* buf, uint64_t size)> memoryReader;
+	std::function<void(uint8_t player, ControllerData& controllerData)> inputSetter;
+	std::function<void(std::string message)> errorHandler;
+
+	struct BatchEntry {
+		uint64_t addr;
+		LuaMemoryType type;
+		int index;
+	};
 
-	void sendSyscall(std::function<void()> func);
+	static uint8_t getTypeSize(LuaMemoryType type);
+	static uint8_t parseType(const std::string& name, LuaMemoryType& type);
+	sol::object decodeValue(LuaMemoryType type, uint8_t* bytes);
 
-	void luaThread();
+	static uint64_t hashSource(const std::string& source);
+	static int writeBytecode(lua_State* L, const void* data, size_t size, void* userdata);
+	// Compiles the source, or pulls it from the cache, then runs the body
+	void loadSource(const std::string& source, const std::string& chunkName);
+
+	// Aborts the script from inside the interpreter once the budget is used up
+	static void budgetHook(lua_State* L, lua_Debug* ar);
+	// Stops the script and reports the error if the call fails
+	uint8_t callWithBudget(sol::protected_function& func);
+
+	void registerSyscalls();
+
+	sol::object readMemory(const std::string& typeName, uint64_t addr);
+	// Takes { { type, addr }, ... } and returns the values in the same order
+	sol::table readMemoryBatch(sol::table requests);
+	std::shared_ptr<MemoryView> mapMemory(uint64_t addr, uint64_t size);
+	void setInputs(uint8_t player, uint32_t buttons, int16_t lsX, int16_t lsY, int16_t rsX, int16_t rsY);
 
 public:
 	LuaScripting();
@@ -46,9 +105,37 @@ public:
 		yuzuSyscalls = syscalls;
 	}
 #endif
+
+	void setMemoryReader(std::function<uint8_t(uint64_t addr, uint8_t* buf, uint64_t size)> reader) {
+		memoryReader = reader;
+	}
+
+	void setInputSetter(std::function<void(uint8_t player, ControllerData& controllerData)> setter) {
+		inputSetter = setter;
+	}
+
+	void setErrorHandler(std::function<void(std::string message)> handler) {
+		errorHandler = handler;
+	}
+
+	void setInstructionBudget(uint32_t budget) {
+		instructionBudget = budget == 0 ? LUA_DEFAULT_INSTRUCTION_BUDGET : budget;
+	}
+
+	uint8_t isLoaded() {
+		return scriptLoaded;
+	}
+
+	// Runs the body of the script, which should define onFrame
 	void loadScript(std::string path);
 
 	void endScript();
 
-	void callMainloop();
-};
\ No newline at end of file
+	// Calls onFrame, cheap if no script is loaded
+	void runFrame();
+
+#ifdef SIMULATED
+	// Compares the ways of reading memory from Lua, prints values read per millisecond
+	void benchmark(uint64_t addr, uint32_t numOfValues, uint32_t frames);
+#endif
+};
@@ -0,0 +1,42 @@
+#include "memoryView.hpp"
+
+sol::table MemoryView::array(sol::this_state state, const std::string& type, uint64_t offset, uint32_t count) {
+	sol::state_view lua(state);
+	sol::table values = lua.create_table(count, 0);
+
+// clang-format off
+#define READ_ARRAY(Type, LuaType) { \
+	for(uint32_t i = 0; i < count; i++) { \
+		values[i + 1] = (LuaType)read<Type>(offset + i * sizeof(Type)); \
+	} \
+}
+	// clang-format on
+
+	if(type == "u8") {
+		READ_ARRAY(uint8_t, int64_t)
+	} else if(type == "s8") {
+		READ_ARRAY(int8_t, int64_t)
+	} else if(type == "u16") {
+		READ_ARRAY(uint16_t, int64_t)
+	} else if(type == "s16") {
+		READ_ARRAY(int16_t, int64_t)
+	} else if(type == "u32") {
+		READ_ARRAY(uint32_t, int64_t)
+	} else if(type == "s32") {
+		READ_ARRAY(int32_t, int64_t)
+	} else if(type == "u64") {
+		READ_ARRAY(uint64_t, int64_t)
+	} else if(type == "s64") {
+		READ_ARRAY(int64_t, int64_t)
+	} else if(type == "f32") {
+		READ_ARRAY(float, double)
+	} else if(type == "f64") {
+		READ_ARRAY(double, double)
+	} else {
+		throw sol::error("unknown memory type " + type);
+	}
+
+#undef READ_ARRAY
+
+	return values;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <sol/sol.hpp>
+#include <string>
+#include <vector>
+
+// A range of game memory copied in once per frame
+// Accessors read straight out of the buffer, no allocation or syscall per value
+class MemoryView {
+private:
+	uint64_t startAddr;
+	std::vector<uint8_t> buffer;
+	uint8_t valid = false;
+
+	template <typename T> T read(uint64_t offset) {
+		if(offset + sizeof(T) > buffer.size()) {
+			throw sol::error("memory view read out of range");
+		}
+		T value;
+		// Memcpy so unaligned offsets are fine
+		memcpy(&value, &buffer[offset], sizeof(T));
+		return value;
+	}
+
+public:
+	MemoryView(uint64_t addr, uint64_t size) {
+		startAddr = addr;
+		buffer.resize(size);
+	}
+
+	// One memory read for the whole range
+	void refresh(std::function<uint8_t(uint64_t addr, uint8_t* buf, uint64_t size)>& reader) {
+		valid = reader(startAddr, buffer.data(), buffer.size());
+	}
+
+	bool isValid() {
+		return valid;
+	}
+
+	uint64_t getAddress() {
+		return startAddr;
+	}
+
+	uint64_t getSize() {
+		return buffer.size();
+	}
+
+	int64_t u8(uint64_t offset) {
+		return read<uint8_t>(offset);
+	}
+	int64_t s8(uint64_t offset) {
+		return read<int8_t>(offset);
+	}
+	int64_t u16(uint64_t offset) {
+		return read<uint16_t>(offset);
+	}
+	int64_t s16(uint64_t offset) {
+		return read<int16_t>(offset);
+	}
+	int64_t u32(uint64_t offset) {
+		return read<uint32_t>(offset);
+	}
+	int64_t s32(uint64_t offset) {
+		return read<int32_t>(offset);
+	}
+	int64_t u64(uint64_t offset) {
+		return read<uint64_t>(offset);
+	}
+	int64_t s64(uint64_t offset) {
+		return read<int64_t>(offset);
+	}
+	double f32(uint64_t offset) {
+		return read<float>(offset);
+	}
+	double f64(uint64_t offset) {
+		return read<double>(offset);
+	}
+
+	// Reads count values of the same type in a row, stride is the size of the type
+	sol::table array(sol::this_state state, const std::string& type, uint64_t offset, uint32_t count);
+};
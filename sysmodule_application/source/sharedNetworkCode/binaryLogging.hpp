@@ -0,0 +1,64 @@
+#pragma once
+
+#include "include/zpp.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#define BINARY_LOG_MAX_ARGS 4
+
+// The switch only records the ID and the arguments, the PC turns them into text
+// Never reorder these, old log files depend on the numbers
+enum LogEventId : uint16_t {
+	LOG_EVENTS_DROPPED,
+	LOG_PAUSING,
+	LOG_RUNNING_FRAME,
+	LOG_FRAME_TIME,
+	LOG_CAPTURE_SKIPPED,
+	LOG_RECIEVED_FLAG,
+	LOG_SET_CONTROLLER_NUMBER,
+	LOG_APPLICATION_CLOSED,
+	LOG_INTERNET_CONNECTED,
+	LOG_INTERNET_DISCONNECTED,
+	NUM_OF_LOG_EVENTS,
+};
+
+// Every argument is a uint64_t, so only use %llu, %lld and %llX
+static const char* const logEventFormats[] = {
+	"%llu log events were dropped",
+	"Pausing",
+	"Running frame %llu",
+	"Time taken between frames: %llu ms",
+	"Capture skipped for frame %llu, all buffers busy",
+	"Recieved flag %llu",
+	"Set controller number to %llu",
+	"Application closed",
+	"Internet connected",
+	"Internet disconnected",
+};
+
+struct BinaryLogEvent {
+	uint16_t id;
+	// Nanoseconds since the switch booted
+	uint64_t timestamp;
+	uint64_t args[BINARY_LOG_MAX_ARGS];
+
+	friend zpp::serializer::access;
+	template <typename Archive, typename Self> static void serialize(Archive& archive, Self& self) {
+		// clang-format off
+			archive(self.id, self.timestamp,
+				self.args[0], self.args[1], self.args[2], self.args[3]);
+		// clang-format on
+	}
+};
+
+inline std::string formatLogEvent(const BinaryLogEvent& event) {
+	if(event.id >= LogEventId::NUM_OF_LOG_EVENTS) {
+		return "Unknown log event " + std::to_string(event.id);
+	}
+
+	// Extra arguments are ignored by snprintf
+	char text[256];
+	snprintf(text, sizeof(text), logEventFormats[event.id], (unsigned long long)event.args[0], (unsigned long long)event.args[1], (unsigned long long)event.args[2], (unsigned long long)event.args[3]);
+	return std::string(text);
+}
@@ -35,6 +35,8 @@ enum Btn : uint8_t {
 enum FrameState : uint8_t {
 	RAN,
 	SAVESTATE,
+	// The switch saw the game ignore this frame
+	LAG,
 };
 
 // Controller data that will be packed into the array and will be recieved from
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buttonData.hpp"
+
+// Fields of ControllerData in the order they are written, frameState is never recorded
+enum RecordedInputField : uint8_t {
+	RECORDED_BUTTONS,
+	RECORDED_LS_X,
+	RECORDED_LS_Y,
+	RECORDED_RS_X,
+	RECORDED_RS_Y,
+	RECORDED_ACCEL_X,
+	RECORDED_ACCEL_Y,
+	RECORDED_ACCEL_Z,
+	RECORDED_GYRO_1,
+	RECORDED_GYRO_2,
+	RECORDED_GYRO_3,
+	NUM_OF_RECORDED_FIELDS,
+};
+
+// Each frame is a little endian uint16_t of the fields that changed since the frame before, then only those fields
+// Held buttons and a still stick cost two bytes a frame
+// The first frame of a batch is compared with a blank ControllerData, so batches can be decoded on their own
+inline void encodeInputDelta(const ControllerData& previous, const ControllerData& current, std::vector<uint8_t>& buf) {
+	const int16_t previousValues[] = { previous.LS_X, previous.LS_Y, previous.RS_X, previous.RS_Y, previous.ACCEL_X, previous.ACCEL_Y, previous.ACCEL_Z, previous.GYRO_1, previous.GYRO_2, previous.GYRO_3 };
+	const int16_t currentValues[]  = { current.LS_X, current.LS_Y, current.RS_X, current.RS_Y, current.ACCEL_X, current.ACCEL_Y, current.ACCEL_Z, current.GYRO_1, current.GYRO_2, current.GYRO_3 };
+
+	uint16_t changed = 0;
+	if(previous.buttons != current.buttons) {
+		changed |= 1 << RecordedInputField::RECORDED_BUTTONS;
+	}
+	for(uint8_t i = 0; i < NUM_OF_RECORDED_FIELDS - 1; i++) {
+		if(previousValues[i] != currentValues[i]) {
+			changed |= 1 << (i + 1);
+		}
+	}
+
+	buf.push_back(changed & 0xFF);
+	buf.push_back(changed >> 8);
+
+	if(changed & (1 << RecordedInputField::RECORDED_BUTTONS)) {
+		for(uint8_t byte = 0; byte < sizeof(current.buttons); byte++) {
+			buf.push_back((current.buttons >> (byte * 8)) & 0xFF);
+		}
+	}
+	for(uint8_t i = 0; i < NUM_OF_RECORDED_FIELDS - 1; i++) {
+		if(changed & (1 << (i + 1))) {
+			buf.push_back((uint16_t)currentValues[i] & 0xFF);
+			buf.push_back((uint16_t)currentValues[i] >> 8);
+		}
+	}
+}
+
+// controllerData has to hold the frame before, it becomes the decoded frame
+// Returns false if the delta runs past the end
+inline uint8_t decodeInputDelta(const uint8_t*& pointer, const uint8_t* end, ControllerData& controllerData) {
+	if(end - pointer < 2) {
+		return false;
+	}
+	uint16_t changed = pointer[0] | (pointer[1] << 8);
+	pointer += 2;
+
+	if(changed & (1 << RecordedInputField::RECORDED_BUTTONS)) {
+		if(end - pointer < (long)sizeof(controllerData.buttons)) {
+			return false;
+		}
+		controllerData.buttons = 0;
+		for(uint8_t byte = 0; byte < sizeof(controllerData.buttons); byte++) {
+			controllerData.buttons |= (uint32_t)pointer[byte] << (byte * 8);
+		}
+		pointer += sizeof(controllerData.buttons);
+	}
+
+	int16_t* values[] = { &controllerData.LS_X, &controllerData.LS_Y, &controllerData.RS_X, &controllerData.RS_Y, &controllerData.ACCEL_X, &controllerData.ACCEL_Y, &controllerData.ACCEL_Z, &controllerData.GYRO_1, &controllerData.GYRO_2, &controllerData.GYRO_3 };
+	for(uint8_t i = 0; i < NUM_OF_RECORDED_FIELDS - 1; i++) {
+		if(changed & (1 << (i + 1))) {
+			if(end - pointer < 2) {
+				return false;
+			}
+			*values[i] = (int16_t)(pointer[0] | (pointer[1] << 8));
+			pointer += 2;
+		}
+	}
+
+	return true;
+}
+
+// Every frame of a batch, empty if it is malformed
+inline std::vector<ControllerData> decodeInputBatch(const std::vector<uint8_t>& deltas, uint32_t numOfFrames) {
+	std::vector<ControllerData> frames;
+	frames.reserve(numOfFrames);
+
+	ControllerData controllerData;
+	const uint8_t* pointer = deltas.data();
+	const uint8_t* end     = deltas.data() + deltas.size();
+	for(uint32_t i = 0; i < numOfFrames; i++) {
+		if(!decodeInputDelta(pointer, end, controllerData)) {
+			return std::vector<ControllerData>();
+		}
+		frames.push_back(controllerData);
+	}
+
+	return frames;
+}
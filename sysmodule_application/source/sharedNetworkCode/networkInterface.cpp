@@ -158,7 +158,8 @@ void CommunicateWithNetwork::waitForNetworkConnection() {
 			connectedToSocket = true;
 			break;
 		} else {
-			handleSocketError("during server accept attempts");
+			// There is no connection yet, the error is on the listening socket
+			handleSocketError(&listeningServer, "during server accept attempts");
 		}
 		// Wait briefly
 		yieldThread();
@@ -201,6 +202,7 @@ void CommunicateWithNetwork::endNetwork() {
 	CLEAN_QUEUE(SendFlag)
 	CLEAN_QUEUE(SendLogging)
 	CLEAN_QUEUE(RecieveLogging)
+	CLEAN_QUEUE(RecieveBinaryLogging)
 	CLEAN_QUEUE(RecieveFlag)
 	CLEAN_QUEUE(RecieveApplicationConnected)
 	CLEAN_QUEUE(SendTrackMemoryRegion)
@@ -208,17 +210,29 @@ void CommunicateWithNetwork::endNetwork() {
 	CLEAN_QUEUE(RecieveMemoryRegion)
 	CLEAN_QUEUE(SendAddMemoryRegion)
 	CLEAN_QUEUE(SendStartFinalTas)
+	CLEAN_QUEUE(SendLuaScript)
+	CLEAN_QUEUE(RecieveFinalTasCheckpoint)
+	CLEAN_QUEUE(RecieveFinalTasFinished)
+	CLEAN_QUEUE(SendRewindOptions)
+	CLEAN_QUEUE(SendJumpToFrame)
+	CLEAN_QUEUE(RecieveJumpToFrame)
+	CLEAN_QUEUE(SendRamHashRanges)
+	CLEAN_QUEUE(SendLagDetection)
+	CLEAN_QUEUE(SendFrameAdvanceStrategy)
+	CLEAN_QUEUE(RecieveFrameAdvanceStats)
+	CLEAN_QUEUE(SendInputRecording)
+	CLEAN_QUEUE(RecieveRecordedInputs)
 
 #ifdef SERVER_IMP
 	listeningServer.Close();
 #endif
 }
 
-bool CommunicateWithNetwork::handleSocketError(const char* extraMessage) {
+bool CommunicateWithNetwork::handleSocketError(CSimpleSocket* socket, const char* extraMessage) {
 	// Return true if it's a fatal error that should try to reconnect sockets
 	//   false if there is no error
-	networkConnection->TranslateSocketError();
-	CSimpleSocket::CSocketError e = networkConnection->GetSocketError();
+	socket->TranslateSocketError();
+	CSimpleSocket::CSocketError e = socket->GetSocketError();
 	lastError                     = e;
 	// Some errors are just annoying and spam
 	// clang-format off
@@ -231,10 +245,10 @@ bool CommunicateWithNetwork::handleSocketError(const char* extraMessage) {
 		return false;
 	} else {
 #ifdef __SWITCH__
-		LOGD << std::string(networkConnection->DescribeError(e)) << " " << std::string(extraMessage);
+		LOGD << std::string(socket->DescribeError(e)) << " " << std::string(extraMessage);
 #endif
 #ifdef CLIENT_IMP
-		wxLogMessage(wxString::FromUTF8(networkConnection->DescribeError(e)) + " " + extraMessage);
+		wxLogMessage(wxString::FromUTF8(socket->DescribeError(e)) + " " + extraMessage);
 #endif
 		// clang-format off
 		if(e == E::SocketConnectionRefused
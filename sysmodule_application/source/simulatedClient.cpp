@@ -0,0 +1,327 @@
+#include "simulatedClient.hpp"
+
+#ifdef SIMULATED
+
+SimulatedClient::SimulatedClient(uint32_t frames) {
+	numOfFrames = frames;
+	done        = false;
+	frameTimes.reserve(frames);
+	setLagDetection(LagDetectionMethod::LAG_DETECTION_NONE, false);
+}
+
+bool SimulatedClient::readFull(void* buf, uint32_t size) {
+	uint8_t* pointer   = (uint8_t*)buf;
+	uint32_t bytesRead = 0;
+	while(bytesRead != size) {
+		int32_t res = connection.Receive(size - bytesRead, &pointer[bytesRead]);
+		if(res <= 0) {
+			// Includes the timeout, the sysmodule should never take that long
+			return false;
+		}
+		bytesRead += res;
+	}
+	return true;
+}
+
+bool SimulatedClient::sendFull(void* buf, uint32_t size) {
+	uint8_t* pointer   = (uint8_t*)buf;
+	uint32_t bytesSent = 0;
+	while(bytesSent != size) {
+		int32_t res = connection.Send(&pointer[bytesSent], size - bytesSent);
+		if(res <= 0) {
+			return false;
+		}
+		bytesSent += res;
+	}
+	return true;
+}
+
+bool SimulatedClient::readUntil(std::function<bool(DataFlag flag, uint8_t* data, uint32_t size)> handler) {
+	std::vector<uint8_t> data;
+	while(true) {
+		uint32_t dataSize;
+		DataFlag flag;
+		if(!readFull(&dataSize, sizeof(dataSize)) || !readFull(&flag, sizeof(flag))) {
+			return false;
+		}
+
+		data.resize(ntohl(dataSize));
+		if(!readFull(data.data(), data.size())) {
+			return false;
+		}
+
+		if(flag == DataFlag::RecieveGameFramebuffer) {
+			Protocol::Struct_RecieveGameFramebuffer framebuffer;
+			serializeProtocol.binaryToData<Protocol::Struct_RecieveGameFramebuffer>(framebuffer, data.data(), data.size());
+			if(framebuffer.ramHashIncluded) {
+				lastRamHash = framebuffer.ramHash;
+			}
+			if(framebuffer.fromFrameAdvance && !framebuffer.fromCaptureWorker) {
+				lagFrames += framebuffer.isLagFrame + framebuffer.lagFramesSkipped;
+				lagFramesSkipped += framebuffer.lagFramesSkipped;
+			}
+			if(framebuffer.fromCaptureWorker) {
+				lastDhash         = framebuffer.dhash;
+				lastDhashIncluded = framebuffer.dhashIncluded;
+				capturesOutstanding--;
+			} else if(framebuffer.captureFollows) {
+				capturesOutstanding++;
+			}
+		}
+
+		if(handler(flag, data.data(), data.size())) {
+			return true;
+		}
+	}
+}
+
+ControllerData SimulatedClient::getInputsForFrame(uint32_t frame) {
+	ControllerData controllerData;
+	// Mash A and sweep the left stick back and forth
+	SET_BIT(controllerData.buttons, (frame / 3) % 2, Btn::A);
+	controllerData.LS_X = ((int32_t)(frame * 37 % 200) - 100) * 300;
+	controllerData.LS_Y = ((int32_t)(frame * 11 % 120) - 60) * 500;
+	return controllerData;
+}
+
+bool SimulatedClient::recordInputs() {
+	// Where the recording starts, the replay has to start from the same place
+	std::vector<uint8_t> startState;
+	platform->saveState(startState);
+
+	Protocol::Struct_SendInputRecording recording;
+	recording.recording        = true;
+	recording.savestateHookNum = 0;
+	recording.branchIndex      = 0;
+	recording.playerIndex      = 0;
+	recording.startFrame       = 0;
+	if(!sendMessage(recording)) {
+		return false;
+	}
+
+	// Presses are a bit faster than the game, so they land anywhere within a frame
+	auto end        = std::chrono::steady_clock::now() + std::chrono::microseconds(16667) * recordFrames;
+	uint32_t change = 0;
+	while(std::chrono::steady_clock::now() < end) {
+		ControllerData physical = getInputsForFrame(change++);
+		platform->setPhysicalController(physical);
+		std::this_thread::sleep_for(std::chrono::milliseconds(7));
+	}
+
+	recording.recording = false;
+	if(!sendMessage(recording)) {
+		return false;
+	}
+
+	// The final batch comes after the game is paused again
+	uint8_t finished = false;
+	auto isFinished  = [this, &finished](DataFlag flag, uint8_t* data, uint32_t size) {
+		if(flag == DataFlag::RecieveRecordedInputs) {
+			Protocol::Struct_RecieveRecordedInputs message;
+			serializeProtocol.binaryToData<Protocol::Struct_RecieveRecordedInputs>(message, data, size);
+
+			std::vector<ControllerData> frames = decodeInputBatch(message.deltas, message.numOfFrames);
+			if(message.firstFrame != recordedInputs.size() || frames.size() != message.numOfFrames) {
+				recordingMalformed = true;
+			}
+			recordedInputs.insert(recordedInputs.end(), frames.begin(), frames.end());
+			recordedBatches++;
+			recordedBytes += message.deltas.size();
+			finished = message.finished;
+		}
+		return finished;
+	};
+
+	if(!readUntil(isFinished)) {
+		return false;
+	}
+	platform->detachPhysicalController();
+	platform->saveState(recordingEndState);
+
+	return !recordingMalformed && platform->loadState(startState);
+}
+
+void SimulatedClient::run() {
+	connection.Initialize();
+
+	// The sysmodule might not be listening yet
+	uint8_t connected = false;
+	for(uint16_t attempt = 0; attempt < 500; attempt++) {
+		if(connection.Open("127.0.0.1", SERVER_PORT)) {
+			connected = true;
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	if(!connected) {
+		printf("Could not connect to the simulated sysmodule\n");
+		done = true;
+		return;
+	}
+
+	connection.SetBlocking();
+	connection.SetReceiveTimeout(5, 0);
+
+	auto isFlag = [](RecieveInfo info) {
+		return [info](DataFlag flag, uint8_t* data, uint32_t size) {
+			if(flag == DataFlag::RecieveFlag) {
+				Protocol::Struct_RecieveFlag message;
+				SerializeProtocol().binaryToData<Protocol::Struct_RecieveFlag>(message, data, size);
+				return message.actFlag == info;
+			}
+			return false;
+		};
+	};
+
+	auto isAdvance = [](uint8_t fromFrameAdvance, uint32_t frame) {
+		return [fromFrameAdvance, frame](DataFlag flag, uint8_t* data, uint32_t size) {
+			if(flag == DataFlag::RecieveGameFramebuffer) {
+				Protocol::Struct_RecieveGameFramebuffer message;
+				SerializeProtocol().binaryToData<Protocol::Struct_RecieveGameFramebuffer>(message, data, size);
+				return !message.fromCaptureWorker && message.fromFrameAdvance == fromFrameAdvance && message.frame == frame;
+			}
+			return false;
+		};
+	};
+
+	Protocol::Struct_SendSetNumControllers setNumControllers;
+	setNumControllers.size = 1;
+	if(!sendMessage(setNumControllers) || !readUntil(isFlag(RecieveInfo::CONTROLLERS_CONNECTED))) {
+		printf("Controllers were never connected\n");
+		done = true;
+		return;
+	}
+
+	// Hash all of the memory so every advance is verified like the PC would
+	Protocol::Struct_SendRamHashRanges ramHashRanges;
+	ramHashRanges.addresses.push_back(SIMULATED_RAM_BASE);
+	ramHashRanges.lengths.push_back(SIMULATED_RAM_SIZE);
+	sendMessage(ramHashRanges);
+	sendMessage(lagDetection);
+	if(advanceStrategySet) {
+		sendMessage(advanceStrategy);
+	}
+
+	if(!sendFlag(SendInfo::PAUSE) || !readUntil(isAdvance(false, 0))) {
+		printf("Game could not be paused\n");
+		done = true;
+		return;
+	}
+
+	if(recordFrames != 0) {
+		if(!recordInputs()) {
+			printf("Inputs could not be recorded\n");
+			done = true;
+			return;
+		}
+		// Replaying the recording has to end up in the same place
+		numOfFrames = recordedInputs.size();
+	}
+
+	for(uint32_t frame = 0; frame < numOfFrames; frame++) {
+		Protocol::Struct_SendFrameData frameData;
+		frameData.controllerData     = recordFrames != 0 ? recordedInputs[frame] : getInputsForFrame(frame);
+		frameData.frame              = frame;
+		frameData.savestateHookNum   = 0;
+		frameData.branchIndex        = 0;
+		frameData.playerIndex        = 0;
+		frameData.incrementFrame     = false;
+		frameData.includeFramebuffer = false;
+		frameData.isAutoRun          = false;
+
+		auto start = std::chrono::steady_clock::now();
+
+		// Same pair of messages the piano roll sends per frame, or the auto advance when skipping lag
+		uint8_t success = sendMessage(frameData);
+		if(lagDetection.skipLagFrames) {
+			frameData.isAutoRun = true;
+		} else {
+			frameData.incrementFrame = true;
+		}
+		success = success && sendMessage(frameData);
+
+		if(!success || !readUntil(isAdvance(true, frame))) {
+			printf("Frame %u was never acknowledged\n", frame);
+			done = true;
+			return;
+		}
+
+		frameTimes.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	// The last capture carries the final dHash
+	if(capturesOutstanding != 0) {
+		readUntil([this](DataFlag flag, uint8_t* data, uint32_t size) { return capturesOutstanding == 0; });
+	}
+
+	// One message per strategy, only the one that ran is printed
+	uint8_t statsLeft = FrameAdvanceStrategyType::NUM_OF_FRAME_ADVANCE_STRATEGIES;
+	if(sendFlag(SendInfo::GET_FRAME_ADVANCE_STATS)) {
+		readUntil([this, &statsLeft](DataFlag flag, uint8_t* data, uint32_t size) {
+			if(flag == DataFlag::RecieveFrameAdvanceStats) {
+				Protocol::Struct_RecieveFrameAdvanceStats message;
+				serializeProtocol.binaryToData<Protocol::Struct_RecieveFrameAdvanceStats>(message, data, size);
+				if(message.active) {
+					advanceStats         = message;
+					advanceStatsRecieved = true;
+				}
+				statsLeft--;
+			}
+			return statsLeft == 0;
+		});
+	}
+
+	sendFlag(SendInfo::UNPAUSE);
+	connection.Close();
+
+	if(recordFrames != 0) {
+		// Compares the whole game, not just the hashed ranges
+		std::vector<uint8_t> replayEndState;
+		platform->saveState(replayEndState);
+		replayMatches = replayEndState == recordingEndState;
+	}
+
+	succeeded = lastDhashIncluded && (recordFrames == 0 || replayMatches);
+	done      = true;
+}
+
+void SimulatedClient::printResults() {
+	if(frameTimes.empty()) {
+		printf("No frames were run\n");
+		return;
+	}
+
+	std::vector<uint64_t> sorted = frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+
+	uint64_t total = 0;
+	for(uint64_t time : sorted) {
+		total += time;
+	}
+
+	printf("Frames:     %zu\n", sorted.size());
+	printf("Min:        %.3f ms\n", sorted.front() / 1000000.0);
+	printf("Average:    %.3f ms\n", total / (double)sorted.size() / 1000000.0);
+	printf("Median:     %.3f ms\n", sorted[sorted.size() / 2] / 1000000.0);
+	printf("99th:       %.3f ms\n", sorted[sorted.size() * 99 / 100] / 1000000.0);
+	printf("Max:        %.3f ms\n", sorted.back() / 1000000.0);
+	printf("Final dHash: %016llx\n", (unsigned long long)lastDhash);
+	printf("Final RAM hash: %016llx\n", (unsigned long long)lastRamHash);
+	if(advanceStatsRecieved) {
+		const char* names[] = { "vsync", "single", "step" };
+		printf("Advance strategy: %s\n", names[advanceStats.strategy]);
+		printf("Advance average: %.3f ms\n", advanceStats.averageNanoseconds / 1000000.0);
+		printf("Advance median: %.3f ms\n", advanceStats.medianNanoseconds / 1000000.0);
+		printf("Advance 99th: %.3f ms\n", advanceStats.percentile99Nanoseconds / 1000000.0);
+	}
+	if(lagDetection.method != LagDetectionMethod::LAG_DETECTION_NONE) {
+		printf("Lag frames: %u (%u skipped)\n", lagFrames, lagFramesSkipped);
+	}
+	if(recordFrames != 0) {
+		printf("Recorded frames: %zu in %u batches, %llu bytes\n", recordedInputs.size(), recordedBatches, (unsigned long long)recordedBytes);
+		printf("Replay %s\n", replayMatches ? "matches" : "desynced");
+	}
+}
+
+#endif
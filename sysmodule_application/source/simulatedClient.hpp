@@ -0,0 +1,126 @@
+#pragma once
+
+#ifdef SIMULATED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "sharedNetworkCode/networkInterface.hpp"
+#include "simulatedPlatform.hpp"
+
+// Stands in for the PC application when benchmarking the simulated platform
+// Connects over the real socket and frame advances like the piano roll does
+class SimulatedClient {
+private:
+	CActiveSocket connection;
+	SerializeProtocol serializeProtocol;
+
+	uint32_t numOfFrames;
+	std::atomic_bool done;
+	uint8_t succeeded = false;
+
+	// Nanoseconds from sending the advance to recieving the acknowledgement
+	std::vector<uint64_t> frameTimes;
+	uint64_t lastDhash           = 0;
+	uint8_t lastDhashIncluded    = false;
+	uint32_t capturesOutstanding = 0;
+	uint64_t lastRamHash         = 0;
+
+	Protocol::Struct_SendLagDetection lagDetection;
+	uint32_t lagFrames        = 0;
+	uint32_t lagFramesSkipped = 0;
+
+	uint8_t advanceStrategySet = false;
+	Protocol::Struct_SendFrameAdvanceStrategy advanceStrategy;
+	// Timed on the sysmodule side, without the network
+	Protocol::Struct_RecieveFrameAdvanceStats advanceStats;
+	uint8_t advanceStatsRecieved = false;
+
+	// Record bench, a person plays for this many frames and the recording is replayed with frame advance
+	uint32_t recordFrames = 0;
+	std::shared_ptr<SimulatedPlatform> platform;
+	std::vector<ControllerData> recordedInputs;
+	uint32_t recordedBatches   = 0;
+	uint64_t recordedBytes     = 0;
+	uint8_t recordingMalformed = false;
+	// The whole game RAM when the recording stopped
+	std::vector<uint8_t> recordingEndState;
+	uint8_t replayMatches = false;
+
+	bool readFull(void* buf, uint32_t size);
+	bool sendFull(void* buf, uint32_t size);
+
+	template <typename T> bool sendMessage(T& message) {
+		uint8_t* data;
+		uint32_t size;
+		serializeProtocol.dataToBinary<T>(message, &data, &size);
+		uint32_t dataSize = htonl(size);
+
+		bool success = sendFull(&dataSize, sizeof(dataSize)) && sendFull(&message.flag, sizeof(DataFlag)) && sendFull(data, size);
+		free(data);
+		return success;
+	}
+
+	bool sendFlag(SendInfo info) {
+		Protocol::Struct_SendFlag message;
+		message.actFlag = info;
+		return sendMessage(message);
+	}
+
+	// Reads messages until the handler returns true, framebuffer captures are always recorded
+	bool readUntil(std::function<bool(DataFlag flag, uint8_t* data, uint32_t size)> handler);
+
+	// Deterministic inputs so the final dHash can be compared between runs
+	static ControllerData getInputsForFrame(uint32_t frame);
+
+	// Plays on the physical controller while the sysmodule records, the game has to be paused
+	bool recordInputs();
+
+public:
+	SimulatedClient(uint32_t frames);
+
+	// Skipping runs every frame like the auto advance does
+	void setLagDetection(LagDetectionMethod method, uint8_t skip) {
+		lagDetection.method         = method;
+		lagDetection.counterAddress = SIMULATED_RAM_BASE + INPUT_POLLS;
+		lagDetection.counterSize    = sizeof(uint32_t);
+		lagDetection.skipLagFrames  = skip;
+	}
+
+	// Otherwise the sysmodule uses its default
+	void setFrameAdvanceStrategy(FrameAdvanceStrategyType strategy) {
+		advanceStrategy.strategy   = strategy;
+		advanceStrategy.resetStats = true;
+		advanceStrategySet         = true;
+	}
+
+	// Only works throttled, the game has to run in realtime to be recorded
+	void setRecordBench(uint32_t frames, std::shared_ptr<SimulatedPlatform> simulatedPlatform) {
+		recordFrames = frames;
+		platform     = simulatedPlatform;
+	}
+
+	void run();
+
+	uint8_t isDone() {
+		return done;
+	}
+
+	uint8_t hasSucceeded() {
+		return succeeded;
+	}
+
+	uint64_t getLastDhash() {
+		return lastDhash;
+	}
+
+	void printResults();
+};
+
+#endif
@@ -0,0 +1,237 @@
+#include "simulatedPlatform.hpp"
+
+#ifdef SIMULATED
+
+SimulatedPlatform::SimulatedPlatform() {
+	ram.resize(SIMULATED_RAM_SIZE, 0);
+	framebuffer.resize(SIMULATED_SCREEN_WIDTH * SIMULATED_SCREEN_HEIGHT * 4);
+
+	// Start in the middle of the screen
+	writeRam<int32_t>(PLAYER_X, SIMULATED_SCREEN_WIDTH / 2);
+	writeRam<int32_t>(PLAYER_Y, SIMULATED_SCREEN_HEIGHT / 2);
+	writeRam<uint64_t>(RNG_STATE, 0x5357544153ULL);
+
+	nextVsync = std::chrono::steady_clock::now() + vsyncInterval;
+}
+
+void SimulatedPlatform::stepGame() {
+	// Only the first controller controls the game
+	ControllerData& player = controllerStates[0];
+
+	uint64_t frame = readRam<uint64_t>(FRAME_COUNTER) + 1;
+	writeRam<uint64_t>(FRAME_COUNTER, frame);
+
+	// Every 50th frame the game "lags" and ignores input entirely
+	if(frame % 50 == 0) {
+		writeRam<uint32_t>(LAG_COUNTER, readRam<uint32_t>(LAG_COUNTER) + 1);
+		return;
+	}
+
+	writeRam<uint32_t>(INPUT_POLLS, readRam<uint32_t>(INPUT_POLLS) + 1);
+
+	int32_t x = readRam<int32_t>(PLAYER_X) + player.LS_X / 2000;
+	int32_t y = readRam<int32_t>(PLAYER_Y) - player.LS_Y / 2000;
+	x         = std::max(0, std::min(x, SIMULATED_SCREEN_WIDTH - 64));
+	y         = std::max(0, std::min(y, SIMULATED_SCREEN_HEIGHT - 64));
+	writeRam<int32_t>(PLAYER_X, x);
+	writeRam<int32_t>(PLAYER_Y, y);
+
+	uint32_t lastButtons = readRam<uint32_t>(LAST_BUTTONS);
+	if(GET_BIT(player.buttons, Btn::A) && !(GET_BIT(lastButtons, Btn::A))) {
+		writeRam<uint32_t>(A_PRESSES, readRam<uint32_t>(A_PRESSES) + 1);
+	}
+	writeRam<uint32_t>(LAST_BUTTONS, player.buttons);
+
+	// xorshift64, inputs are mixed in so any desync shows up quickly
+	uint64_t rng = readRam<uint64_t>(RNG_STATE) ^ player.buttons ^ ((uint64_t)(uint16_t)player.LS_X << 32);
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	writeRam<uint64_t>(RNG_STATE, rng);
+
+	// Touch some scratch memory so memory reads have something to look at
+	uint64_t scratchSlots = (SIMULATED_RAM_SIZE - SCRATCH_MEMORY) / sizeof(uint64_t);
+	writeRam<uint64_t>(SCRATCH_MEMORY + (frame % scratchSlots) * sizeof(uint64_t), rng);
+
+	framebufferDirty = true;
+}
+
+void SimulatedPlatform::renderFramebuffer() {
+	uint64_t frame   = readRam<uint64_t>(FRAME_COUNTER);
+	int32_t playerX  = readRam<int32_t>(PLAYER_X);
+	int32_t playerY  = readRam<int32_t>(PLAYER_Y);
+	uint8_t presses  = readRam<uint32_t>(A_PRESSES) * 16;
+	uint8_t* pointer = framebuffer.data();
+
+	for(int32_t y = 0; y < SIMULATED_SCREEN_HEIGHT; y++) {
+		uint8_t insideY = y >= playerY && y < playerY + 64;
+		for(int32_t x = 0; x < SIMULATED_SCREEN_WIDTH; x++) {
+			if(insideY && x >= playerX && x < playerX + 64) {
+				pointer[0] = 255;
+				pointer[1] = 255;
+				pointer[2] = 255;
+			} else {
+				pointer[0] = (uint8_t)(y + frame);
+				pointer[1] = x * 255 / SIMULATED_SCREEN_WIDTH;
+				pointer[2] = presses;
+			}
+			pointer[3] = 255;
+			pointer += 4;
+		}
+	}
+
+	framebufferDirty = false;
+}
+
+void SimulatedPlatform::waitForVsync() {
+	if(throttled) {
+		std::this_thread::sleep_until(nextVsync);
+		nextVsync += vsyncInterval;
+	}
+
+	std::unique_lock<std::mutex> lock(platformMutex);
+	if(!paused) {
+		stepGame();
+	}
+}
+
+void SimulatedPlatform::update() {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	// Unthrottled, frames only run when vsync is waited on, that keeps benchmarks deterministic
+	if(paused || !throttled) {
+		return;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	while(now >= nextVsync) {
+		stepGame();
+		nextVsync += vsyncInterval;
+	}
+}
+
+void SimulatedPlatform::pause() {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	paused = true;
+}
+
+void SimulatedPlatform::unpause() {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	paused = false;
+	// Don't run every frame that passed while paused
+	nextVsync = std::max(nextVsync, std::chrono::steady_clock::now());
+}
+
+void SimulatedPlatform::stepFrame() {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	stepGame();
+}
+
+uint64_t SimulatedPlatform::getFrameCount() {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	return readRam<uint64_t>(FRAME_COUNTER);
+}
+
+uint64_t SimulatedPlatform::getInputPollCount() {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	return readRam<uint32_t>(INPUT_POLLS);
+}
+
+uint8_t SimulatedPlatform::readMemory(uint64_t addr, uint8_t* buf, uint64_t size) {
+	if(addr < SIMULATED_RAM_BASE || addr + size > SIMULATED_RAM_BASE + SIMULATED_RAM_SIZE) {
+		memset(buf, 0, size);
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(platformMutex);
+	memcpy(buf, &ram[addr - SIMULATED_RAM_BASE], size);
+	return true;
+}
+
+void SimulatedPlatform::saveState(std::vector<uint8_t>& buf) {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	buf = ram;
+}
+
+uint8_t SimulatedPlatform::loadState(const std::vector<uint8_t>& buf) {
+	if(buf.size() != SIMULATED_RAM_SIZE) {
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(platformMutex);
+	ram              = buf;
+	framebufferDirty = true;
+	return true;
+}
+
+uint8_t SimulatedPlatform::attachController() {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	for(uint8_t i = 0; i < SIMULATED_MAX_CONTROLLERS; i++) {
+		if(!controllerAttached[i]) {
+			controllerAttached[i] = true;
+			controllerStates[i]   = ControllerData();
+			return i;
+		}
+	}
+	// Out of controllers, just share the last one
+	return SIMULATED_MAX_CONTROLLERS - 1;
+}
+
+void SimulatedPlatform::detachController(uint8_t index) {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	controllerAttached[index] = false;
+	controllerStates[index]   = ControllerData();
+}
+
+void SimulatedPlatform::setControllerState(uint8_t index, ControllerData& state) {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	controllerStates[index] = state;
+}
+
+uint8_t SimulatedPlatform::getNumControllers() {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	uint8_t num = 0;
+	for(uint8_t i = 0; i < SIMULATED_MAX_CONTROLLERS; i++) {
+		if(controllerAttached[i]) {
+			num++;
+		}
+	}
+	return num;
+}
+
+void SimulatedPlatform::setPhysicalController(ControllerData& state) {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	physicalController         = state;
+	physicalControllerAttached = true;
+}
+
+void SimulatedPlatform::detachPhysicalController() {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	physicalController         = ControllerData();
+	physicalControllerAttached = false;
+}
+
+uint8_t SimulatedPlatform::readPhysicalController(ControllerData& state) {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	if(physicalControllerAttached) {
+		state = physicalController;
+	}
+	return physicalControllerAttached;
+}
+
+void SimulatedPlatform::readFramebufferRow(uint16_t y, uint8_t* buf) {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	if(framebufferDirty) {
+		renderFramebuffer();
+	}
+	memcpy(buf, &framebuffer[y * SIMULATED_SCREEN_WIDTH * 4], SIMULATED_SCREEN_WIDTH * 4);
+}
+
+void SimulatedPlatform::readPixel(uint16_t x, uint16_t y, uint8_t* rgba) {
+	std::unique_lock<std::mutex> lock(platformMutex);
+	if(framebufferDirty) {
+		renderFramebuffer();
+	}
+	memcpy(rgba, &framebuffer[(y * SIMULATED_SCREEN_WIDTH + x) * 4], 4);
+}
+
+#endif
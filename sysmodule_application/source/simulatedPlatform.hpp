@@ -0,0 +1,125 @@
+#pragma once
+
+#ifdef SIMULATED
+
+#define SIMULATED_SCREEN_WIDTH 1280
+#define SIMULATED_SCREEN_HEIGHT 720
+// Game memory is exposed starting at this fake address
+#define SIMULATED_RAM_BASE 0x8000000
+#define SIMULATED_RAM_SIZE 0x100000
+#define SIMULATED_MAX_CONTROLLERS 8
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "buttonData.hpp"
+
+// Layout of the fake game's RAM, everything is little endian
+// Lua scripts and memory watches can rely on these
+enum SimulatedRamLayout : uint64_t {
+	FRAME_COUNTER  = 0x00,
+	PLAYER_X       = 0x08,
+	PLAYER_Y       = 0x0C,
+	LAST_BUTTONS   = 0x10,
+	A_PRESSES      = 0x14,
+	RNG_STATE      = 0x18,
+	LAG_COUNTER    = 0x20,
+	// Only counts frames where the game read the controllers
+	INPUT_POLLS    = 0x24,
+	SCRATCH_MEMORY = 0x1000,
+};
+
+// Stands in for the switch in a plain Linux process
+// A fake game that only advances on vsync, a HID sink and a generated framebuffer
+// Everything is deterministic, the same inputs always give the same RAM and screen
+class SimulatedPlatform {
+private:
+	std::mutex platformMutex;
+
+	uint8_t paused    = false;
+	uint8_t throttled = true;
+
+	std::chrono::steady_clock::time_point nextVsync;
+	const std::chrono::nanoseconds vsyncInterval { 16666667 };
+
+	std::vector<uint8_t> ram;
+	// RGBA, only regenerated when somebody reads it
+	std::vector<uint8_t> framebuffer;
+	uint8_t framebufferDirty = true;
+
+	ControllerData controllerStates[SIMULATED_MAX_CONTROLLERS];
+	uint8_t controllerAttached[SIMULATED_MAX_CONTROLLERS] = { false };
+
+	// Somebody holding a real controller, it only reaches the game through a TAS controller
+	ControllerData physicalController;
+	uint8_t physicalControllerAttached = false;
+
+	template <typename T> T readRam(uint64_t offset) {
+		T value;
+		memcpy(&value, &ram[offset], sizeof(T));
+		return value;
+	}
+
+	template <typename T> void writeRam(uint64_t offset, T value) {
+		memcpy(&ram[offset], &value, sizeof(T));
+	}
+
+	// Runs one game logic frame with the current controller states
+	void stepGame();
+	void renderFramebuffer();
+
+public:
+	SimulatedPlatform();
+
+	// When false, vsync returns immediately and the game only advances when vsync is waited on
+	void setThrottled(uint8_t throttle) {
+		throttled = throttle;
+	}
+
+	uint8_t isThrottled() {
+		return throttled;
+	}
+
+	// Equivalent of waiting on the vsync event, the game advances if it isn't paused
+	void waitForVsync();
+	// Catches up on the frames that would have run in realtime while unpaused, only when throttled
+	void update();
+
+	void pause();
+	void unpause();
+	// Runs one frame right away while paused, like Yuzu's frame advance
+	void stepFrame();
+
+	uint64_t getFrameCount();
+	uint64_t getInputPollCount();
+
+	// Returns false if the range is outside of the fake game's memory
+	uint8_t readMemory(uint64_t addr, uint8_t* buf, uint64_t size);
+
+	// The RAM is the whole state of the fake game, so that is all a savestate has to hold
+	void saveState(std::vector<uint8_t>& buf);
+	// Returns false if buf isn't a state from this platform
+	uint8_t loadState(const std::vector<uint8_t>& buf);
+
+	// HID sink, returns the index of the new controller
+	uint8_t attachController();
+	void detachController(uint8_t index);
+	void setControllerState(uint8_t index, ControllerData& state);
+	uint8_t getNumControllers();
+
+	// Can be changed from any thread at any time, like a person pressing buttons
+	void setPhysicalController(ControllerData& state);
+	void detachPhysicalController();
+	// Returns false if nobody is holding one
+	uint8_t readPhysicalController(ControllerData& state);
+
+	// Copies one RGBA scanline into buf, which has to be SIMULATED_SCREEN_WIDTH * 4 long
+	void readFramebufferRow(uint16_t y, uint8_t* buf);
+	void readPixel(uint16_t x, uint16_t y, uint8_t* rgba);
+};
+
+#endif
@@ -1,3 +1,116 @@
 #include "yuzuSyscalls.hpp"
 
-Syscalls::Syscalls() {}
\ No newline at end of file
+Syscalls::Syscalls() {}
+
+#ifdef YUZU
+uint8_t Syscalls::readScreenFramebuffer(std::vector<uint8_t>& buf, int& width, int& height) {
+	if(function_emu_getscreenframebuffer) {
+		// Yuzu reports the real size, try again if the resolution was scaled up
+		if(buf.size() < YUZU_SCREEN_WIDTH * YUZU_SCREEN_HEIGHT * 4) {
+			buf.resize(YUZU_SCREEN_WIDTH * YUZU_SCREEN_HEIGHT * 4);
+		}
+		if(function_emu_getscreenframebuffer(yuzuInstance, buf.data(), buf.size(), &width, &height, true)) {
+			buf.resize(width * height * 4);
+			return true;
+		}
+		if((uint64_t)width * height * 4 <= buf.size()) {
+			return false;
+		}
+		buf.resize(width * height * 4);
+		return function_emu_getscreenframebuffer(yuzuInstance, buf.data(), buf.size(), &width, &height, true);
+	}
+
+	if(function_emu_getscreenpixel) {
+		// One call per pixel, very slow
+		width  = YUZU_SCREEN_WIDTH;
+		height = YUZU_SCREEN_HEIGHT;
+		buf.resize(width * height * 4);
+		for(int y = 0; y < height; y++) {
+			for(int x = 0; x < width; x++) {
+				memcpy(&buf[(y * width + x) * 4], function_emu_getscreenpixel(yuzuInstance, x, y, true), 4);
+			}
+		}
+		return true;
+	}
+
+	return false;
+}
+
+uint8_t Syscalls::readMemory(uint64_t addr, uint8_t* buf, uint64_t size) {
+	if(function_memory_readbyterange) {
+		uint8_t* memory = function_memory_readbyterange(yuzuInstance, addr, size);
+		if(memory != nullptr) {
+			memcpy(buf, memory, size);
+			return true;
+		}
+	}
+	return false;
+}
+
+uint8_t Syscalls::readMemoryRanges(const uint64_t* addresses, const uint64_t* lengths, uint64_t count, uint8_t* buf) {
+	if(function_memory_readbyteranges) {
+		return function_memory_readbyteranges(yuzuInstance, addresses, lengths, count, buf);
+	}
+
+	uint8_t succeeded = true;
+	for(uint64_t i = 0; i < count; i++) {
+		if(!readMemory(addresses[i], buf, lengths[i])) {
+			memset(buf, 0, lengths[i]);
+			succeeded = false;
+		}
+		buf += lengths[i];
+	}
+	return succeeded;
+}
+
+uint8_t Syscalls::saveState(std::vector<uint8_t>& buf) {
+	if(!hasMemorySavestates()) {
+		return false;
+	}
+
+	// The state rarely changes size, so the last buffer usually fits
+	uint64_t size = function_savestate_savetomemory(yuzuInstance, buf.data(), buf.size());
+	if(size > buf.size()) {
+		buf.resize(size);
+		size = function_savestate_savetomemory(yuzuInstance, buf.data(), buf.size());
+	}
+	if(size == 0 || size > buf.size()) {
+		return false;
+	}
+	buf.resize(size);
+	return true;
+}
+
+uint8_t Syscalls::loadState(const std::vector<uint8_t>& buf) {
+	if(!hasMemorySavestates()) {
+		return false;
+	}
+	return function_savestate_loadfrommemory(yuzuInstance, buf.data(), buf.size());
+}
+uint8_t Syscalls::readJoypad(uint8_t player, ControllerData& controllerData) {
+	if(function_joypad_read == nullptr) {
+		return false;
+	}
+
+	// Yuzu uses the libnx bits
+	uint64_t keys = function_joypad_read(yuzuInstance, player);
+	for(auto const& button : btnToHidKeys) {
+		SET_BIT(controllerData.buttons, (keys & button.second) != 0, button.first);
+	}
+
+	if(function_joypad_readjoystick) {
+		controllerData.LS_X    = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_LS_X);
+		controllerData.LS_Y    = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_LS_Y);
+		controllerData.RS_X    = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_RS_X);
+		controllerData.RS_Y    = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_RS_Y);
+		controllerData.ACCEL_X = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_ACCEL_X);
+		controllerData.ACCEL_Y = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_ACCEL_Y);
+		controllerData.ACCEL_Z = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_ACCEL_Z);
+		controllerData.GYRO_1  = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_GYRO_1);
+		controllerData.GYRO_2  = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_GYRO_2);
+		controllerData.GYRO_3  = function_joypad_readjoystick(yuzuInstance, player, JOYPAD_GYRO_3);
+	}
+
+	return true;
+}
+#endif
@@ -1,13 +1,22 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #ifdef __SWITCH__
 #include <switch.h>
 #endif
 
 #ifdef YUZU
+#include "buttonData.hpp"
 #include "dllFunctionDefinitions.hpp"
 #endif
 
+// Yuzu renders at this size unless the resolution scale is changed
+#define YUZU_SCREEN_WIDTH 1280
+#define YUZU_SCREEN_HEIGHT 720
+
 class Syscalls {
 private:
 	void* yuzuInstance;
@@ -21,6 +30,15 @@ public:
 	YUZU_FUNC(emu_message)
 	YUZU_FUNC(emu_framecount)
 	YUZU_FUNC(emu_emulating)
+	YUZU_FUNC(emu_getscreenpixel)
+	YUZU_FUNC(emu_getscreenframebuffer)
+	YUZU_FUNC(memory_readbyterange)
+	YUZU_FUNC(memory_readbyteranges)
+	YUZU_FUNC(savestate_savetomemory)
+	YUZU_FUNC(savestate_loadfrommemory)
+	YUZU_FUNC(joypad_getpollcount)
+	YUZU_FUNC(joypad_read)
+	YUZU_FUNC(joypad_readjoystick)
 // Etc...
 #endif
 
@@ -29,4 +47,41 @@ public:
 	void setYuzuInstance(void* instance) {
 		yuzuInstance = instance;
 	}
-};
\ No newline at end of file
+
+	void* getYuzuInstance() {
+		return yuzuInstance;
+	}
+
+#ifdef YUZU
+	// Older Yuzu builds only have the per pixel and single range functions, these fall back to them
+	uint8_t hasBulkFramebuffer() {
+		return function_emu_getscreenframebuffer != nullptr;
+	}
+
+	// Whole screen as RGBA, buf is resized to fit
+	uint8_t readScreenFramebuffer(std::vector<uint8_t>& buf, int& width, int& height);
+
+	uint8_t readMemory(uint64_t addr, uint8_t* buf, uint64_t size);
+	// Every range is written back to back into buf
+	uint8_t readMemoryRanges(const uint64_t* addresses, const uint64_t* lengths, uint64_t count, uint8_t* buf);
+
+	uint8_t hasMemorySavestates() {
+		return function_savestate_savetomemory != nullptr && function_savestate_loadfrommemory != nullptr;
+	}
+
+	uint8_t readInputPollCount(uint64_t& count) {
+		if(function_joypad_getpollcount == nullptr) {
+			return false;
+		}
+		count = function_joypad_getpollcount(yuzuInstance);
+		return true;
+	}
+
+	// What the player is holding on the real controller, returns false if Yuzu can't say
+	uint8_t readJoypad(uint8_t player, ControllerData& controllerData);
+
+	// buf is resized to the size of the state
+	uint8_t saveState(std::vector<uint8_t>& buf);
+	uint8_t loadState(const std::vector<uint8_t>& buf);
+#endif
+};